@@ -0,0 +1,289 @@
+/**
+ * @file arq_loopback.cpp
+ * @brief Banco de pruebas del ARQ (telemetry_arq.cpp) sobre un canal con pérdidas
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Simula en tiempo virtual (pasos de 1 ms) el emisor del firmware y el
+ * receptor de bridge/frame_decoder unidos por:
+ * - una bajada a la velocidad de la UART (baudios/10 bytes por segundo),
+ *   precedida por un buffer de TELEM_TXBUF_BYTES como telemetry_txbuf
+ * - una subida para los acuses con el mismo retardo
+ * - pérdidas por trama en ambos sentidos: la trama se corrompe en un byte
+ *   al azar y el receptor la descarta por CRC, como con ruido en la línea
+ *
+ * El emisor tiene siempre paquetes que enviar (sintéticos, de todos los
+ * tipos). Para cada tasa de pérdida compara tres modos:
+ * - sin ARQ: cada trama se envía una vez
+ * - parada y espera: ARQ con ventana de 1 trama
+ * - ventana: ARQ con TELEM_ARQ_WINDOW tramas
+ * y muestra el caudal útil (paquetes entregados en orden y sin repetir,
+ * comprobados contra los originales por su JSON) y qué parte del enlace
+ * supone. Comprueba además que ninguna repetición vence antes del plazo
+ * que anuncia telemetry_arq_tx_next_due_ms(), que es lo que duerme el
+ * transmisor del firmware.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -I../../include arq_loopback.cpp ../../src/telemetry_arq.cpp \
+ *       ../../src/telemetry_frame.cpp ../../src/telemetry_delta.cpp ../../src/telemetry_schema.cpp \
+ *       -o arq_loopback
+ *
+ * Uso:
+ *   ./arq_loopback [baudios] [segundos] [retardo ms] [delta 0/1]   (por defecto 115200 30 20 0)
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+#include "../../include/telemetry_arq.h"
+#include "../../include/telemetry_frame.h"
+#include "../../include/telemetry_delta.h"
+#include "../../include/telemetry_schema.h"
+#include "../../include/telemetry_txbuf.h"
+
+/** @brief Generador pseudoaleatorio reproducible (xorshift32) */
+static uint32_t g_rng = 1;
+static uint32_t rng(void) {
+  g_rng ^= g_rng << 13;
+  g_rng ^= g_rng >> 17;
+  g_rng ^= g_rng << 5;
+  return g_rng;
+}
+static bool chance(double p) {
+  return (rng() & 0xFFFFFF) < (uint32_t)(p * 0x1000000);
+}
+
+/**
+ * @brief Byte en un sentido del canal con su instante de llegada
+ */
+typedef struct {
+  uint8_t byte;
+  uint32_t arrive_ms;
+} wire_byte_t;
+
+/**
+ * @brief Parámetros de una ejecución
+ */
+typedef struct {
+  uint32_t baud;
+  uint32_t seconds;
+  uint32_t delay_ms;
+  bool delta;
+  double loss;
+  bool arq;
+  uint32_t window;
+} run_cfg_t;
+
+typedef struct {
+  uint32_t generated;
+  uint32_t delivered;
+  uint64_t goodput_bytes;
+  uint32_t mismatches;
+  uint32_t retransmissions;
+  uint32_t abandoned;
+  uint64_t wire_bytes;
+  uint32_t early_due;       /**< Repeticiones vencidas antes de lo anunciado por telemetry_arq_tx_next_due_ms() */
+} run_result_t;
+
+/** @brief JSON de cada paquete generado, para comprobar lo entregado */
+static std::vector<std::string> g_sent_json;
+/** @brief Bytes de la primera transmisión de cada paquete (caudal útil) */
+static std::vector<uint16_t> g_sent_len;
+
+/**
+ * @brief Paquete sintético número i (timestamp = i, para identificarlo al llegar)
+ */
+static void make_packet(uint32_t i, telemetry_packet_t* p) {
+  memset(p, 0, sizeof(*p));
+  p->header.type = (telem_data_type_t)(i % TELEM_DATA_TYPE_COUNT);
+  p->header.timestamp = i;
+  p->header.sequence = (uint16_t)i;
+  uint8_t* raw = (uint8_t*)p + sizeof(p->header);
+  for (size_t b = 0; b < sizeof(*p) - sizeof(p->header); b++) {
+    raw[b] = (uint8_t)((i / TELEM_DATA_TYPE_COUNT + b) & 0x1F); // Cambia poco entre paquetes del mismo tipo
+  }
+}
+
+/**
+ * @brief Receptor de tierra: decodifica en orden y comprueba contra lo enviado
+ */
+typedef struct {
+  telemetry_frame_rx_t rx;
+  telemetry_delta_ctx_t delta;
+  run_result_t* result;
+  int64_t last_index;
+} ground_t;
+
+static void ground_deliver(const uint8_t* frame, uint16_t len, void* arg) {
+  ground_t* g = (ground_t*)arg;
+  telemetry_packet_t packet;
+  char json[256];
+  if (!telemetry_frame_rx_decode(&g->rx, frame, len, &packet, NULL)) return;
+  uint32_t index = packet.header.timestamp;
+  telemetry_schema_format_json(&packet, json, sizeof(json));
+  if (index >= g_sent_json.size() || (int64_t)index <= g->last_index || g_sent_json[index] != json) {
+    g->result->mismatches++;
+    return;
+  }
+  g->last_index = index;
+  g->result->delivered++;
+  g->result->goodput_bytes += g_sent_len[index];
+}
+
+/**
+ * @brief Pone una trama en un sentido del canal, dañándola con probabilidad loss
+ */
+static void channel_put(std::deque<wire_byte_t>& wire, const uint8_t* frame, size_t len, double loss,
+                        double* next_free_ms, uint32_t now_ms, double bytes_per_ms, uint32_t delay_ms) {
+  size_t corrupt = (len > 2 && chance(loss)) ? 1 + rng() % (len - 2) : len; // Nunca un delimitador
+  double t = (*next_free_ms > now_ms) ? *next_free_ms : (double)now_ms;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t b = frame[i];
+    if (i == corrupt) b = (uint8_t)(b ^ (1 + rng() % 255));
+    t += 1.0 / bytes_per_ms;
+    wire.push_back({ b, (uint32_t)t + delay_ms });
+  }
+  *next_free_ms = t;
+}
+
+static run_result_t run(const run_cfg_t* cfg) {
+  run_result_t result;
+  memset(&result, 0, sizeof(result));
+  g_sent_json.clear();
+  g_sent_len.clear();
+  g_rng = 12345;
+
+  const double bytes_per_ms = cfg->baud / (double)TELEM_TXBUF_BITS_PER_BYTE / 1000.0;
+  static telemetry_arq_tx_t tx;
+  telemetry_arq_tx_init(&tx, 0, 0);
+  telemetry_delta_ctx_t tx_delta;
+  telemetry_delta_init(&tx_delta, 0);
+  uint16_t frame_seq[TELEM_DATA_TYPE_COUNT] = { 0 };
+
+  static ground_t ground;
+  telemetry_frame_rx_init(&ground.rx);
+  telemetry_delta_init(&ground.delta, 0);
+  ground.rx.delta = &ground.delta;
+  ground.result = &result;
+  ground.last_index = -1;
+  static telemetry_arq_rx_t arq_rx;
+  telemetry_arq_rx_init(&arq_rx);
+
+  std::deque<wire_byte_t> down, up;
+  double down_free_ms = 0, up_free_ms = 0;
+  const uint32_t end_ms = cfg->seconds * 1000;
+  uint8_t frame[TELEM_FRAME_MAX_BYTES];
+
+  for (uint32_t now = 0; now < end_ms; now++) {
+    // Subida: acuses que llegan al satélite
+    while (!up.empty() && up.front().arrive_ms <= now) {
+      telemetry_arq_tx_uplink(&tx, up.front().byte, now);
+      up.pop_front();
+    }
+
+    // Emisor: como mucho lo que cabe en el buffer de transmisión
+    auto queued = [&]() { return (uint32_t)(down_free_ms > now ? (down_free_ms - now) * bytes_per_ms : 0); };
+    if (cfg->arq) {
+      const uint8_t* again;
+      uint16_t len;
+      // El firmware duerme lo que anuncia telemetry_arq_tx_next_due_ms(): nada puede vencer antes
+      uint32_t due_in = telemetry_arq_tx_next_due_ms(&tx, now);
+      while (queued() < TELEM_TXBUF_BYTES && (again = telemetry_arq_tx_due(&tx, now, &len)) != NULL) {
+        if (due_in > 0) result.early_due++;
+        due_in = 0;
+        channel_put(down, again, len, cfg->loss, &down_free_ms, now, bytes_per_ms, cfg->delay_ms);
+      }
+      uint32_t types = telemetry_arq_tx_take_abandoned(&tx);
+      for (uint32_t t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+        if (types & (1UL << t)) telemetry_delta_invalidate(&tx_delta, (telem_data_type_t)t);
+      }
+    }
+    while (queued() + TELEM_FRAME_MAX_BYTES < TELEM_TXBUF_BYTES &&
+           (!cfg->arq || telemetry_arq_tx_in_flight(&tx) < cfg->window)) {
+      telemetry_packet_t p;
+      uint32_t index = (uint32_t)g_sent_json.size();
+      make_packet(index, &p);
+      char json[256];
+      telemetry_schema_format_json(&p, json, sizeof(json));
+      telemetry_delta_ctx_t* delta = cfg->delta ? &tx_delta : NULL;
+      size_t len = cfg->arq
+          ? telemetry_frame_encode_link(delta, &p, frame_seq[p.header.type], telemetry_arq_tx_next_seq(&tx), frame, sizeof(frame))
+          : (delta ? telemetry_frame_encode_delta(delta, &p, frame_seq[p.header.type], frame, sizeof(frame))
+                   : telemetry_frame_encode(&p, frame_seq[p.header.type], frame, sizeof(frame)));
+      frame_seq[p.header.type]++;
+      g_sent_json.push_back(json);
+      g_sent_len.push_back((uint16_t)len);
+      if (cfg->arq) telemetry_arq_tx_store(&tx, frame, (uint16_t)len, (uint8_t)p.header.type, now);
+      channel_put(down, frame, len, cfg->loss, &down_free_ms, now, bytes_per_ms, cfg->delay_ms);
+    }
+
+    // Tierra: tramas que llegan en este milisegundo y un acuse si hubo alguna
+    bool ack = false;
+    while (!down.empty() && down.front().arrive_ms <= now) {
+      uint8_t b = down.front().byte;
+      down.pop_front();
+      if (!telemetry_frame_split(&ground.rx, b)) continue;
+      if (!cfg->arq) {
+        ground_deliver(ground.rx.buf, ground.rx.len, &ground);
+      } else if (telemetry_arq_rx_accept(&arq_rx, ground.rx.buf, ground.rx.len, ground_deliver, &ground) >= 0) {
+        ack = true;
+      }
+    }
+    size_t ack_len;
+    if (ack && (ack_len = telemetry_arq_rx_ack(&arq_rx, frame, sizeof(frame))) > 0) {
+      channel_put(up, frame, ack_len, cfg->loss, &up_free_ms, now, bytes_per_ms, cfg->delay_ms);
+    }
+  }
+
+  result.generated = (uint32_t)g_sent_json.size();
+  result.retransmissions = tx.retransmissions;
+  result.abandoned = tx.frames_abandoned;
+  result.wire_bytes = (uint64_t)(cfg->seconds * 1000.0 * bytes_per_ms);
+  return result;
+}
+
+int main(int argc, char** argv) {
+  run_cfg_t cfg;
+  cfg.baud = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 115200;
+  cfg.seconds = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : 30;
+  cfg.delay_ms = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 10) : 20;
+  cfg.delta = (argc > 4) ? atoi(argv[4]) != 0 : false;
+  if (cfg.baud == 0 || cfg.seconds == 0) {
+    fprintf(stderr, "uso: %s [baudios] [segundos] [retardo ms] [delta 0/1]\n", argv[0]);
+    return 1;
+  }
+
+  printf("Enlace %u baudios, %u s, retardo %u ms en cada sentido, %s; ARQ: ventana %u, RTO %u ms, %u envíos\n",
+         cfg.baud, cfg.seconds, cfg.delay_ms, cfg.delta ? "tramas delta" : "tramas de esquema",
+         (unsigned)TELEM_ARQ_WINDOW, (unsigned)TELEM_ARQ_RTO_MS, (unsigned)TELEM_ARQ_MAX_TRIES);
+  printf("%-7s %-15s %11s %8s %10s %10s %10s %8s\n", "pérdida", "modo", "paquetes/s", "útil", "entregado",
+         "repetidas", "abandonad", "errores");
+
+  static const double kLoss[] = { 0.0, 0.01, 0.02, 0.05, 0.10, 0.20, 0.30 };
+  static const struct { const char* name; bool arq; uint32_t window; } kModes[] = {
+    { "sin ARQ", false, 0 },
+    { "parada y espera", true, 1 },
+    { "ventana", true, TELEM_ARQ_WINDOW },
+  };
+  bool ok = true;
+  for (double loss : kLoss) {
+    for (const auto& mode : kModes) {
+      cfg.loss = loss;
+      cfg.arq = mode.arq;
+      cfg.window = mode.window;
+      run_result_t r = run(&cfg);
+      printf("%5.0f%%  %-15s %11.1f %7.1f%% %9.1f%% %10u %10u %8u\n", loss * 100, mode.name,
+             r.delivered / (double)cfg.seconds, 100.0 * r.goodput_bytes / r.wire_bytes,
+             r.generated ? 100.0 * r.delivered / r.generated : 0.0, r.retransmissions, r.abandoned, r.mismatches);
+      if (r.early_due) {
+        printf("ERROR: %u repeticiones vencidas antes del plazo de telemetry_arq_tx_next_due_ms()\n", r.early_due);
+        ok = false;
+      }
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file decimation_sim.cpp
+ * @brief Simulación del diezmado adaptativo (telemetry_decimation.cpp) con el enlace saturado
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Simula en tiempo virtual (pasos de 1 ms) la cadena del firmware cuando se
+ * adquiere más de lo que el enlace puede bajar:
+ * - adquisición cada periodo con los tipos y cadencias de
+ *   telemetry_acquisition.cpp y las prioridades de telemetry_type_priority()
+ * - buffer de TELEM_BUFFER_SIZE paquetes (o el que se indique) con la
+ *   política por defecto, TELEM_OVERFLOW_DROP_NEWEST: lleno, se pierde lo nuevo
+ * - transmisor que encola tramas binarias en un buffer de TELEM_TXBUF_BYTES
+ *   mientras quepan, con o sin diezmado
+ * - UART a baudios/10 bytes por segundo
+ *
+ * Para cada velocidad compara sin y con diezmado:
+ * - frescura: cada segundo, la edad en tierra de la última muestra recibida
+ *   de cada tipo (media de todos los tipos y la de potencia)
+ * - edad media de los paquetes al llegar
+ * - paquetes perdidos por desbordamiento y descartados por el diezmado
+ * - uso del enlace
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -I../../include decimation_sim.cpp ../../src/telemetry_decimation.cpp \
+ *       ../../src/telemetry_frame.cpp ../../src/telemetry_delta.cpp ../../src/telemetry_schema.cpp \
+ *       -o decimation_sim
+ *
+ * Uso:
+ *   ./decimation_sim [periodo ms] [segundos] [capacidad]   (por defecto 200 600 TELEM_BUFFER_SIZE)
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include "../../include/telemetry_decimation.h"
+#include "../../include/telemetry_frame.h"
+#include "../../include/telemetry_txbuf.h"
+
+/** @brief Cadencia de cada tipo en ciclos de adquisición (s_fillers de telemetry_acquisition.cpp) */
+static const struct {
+  telem_data_type_t type;
+  uint8_t period;
+  uint8_t priority;
+} s_types[] = {
+  { TELEM_SYSTEM_STATUS,        1,  TELEM_PRIORITY_NORMAL },
+  { TELEM_POWER_DATA,           1,  TELEM_PRIORITY_HIGH },
+  { TELEM_TEMPERATURE_DATA,     1,  TELEM_PRIORITY_NORMAL },
+  { TELEM_COMMUNICATION_STATUS, 1,  TELEM_PRIORITY_NORMAL },
+  { TELEM_STORAGE_METRICS,      15, TELEM_PRIORITY_LOW },
+  { TELEM_LATENCY_METRICS,      3,  TELEM_PRIORITY_LOW },
+};
+#define SIM_TYPES (sizeof(s_types) / sizeof(s_types[0]))
+
+/** @brief TELEM_BUFFER_SIZE por defecto (telemetry_storage.h depende de FreeRTOS) */
+#define SIM_BUFFER_SIZE 1024
+
+/** @brief Bytes de la trama binaria de cada tipo */
+static uint32_t g_frame_bytes[TELEM_DATA_TYPE_COUNT];
+
+typedef struct {
+  telem_header_t header;
+  uint32_t acquired_ms;
+} sim_packet_t;
+
+typedef struct {
+  uint32_t type;
+  uint32_t acquired_ms;
+  uint64_t end_byte;    /**< Posición de su último byte en el flujo de la UART */
+} in_flight_t;
+
+typedef struct {
+  uint32_t generated;
+  uint32_t delivered;
+  uint32_t lost;
+  uint32_t decimated;
+  double age_sum_ms;
+  double stale_sum_ms;
+  double stale_power_sum_ms;
+  uint32_t stale_samples;
+  uint64_t link_bytes;
+  uint32_t backlog_end;
+} sim_result_t;
+
+static void measure_frames(void) {
+  for (uint32_t t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+    telemetry_packet_t p;
+    memset(&p, 0, sizeof(p));
+    p.header.type = (telem_data_type_t)t;
+    uint8_t frame[TELEM_FRAME_MAX_BYTES];
+    g_frame_bytes[t] = (uint32_t)telemetry_frame_encode(&p, 0, frame, sizeof(frame));
+  }
+}
+
+static sim_result_t run(uint32_t baud, uint32_t period_ms, uint32_t seconds, uint32_t capacity, bool decimate) {
+  sim_result_t r;
+  memset(&r, 0, sizeof(r));
+  telemetry_decimation_t dec;
+  telemetry_decimation_init(&dec);
+
+  std::deque<sim_packet_t> queue;
+  std::deque<in_flight_t> link;
+  uint64_t queued_bytes = 0;     // Bytes encolados en la UART desde el inicio
+  double sent_bytes = 0;         // Bytes que ya han salido
+  const double bytes_per_ms = baud / 10.0 / 1000.0;
+  uint32_t cycle = 0;
+  int64_t last_acquired[TELEM_DATA_TYPE_COUNT];
+  for (uint32_t t = 0; t < TELEM_DATA_TYPE_COUNT; t++) last_acquired[t] = -1;
+
+  for (uint32_t now = 0; now < seconds * 1000; now++) {
+    if (now % period_ms == 0) {
+      for (uint32_t i = 0; i < SIM_TYPES; i++) {
+        if (cycle % s_types[i].period != 0) continue;
+        r.generated++;
+        if (queue.size() >= capacity) {
+          r.lost++;
+          continue;
+        }
+        sim_packet_t p;
+        memset(&p, 0, sizeof(p));
+        p.header.type = s_types[i].type;
+        p.header.priority = s_types[i].priority;
+        p.acquired_ms = now;
+        queue.push_back(p);
+      }
+      cycle++;
+    }
+
+    // Transmisor: encola mientras quepa en el buffer de la UART
+    while (!queue.empty()) {
+      const sim_packet_t& p = queue.front();
+      uint32_t len = g_frame_bytes[p.header.type];
+      if (queued_bytes + len - (uint64_t)sent_bytes > TELEM_TXBUF_BYTES) break;
+      if (decimate && !telemetry_decimation_keep(&dec, &p.header, (uint32_t)queue.size() - 1)) {
+        queue.pop_front();
+        continue;
+      }
+      queued_bytes += len;
+      link.push_back({ (uint32_t)p.header.type, p.acquired_ms, queued_bytes });
+      queue.pop_front();
+    }
+
+    // UART
+    sent_bytes += bytes_per_ms;
+    if (sent_bytes > queued_bytes) sent_bytes = (double)queued_bytes;
+    while (!link.empty() && link.front().end_byte <= (uint64_t)sent_bytes) {
+      r.delivered++;
+      r.age_sum_ms += now - link.front().acquired_ms;
+      last_acquired[link.front().type] = link.front().acquired_ms;
+      link.pop_front();
+    }
+
+    // Frescura en tierra, una vez por segundo
+    if (now % 1000 == 999) {
+      for (uint32_t i = 0; i < SIM_TYPES; i++) {
+        uint32_t t = s_types[i].type;
+        double stale = (last_acquired[t] < 0) ? now : now - last_acquired[t];
+        r.stale_sum_ms += stale / SIM_TYPES;
+        if (t == TELEM_POWER_DATA) r.stale_power_sum_ms += stale;
+      }
+      r.stale_samples++;
+    }
+  }
+  r.decimated = dec.dropped_total;
+  r.link_bytes = (uint64_t)sent_bytes;
+  r.backlog_end = (uint32_t)queue.size();
+  return r;
+}
+
+int main(int argc, char** argv) {
+  uint32_t period_ms = (argc > 1) ? (uint32_t)atoi(argv[1]) : 200;
+  uint32_t seconds = (argc > 2) ? (uint32_t)atoi(argv[2]) : 600;
+  uint32_t capacity = (argc > 3) ? (uint32_t)atoi(argv[3]) : SIM_BUFFER_SIZE;
+  if (period_ms == 0 || seconds == 0 || capacity == 0) {
+    fprintf(stderr, "uso: %s [periodo ms] [segundos] [capacidad]\n", argv[0]);
+    return 1;
+  }
+  measure_frames();
+
+  double offered = 0;
+  for (uint32_t i = 0; i < SIM_TYPES; i++) {
+    offered += g_frame_bytes[s_types[i].type] * 1000.0 / period_ms / s_types[i].period;
+  }
+  printf("Adquisición cada %u ms (%.0f B/s en tramas binarias), %u s, buffer de %u paquetes\n", period_ms,
+         offered, seconds, capacity);
+  printf("Diezmado: prioridad <= %u, escalón %u paquetes, hasta 1/%u\n", (unsigned)TELEM_DECIMATION_MAX_PRIORITY,
+         (unsigned)TELEM_DECIMATION_STEP, 1U << TELEM_DECIMATION_MAX_LEVEL);
+  printf("baudios  diezmado  edad tierra  edad potencia  edad al llegar  perdidos  descartados  entregados  enlace  retraso final\n");
+
+  const uint32_t bauds[] = { 1200, 2400, 4800, 9600 };
+  for (uint32_t b = 0; b < sizeof(bauds) / sizeof(bauds[0]); b++) {
+    for (int decimate = 0; decimate <= 1; decimate++) {
+      sim_result_t r = run(bauds[b], period_ms, seconds, capacity, decimate != 0);
+      double link_pct = 100.0 * r.link_bytes / (bauds[b] / 10.0 * seconds);
+      printf("%7u  %-8s  %9.1f s  %11.1f s  %12.1f s  %8u  %11u  %10u  %5.1f%%  %13u\n", bauds[b],
+             decimate ? "sí" : "no", r.stale_sum_ms / r.stale_samples / 1000.0,
+             r.stale_power_sum_ms / r.stale_samples / 1000.0,
+             r.delivered ? r.age_sum_ms / r.delivered / 1000.0 : 0.0, r.lost, r.decimated, r.delivered,
+             link_pct, r.backlog_end);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file delta_benchmark.cpp
+ * @brief Relación de compresión y coste de la codificación delta sobre telemetría grabada
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Lee una captura del puerto serie en modo binario (TELEM_DOWNLINK_BINARY=1,
+ * con o sin TELEM_DOWNLINK_DELTA), reconstruye los paquetes y los vuelve a
+ * codificar con telemetry_delta.cpp para varios intervalos de fotograma
+ * clave. Para cada uno muestra bytes por paquete frente a JSON y a la
+ * codificación de esquema, y el tiempo medio de codificación. Comprueba
+ * además que la decodificación reproduce cada paquete (los float, dentro de
+ * los decimales del esquema).
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -I../../include delta_benchmark.cpp ../../src/telemetry_frame.cpp \
+ *       ../../src/telemetry_delta.cpp ../../src/telemetry_schema.cpp -o delta_benchmark
+ *
+ * Uso:
+ *   cat /dev/ttyUSB0 > captura.bin      (con el firmware en modo binario)
+ *   ./delta_benchmark captura.bin
+ *
+ * Las cifras de coste son del host; en el ESP32 (240 MHz) cabe esperar
+ * un orden de magnitud más.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "../../include/telemetry_frame.h"
+#include "../../include/telemetry_schema.h"
+#include "../../include/telemetry_delta.h"
+
+/** @brief Repeticiones de la codificación para medir tiempos estables */
+static const int kRounds = 50;
+
+/**
+ * @brief Compara un paquete reconstruido con el original campo a campo
+ */
+static bool same_packet(const telemetry_packet_t& a, const telemetry_packet_t& b) {
+  if (a.header.type != b.header.type || a.header.timestamp != b.header.timestamp ||
+      a.header.sequence != b.header.sequence) {
+    return false;
+  }
+  const telemetry_schema_t* schema = telemetry_schema_get(a.header.type);
+  const uint8_t* pa = (const uint8_t*)&a;
+  const uint8_t* pb = (const uint8_t*)&b;
+  for (uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    uint8_t width = telemetry_field_width(field->kind);
+    for (uint8_t i = 0; i < field->count; i++) {
+      uint32_t off = field->offset + i * width;
+      if (field->kind == TELEM_FIELD_F32) {
+        float fa, fb;
+        memcpy(&fa, pa + off, 4);
+        memcpy(&fb, pb + off, 4);
+        if (std::fabs(fa - fb) > 0.5f * std::pow(10.0f, -field->decimals) + 1e-6f) return false;
+      } else if (memcmp(pa + off, pb + off, width) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "uso: %s captura.bin\n", argv[0]);
+    return 1;
+  }
+  FILE* in = fopen(argv[1], "rb");
+  if (!in) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  // Paquetes de la captura
+  std::vector<telemetry_packet_t> packets;
+  telemetry_frame_rx_t rx;
+  telemetry_frame_rx_init(&rx);
+  telemetry_delta_ctx_t rx_delta;
+  telemetry_delta_init(&rx_delta, 0);
+  rx.delta = &rx_delta;
+  telemetry_packet_t packet;
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if (telemetry_frame_rx_push(&rx, (uint8_t)c, &packet, NULL)) {
+      packets.push_back(packet);
+    }
+  }
+  fclose(in);
+  if (packets.empty()) {
+    fprintf(stderr, "la captura no contiene tramas válidas\n");
+    return 1;
+  }
+
+  // Referencias: JSON (modo por defecto) y codificación de esquema
+  size_t json_bytes = 0, schema_bytes = 0;
+  char json[256];
+  uint8_t buf[TELEM_DELTA_MAX_BYTES];
+  for (const telemetry_packet_t& p : packets) {
+    json_bytes += telemetry_schema_format_json(&p, json, sizeof(json)) + 1; // '\n'
+    schema_bytes += telemetry_schema_encode(&p, buf, sizeof(buf));
+  }
+  double n = (double)packets.size();
+  printf("%zu paquetes\n", packets.size());
+  printf("%-10s %10s %10s %10s %12s\n", "keyframe", "B/paquete", "vs JSON", "vs esquema", "ns/paquete");
+  printf("%-10s %10.1f %10s %10s %12s\n", "json", json_bytes / n, "1.0x", "-", "-");
+  printf("%-10s %10.1f %9.1fx %10s %12s\n", "esquema", schema_bytes / n, (double)json_bytes / schema_bytes, "1.0x", "-");
+
+  std::vector<uint8_t> stream(packets.size() * TELEM_DELTA_MAX_BYTES);
+  const uint16_t intervals[] = { 1, 4, 8, 16, 32, 64 };
+  bool all_ok = true;
+  for (uint16_t interval : intervals) {
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < kRounds; round++) {
+      telemetry_delta_ctx_t enc;
+      telemetry_delta_init(&enc, interval);
+      bytes = 0;
+      for (const telemetry_packet_t& p : packets) {
+        bytes += telemetry_delta_encode(&enc, &p, stream.data() + bytes, TELEM_DELTA_MAX_BYTES);
+      }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // Ida y vuelta sobre la última ronda
+    telemetry_delta_ctx_t dec;
+    telemetry_delta_init(&dec, interval);
+    size_t pos = 0;
+    size_t mismatches = 0;
+    for (const telemetry_packet_t& p : packets) {
+      uint32_t used = telemetry_delta_decode(&dec, stream.data() + pos, (uint32_t)(bytes - pos), &packet);
+      pos += used;
+      if (used == 0 || !same_packet(p, packet)) mismatches++;
+    }
+    all_ok = all_ok && mismatches == 0;
+
+    printf("%-10u %10.1f %9.1fx %9.1fx %12.0f%s\n", interval, bytes / n, (double)json_bytes / bytes,
+           (double)schema_bytes / bytes, ns / (kRounds * n), mismatches ? "  (ERROR de ida y vuelta)" : "");
+  }
+  return all_ok ? 0 : 2;
+}
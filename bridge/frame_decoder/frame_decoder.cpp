@@ -0,0 +1,103 @@
+/**
+ * @file frame_decoder.cpp
+ * @brief Decodificador en el host de las tramas binarias de bajada
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Lee el flujo del ESP32 compilado con TELEM_DOWNLINK_BINARY=1 (tramas de
+ * include/telemetry_frame.h) y escribe por stdout una línea JSON por paquete,
+ * idéntica a la que el firmware envía en modo JSON, de modo que el bridge
+ * de Fomalhaut no necesita cambios. Reutiliza telemetry_frame.cpp,
+ * telemetry_delta.cpp y telemetry_schema.cpp del firmware. Las tramas delta
+ * (TELEM_DOWNLINK_DELTA=1) se reconstruyen igual; tras una trama perdida se
+ * espera al siguiente fotograma clave de ese tipo.
+ *
+ * Las tramas con secuencia de enlace (TELEM_DOWNLINK_ARQ=1) pasan por el
+ * receptor de telemetry_arq.h, que las reordena y descarta repeticiones.
+ * Si la entrada es un terminal (el puerto serie), tras cada lectura se
+ * devuelve un acuse por el mismo puerto; con un fichero o stdin no hay
+ * acuses y las tramas se entregan igualmente en orden.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -I../../include frame_decoder.cpp ../../src/telemetry_frame.cpp \
+ *       ../../src/telemetry_delta.cpp ../../src/telemetry_schema.cpp ../../src/telemetry_arq.cpp \
+ *       -o frame_decoder
+ *
+ * Uso:
+ *   stty -F /dev/ttyUSB0 115200 raw
+ *   ./frame_decoder /dev/ttyUSB0        (sin argumento lee de stdin)
+ */
+
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../../include/telemetry_frame.h"
+#include "../../include/telemetry_schema.h"
+#include "../../include/telemetry_delta.h"
+#include "../../include/telemetry_arq.h"
+
+/**
+ * @brief Decodifica una trama ya en orden y escribe su línea JSON
+ */
+static void print_frame(const uint8_t* frame, uint16_t len, void* arg) {
+  telemetry_frame_rx_t* rx = (telemetry_frame_rx_t*)arg;
+  telemetry_packet_t packet;
+  char json[256];
+  if (telemetry_frame_rx_decode(rx, frame, len, &packet, NULL) &&
+      telemetry_schema_format_json(&packet, json, sizeof(json)) > 0) {
+    puts(json);
+    fflush(stdout);
+  }
+}
+
+int main(int argc, char** argv) {
+  int fd = STDIN_FILENO;
+  if (argc > 1) {
+    fd = open(argv[1], O_RDWR | O_NOCTTY);
+    if (fd < 0) fd = open(argv[1], O_RDONLY);
+    if (fd < 0) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+  bool send_acks = isatty(fd) && fd != STDIN_FILENO;
+
+  telemetry_frame_rx_t rx;
+  telemetry_frame_rx_init(&rx);
+  telemetry_delta_ctx_t delta;
+  telemetry_delta_init(&delta, 0);
+  rx.delta = &delta;
+  telemetry_arq_rx_t arq;
+  telemetry_arq_rx_init(&arq);
+
+  uint8_t chunk[512];
+  ssize_t n;
+  while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+    bool ack = false;
+    for (ssize_t i = 0; i < n; i++) {
+      if (!telemetry_frame_split(&rx, chunk[i])) continue;
+      int result = telemetry_arq_rx_accept(&arq, rx.buf, rx.len, print_frame, &rx);
+      if (result < 0) {
+        print_frame(rx.buf, rx.len, &rx); // Sin ARQ (o texto de log entre tramas)
+      } else {
+        ack = true;
+      }
+    }
+    uint8_t frame[TELEM_FRAME_MAX_BYTES];
+    size_t len;
+    if (ack && send_acks && (len = telemetry_arq_rx_ack(&arq, frame, sizeof(frame))) > 0) {
+      if (write(fd, frame, len) != (ssize_t)len) perror("ack");
+    }
+  }
+
+  fprintf(stderr, "frames ok=%lu discarded=%lu unsynced=%lu\n", (unsigned long)rx.frames_ok,
+          (unsigned long)rx.frames_bad, (unsigned long)rx.frames_unsynced);
+  if (arq.synced) {
+    fprintf(stderr, "arq delivered=%lu duplicates=%lu reordered=%lu skipped=%lu\n",
+            (unsigned long)arq.frames_delivered, (unsigned long)arq.duplicates,
+            (unsigned long)arq.out_of_order, (unsigned long)arq.skipped);
+  }
+  if (fd != STDIN_FILENO) close(fd);
+  return 0;
+}
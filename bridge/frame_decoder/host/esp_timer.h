@@ -0,0 +1,20 @@
+/**
+ * @file esp_timer.h
+ * @brief esp_timer_get_time() sobre el reloj monótono del host
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+  #include <chrono>
+  #include <stdint.h>
+
+/** @brief Microsegundos desde un origen fijo, como en el ESP32 */
+inline int64_t esp_timer_get_time(void) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif /* HOST_ESP_TIMER_H */
@@ -0,0 +1,30 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Sustituto de FreeRTOS para compilar módulos del firmware en el host
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Solo lo que usan los módulos que enlazan los bancos de pruebas
+ * (telemetry_storage.cpp): tipos básicos y ticks de 1 ms. Se añade con
+ * -Ihost a la línea de compilación.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+  #include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+
+/** @brief Ticks de 1 ms, como configTICK_RATE_HZ=1000 en el ESP32 */
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif /* HOST_FREERTOS_H */
@@ -0,0 +1,37 @@
+/**
+ * @file semphr.h
+ * @brief Mutex de FreeRTOS sobre std::timed_mutex para el host
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Sin herencia de prioridad: en el host todos los hilos tienen la misma.
+ */
+
+#ifndef HOST_FREERTOS_SEMPHR_H
+#define HOST_FREERTOS_SEMPHR_H
+
+  #include <chrono>
+  #include <mutex>
+  #include "FreeRTOS.h"
+
+typedef std::timed_mutex* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+  return new std::timed_mutex();
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks) {
+  if (ticks == portMAX_DELAY) {
+    mutex->lock();
+    return pdTRUE;
+  }
+  return mutex->try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex) {
+  mutex->unlock();
+  return pdTRUE;
+}
+
+#endif /* HOST_FREERTOS_SEMPHR_H */
@@ -0,0 +1,21 @@
+/**
+ * @file task.h
+ * @brief Tareas de FreeRTOS sobre hilos del host (solo esperas)
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ */
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+  #include <chrono>
+  #include <thread>
+  #include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+
+inline void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+#endif /* HOST_FREERTOS_TASK_H */
@@ -0,0 +1,323 @@
+/**
+ * @file json_benchmark.cpp
+ * @brief Coste por paquete del JSON de bajada: cadena de Serial.print, printf y el serializador del esquema
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Serializa los mismos paquetes (valores como los de telemetry_generators.cpp)
+ * de tres formas y mide el tiempo medio por paquete:
+ * - Serial.print: la antigua send_json_packet() contra un MockStream que
+ *   reproduce Print de Arduino (printNumber/printFloat) y guarda la salida
+ *   en memoria en lugar de la UART
+ * - snprintf: un snprintf por fragmento, como el formateador del esquema
+ *   antes de telemetry_schema sin printf
+ * - esquema: telemetry_schema_format_json()
+ * y comprueba que el esquema produce exactamente el texto de snprintf.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -I../../include json_benchmark.cpp ../../src/telemetry_schema.cpp -o json_benchmark
+ *
+ * Uso:
+ *   ./json_benchmark [paquetes]     (por defecto 100000)
+ *
+ * En el MockStream cada print() es una llamada virtual y un memcpy; en el
+ * ESP32 cada una pasa además por el cerrojo y la FIFO de la UART, así que
+ * la diferencia real es mayor que la medida aquí.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../../include/telemetry_schema.h"
+
+/* ----------------------------------------------------------------------------
+ * MockStream: Print de Arduino (ESP32) con salida a memoria
+ * ------------------------------------------------------------------------- */
+
+class MockStream {
+public:
+  char buf[512];
+  size_t len = 0;
+
+  virtual ~MockStream() {}
+  virtual size_t write(const uint8_t* data, size_t size) {
+    if (len + size > sizeof(buf)) size = sizeof(buf) - len;
+    memcpy(buf + len, data, size);
+    len += size;
+    return size;
+  }
+  size_t write(uint8_t c) { return write(&c, 1); }
+
+  size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char n) { return print((unsigned long)n); }
+  size_t print(int n) { return print((long)n); }
+  size_t print(unsigned int n) { return print((unsigned long)n); }
+  size_t print(long n) {
+    if (n < 0) {
+      size_t t = print('-');
+      return t + printNumber((unsigned long)-n);
+    }
+    return printNumber((unsigned long)n);
+  }
+  size_t print(unsigned long n) { return printNumber(n); }
+  size_t print(double number, int digits) { return printFloat(number, (uint8_t)digits); }
+  size_t println(const char* s) { return print(s) + print("\r\n"); }
+
+private:
+  /** @brief Print::printNumber() en base 10 */
+  size_t printNumber(unsigned long n) {
+    char tmp[8 * sizeof(long) + 1];
+    char* str = &tmp[sizeof(tmp) - 1];
+    *str = '\0';
+    do {
+      unsigned long m = n;
+      n /= 10;
+      *--str = (char)('0' + (m - 10 * n));
+    } while (n);
+    return write((const uint8_t*)str, strlen(str));
+  }
+
+  /** @brief Print::printFloat() */
+  size_t printFloat(double number, uint8_t digits) {
+    size_t n = 0;
+    if (std::isnan(number)) return print("nan");
+    if (std::isinf(number)) return print("inf");
+    if (number > 4294967040.0) return print("ovf");
+    if (number < -4294967040.0) return print("ovf");
+    if (number < 0.0) {
+      n += print('-');
+      number = -number;
+    }
+    double rounding = 0.5;
+    for (uint8_t i = 0; i < digits; ++i) rounding /= 10.0;
+    number += rounding;
+    unsigned long int_part = (unsigned long)number;
+    double remainder = number - (double)int_part;
+    n += print(int_part);
+    if (digits > 0) n += print(".");
+    while (digits-- > 0) {
+      remainder *= 10.0;
+      unsigned int to_print = (unsigned int)remainder;
+      n += print(to_print);
+      remainder -= to_print;
+    }
+    return n;
+  }
+};
+
+/**
+ * @brief Antigua send_json_packet() (los tipos que existían entonces)
+ */
+static void print_chain(MockStream& Serial, const telemetry_packet_t* packet) {
+  switch (packet->header.type) {
+    case TELEM_SYSTEM_STATUS: {
+      const system_status_telem_t* sys = &packet->system;
+      Serial.print("{\"type\":\"system\",\"cpuUsage\":");
+      Serial.print(sys->cpu_usage);
+      Serial.print(",\"memoryFree\":");
+      Serial.print((unsigned long)sys->heap_free);
+      Serial.print(",\"uptime\":");
+      Serial.print((unsigned long)sys->uptime_seconds);
+      Serial.print(",\"taskCount\":");
+      Serial.print(sys->task_count);
+      Serial.print(",\"cpuTemp\":");
+      Serial.print(sys->cpu_temperature, 1);
+      Serial.println("}");
+      break;
+    }
+    case TELEM_POWER_DATA: {
+      const power_telem_t* pwr = &packet->power;
+      Serial.print("{\"type\":\"power\",\"voltage\":");
+      Serial.print(pwr->battery_voltage, 2);
+      Serial.print(",\"current\":");
+      Serial.print(pwr->battery_current, 3);
+      Serial.print(",\"solarVoltage\":");
+      Serial.print(pwr->solar_panel_voltage, 2);
+      Serial.print(",\"solarCurrent\":");
+      Serial.print(pwr->solar_panel_current, 3);
+      Serial.print(",\"batteryLevel\":");
+      Serial.print(pwr->battery_level);
+      Serial.print(",\"batteryTemp\":");
+      Serial.print((int)pwr->battery_temperature);
+      Serial.println("}");
+      break;
+    }
+    case TELEM_TEMPERATURE_DATA: {
+      const temperature_telem_t* temp = &packet->temperature;
+      Serial.print("{\"type\":\"temperature\",\"obcTemp\":");
+      Serial.print(temp->obc_temperature / 10.0, 1);
+      Serial.print(",\"commsTemp\":");
+      Serial.print(temp->comms_temperature / 10.0, 1);
+      Serial.print(",\"payloadTemp\":");
+      Serial.print(temp->payload_temperature / 10.0, 1);
+      Serial.print(",\"batteryTemp\":");
+      Serial.print(temp->battery_temperature / 10.0, 1);
+      Serial.print(",\"externalTemp\":");
+      Serial.print(temp->external_temperature / 10.0, 1);
+      Serial.println("}");
+      break;
+    }
+    case TELEM_COMMUNICATION_STATUS: {
+      const subsystem_status_telem_t* sub = &packet->subsystems;
+      Serial.print("{\"type\":\"comms\",\"commsUptime\":");
+      Serial.print((unsigned long)sub->comms_uptime);
+      Serial.print(",\"successRate\":");
+      Serial.print(sub->command_success_rate);
+      Serial.print(",\"rssi\":");
+      Serial.print((int)sub->rssi_dbm);
+      Serial.print(",\"snr\":");
+      Serial.print((int)sub->snr_db);
+      Serial.println("}");
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/* ----------------------------------------------------------------------------
+ * snprintf por fragmento (formateador anterior del esquema)
+ * ------------------------------------------------------------------------- */
+
+static size_t snprintf_json(const telemetry_packet_t* packet, char* out, size_t capacity) {
+  const telemetry_schema_t* schema = telemetry_schema_get(packet->header.type);
+  const uint8_t* base = (const uint8_t*)packet;
+  size_t len = (size_t)snprintf(out, capacity, "{\"type\":\"%s\"", schema->json_type);
+  for (uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    if (!field->json_key) continue;
+    len += (size_t)snprintf(out + len, capacity - len, ",\"%s\":", field->json_key);
+    if (field->count > 1) len += (size_t)snprintf(out + len, capacity - len, "[");
+    for (uint8_t i = 0; i < field->count; i++) {
+      if (i) len += (size_t)snprintf(out + len, capacity - len, ",");
+      const uint8_t* p = base + field->offset + i * telemetry_field_width(field->kind);
+      long v = 0;
+      switch (field->kind) {
+        case TELEM_FIELD_F32: {
+          float fv;
+          memcpy(&fv, p, 4);
+          len += (size_t)snprintf(out + len, capacity - len, "%.*f", field->decimals, fv);
+          continue;
+        }
+        case TELEM_FIELD_U8: v = *p; break;
+        case TELEM_FIELD_I8: v = (int8_t)*p; break;
+        case TELEM_FIELD_U16: { uint16_t x; memcpy(&x, p, 2); v = x; } break;
+        case TELEM_FIELD_I16: { int16_t x; memcpy(&x, p, 2); v = x; } break;
+        default: { uint32_t x; memcpy(&x, p, 4); v = (long)x; } break;
+      }
+      if (field->decimals == 0) {
+        len += (size_t)snprintf(out + len, capacity - len, "%ld", v);
+      } else {
+        long div = 1;
+        for (uint8_t d = 0; d < field->decimals; d++) div *= 10;
+        unsigned long mag = (unsigned long)(v < 0 ? -v : v);
+        len += (size_t)snprintf(out + len, capacity - len, "%s%lu.%0*lu", v < 0 ? "-" : "", mag / div,
+                                (int)field->decimals, mag % div);
+      }
+    }
+    if (field->count > 1) len += (size_t)snprintf(out + len, capacity - len, "]");
+  }
+  len += (size_t)snprintf(out + len, capacity - len, "}");
+  return len;
+}
+
+/* ----------------------------------------------------------------------------
+ * Paquetes y medida
+ * ------------------------------------------------------------------------- */
+
+static float jitter(float center, int range, float scale) {
+  return center + (float)((rand() % (2 * range)) - range) * scale;
+}
+
+/**
+ * @brief Paquete con valores como los de telemetry_generators.cpp
+ */
+static telemetry_packet_t make_packet(uint32_t i) {
+  telemetry_packet_t p;
+  memset(&p, 0, sizeof(p));
+  p.header.type = (telem_data_type_t)(i % 4); // Los cuatro tipos de la cadena antigua
+  p.header.sequence = (uint16_t)i;
+  switch (p.header.type) {
+    case TELEM_SYSTEM_STATUS:
+      p.system.uptime_seconds = i / 4;
+      p.system.heap_free = 250000 + rand() % 20000;
+      p.system.task_count = 9;
+      p.system.cpu_temperature = jitter(45.0f, 50, 0.1f);
+      break;
+    case TELEM_POWER_DATA:
+      p.power.battery_voltage = jitter(3.3f, 50, 0.001f);
+      p.power.battery_current = jitter(0.1f, 20, 0.001f);
+      p.power.solar_panel_voltage = jitter(5.0f, 100, 0.001f);
+      p.power.solar_panel_current = jitter(0.5f, 100, 0.001f);
+      p.power.battery_level = (uint8_t)(80 + rand() % 20);
+      p.power.battery_temperature = (int8_t)(22 + rand() % 7);
+      break;
+    case TELEM_TEMPERATURE_DATA:
+      p.temperature.obc_temperature = (int16_t)(230 + rand() % 40 - 20);
+      p.temperature.comms_temperature = (int16_t)(240 + rand() % 40 - 20);
+      p.temperature.payload_temperature = (int16_t)(220 + rand() % 40 - 20);
+      p.temperature.battery_temperature = (int16_t)(250 + rand() % 40 - 20);
+      p.temperature.external_temperature = (int16_t)(-150 + rand() % 300);
+      break;
+    default:
+      p.subsystems.comms_uptime = i / 4;
+      p.subsystems.command_success_rate = (uint8_t)(92 + rand() % 7);
+      p.subsystems.rssi_dbm = (int8_t)(-50 - rand() % 31);
+      p.subsystems.snr_db = (int8_t)(8 + rand() % 11);
+      break;
+  }
+  return p;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char** argv) {
+  size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 100000;
+  if (count == 0) {
+    fprintf(stderr, "uso: %s [paquetes]\n", argv[0]);
+    return 1;
+  }
+  std::vector<telemetry_packet_t> packets;
+  for (size_t i = 0; i < count; i++) packets.push_back(make_packet((uint32_t)i));
+
+  // Comprobación: el esquema escribe lo mismo que snprintf
+  char a[256], b[256];
+  size_t mismatches = 0;
+  for (const telemetry_packet_t& p : packets) {
+    snprintf_json(&p, a, sizeof(a));
+    telemetry_schema_format_json(&p, b, sizeof(b));
+    if (strcmp(a, b) != 0 && mismatches++ == 0) fprintf(stderr, "snprintf: %s\nesquema:  %s\n", a, b);
+  }
+
+  size_t bytes = 0;
+  volatile size_t sink = 0; // Evita que el compilador descarte la salida
+  MockStream serial;
+  Clock::time_point t0 = Clock::now();
+  for (const telemetry_packet_t& p : packets) {
+    serial.len = 0;
+    print_chain(serial, &p);
+    bytes += serial.len;
+  }
+  Clock::time_point t1 = Clock::now();
+  for (const telemetry_packet_t& p : packets) sink = sink + snprintf_json(&p, a, sizeof(a));
+  Clock::time_point t2 = Clock::now();
+  for (const telemetry_packet_t& p : packets) sink = sink + telemetry_schema_format_json(&p, b, sizeof(b));
+  Clock::time_point t3 = Clock::now();
+
+  double n = (double)count;
+  double ns_print = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+  double ns_snprintf = std::chrono::duration<double, std::nano>(t2 - t1).count() / n;
+  double ns_schema = std::chrono::duration<double, std::nano>(t3 - t2).count() / n;
+  printf("%zu paquetes, %.1f B/paquete\n", count, bytes / n);
+  printf("%-14s %12s %10s\n", "serializador", "ns/paquete", "vs print");
+  printf("%-14s %12.0f %10s\n", "Serial.print", ns_print, "1.0x");
+  printf("%-14s %12.0f %9.1fx\n", "snprintf", ns_snprintf, ns_print / ns_snprintf);
+  printf("%-14s %12.0f %9.1fx\n", "esquema", ns_schema, ns_print / ns_schema);
+  if (mismatches) printf("ERROR: %zu paquetes difieren de snprintf\n", mismatches);
+  return mismatches ? 2 : 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file limit_eval.cpp
+ * @brief Banco de pruebas de la comprobación de límites (telemetry_limits.cpp)
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * - Secuencia fija sobre battery_voltage (amarillo bajo en 3.2 V, histéresis
+ *   0.05 V, persistencia 3): una caída de dos paquetes no avisa, una de tres
+ *   sí, la oscilación sobre el umbral no produce eventos y la vuelta a
+ *   nominal exige pasar de 3.25 V. Comprueba los eventos exactos y su ida y
+ *   vuelta por telemetry_frame.
+ * - Carrera de paquetes de potencia, temperatura y sistema con deriva y
+ *   ruido que cruzan los umbrales: cuenta los cambios de zona sin
+ *   histéresis ni persistencia frente a los eventos del motor, y mide
+ *   paquetes y límites evaluados por segundo.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -I../../include limit_eval.cpp ../../src/telemetry_limits.cpp \
+ *       ../../src/telemetry_schema.cpp ../../src/telemetry_frame.cpp ../../src/telemetry_delta.cpp \
+ *       -o limit_eval
+ *
+ * Uso:
+ *   ./limit_eval [paquetes]   (por defecto 3000000)
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "../../include/telemetry_limits.h"
+#include "../../include/telemetry_schema.h"
+#include "../../include/telemetry_frame.h"
+
+/** @brief Umbrales de la tabla para contar los cambios de zona sin histéresis ni persistencia */
+typedef struct {
+  telem_data_type_t type;
+  size_t offset;
+  float red_low, yellow_low, yellow_high, red_high;
+} naive_limit_t;
+
+#define NAIVE_LIMIT(t, st, m, rl, yl, yh, rh, h, p) { t, offsetof(st, m), rl, yl, yh, rh },
+static const naive_limit_t s_naive[] = { TELEM_LIMITS_TABLE(NAIVE_LIMIT) };
+
+static int naive_zone(const naive_limit_t* l, float x) {
+  if (x < l->red_low) return 3;
+  if (x > l->red_high) return 4;
+  if (x < l->yellow_low) return 1;
+  if (x > l->yellow_high) return 2;
+  return 0;
+}
+
+static telemetry_packet_t power_packet(float voltage, uint32_t t) {
+  telemetry_packet_t p;
+  memset(&p, 0, sizeof(p));
+  p.header.type = TELEM_POWER_DATA;
+  p.header.timestamp = t;
+  p.power.battery_voltage = voltage;
+  p.power.battery_level = 80;
+  p.power.battery_temperature = 20;
+  return p;
+}
+
+/**
+ * @brief Secuencia fija de battery_voltage con los eventos esperados
+ */
+static bool scripted(void) {
+  const float volts[] = {
+    3.30f, 3.15f, 3.15f, 3.30f,            // caída de 2 paquetes: sin evento
+    3.15f, 3.15f, 3.15f,                   // 3 seguidos: YELLOW_LOW
+    3.21f, 3.19f, 3.22f, 3.18f, 3.24f,     // oscila dentro de la histéresis: nada
+    3.26f, 3.26f, 3.26f,                   // despeja 3.25: NOMINAL
+    2.90f, 2.90f, 2.90f,                   // rojo bajo directamente
+  };
+  const struct {
+    uint32_t at;
+    uint8_t previous, state;
+  } expected[] = {
+    { 6, TELEM_LIMIT_NOMINAL, TELEM_LIMIT_YELLOW_LOW },
+    { 14, TELEM_LIMIT_YELLOW_LOW, TELEM_LIMIT_NOMINAL },
+    { 17, TELEM_LIMIT_NOMINAL, TELEM_LIMIT_RED_LOW },
+  };
+  telemetry_limits_t limits;
+  telemetry_limits_init(&limits);
+  uint32_t next = 0;
+  bool ok = true;
+  for (uint32_t i = 0; i < sizeof(volts) / sizeof(volts[0]); i++) {
+    telemetry_packet_t p = power_packet(volts[i], i);
+    telemetry_packet_t events[TELEM_LIMIT_COUNT];
+    uint32_t n = telemetry_limits_evaluate(&limits, &p, events, TELEM_LIMIT_COUNT);
+    for (uint32_t e = 0; e < n; e++) {
+      const limit_event_telem_t* ev = &events[e].event;
+      bool match = next < sizeof(expected) / sizeof(expected[0]) && expected[next].at == i &&
+                   expected[next].previous == ev->previous && expected[next].state == ev->state;
+      uint8_t frame[TELEM_FRAME_MAX_BYTES];
+      size_t len = telemetry_frame_encode(&events[e], 0, frame, sizeof(frame));
+      telemetry_packet_t back;
+      uint16_t seq;
+      bool trip = len > 2 && telemetry_frame_decode(frame + 1, len - 2, &back, &seq) &&
+                  back.event.state == ev->state && back.event.value == ev->value &&
+                  back.event.threshold == ev->threshold;
+      char json[256];
+      telemetry_schema_format_json(&events[e], json, sizeof(json));
+      printf("  paquete %2u  %.2f V  %-10s -> %-10s  %s%s\n", i, volts[i], telemetry_limit_state_name(ev->previous),
+             telemetry_limit_state_name(ev->state), json, (match && trip) ? "" : "  <-- INESPERADO");
+      ok = ok && match && trip;
+      next++;
+    }
+  }
+  return ok && next == sizeof(expected) / sizeof(expected[0]);
+}
+
+int main(int argc, char** argv) {
+  uint32_t count = (argc > 1) ? (uint32_t)atoi(argv[1]) : 3000000;
+  if (count == 0) {
+    fprintf(stderr, "uso: %s [paquetes]\n", argv[0]);
+    return 1;
+  }
+
+  printf("secuencia fija (battery_voltage):\n");
+  bool ok = scripted();
+
+  // Paquetes con deriva lenta y ruido alrededor de los umbrales
+  std::mt19937 rng(2026);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  std::vector<telemetry_packet_t> packets(count);
+  for (uint32_t i = 0; i < count; i++) {
+    telemetry_packet_t* p = &packets[i];
+    memset(p, 0, sizeof(*p));
+    float phase = (float)i / 20000.0f;
+    p->header.timestamp = i;
+    switch (i % 3) {
+      case 0:
+        p->header.type = TELEM_POWER_DATA;
+        p->power.battery_voltage = 3.6f + 0.6f * std::sin(phase) + 0.03f * noise(rng);
+        p->power.battery_level = (uint8_t)(50 + 45 * std::sin(phase * 0.7f) + 2 * noise(rng));
+        p->power.battery_temperature = (int8_t)(25 + 30 * std::sin(phase * 1.3f) + 2 * noise(rng));
+        break;
+      case 1:
+        p->header.type = TELEM_TEMPERATURE_DATA;
+        p->temperature.obc_temperature = (int16_t)(300 + 600 * std::sin(phase) + 15 * noise(rng));
+        p->temperature.comms_temperature = (int16_t)(250 + 500 * std::sin(phase * 1.1f) + 15 * noise(rng));
+        p->temperature.payload_temperature = (int16_t)(150 + 400 * std::sin(phase * 0.9f) + 15 * noise(rng));
+        p->temperature.battery_temperature = (int16_t)(200 + 350 * std::sin(phase * 1.2f) + 15 * noise(rng));
+        p->temperature.external_temperature = (int16_t)(-1000 * std::sin(phase * 0.5f) + 30 * noise(rng));
+        break;
+      default:
+        p->header.type = TELEM_SYSTEM_STATUS;
+        p->system.cpu_temperature = 60.0f + 30.0f * std::sin(phase * 0.8f) + 1.5f * noise(rng);
+        break;
+    }
+  }
+
+  uint32_t naive_changes = 0;
+  int zone[sizeof(s_naive) / sizeof(s_naive[0])] = { 0 };
+  for (const auto& p : packets) {
+    for (size_t l = 0; l < sizeof(s_naive) / sizeof(s_naive[0]); l++) {
+      if (s_naive[l].type != p.header.type) continue;
+      const telemetry_schema_t* schema = telemetry_schema_get(p.header.type);
+      for (uint8_t f = 0; f < schema->field_count; f++) {
+        const telemetry_field_t* field = &schema->fields[f];
+        if (field->offset != s_naive[l].offset) continue;
+        int z = naive_zone(&s_naive[l], telemetry_field_value(&p, field->offset, field->kind, field->decimals));
+        if (z != zone[l]) naive_changes++;
+        zone[l] = z;
+      }
+    }
+  }
+
+  static telemetry_limits_t limits;
+  telemetry_limits_init(&limits);
+  telemetry_packet_t events[TELEM_LIMIT_COUNT];
+  uint32_t emitted = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (const auto& p : packets) {
+    emitted += telemetry_limits_evaluate(&limits, &p, events, TELEM_LIMIT_COUNT);
+  }
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  printf("%u paquetes, %u límites en la tabla (%u sin campo)\n", count, (unsigned)TELEM_LIMIT_COUNT, limits.unresolved);
+  printf("cambios de zona sin histéresis ni persistencia: %u\n", naive_changes);
+  printf("eventos del motor:                              %u\n", emitted);
+  printf("evaluación: %.1f M paquetes/s, %.1f M límites/s, %.1f ns/paquete\n", count / s / 1e6,
+         limits.checks / s / 1e6, s * 1e9 / count);
+
+  if (!ok || limits.unresolved != 0 || emitted == 0 || emitted >= naive_changes) {
+    printf("ERROR: eventos inesperados\n");
+    return 1;
+  }
+  return 0;
+}
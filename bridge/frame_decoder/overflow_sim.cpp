@@ -0,0 +1,204 @@
+/**
+ * @file overflow_sim.cpp
+ * @brief Simulación de las políticas de desbordamiento del buffer (telemetry_storage.cpp) con carga a ráfagas
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Simula en tiempo virtual (pasos de 10 ms) el buffer del firmware, enlazado
+ * tal cual (el directorio host/ sustituye a FreeRTOS y esp_timer):
+ * - adquisición con los tipos, cadencias y prioridades de
+ *   telemetry_acquisition.cpp; cada ciclo de ráfaga los genera cada 50 ms en
+ *   lugar de cada segundo (p. ej. un modo de observación intensiva)
+ * - un suscriptor bloqueante, como el transmisor, que saca un número fijo de
+ *   paquetes por segundo (lo que admite el enlace)
+ *
+ * Para cada política (telemetry_set_overflow_policy()) y cada tipo:
+ * - paquetes generados y perdidos (telemetry_get_lost_by_type())
+ * - edad media de los paquetes al salir del buffer
+ * - frescura: cada segundo, la edad de la última muestra entregada del tipo
+ *
+ * Comprueba que generados = entregados + perdidos + retenidos al final.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -pthread -Ihost -I../../include overflow_sim.cpp ../../src/telemetry_storage.cpp \
+ *       ../../src/telemetry_latency.cpp ../../src/telemetry_schema.cpp ../../src/telemetry_wake.cpp \
+ *       -o overflow_sim
+ *
+ * Uso:
+ *   ./overflow_sim [segundos] [paquetes/s del enlace] [ráfaga s] [periodo de ráfagas s]
+ *   (por defecto 1200 20 20 120)
+ */
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../../include/telemetry_storage.h"
+#include "../../include/telemetry_logger.h"
+#include "../../include/telemetry_schema.h"
+
+/** @brief Paso de la simulación (ms) */
+#define SIM_STEP_MS 10
+
+/** @brief Periodo de adquisición fuera y dentro de las ráfagas (ms) */
+#define SIM_PERIOD_MS 1000
+#define SIM_BURST_PERIOD_MS 50
+
+/** @brief Cadencia de cada tipo en ciclos de adquisición (s_fillers de telemetry_acquisition.cpp) */
+static const struct {
+  telem_data_type_t type;
+  uint8_t period;
+  uint8_t priority;
+} s_types[] = {
+  { TELEM_SYSTEM_STATUS,        1,  TELEM_PRIORITY_NORMAL },
+  { TELEM_POWER_DATA,           1,  TELEM_PRIORITY_HIGH },
+  { TELEM_TEMPERATURE_DATA,     1,  TELEM_PRIORITY_NORMAL },
+  { TELEM_COMMUNICATION_STATUS, 1,  TELEM_PRIORITY_NORMAL },
+  { TELEM_STORAGE_METRICS,      15, TELEM_PRIORITY_LOW },
+  { TELEM_LATENCY_METRICS,      3,  TELEM_PRIORITY_LOW },
+};
+#define SIM_TYPES (sizeof(s_types) / sizeof(s_types[0]))
+
+/** @brief telemetry_latency.cpp solo registra por aquí en telemetry_latency_dump() */
+void telemetry_logf(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  va_end(args);
+  printf("\n");
+}
+
+typedef struct {
+  uint32_t generated;
+  uint32_t delivered;
+  uint32_t lost;
+  double age_sum_ms;
+  double stale_sum_ms;
+} type_result_t;
+
+typedef struct {
+  type_result_t types[SIM_TYPES];
+  uint32_t stale_samples;
+  uint32_t retained_end;
+} sim_result_t;
+
+static sim_result_t run(telem_overflow_policy_t policy, uint32_t seconds, uint32_t link_pps, uint32_t burst_s,
+                        uint32_t burst_every_s) {
+  sim_result_t r;
+  memset(&r, 0, sizeof(r));
+
+  telemetry_storage_init();
+  telemetry_set_overflow_policy(policy);
+  telemetry_subscriber_t sub = telemetry_subscribe(TELEM_SUB_BLOCKING);
+
+  int64_t last_acquired[SIM_TYPES];
+  for (uint32_t i = 0; i < SIM_TYPES; i++) last_acquired[i] = -1;
+  int index_of[TELEM_DATA_TYPE_COUNT];
+  for (uint32_t t = 0; t < TELEM_DATA_TYPE_COUNT; t++) index_of[t] = -1;
+  for (uint32_t i = 0; i < SIM_TYPES; i++) index_of[s_types[i].type] = (int)i;
+
+  uint32_t cycle = 0;
+  uint32_t next_cycle_ms = 0;
+  double link_credit = 0.0;
+  for (uint32_t now = 0; now < seconds * 1000; now += SIM_STEP_MS) {
+    if (now >= next_cycle_ms) {
+      for (uint32_t i = 0; i < SIM_TYPES; i++) {
+        if (cycle % s_types[i].period != 0) continue;
+        telemetry_packet_t p;
+        memset(&p, 0, sizeof(p));
+        p.header.type = s_types[i].type;
+        p.header.priority = s_types[i].priority;
+        p.header.timestamp = now;   // ms virtuales
+        telemetry_store_packet(&p);
+        r.types[i].generated++;
+      }
+      cycle++;
+      bool burst = (now / 1000) % burst_every_s < burst_s;
+      next_cycle_ms = now + (burst ? SIM_BURST_PERIOD_MS : SIM_PERIOD_MS);
+    }
+
+    // Transmisor: tantos paquetes como admite el enlace
+    link_credit += link_pps * SIM_STEP_MS / 1000.0;
+    while (link_credit >= 1.0) {
+      telemetry_packet_t p;
+      if (!telemetry_retrieve_packet_for(sub, &p)) {
+        link_credit = 0.0;
+        break;
+      }
+      link_credit -= 1.0;
+      int i = index_of[p.header.type];
+      if (i < 0) continue;
+      r.types[i].delivered++;
+      r.types[i].age_sum_ms += now - p.header.timestamp;
+      if ((int64_t)p.header.timestamp > last_acquired[i]) last_acquired[i] = p.header.timestamp;
+    }
+
+    // Frescura en tierra, una vez por segundo
+    if (now % 1000 == 1000 - SIM_STEP_MS) {
+      for (uint32_t i = 0; i < SIM_TYPES; i++) {
+        r.types[i].stale_sum_ms += (last_acquired[i] < 0) ? now : now - last_acquired[i];
+      }
+      r.stale_samples++;
+    }
+  }
+
+  for (uint32_t i = 0; i < SIM_TYPES; i++) {
+    r.types[i].lost = telemetry_get_lost_by_type(s_types[i].type);
+  }
+  r.retained_end = telemetry_available_packets_for(sub);
+  telemetry_unsubscribe(sub);
+  return r;
+}
+
+int main(int argc, char** argv) {
+  uint32_t seconds = (argc > 1) ? (uint32_t)atoi(argv[1]) : 1200;
+  uint32_t link_pps = (argc > 2) ? (uint32_t)atoi(argv[2]) : 20;
+  uint32_t burst_s = (argc > 3) ? (uint32_t)atoi(argv[3]) : 20;
+  uint32_t burst_every_s = (argc > 4) ? (uint32_t)atoi(argv[4]) : 120;
+  if (seconds == 0 || link_pps == 0 || burst_every_s == 0 || burst_s > burst_every_s) {
+    fprintf(stderr, "uso: %s [segundos] [paquetes/s del enlace] [ráfaga s] [periodo de ráfagas s]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%u s, enlace de %u paquetes/s, ráfagas de %u s cada %u s (adquisición cada %u ms, si no cada %u ms)\n",
+         seconds, link_pps, burst_s, burst_every_s, (unsigned)SIM_BURST_PERIOD_MS, (unsigned)SIM_PERIOD_MS);
+  printf("buffer de %u paquetes, %u retenidos por tipo con KEEP_LATEST_PER_TYPE, ventana de búsqueda %u\n",
+         (unsigned)TELEM_BUFFER_SIZE - 1, (unsigned)TELEM_KEEP_LATEST_PER_TYPE, (unsigned)TELEM_OVERFLOW_SCAN_WINDOW);
+
+  const struct {
+    telem_overflow_policy_t policy;
+    const char* name;
+  } policies[] = {
+    { TELEM_OVERFLOW_DROP_NEWEST, "DROP_NEWEST" },
+    { TELEM_OVERFLOW_OVERWRITE_OLDEST, "OVERWRITE_OLDEST" },
+    { TELEM_OVERFLOW_EVICT_LOWEST_PRIORITY, "EVICT_LOWEST_PRIORITY" },
+    { TELEM_OVERFLOW_KEEP_LATEST_PER_TYPE, "KEEP_LATEST_PER_TYPE" },
+  };
+
+  bool ok = true;
+  for (const auto& pol : policies) {
+    sim_result_t r = run(pol.policy, seconds, link_pps, burst_s, burst_every_s);
+    printf("\n%s\n", pol.name);
+    printf("  %-12s %10s %10s %7s %14s %14s\n", "tipo", "generados", "perdidos", "%", "edad al salir", "edad en tierra");
+    uint32_t generated = 0, delivered = 0, lost = 0;
+    for (uint32_t i = 0; i < SIM_TYPES; i++) {
+      const type_result_t* t = &r.types[i];
+      printf("  %-12s %10u %10u %6.1f%% %12.1f s %12.1f s\n", telemetry_schema_get(s_types[i].type)->json_type,
+             t->generated, t->lost, t->generated ? 100.0 * t->lost / t->generated : 0.0,
+             t->delivered ? t->age_sum_ms / t->delivered / 1000.0 : 0.0,
+             r.stale_samples ? t->stale_sum_ms / r.stale_samples / 1000.0 : 0.0);
+      generated += t->generated;
+      delivered += t->delivered;
+      lost += t->lost;
+    }
+    printf("  %-12s %10u %10u %6.1f%%   (%u entregados, %u retenidos al final)\n", "total", generated, lost,
+           generated ? 100.0 * lost / generated : 0.0, delivered, r.retained_end);
+    if (generated != delivered + lost + r.retained_end) {
+      printf("ERROR: %u generados frente a %u entregados + %u perdidos + %u retenidos\n", generated, delivered, lost,
+             r.retained_end);
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
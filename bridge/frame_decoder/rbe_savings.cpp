@@ -0,0 +1,209 @@
+/**
+ * @file rbe_savings.cpp
+ * @brief Banco de pruebas de la bajada por excepción (telemetry_rbe.cpp)
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Genera paquetes de temperatura y de comunicaciones con el mismo ruido
+ * uniforme que telemetry_generators.cpp (una muestra de cada tipo cada 2 s)
+ * y los baja por el enlace en cuatro modos: binario, binario con bajada por
+ * excepción, delta y delta con bajada por excepción. Para cada modo:
+ * - bytes y tramas en el enlace
+ * - decodifica byte a byte con telemetry_frame_rx_push y comprueba que, en
+ *   cada muestra (también las suprimidas), el valor que tiene tierra de
+ *   cada campo no se aleja del real más que su banda muerta
+ * - paquetes suprimidos, latidos y campos retenidos
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -I../../include rbe_savings.cpp ../../src/telemetry_rbe.cpp \
+ *       ../../src/telemetry_schema.cpp ../../src/telemetry_frame.cpp ../../src/telemetry_delta.cpp \
+ *       -o rbe_savings
+ *
+ * Uso:
+ *   ./rbe_savings [muestras]   (por defecto 43200, un día)
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "../../include/telemetry_rbe.h"
+#include "../../include/telemetry_schema.h"
+#include "../../include/telemetry_frame.h"
+#include "../../include/telemetry_delta.h"
+
+/** @brief Periodo entre muestras de cada tipo (ms) */
+#define SAMPLE_PERIOD_MS 2000
+
+static std::mt19937 s_rng(2026);
+
+/** @brief Ruido uniforme en [-span, span], como (esp_random() % (2 * span + 1)) - span */
+static int uniform(int span) {
+  return (int)(s_rng() % (uint32_t)(2 * span + 1)) - span;
+}
+
+static telemetry_packet_t temperature_packet(uint32_t i) {
+  telemetry_packet_t p;
+  memset(&p, 0, sizeof(p));
+  p.header.type = TELEM_TEMPERATURE_DATA;
+  p.header.timestamp = i * SAMPLE_PERIOD_MS;
+  p.header.sequence = (uint16_t)i;
+  p.temperature.obc_temperature = (int16_t)(350 + uniform(20));
+  p.temperature.comms_temperature = (int16_t)(280 + uniform(20));
+  p.temperature.payload_temperature = (int16_t)(250 + uniform(10));
+  p.temperature.battery_temperature = (int16_t)(220 + uniform(20));
+  p.temperature.external_temperature = (int16_t)(-150 + uniform(50));
+  return p;
+}
+
+static telemetry_packet_t comms_packet(uint32_t i) {
+  telemetry_packet_t p;
+  memset(&p, 0, sizeof(p));
+  p.header.type = TELEM_COMMUNICATION_STATUS;
+  p.header.timestamp = i * SAMPLE_PERIOD_MS + 1;
+  p.header.sequence = (uint16_t)i;
+  uint32_t uptime = i * SAMPLE_PERIOD_MS / 1000;
+  p.subsystems.comms_uptime = uptime;
+  p.subsystems.payload_uptime = (uptime > 100) ? uptime - 100 : 0;
+  p.subsystems.command_success_rate = (uint8_t)(98 + uniform(2));
+  p.subsystems.rssi_dbm = -55;
+  p.subsystems.snr_db = 13;
+  return p;
+}
+
+/**
+ * @brief Resultado de un modo de bajada
+ */
+typedef struct {
+  const char* name;
+  uint64_t bytes;
+  uint32_t frames;
+  uint32_t bad_frames;
+  uint32_t out_of_band;     /**< Muestras con algún campo de tierra fuera de su banda */
+  float worst_margin;       /**< Mayor |tierra - real| / banda de los campos con banda */
+  telemetry_rbe_counts_t counts;
+} mode_result_t;
+
+/**
+ * @brief Comprueba el valor de tierra de cada campo frente al real
+ */
+static void check_ground(const telemetry_rbe_t* rbe, const telemetry_packet_t* truth, const telemetry_packet_t* ground,
+                         mode_result_t* r) {
+  const telemetry_schema_t* schema = telemetry_schema_get(truth->header.type);
+  bool bad = false;
+  for (uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    uint8_t width = telemetry_field_width(field->kind);
+    float band = rbe->deadband[truth->header.type][f];
+    for (uint8_t e = 0; e < field->count; e++) {
+      uint8_t offset = (uint8_t)(field->offset + e * width);
+      float error = std::fabs(telemetry_field_value(truth, offset, field->kind, field->decimals) -
+                              telemetry_field_value(ground, offset, field->kind, field->decimals));
+      if (error > band + 1e-4f) bad = true;
+      if (band > 0.0f && error / band > r->worst_margin) r->worst_margin = error / band;
+    }
+  }
+  if (bad) r->out_of_band++;
+}
+
+static mode_result_t run(const char* name, const std::vector<telemetry_packet_t>& packets, bool rbe_on, bool delta_on) {
+  mode_result_t r;
+  memset(&r, 0, sizeof(r));
+  r.name = name;
+
+  static telemetry_rbe_t rbe;
+  telemetry_rbe_init(&rbe, TELEM_RBE_HEARTBEAT_MS);
+  static telemetry_delta_ctx_t tx_delta, rx_delta;
+  telemetry_delta_init(&tx_delta, TELEM_DELTA_KEYFRAME_INTERVAL);
+  telemetry_delta_init(&rx_delta, 0);
+  static telemetry_frame_rx_t rx;
+  telemetry_frame_rx_init(&rx);
+  rx.delta = &rx_delta;
+
+  uint16_t seq[TELEM_DATA_TYPE_COUNT] = { 0 };
+  telemetry_packet_t ground[TELEM_DATA_TYPE_COUNT];
+  bool has_ground[TELEM_DATA_TYPE_COUNT] = { false };
+
+  for (const auto& truth : packets) {
+    telemetry_packet_t p = truth;
+    bool send = !rbe_on || telemetry_rbe_prepare(&rbe, &p);
+    if (send) {
+      uint8_t frame[TELEM_FRAME_MAX_BYTES];
+      size_t len = delta_on ? telemetry_frame_encode_delta(&tx_delta, &p, seq[p.header.type], frame, sizeof(frame))
+                            : telemetry_frame_encode(&p, seq[p.header.type], frame, sizeof(frame));
+      seq[p.header.type]++;
+      r.bytes += len;
+      r.frames++;
+      if (rbe_on) telemetry_rbe_sent(&rbe, &p);
+
+      bool got = false;
+      for (size_t b = 0; b < len; b++) {
+        telemetry_packet_t back;
+        uint16_t back_seq;
+        if (telemetry_frame_rx_push(&rx, frame[b], &back, &back_seq)) {
+          ground[back.header.type] = back;
+          has_ground[back.header.type] = true;
+          got = true;
+        }
+      }
+      if (!got) r.bad_frames++;
+    }
+    if (has_ground[truth.header.type]) {
+      check_ground(&rbe, &truth, &ground[truth.header.type], &r);
+    } else {
+      r.out_of_band++;
+    }
+  }
+  telemetry_rbe_totals(&rbe, &r.counts);
+  return r;
+}
+
+int main(int argc, char** argv) {
+  uint32_t samples = (argc > 1) ? (uint32_t)atoi(argv[1]) : 43200;
+  if (samples == 0) {
+    fprintf(stderr, "uso: %s [muestras]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<telemetry_packet_t> packets;
+  packets.reserve(2 * samples);
+  for (uint32_t i = 0; i < samples; i++) {
+    packets.push_back(temperature_packet(i));
+    packets.push_back(comms_packet(i));
+  }
+
+  static telemetry_rbe_t probe;
+  uint32_t unresolved = telemetry_rbe_init(&probe, TELEM_RBE_HEARTBEAT_MS);
+  printf("%u muestras de temperatura y comunicaciones cada %u ms, latido %u ms (%u entradas sin campo)\n\n", samples,
+         (unsigned)SAMPLE_PERIOD_MS, (unsigned)TELEM_RBE_HEARTBEAT_MS, unresolved);
+
+  mode_result_t results[] = {
+    run("binario", packets, false, false),
+    run("binario + RBE", packets, true, false),
+    run("delta", packets, false, true),
+    run("delta + RBE", packets, true, true),
+  };
+
+  bool ok = unresolved == 0;
+  printf("%-16s %10s %7s %8s %8s %10s %8s %8s\n", "modo", "bytes", "%", "tramas", "B/trama", "suprimidos", "latidos",
+         "retenidos");
+  for (const auto& r : results) {
+    uint32_t fields = r.counts.held + r.counts.changed;
+    printf("%-16s %10llu %6.1f%% %8u %8.1f %10u %8u %7.1f%%\n", r.name, (unsigned long long)r.bytes,
+           100.0 * r.bytes / results[0].bytes, r.frames, r.frames ? (double)r.bytes / r.frames : 0.0, r.counts.suppressed,
+           r.counts.heartbeats, fields ? 100.0 * r.counts.held / fields : 0.0);
+    ok = ok && r.bad_frames == 0 && r.out_of_band == 0;
+  }
+  printf("\nerror máximo en tierra (fracción de la banda): binario+RBE %.2f, delta+RBE %.2f\n", results[1].worst_margin,
+         results[3].worst_margin);
+  for (const auto& r : results) {
+    if (r.bad_frames || r.out_of_band) {
+      printf("ERROR %s: %u tramas sin paquete, %u muestras fuera de banda\n", r.name, r.bad_frames, r.out_of_band);
+    }
+  }
+  ok = ok && results[1].bytes < results[0].bytes && results[3].bytes < results[2].bytes;
+  return ok ? 0 : 1;
+}
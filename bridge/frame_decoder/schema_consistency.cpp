@@ -0,0 +1,243 @@
+/**
+ * @file schema_consistency.cpp
+ * @brief Comprueba que las tres salidas del esquema coinciden campo a campo (telemetry_schema.cpp)
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Para cada tipo de telemetría genera paquetes con valores aleatorios en
+ * todos los campos (y algunos casos límite: ceros, extremos de cada entero,
+ * negativos que redondean a cero) y los pasa por las tres salidas:
+ * - binaria: trama de telemetry_frame_encode() decodificada byte a byte con
+ *   telemetry_frame_rx_push(), como la recibe tierra
+ * - JSON: telemetry_schema_format_json()
+ * - log: telemetry_schema_format_log()
+ *
+ * Recorre la tabla del esquema y, para cada elemento de cada campo, extrae
+ * el texto del JSON y el del log y los compara entre sí y con el valor
+ * decodificado de la trama formateado con printf("%.*f"). La cabecera
+ * (tipo, sello, secuencia, prioridad) se compara con la decodificada. Así
+ * una entrada mal escrita en una X-macro o un formateador que se separe de
+ * los demás se detecta con el nombre del campo.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -I../../include schema_consistency.cpp ../../src/telemetry_schema.cpp \
+ *       ../../src/telemetry_frame.cpp ../../src/telemetry_delta.cpp -o schema_consistency
+ *
+ * Uso:
+ *   ./schema_consistency [paquetes por tipo]   (por defecto 10000)
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include "../../include/telemetry_schema.h"
+#include "../../include/telemetry_frame.h"
+
+static std::mt19937 s_rng(2026);
+
+/** @brief Diferencias encontradas (se informa de las primeras) */
+static uint32_t s_errors = 0;
+
+static void report(const telemetry_schema_t* schema, const telemetry_field_t* field, uint8_t element, const char* what,
+                   const std::string& a, const std::string& b) {
+  if (++s_errors > 20) return;
+  printf("ERROR %s.%s[%u] %s: '%s' frente a '%s'\n", schema->json_type,
+         field->json_key ? field->json_key : (field->log_label ? field->log_label : "?"), element, what, a.c_str(),
+         b.c_str());
+}
+
+/**
+ * @brief Rellena el elemento de un campo con un valor aleatorio o un caso límite
+ */
+static void fill_element(telemetry_packet_t* p, const telemetry_field_t* field, uint8_t element, uint32_t trial) {
+  uint8_t* dst = p->raw_data + field->offset + element * telemetry_field_width(field->kind);
+  uint32_t bits = s_rng();
+  if (trial == 0) bits = 0;
+  if (trial == 1) bits = 0xFFFFFFFFu;
+  if (trial == 2) bits = 0x7FFFFFFFu;
+  if (trial == 3) bits = 0x80000000u;
+  switch (field->kind) {
+    case TELEM_FIELD_U8:
+    case TELEM_FIELD_I8:
+      *dst = (trial == 2) ? 0x7F : (trial == 3) ? 0x80 : (uint8_t)bits;
+      break;
+    case TELEM_FIELD_U16:
+    case TELEM_FIELD_I16: {
+      uint16_t v = (trial == 2) ? 0x7FFF : (trial == 3) ? 0x8000 : (uint16_t)bits;
+      memcpy(dst, &v, sizeof(v));
+      break;
+    }
+    case TELEM_FIELD_U32:
+      memcpy(dst, &bits, sizeof(bits));
+      break;
+    default: {
+      // Magnitudes de sensores, con medias unidades y negativos que redondean a cero
+      float f;
+      switch (trial) {
+        case 0: f = 0.0f; break;
+        case 1: f = -0.0004f; break;
+        case 2: f = 123456.789f; break;
+        case 3: f = -0.5f; break;
+        default: f = std::ldexp((float)(int32_t)bits, -(int)(s_rng() % 40)); break;
+      }
+      memcpy(dst, &f, sizeof(f));
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Texto que escribe printf("%.*f") para el elemento (con "0.0" en lugar de "-0.0")
+ */
+static std::string printf_value(const telemetry_packet_t* p, const telemetry_field_t* field, uint8_t element) {
+  uint8_t offset = (uint8_t)(field->offset + element * telemetry_field_width(field->kind));
+  const uint8_t* src = p->raw_data + offset;
+  double value;
+  switch (field->kind) {
+    case TELEM_FIELD_U8:  value = *src; break;
+    case TELEM_FIELD_I8:  value = (int8_t)*src; break;
+    case TELEM_FIELD_U16: { uint16_t v; memcpy(&v, src, 2); value = v; break; }
+    case TELEM_FIELD_I16: { int16_t v; memcpy(&v, src, 2); value = v; break; }
+    case TELEM_FIELD_U32: { uint32_t v; memcpy(&v, src, 4); value = v; break; }
+    default:              { float v; memcpy(&v, src, 4); value = v; break; }
+  }
+  if (field->kind != TELEM_FIELD_F32) {
+    // Entero en unidades de 10^-dec: el texto es el entero con la coma desplazada
+    for (uint8_t d = 0; d < field->decimals; d++) value /= 10.0;
+  }
+  char text[64];
+  snprintf(text, sizeof(text), "%.*f", field->decimals, value);
+  std::string s(text);
+  if (s[0] == '-' && s.find_first_not_of("-0.") == std::string::npos) s.erase(0, 1);
+  return s;
+}
+
+/** @brief Extrae un número ([-0-9.]) de text a partir de pos */
+static std::string take_number(const std::string& text, size_t* pos) {
+  size_t start = *pos;
+  while (*pos < text.size() && (isdigit((unsigned char)text[*pos]) || text[*pos] == '-' || text[*pos] == '.')) (*pos)++;
+  return text.substr(start, *pos - start);
+}
+
+/** @brief Consume lit en text a partir de pos */
+static bool expect(const std::string& text, size_t* pos, const char* lit) {
+  size_t n = strlen(lit);
+  if (text.compare(*pos, n, lit) != 0) return false;
+  *pos += n;
+  return true;
+}
+
+static void check_packet(const telemetry_packet_t* sent) {
+  const telemetry_schema_t* schema = telemetry_schema_get(sent->header.type);
+
+  // Binario: lo que recibe tierra
+  uint8_t frame[TELEM_FRAME_MAX_BYTES];
+  size_t len = telemetry_frame_encode(sent, sent->header.sequence, frame, sizeof(frame));
+  telemetry_frame_rx_t rx;
+  telemetry_frame_rx_init(&rx);
+  telemetry_packet_t back;
+  uint16_t back_seq;
+  bool got = false;
+  for (size_t b = 0; b < len; b++) {
+    got = telemetry_frame_rx_push(&rx, frame[b], &back, &back_seq) || got;
+  }
+  if (!got) {
+    s_errors++;
+    printf("ERROR %s: la trama de %zu bytes no se decodifica\n", schema->json_type, len);
+    return;
+  }
+  if (back.header.type != sent->header.type || back.header.timestamp != sent->header.timestamp ||
+      back.header.sequence != sent->header.sequence || back.header.priority != sent->header.priority) {
+    s_errors++;
+    printf("ERROR %s: cabecera decodificada distinta\n", schema->json_type);
+  }
+
+  char json_buf[512], log_buf[512];
+  std::string json(json_buf, telemetry_schema_format_json(sent, json_buf, sizeof(json_buf)));
+  std::string log(log_buf, telemetry_schema_format_log(sent, log_buf, sizeof(log_buf)));
+  size_t jpos = 0, lpos = 0;
+  bool json_ok = expect(json, &jpos, schema->json_prefix);
+  bool log_ok = expect(log, &lpos, schema->log_tag) && expect(log, &lpos, ":");
+  if (!json_ok || !log_ok) {
+    s_errors++;
+    printf("ERROR %s: prefijo JSON o etiqueta de log incorrectos\n", schema->json_type);
+    return;
+  }
+
+  for (uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    if (field->json_key) json_ok = json_ok && expect(json, &jpos, field->json_frag) &&
+                                   (field->count == 1 || expect(json, &jpos, "["));
+    if (field->log_label) log_ok = log_ok && expect(log, &lpos, " ") && expect(log, &lpos, field->log_label) &&
+                                   expect(log, &lpos, "=");
+    for (uint8_t e = 0; e < field->count; e++) {
+      std::string ground = printf_value(&back, field, e);
+      std::string truth = printf_value(sent, field, e);
+      if (ground != truth) report(schema, field, e, "binario", ground, truth);
+      if (field->json_key && json_ok) {
+        if (e) json_ok = expect(json, &jpos, ",");
+        std::string j = take_number(json, &jpos);
+        if (j != ground) report(schema, field, e, "JSON", j, ground);
+      }
+      if (field->log_label && log_ok) {
+        if (e) log_ok = expect(log, &lpos, "/");
+        std::string l = take_number(log, &lpos);
+        if (l != ground) report(schema, field, e, "log", l, ground);
+      }
+    }
+    if (field->json_key) json_ok = json_ok && (field->count == 1 || expect(json, &jpos, "]"));
+    if (field->log_label) log_ok = log_ok && expect(log, &lpos, field->unit) && expect(log, &lpos, " |");
+  }
+  json_ok = json_ok && expect(json, &jpos, "}") && jpos == json.size();
+  log_ok = log_ok && expect(log, &lpos, " Seq=") && take_number(log, &lpos) == std::to_string(sent->header.sequence) &&
+           lpos == log.size();
+  if (!json_ok) {
+    s_errors++;
+    printf("ERROR %s: JSON con estructura inesperada: %s\n", schema->json_type, json.c_str());
+  }
+  if (!log_ok) {
+    s_errors++;
+    printf("ERROR %s: log con estructura inesperada: %s\n", schema->json_type, log.c_str());
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t trials = (argc > 1) ? (uint32_t)atoi(argv[1]) : 10000;
+  if (trials == 0) {
+    fprintf(stderr, "uso: %s [paquetes por tipo]\n", argv[0]);
+    return 1;
+  }
+
+  uint32_t fields = 0, checked = 0;
+  for (uint32_t t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+    const telemetry_schema_t* schema = telemetry_schema_get((telem_data_type_t)t);
+    if (!schema) {
+      s_errors++;
+      printf("ERROR: el tipo %u no tiene esquema\n", t);
+      continue;
+    }
+    fields += schema->field_count;
+    for (uint32_t trial = 0; trial < trials; trial++) {
+      telemetry_packet_t p;
+      memset(&p, 0, sizeof(p));
+      p.header.type = (telem_data_type_t)t;
+      p.header.timestamp = s_rng();
+      p.header.sequence = (uint16_t)s_rng();
+      p.header.priority = (uint8_t)(s_rng() % 3);
+      for (uint8_t f = 0; f < schema->field_count; f++) {
+        for (uint8_t e = 0; e < schema->fields[f].count; e++) {
+          fill_element(&p, &schema->fields[f], e, trial);
+        }
+      }
+      check_packet(&p);
+      checked++;
+    }
+  }
+  printf("%u tipos, %u campos, %u paquetes: binario, JSON y log %s\n", (unsigned)TELEM_DATA_TYPE_COUNT, fields,
+         checked, s_errors ? "DIFIEREN" : "coinciden campo a campo");
+  return s_errors ? 1 : 0;
+}
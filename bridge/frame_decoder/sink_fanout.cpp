@@ -0,0 +1,248 @@
+/**
+ * @file sink_fanout.cpp
+ * @brief Banco de pruebas del despachador de sinks (telemetry_sink.cpp)
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Publica mensajes (líneas JSON del esquema, como la bajada) a ritmo fijo
+ * en tres sinks, cada uno con su hilo como vTelemetrySinkTask (dormido en
+ * telemetry_sink_wait() hasta que se le encola un mensaje):
+ * - memoria: captura en RAM (telemetry_sink_memory())
+ * - udp: datagramas a 127.0.0.1 que recibe el propio programa
+ * - lento: tarda lo indicado en cada mensaje, como abrir, añadir y cerrar
+ *   un fichero de LittleFS
+ *
+ * Compara el tiempo que pasa quien publica con el reparto asíncrono frente
+ * a escribir en los tres desde su tarea (lo que hace TELEM_SINK_ASYNC=0 y
+ * hacía el logger), y comprueba que la captura en memoria y los datagramas
+ * llegan completos y en orden aunque el sink lento pierda mensajes.
+ *
+ * Compilación (colas de 32: el planificador del host retrasa los hilos
+ * bastante más que el de FreeRTOS, y con las 8 por defecto también
+ * perderían mensajes los sinks rápidos):
+ *   g++ -O2 -std=c++17 -pthread -DTELEM_SINK_QUEUE=32 -DTELEM_SINK_POOL=128 -I../../include \
+ *       sink_fanout.cpp ../../src/telemetry_sink.cpp ../../src/telemetry_sink_udp.cpp \
+ *       ../../src/telemetry_schema.cpp -o sink_fanout
+ *
+ * Uso:
+ *   ./sink_fanout [mensajes] [intervalo µs] [ms por mensaje del sink lento]   (por defecto 2000 500 5)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "../../include/telemetry_sink.h"
+#include "../../include/telemetry_schema.h"
+
+static uint32_t g_slow_ms = 5;
+static std::atomic<uint32_t> g_slow_written(0);
+
+static bool slow_write(void* ctx, uint32_t channel, const uint8_t* data, uint32_t len) {
+  (void)ctx;
+  (void)channel;
+  (void)data;
+  (void)len;
+  std::this_thread::sleep_for(std::chrono::milliseconds(g_slow_ms));
+  g_slow_written++;
+  return true;
+}
+
+/**
+ * @brief Aviso pendiente como el de una notificación de tarea
+ */
+typedef struct {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool pending;
+} host_waiter_t;
+
+static void host_notify(void* ctx) {
+  host_waiter_t* w = (host_waiter_t*)ctx;
+  std::lock_guard<std::mutex> lock(w->mutex);
+  w->pending = true;
+  w->cv.notify_one();
+}
+
+static bool host_wait(void* ctx, uint32_t timeout_ms) {
+  host_waiter_t* w = (host_waiter_t*)ctx;
+  std::unique_lock<std::mutex> lock(w->mutex);
+  w->cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [w] { return w->pending; });
+  bool notified = w->pending;
+  w->pending = false;
+  return notified;
+}
+
+static const telemetry_wake_port_t s_host_port = { host_notify, host_wait };
+
+static uint64_t now_ns(void) {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Línea JSON del paquete número i (sequence = i)
+ */
+static std::string make_message(uint32_t i) {
+  telemetry_packet_t p;
+  memset(&p, 0, sizeof(p));
+  p.header.type = (telem_data_type_t)(i % 4);
+  p.header.sequence = (uint16_t)i;
+  p.system.uptime_seconds = i;
+  p.power.battery_level = (uint8_t)i;
+  char json[256];
+  size_t len = telemetry_schema_format_json(&p, json, sizeof(json));
+  return std::string(json, len) + "\r\n";
+}
+
+static void print_latency(const char* label, std::vector<uint64_t>& ns) {
+  std::sort(ns.begin(), ns.end());
+  printf("%-10s publicar: p50 %8.1f µs  p99 %8.1f µs  máx %8.1f µs\n", label, ns[ns.size() / 2] / 1000.0,
+         ns[ns.size() * 99 / 100] / 1000.0, ns.back() / 1000.0);
+}
+
+int main(int argc, char** argv) {
+  uint32_t messages = (argc > 1) ? (uint32_t)atoi(argv[1]) : 2000;
+  uint32_t interval_us = (argc > 2) ? (uint32_t)atoi(argv[2]) : 500;
+  g_slow_ms = (argc > 3) ? (uint32_t)atoi(argv[3]) : 5;
+  if (messages == 0) {
+    fprintf(stderr, "uso: %s [mensajes] [intervalo µs] [ms por mensaje del sink lento]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<std::string> sent;
+  size_t total_bytes = 0;
+  for (uint32_t i = 0; i < messages; i++) {
+    sent.push_back(make_message(i));
+    total_bytes += sent.back().size();
+  }
+
+  // Receptor de los datagramas en un puerto libre
+  int rx = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addr_len = sizeof(addr);
+  int rcvbuf = 4 << 20;
+  setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  if (rx < 0 || bind(rx, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+      getsockname(rx, (struct sockaddr*)&addr, &addr_len) != 0) {
+    perror("udp");
+    return 1;
+  }
+
+  std::vector<uint8_t> capture(total_bytes);
+  telemetry_sink_memory_t mem = { capture.data(), (uint32_t)capture.size(), 0, 0, 0 };
+  telemetry_sink_t mem_sink, udp_sink;
+  telemetry_sink_memory(&mem, &mem_sink);
+  telemetry_sink_udp_t udp;
+  if (!telemetry_sink_udp_open(&udp, ntohs(addr.sin_port), &udp_sink)) {
+    perror("udp");
+    return 1;
+  }
+  telemetry_sink_t slow_sink = { "lento", slow_write, NULL };
+
+  printf("%u mensajes cada %u µs, sink lento %u ms por mensaje, colas de %u mensajes\n", messages, interval_us,
+         g_slow_ms, (unsigned)TELEM_SINK_QUEUE);
+
+  // Síncrono: quien publica escribe en las tres salidas
+  std::vector<uint64_t> sync_ns;
+  uint32_t sync_count = std::min<uint32_t>(messages, 200);
+  mem.used = 0;
+  for (uint32_t i = 0; i < sync_count; i++) {
+    uint64_t t0 = now_ns();
+    const uint8_t* data = (const uint8_t*)sent[i].data();
+    uint32_t len = (uint32_t)sent[i].size();
+    mem_sink.write(mem_sink.ctx, TELEM_SINK_CH_DOWNLINK, data, len);
+    udp_sink.write(udp_sink.ctx, TELEM_SINK_CH_DOWNLINK, data, len);
+    slow_sink.write(slow_sink.ctx, TELEM_SINK_CH_DOWNLINK, data, len);
+    sync_ns.push_back(now_ns() - t0);
+  }
+  char drain[512];
+  while (recv(rx, drain, sizeof(drain), MSG_DONTWAIT) > 0) {}
+  mem.used = 0;
+  mem.messages = 0;
+  g_slow_written = 0;
+
+  // Asíncrono: cada sink en su hilo
+  telemetry_sink_init();
+  int ids[3] = {
+    telemetry_sink_add(&mem_sink, TELEM_SINK_CH_DOWNLINK, TELEM_SINK_DROP_NEWEST),
+    telemetry_sink_add(&udp_sink, TELEM_SINK_CH_DOWNLINK, TELEM_SINK_DROP_NEWEST),
+    telemetry_sink_add(&slow_sink, TELEM_SINK_CH_DOWNLINK, TELEM_SINK_DROP_OLDEST),
+  };
+  std::atomic<bool> stop(false);
+  std::vector<std::thread> workers;
+  static host_waiter_t waiters[3];
+  for (int k = 0; k < 3; k++) {
+    // Antes de arrancar el hilo: sin aviso registrado, telemetry_sink_publish() escribe él mismo
+    waiters[k].pending = false;
+    telemetry_sink_set_wake(ids[k], &s_host_port, &waiters[k]);
+  }
+  for (int id : ids) {
+    workers.emplace_back([id, &stop] {
+      while (!stop) {
+        if (!telemetry_sink_service(id)) telemetry_sink_wait(id, 10); // 10 ms: para ver stop
+      }
+      while (telemetry_sink_service(id)) {}
+    });
+  }
+
+  // Recepción de los datagramas en paralelo, comprobando el orden
+  uint32_t udp_ok = 0, udp_bad = 0;
+  std::thread receiver([&] {
+    char buf[512];
+    for (uint32_t i = 0; i < messages; i++) {
+      ssize_t n = recv(rx, buf, sizeof(buf), 0);
+      if (n <= 0) break;
+      if (std::string(buf, (size_t)n) == sent[i]) udp_ok++; else udp_bad++;
+    }
+  });
+
+  std::vector<uint64_t> async_ns;
+  auto next = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < messages; i++) {
+    std::this_thread::sleep_until(next); // Sin espera activa: los hilos de los sinks necesitan CPU
+    uint64_t t0 = now_ns();
+    telemetry_sink_publish(TELEM_SINK_CH_DOWNLINK, sent[i].data(), (uint32_t)sent[i].size());
+    async_ns.push_back(now_ns() - t0);
+    next += std::chrono::microseconds(interval_us);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(200 + g_slow_ms * TELEM_SINK_QUEUE));
+  stop = true;
+  for (auto& w : workers) w.join();
+  shutdown(rx, SHUT_RDWR);
+  receiver.join();
+  telemetry_sink_udp_close(&udp);
+  close(rx);
+
+  print_latency("síncrono", sync_ns);
+  print_latency("asíncrono", async_ns);
+
+  std::string expected;
+  for (const auto& m : sent) expected += m;
+  bool mem_ok = mem.used == expected.size() && memcmp(capture.data(), expected.data(), mem.used) == 0;
+  for (int id : ids) {
+    telemetry_sink_stats_t st;
+    const char* name = telemetry_sink_get_stats(id, &st);
+    printf("sink %-8s escritos %6u  descartados %6u  errores %u\n", name, st.delivered, st.dropped, st.failed);
+  }
+  uint32_t no_buffer, too_long;
+  telemetry_sink_get_pool_stats(&no_buffer, &too_long);
+  printf("memoria %s, udp %u/%u en orden (%u distintos), pool sin buffer %u\n",
+         mem_ok ? "completa y en orden" : "INCOMPLETA", udp_ok, messages, udp_bad, no_buffer);
+  return (mem_ok && udp_ok == messages && no_buffer == 0) ? 0 : 1;
+}
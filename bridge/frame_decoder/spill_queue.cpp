@@ -0,0 +1,326 @@
+/**
+ * @file spill_queue.cpp
+ * @brief Pruebas de la cola de desbordamiento en flash (telemetry_spill.cpp) sobre un sistema de archivos en memoria
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Enlaza el buffer y la cola del firmware con un sustituto en memoria de
+ * telemetry_spill_fs_t (un std::map de ficheros) y simula dos reinicios:
+ * - Ronda 1: se almacenan N paquetes con un suscriptor bloqueante, se vuelcan
+ *   los que pasan de TELEM_SPILL_LOW_WATERMARK y se reenvían unos pocos
+ *   confirmando solo una parte del peek (con TELEM_SPILL_DELTA, a mitad de
+ *   un registro delta: head_skip).
+ * - Reinicio: la RAM se pierde y telemetry_spill_init() recupera el estado y
+ *   abre un segmento nuevo (tail_segment + 1).
+ * - Ronda 2: otros N paquetes y otro volcado; el último registro se trunca
+ *   unos bytes, como si el reinicio llegara a mitad de la escritura.
+ * - Reinicio y reenvío completo con confirmaciones parciales de tamaño
+ *   variable.
+ *
+ * Comprueba que se reenvía exactamente lo volcado y no confirmado, en orden
+ * y con el mismo contenido (los float, dentro de los decimales del esquema
+ * cuando se guardan en delta), que el registro truncado se descarta entero
+ * (1 descartado) y que al final no queda ningún segmento en el sistema de
+ * archivos. El directorio host/ sustituye a FreeRTOS y esp_timer.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -pthread -Ihost -I../../include spill_queue.cpp ../../src/telemetry_spill.cpp \
+ *       ../../src/telemetry_record.cpp ../../src/telemetry_delta.cpp ../../src/telemetry_schema.cpp \
+ *       ../../src/telemetry_storage.cpp ../../src/telemetry_latency.cpp ../../src/telemetry_wake.cpp \
+ *       -o spill_queue
+ *   (-DTELEM_SPILL_DELTA=0 para registros de un paquete)
+ *
+ * Uso:
+ *   ./spill_queue [paquetes por ronda] [bytes truncados]   (por defecto 900 y 7)
+ */
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "../../include/telemetry_spill.h"
+#include "../../include/telemetry_storage.h"
+#include "../../include/telemetry_schema.h"
+#include "../../include/telemetry_logger.h"
+
+/** @brief telemetry_latency.cpp solo registra por aquí en telemetry_latency_dump() */
+void telemetry_logf(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  va_end(args);
+  printf("\n");
+}
+
+/** @brief Ficheros del sustituto del sistema de archivos */
+static std::map<std::string, std::vector<uint8_t>> s_files;
+
+static bool mem_append(const char* path, const void* data, uint32_t len) {
+  std::vector<uint8_t>& file = s_files[path];
+  file.insert(file.end(), (const uint8_t*)data, (const uint8_t*)data + len);
+  return true;
+}
+
+static bool mem_write(const char* path, const void* data, uint32_t len) {
+  s_files[path].assign((const uint8_t*)data, (const uint8_t*)data + len);
+  return true;
+}
+
+static int32_t mem_read(const char* path, uint32_t offset, void* data, uint32_t len) {
+  auto it = s_files.find(path);
+  if (it == s_files.end()) return -1;
+  if (offset >= it->second.size()) return 0;
+  uint32_t n = (uint32_t)it->second.size() - offset;
+  if (n > len) n = len;
+  memcpy(data, it->second.data() + offset, n);
+  return (int32_t)n;
+}
+
+static int32_t mem_size(const char* path) {
+  auto it = s_files.find(path);
+  return (it == s_files.end()) ? -1 : (int32_t)it->second.size();
+}
+
+static bool mem_remove(const char* path) {
+  return s_files.erase(path) > 0;
+}
+
+static const telemetry_spill_fs_t s_mem_fs = { mem_append, mem_write, mem_read, mem_size, mem_remove };
+
+/** @brief Estado guardado en el fichero de estado de la cola */
+static telemetry_spill_state_t saved_state(void) {
+  telemetry_spill_state_t state;
+  memset(&state, 0, sizeof(state));
+  mem_read(TELEM_SPILL_STATE_FILE, 0, &state, sizeof(state));
+  return state;
+}
+
+static uint32_t segment_files(void) {
+  uint32_t n = 0;
+  for (const auto& file : s_files) {
+    if (file.first != TELEM_SPILL_STATE_FILE) n++;
+  }
+  return n;
+}
+
+/** @brief Tipos de la adquisición que se alternan en cada ronda */
+static const telem_data_type_t s_types[] = {
+  TELEM_SYSTEM_STATUS, TELEM_POWER_DATA, TELEM_TEMPERATURE_DATA,
+  TELEM_COMMUNICATION_STATUS, TELEM_STORAGE_METRICS, TELEM_LATENCY_METRICS,
+};
+
+/**
+ * @brief Paquete determinista número n: cada campo del esquema deriva con n
+ */
+static telemetry_packet_t make_packet(uint32_t n) {
+  telemetry_packet_t p;
+  memset(&p, 0, sizeof(p));
+  p.header.type = s_types[n % (sizeof(s_types) / sizeof(s_types[0]))];
+  p.header.timestamp = 1000 + n * 2;
+  p.header.sequence = (uint16_t)n;
+  p.header.priority = (uint8_t)(n % 3);
+  const telemetry_schema_t* schema = telemetry_schema_get(p.header.type);
+  for (uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    uint8_t width = telemetry_field_width(field->kind);
+    for (uint8_t i = 0; i < field->count; i++) {
+      uint8_t* dst = p.raw_data + field->offset + i * width;
+      uint32_t v = n * 7 + f * 13 + i;
+      if (field->kind == TELEM_FIELD_F32) {
+        float x = 3.7f + 0.0137f * (float)(n % 97) - 0.25f * f;
+        memcpy(dst, &x, sizeof(x));
+      } else {
+        memcpy(dst, &v, width);
+      }
+    }
+  }
+  return p;
+}
+
+/**
+ * @brief Compara un paquete reenviado con el original campo a campo
+ */
+static bool same_packet(const telemetry_packet_t& a, const telemetry_packet_t& b) {
+  if (a.header.type != b.header.type || a.header.timestamp != b.header.timestamp ||
+      a.header.sequence != b.header.sequence || a.header.priority != b.header.priority) {
+    return false;
+  }
+  const telemetry_schema_t* schema = telemetry_schema_get(a.header.type);
+  for (uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    uint8_t width = telemetry_field_width(field->kind);
+    for (uint8_t i = 0; i < field->count; i++) {
+      uint32_t off = field->offset + i * width;
+      if (field->kind == TELEM_FIELD_F32) {
+        float fa, fb;
+        memcpy(&fa, a.raw_data + off, 4);
+        memcpy(&fb, b.raw_data + off, 4);
+        if (std::fabs(fa - fb) > 0.5f * std::pow(10.0f, -field->decimals) + 1e-6f) return false;
+      } else if (memcmp(a.raw_data + off, b.raw_data + off, width) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static uint32_t s_errors = 0;
+
+static void check(bool ok, const char* what) {
+  if (!ok) {
+    printf("ERROR %s\n", what);
+    s_errors++;
+  }
+}
+
+/**
+ * @brief Arranque: buffer vacío (la RAM no sobrevive) y cola recuperada de flash
+ */
+static telemetry_subscriber_t boot(void) {
+  telemetry_storage_init();
+  telemetry_subscriber_t sub = telemetry_subscribe(TELEM_SUB_BLOCKING);
+  check(telemetry_spill_init(&s_mem_fs), "telemetry_spill_init");
+  return sub;
+}
+
+/**
+ * @brief Almacena los paquetes [first, first + count) y vuelca el exceso a flash
+ *
+ * @param[out] spilled_seq Secuencias volcadas, en orden
+ * @return uint32_t Paquetes volcados
+ */
+static uint32_t store_and_spill(telemetry_subscriber_t sub, uint32_t first, uint32_t count,
+                                std::vector<uint32_t>& spilled_seq) {
+  for (uint32_t n = first; n < first + count; n++) {
+    telemetry_packet_t p = make_packet(n);
+    check(telemetry_store_packet(&p), "paquete rechazado por el buffer");
+  }
+  uint32_t spilled = telemetry_spill_offload(sub);
+  uint32_t expected = (count > TELEM_SPILL_HIGH_WATERMARK) ? count - TELEM_SPILL_LOW_WATERMARK : 0;
+  check(spilled == expected, "paquetes volcados");
+  check(telemetry_available_packets_for(sub) == count - spilled, "paquetes que quedan en RAM");
+  for (uint32_t n = first; n < first + spilled; n++) {
+    spilled_seq.push_back(n);
+  }
+  return spilled;
+}
+
+/**
+ * @brief Reenvía hasta max_packets paquetes confirmando lotes parciales
+ *
+ * @param commit_of Paquetes a confirmar de un peek de got paquetes (1..got)
+ * @param[in,out] next Posición en expected del siguiente paquete esperado
+ * @return uint32_t Paquetes reenviados
+ */
+static uint32_t replay(const std::vector<uint32_t>& expected, size_t& next, uint32_t max_packets,
+                       uint32_t (*commit_of)(uint32_t got, uint32_t round)) {
+  telemetry_packet_t batch[TELEM_SPILL_BATCH];
+  uint32_t replayed = 0;
+  for (uint32_t round = 0; replayed < max_packets; round++) {
+    uint32_t got = telemetry_spill_peek(batch, TELEM_SPILL_BATCH);
+    if (got == 0) break;
+    uint32_t commit = commit_of(got, round);
+    if (commit > max_packets - replayed) commit = max_packets - replayed;
+    for (uint32_t i = 0; i < commit; i++) {
+      if (next >= expected.size()) {
+        printf("ERROR paquete de más: seq %u\n", batch[i].header.sequence);
+        s_errors++;
+        return replayed;
+      }
+      telemetry_packet_t want = make_packet(expected[next]);
+      if (!same_packet(batch[i], want)) {
+        printf("ERROR reenvío %zu: seq %u, se esperaba %u\n", next, batch[i].header.sequence,
+               (unsigned)(uint16_t)expected[next]);
+        s_errors++;
+        return replayed;
+      }
+      next++;
+    }
+    telemetry_spill_commit(commit);
+    replayed += commit;
+  }
+  return replayed;
+}
+
+/** @brief Confirmaciones de 1 a 7 paquetes: casi siempre a mitad de un peek */
+static uint32_t commit_varied(uint32_t got, uint32_t round) {
+  uint32_t n = 1 + round % 7;
+  return (n < got) ? n : got;
+}
+
+static uint32_t commit_all(uint32_t got, uint32_t round) {
+  (void)round;
+  return got;
+}
+
+int main(int argc, char** argv) {
+  uint32_t per_round = (argc > 1) ? (uint32_t)atoi(argv[1]) : 900;
+  uint32_t truncate = (argc > 2) ? (uint32_t)atoi(argv[2]) : 7;
+  if (per_round <= TELEM_SPILL_HIGH_WATERMARK || per_round > TELEM_BUFFER_SIZE || truncate == 0) {
+    fprintf(stderr, "uso: %s [paquetes por ronda (%u-%u)] [bytes truncados (>0)]\n", argv[0],
+            (unsigned)TELEM_SPILL_HIGH_WATERMARK + 1, (unsigned)TELEM_BUFFER_SIZE);
+    return 1;
+  }
+  printf("TELEM_SPILL_DELTA=%d, segmentos de %u B, %u paquetes por ronda\n", TELEM_SPILL_DELTA,
+         (unsigned)TELEM_SPILL_SEGMENT_BYTES, per_round);
+
+  // Ronda 1: volcado y reenvío parcial
+  std::vector<uint32_t> expected;
+  size_t next = 0;
+  telemetry_subscriber_t sub = boot();
+  uint32_t spilled1 = store_and_spill(sub, 0, per_round, expected);
+  uint32_t partial = replay(expected, next, 5, commit_all);
+  check(partial == 5, "reenvío parcial");
+  telemetry_spill_state_t before = saved_state();
+  check(before.head_skip == (TELEM_SPILL_DELTA ? 5u : 0u), "head_skip tras confirmar parte de un registro");
+  printf("Ronda 1: %u volcados, %u reenviados (head_skip %u), segmentos %u-%u\n", spilled1, partial,
+         before.head_skip, before.head_segment, before.tail_segment);
+
+  // Reinicio: la cola sigue donde estaba y se añade en un segmento nuevo
+  sub = boot();
+  telemetry_spill_state_t after = saved_state();
+  check(telemetry_spill_pending(), "cola pendiente tras el reinicio");
+  check(after.head_segment == before.head_segment && after.head_offset == before.head_offset &&
+        after.head_skip == before.head_skip, "posición de reenvío tras el reinicio");
+  check(after.tail_segment == before.tail_segment + 1, "segmento nuevo tras el reinicio");
+
+  // Ronda 2: otro volcado cuyo último registro queda truncado por el siguiente reinicio
+  uint32_t spilled2 = store_and_spill(sub, per_round, per_round, expected);
+  telemetry_spill_state_t tail = saved_state();
+  char path[32];
+  snprintf(path, sizeof(path), TELEM_SPILL_SEGMENT_PREFIX "%08lu.bin", (unsigned long)tail.tail_segment);
+  std::vector<uint8_t>& segment = s_files[path];
+  check(segment.size() > truncate, "segmento de cola más corto que el truncado");
+  segment.resize(segment.size() - truncate);
+  // El último registro lleva el último lote (TELEM_SPILL_DELTA) o el último paquete
+  uint32_t last_record = TELEM_SPILL_DELTA ? (spilled2 % TELEM_SPILL_BATCH ? spilled2 % TELEM_SPILL_BATCH
+                                                                           : TELEM_SPILL_BATCH) : 1;
+  expected.resize(expected.size() - last_record);
+  printf("Ronda 2: %u volcados, último registro (%u paquetes) truncado %u B, segmentos %u-%u\n", spilled2,
+         last_record, truncate, tail.head_segment, tail.tail_segment);
+
+  // Reinicio y reenvío completo
+  boot();
+  uint32_t rest = replay(expected, next, UINT32_MAX, commit_varied);
+  check(next == expected.size(), "paquetes reenviados");
+  check(!telemetry_spill_pending(), "cola vacía al terminar");
+  check(segment_files() == 0, "segmentos sin borrar");
+
+  uint32_t spilled, replayed, discarded, segments;
+  telemetry_spill_get_stats(&spilled, &replayed, &discarded, &segments);
+  check(discarded == 1, "registros descartados");
+  printf("Reenvío: %u paquetes tras el reinicio, %zu en total, %u registro(s) descartado(s)\n", rest, next,
+         discarded);
+
+  if (s_errors > 0) {
+    printf("%u errores\n", s_errors);
+    return 1;
+  }
+  printf("OK: orden y contenido correctos\n");
+  return 0;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file stats_summary.cpp
+ * @brief Banco de pruebas de las estadísticas por ventana (telemetry_stats.cpp)
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Genera las muestras de sistema, potencia y temperatura que produciría el
+ * recolector (una de cada tipo por periodo, con deriva y ruido: descarga de
+ * la batería, calentamiento, heap que fluctúa) y las pasa por
+ * telemetry_stats_update() como el procesador. Comprueba:
+ * - exactitud: cada resumen frente a mínimo, máximo, media, desviación
+ *   típica y variación por minuto calculados en dos pasadas (en double)
+ *   sobre las muestras de su ventana
+ * - telemetry_stats_get(): la ventana deslizante frente a las muestras de
+ *   las últimas TELEM_STATS_BUCKETS cubetas
+ * - ida y vuelta de los resúmenes por telemetry_frame
+ * - coste por paquete
+ *
+ * y compara los bytes de enlace (tramas binarias) de las muestras con los de
+ * los resúmenes que las sustituyen.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -I../../include stats_summary.cpp ../../src/telemetry_stats.cpp \
+ *       ../../src/telemetry_schema.cpp ../../src/telemetry_frame.cpp ../../src/telemetry_delta.cpp \
+ *       -o stats_summary
+ *
+ * Uso:
+ *   ./stats_summary [periodo ms] [horas]   (por defecto 2000 3)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "../../include/telemetry_stats.h"
+#include "../../include/telemetry_schema.h"
+#include "../../include/telemetry_frame.h"
+
+typedef struct {
+  uint32_t t_ms;
+  telem_data_type_t type;
+  double values[TELEM_STATS_MAX_FIELDS];
+} sample_t;
+
+static std::vector<sample_t> g_samples;
+static std::vector<telemetry_packet_t> g_summaries;
+
+static void collect(void* ctx, const telemetry_packet_t* summary) {
+  (void)ctx;
+  g_summaries.push_back(*summary);
+}
+
+/**
+ * @brief Valor de un campo como lo lee el motor (double, unidades físicas)
+ */
+static double field_value(const telemetry_packet_t* p, const telemetry_field_t* f) {
+  const uint8_t* b = p->raw_data + f->offset;
+  double v;
+  switch (f->kind) {
+    case TELEM_FIELD_U8:  v = *b; break;
+    case TELEM_FIELD_I8:  v = (int8_t)*b; break;
+    case TELEM_FIELD_U16: { uint16_t x; memcpy(&x, b, 2); v = x; break; }
+    case TELEM_FIELD_I16: { int16_t x;  memcpy(&x, b, 2); v = x; break; }
+    case TELEM_FIELD_U32: { uint32_t x; memcpy(&x, b, 4); v = x; break; }
+    default:              { float x;    memcpy(&x, b, 4); return x; }
+  }
+  return v / std::pow(10.0, f->decimals);
+}
+
+static void make_packet(telemetry_packet_t* p, telem_data_type_t type, uint32_t t_ms, std::mt19937& rng) {
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  float hours = t_ms / 3600000.0f;
+  memset(p, 0, sizeof(*p));
+  p->header.type = type;
+  p->header.timestamp = t_ms;
+  p->header.priority = (type == TELEM_POWER_DATA) ? TELEM_PRIORITY_HIGH : TELEM_PRIORITY_NORMAL;
+  switch (type) {
+    case TELEM_SYSTEM_STATUS:
+      p->system.uptime_seconds = t_ms / 1000;
+      p->system.system_mode = 1;
+      p->system.cpu_usage = (uint8_t)(30 + 10 * std::fabs(noise(rng)));
+      p->system.stack_high_water = (uint16_t)(2048 - (rng() % 64));
+      p->system.heap_free = 180000 + (uint32_t)(rng() % 20000);
+      p->system.task_count = 9;
+      p->system.cpu_temperature = 45.0f + 5.0f * std::sin(hours * 6.283f) + 0.3f * noise(rng);
+      break;
+    case TELEM_POWER_DATA:
+      p->power.battery_voltage = 4.1f - 0.2f * hours / 3.0f + 0.01f * noise(rng);
+      p->power.battery_current = 0.45f + 0.05f * noise(rng);
+      p->power.solar_panel_voltage = 5.0f + 0.5f * std::sin(hours * 4.0f) + 0.05f * noise(rng);
+      p->power.solar_panel_current = 0.2f + 0.02f * noise(rng);
+      p->power.battery_level = (uint8_t)(95 - 10 * hours / 3.0f);
+      p->power.battery_temperature = (int8_t)(20 + 3 * noise(rng));
+      p->power.power_state = 1;
+      break;
+    default:
+      p->temperature.obc_temperature = (int16_t)(250 + 20 * hours + 5 * noise(rng));
+      p->temperature.comms_temperature = (int16_t)(300 + 10 * noise(rng));
+      p->temperature.payload_temperature = (int16_t)(-150 + 50 * std::sin(hours * 6.283f) + 5 * noise(rng));
+      p->temperature.battery_temperature = (int16_t)(200 + 5 * noise(rng));
+      p->temperature.external_temperature = (int16_t)(-400 + 200 * std::sin(hours * 3.0f) + 10 * noise(rng));
+      break;
+  }
+}
+
+typedef struct {
+  double min, max, mean, stddev, rate;
+  uint32_t n;
+} reference_t;
+
+/**
+ * @brief Estadística en dos pasadas de las muestras de un tipo con t en [lo, hi)
+ */
+static reference_t reference(telem_data_type_t type, uint8_t field, uint32_t lo, uint32_t hi) {
+  reference_t r = { 0, 0, 0, 0, 0, 0 };
+  double sum = 0.0;
+  const sample_t* first = NULL;
+  const sample_t* last = NULL;
+  for (const auto& s : g_samples) {
+    if (s.type != type || s.t_ms < lo || s.t_ms >= hi) continue;
+    double x = s.values[field];
+    if (r.n == 0) r.min = r.max = x;
+    r.min = std::min(r.min, x);
+    r.max = std::max(r.max, x);
+    sum += x;
+    r.n++;
+    if (!first) first = &s;
+    last = &s;
+  }
+  if (r.n == 0) return r;
+  r.mean = sum / r.n;
+  double ss = 0.0;
+  for (const auto& s : g_samples) {
+    if (s.type != type || s.t_ms < lo || s.t_ms >= hi) continue;
+    ss += (s.values[field] - r.mean) * (s.values[field] - r.mean);
+  }
+  r.stddev = (r.n > 1) ? std::sqrt(ss / (r.n - 1)) : 0.0;
+  r.rate = (last->t_ms != first->t_ms)
+             ? (last->values[field] - first->values[field]) * 60000.0 / (last->t_ms - first->t_ms) : 0.0;
+  return r;
+}
+
+/**
+ * @brief Error relativo a la escala del campo en la ventana
+ */
+static double rel_error(double got, double want, double scale) {
+  return std::fabs(got - want) / std::max(scale, 1e-6);
+}
+
+typedef struct {
+  double worst[5];
+  uint32_t checked;
+  uint32_t bad_samples;
+} check_t;
+
+static void check(check_t* c, const stats_summary_telem_t* s, const reference_t& r) {
+  if (s->samples != r.n) {
+    c->bad_samples++;
+    return;
+  }
+  double scale = std::max({ std::fabs(r.max), std::fabs(r.min), r.max - r.min });
+  double rate_scale = std::max(std::fabs(r.rate), scale / 60.0);
+  double e[5] = { rel_error(s->min, r.min, scale), rel_error(s->max, r.max, scale),
+                  rel_error(s->mean, r.mean, scale), rel_error(s->stddev, r.stddev, std::max(r.stddev, scale * 1e-3)),
+                  rel_error(s->rate_per_min, r.rate, rate_scale) };
+  for (int i = 0; i < 5; i++) c->worst[i] = std::max(c->worst[i], e[i]);
+  c->checked++;
+}
+
+int main(int argc, char** argv) {
+  uint32_t period_ms = (argc > 1) ? (uint32_t)atoi(argv[1]) : 2000;
+  uint32_t hours = (argc > 2) ? (uint32_t)atoi(argv[2]) : 3;
+  if (period_ms == 0 || hours == 0) {
+    fprintf(stderr, "uso: %s [periodo ms] [horas]\n", argv[0]);
+    return 1;
+  }
+  const telem_data_type_t types[] = { TELEM_SYSTEM_STATUS, TELEM_POWER_DATA, TELEM_TEMPERATURE_DATA };
+
+  static telemetry_stats_t stats;
+  telemetry_stats_init(&stats, collect, NULL);
+  std::mt19937 rng(2026);
+  uint64_t raw_bytes = 0;
+  uint32_t raw_packets = 0;
+  uint8_t frame[TELEM_FRAME_MAX_BYTES];
+  double update_ns = 0.0;
+
+  // Comprobación de la ventana deslizante cada ~7 min
+  check_t rolling = { { 0 }, 0, 0 };
+  uint32_t end_ms = hours * 3600000U;
+  for (uint32_t t = period_ms; t <= end_ms; t += period_ms) {
+    for (telem_data_type_t type : types) {
+      telemetry_packet_t p;
+      make_packet(&p, type, t, rng);
+      const telemetry_schema_t* schema = telemetry_schema_get(type);
+      sample_t s;
+      s.t_ms = t;
+      s.type = type;
+      for (uint8_t f = 0; f < schema->field_count; f++) s.values[f] = field_value(&p, &schema->fields[f]);
+      g_samples.push_back(s);
+      raw_bytes += telemetry_frame_encode(&p, 0, frame, sizeof(frame));
+      raw_packets++;
+
+      auto t0 = std::chrono::steady_clock::now();
+      telemetry_stats_update(&stats, &p);
+      update_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    }
+    if (t % 420000 < period_ms) {
+      for (uint8_t w = 0; w < TELEM_STATS_WINDOW_COUNT; w++) {
+        uint32_t width = telemetry_stats_window_s(w) * 1000U / TELEM_STATS_BUCKETS;
+        uint32_t epoch = t / width;
+        uint32_t lo = (epoch >= TELEM_STATS_BUCKETS - 1) ? (epoch - (TELEM_STATS_BUCKETS - 1)) * width : 0;
+        for (telem_data_type_t type : types) {
+          for (uint8_t f = 0; f < telemetry_schema_get(type)->field_count; f++) {
+            stats_summary_telem_t out;
+            if (telemetry_stats_get(&stats, type, f, w, t, &out)) check(&rolling, &out, reference(type, f, lo, t + 1));
+          }
+        }
+      }
+    }
+  }
+
+  // Resúmenes de las ventanas cerradas frente a las dos pasadas, y por el enlace
+  check_t closed = { { 0 }, 0, 0 };
+  uint64_t summary_bytes[TELEM_STATS_WINDOW_COUNT] = { 0 };
+  uint32_t summary_count[TELEM_STATS_WINDOW_COUNT] = { 0 };
+  uint32_t roundtrip_bad = 0;
+  for (const auto& sp : g_summaries) {
+    const stats_summary_telem_t* s = &sp.summary;
+    uint32_t window_ms = s->window_s * 1000U;
+    uint32_t lo = s->header.timestamp / window_ms * window_ms;
+    check(&closed, s, reference((telem_data_type_t)s->source_type, s->field, lo, lo + window_ms));
+
+    size_t len = telemetry_frame_encode(&sp, 0, frame, sizeof(frame));
+    telemetry_packet_t back;
+    uint16_t seq;
+    if (len < 2 || !telemetry_frame_decode(frame + 1, len - 2, &back, &seq) ||
+        memcmp(&back.summary.source_type, &s->source_type,
+               sizeof(stats_summary_telem_t) - offsetof(stats_summary_telem_t, source_type)) != 0) {
+      roundtrip_bad++;
+    }
+    for (uint8_t w = 0; w < TELEM_STATS_WINDOW_COUNT; w++) {
+      if (telemetry_stats_window_s(w) == s->window_s) {
+        summary_bytes[w] += len;
+        summary_count[w]++;
+      }
+    }
+  }
+
+  printf("%u h, una muestra de sistema, potencia y temperatura cada %u ms, %u cubetas por ventana\n", hours,
+         period_ms, (unsigned)TELEM_STATS_BUCKETS);
+  printf("estado: %zu B, actualización %.0f ns/paquete\n", sizeof(stats), update_ns / raw_packets);
+  printf("exactitud (error máximo relativo a la escala del campo)\n");
+  printf("                      resúmenes  min       max       media     desv.     variación\n");
+  const struct {
+    const char* name;
+    const check_t* c;
+  } rows[] = { { "ventanas cerradas", &closed }, { "deslizante (get)", &rolling } };
+  for (const auto& row : rows) {
+    printf("%-20s %8u  %.1e  %.1e  %.1e  %.1e  %.1e%s\n", row.name, row.c->checked, row.c->worst[0],
+           row.c->worst[1], row.c->worst[2], row.c->worst[3], row.c->worst[4],
+           row.c->bad_samples ? "  (MUESTRAS DISTINTAS)" : "");
+  }
+
+  printf("enlace (tramas binarias)\n");
+  printf("muestras             %8u paquetes %9llu B  %7.0f B/h\n", raw_packets, (unsigned long long)raw_bytes,
+         (double)raw_bytes / hours);
+  uint64_t all = 0;
+  for (uint8_t w = 0; w < TELEM_STATS_WINDOW_COUNT; w++) {
+    all += summary_bytes[w];
+    printf("resúmenes %4u s     %8u paquetes %9llu B  %7.0f B/h  (%.1f%% de las muestras)\n",
+           telemetry_stats_window_s(w), summary_count[w], (unsigned long long)summary_bytes[w],
+           (double)summary_bytes[w] / hours, 100.0 * summary_bytes[w] / raw_bytes);
+  }
+  printf("resúmenes, todas     %8zu paquetes %9llu B  %7.0f B/h  (%.1f%% de las muestras)\n", g_summaries.size(),
+         (unsigned long long)all, (double)all / hours, 100.0 * all / raw_bytes);
+
+  double worst = 0.0;
+  for (const auto& row : rows) {
+    for (int i = 0; i < 5; i++) worst = std::max(worst, row.c->worst[i]);
+  }
+  bool ok = closed.bad_samples == 0 && rolling.bad_samples == 0 && roundtrip_bad == 0 && worst < 1e-3 &&
+            closed.checked > 0;
+  if (!ok) {
+    printf("ERROR: %u/%u resúmenes con otro número de muestras, %u tramas mal decodificadas, error %.1e\n",
+           closed.bad_samples, rolling.bad_samples, roundtrip_bad, worst);
+    return 1;
+  }
+  return 0;
+}
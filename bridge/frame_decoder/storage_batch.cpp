@@ -0,0 +1,152 @@
+/**
+ * @file storage_batch.cpp
+ * @brief Coste por paquete de telemetry_store_batch()/telemetry_retrieve_batch() según el tamaño de lote
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Almacena y saca los mismos paquetes en lotes de 1, 4, 16 y 64 (uno solo
+ * equivale a telemetry_store_packet()/telemetry_retrieve_packet_for()) y
+ * mide para cada tamaño:
+ * - tomas del mutex por paquete (metrics.lock_acquired)
+ * - ciclos del contador de tiempo (TSC en x86) y ns por paquete, por separado
+ *   al almacenar y al sacar
+ *
+ * Un solo hilo alterna lote guardado y lote sacado, así que el mutex nunca
+ * compite: se mide el coste fijo de cada toma y de cada copia, que es lo que
+ * amortiza el lote. El directorio host/ sustituye a FreeRTOS y esp_timer.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -pthread -Ihost -I../../include storage_batch.cpp ../../src/telemetry_storage.cpp \
+ *       ../../src/telemetry_latency.cpp ../../src/telemetry_schema.cpp ../../src/telemetry_wake.cpp \
+ *       -o storage_batch
+ *
+ * Uso:
+ *   ./storage_batch [paquetes por tamaño]   (por defecto 1048576)
+ */
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "../../include/telemetry_storage.h"
+#include "../../include/telemetry_logger.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+/** @brief telemetry_latency.cpp solo registra por aquí en telemetry_latency_dump() */
+void telemetry_logf(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  va_end(args);
+  printf("\n");
+}
+
+/** @brief Contador de ciclos (0 fuera de x86: solo se informa en ns) */
+static inline uint64_t cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+typedef struct {
+  uint64_t cycles;
+  uint64_t ns;
+} cost_t;
+
+typedef struct {
+  uint32_t batch;
+  uint32_t packets;
+  uint32_t locks_store;
+  uint32_t locks_retrieve;
+  cost_t store;
+  cost_t retrieve;
+  uint32_t errors;
+} batch_result_t;
+
+static batch_result_t run(uint32_t batch, uint32_t total) {
+  batch_result_t r;
+  memset(&r, 0, sizeof(r));
+  r.batch = batch;
+
+  telemetry_storage_init();
+  telemetry_subscriber_t sub = telemetry_subscribe(TELEM_SUB_BLOCKING);
+  std::vector<telemetry_packet_t> in(batch), out(batch);
+  telemetry_storage_metrics_t m;
+
+  uint32_t next = 0, expected = 0;
+  while (r.packets < total) {
+    for (uint32_t k = 0; k < batch; k++) {
+      telemetry_packet_t* p = &in[k];
+      memset(p, 0, sizeof(*p));
+      p->header.type = TELEM_SYSTEM_STATUS;
+      p->header.priority = TELEM_PRIORITY_NORMAL;
+      p->header.sequence = (uint16_t)next;
+      p->system.uptime_seconds = next++;
+    }
+
+    telemetry_get_metrics(&m);
+    uint32_t locks = m.lock_acquired;
+    auto t0 = clock_type::now();
+    uint64_t c0 = cycles();
+    uint32_t stored = telemetry_store_batch(in.data(), batch);
+    uint64_t c1 = cycles();
+    auto t1 = clock_type::now();
+    telemetry_get_metrics(&m);
+    r.locks_store += m.lock_acquired - locks;
+    locks = m.lock_acquired;
+
+    uint64_t c2 = cycles();
+    uint32_t got = telemetry_retrieve_batch(sub, out.data(), batch);
+    uint64_t c3 = cycles();
+    auto t2 = clock_type::now();
+    telemetry_get_metrics(&m);
+    r.locks_retrieve += m.lock_acquired - locks;
+
+    r.store.cycles += c1 - c0;
+    r.retrieve.cycles += c3 - c2;
+    r.store.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    r.retrieve.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+
+    if (stored != batch || got != batch) r.errors++;
+    for (uint32_t k = 0; k < got; k++) {
+      if (out[k].system.uptime_seconds != expected++) r.errors++;
+    }
+    r.packets += got;
+  }
+  telemetry_unsubscribe(sub);
+  return r;
+}
+
+int main(int argc, char** argv) {
+  uint32_t total = (argc > 1) ? (uint32_t)atoi(argv[1]) : 1048576;
+  if (total == 0) {
+    fprintf(stderr, "uso: %s [paquetes por tamaño]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%u paquetes por tamaño de lote, modo %s\n", total, TELEM_STORAGE_LOCKFREE ? "lockfree" : "mutex");
+  printf("lote  tomas/paquete (store, retrieve)   store ciclos/pkt  ns/pkt   retrieve ciclos/pkt  ns/pkt\n");
+
+  const uint32_t batches[] = { 1, 4, 16, 64 };
+  bool ok = true;
+  for (uint32_t batch : batches) {
+    batch_result_t r = run(batch, total);
+    double n = r.packets ? (double)r.packets : 1.0;
+    printf("%4u  %13.3f %13.3f   %16.1f %7.1f   %19.1f %7.1f\n", r.batch, r.locks_store / n, r.locks_retrieve / n,
+           r.store.cycles / n, r.store.ns / n, r.retrieve.cycles / n, r.retrieve.ns / n);
+    if (r.errors) {
+      printf("ERROR: lote %u con %u lotes incompletos o paquetes fuera de orden\n", batch, r.errors);
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file storage_spsc.cpp
+ * @brief Prueba de carga concurrente del buffer de telemetría (telemetry_storage.cpp)
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Un hilo productor almacena paquetes numerados, alternando
+ * telemetry_store_packet() y telemetry_reserve_slot()/telemetry_commit_slot()
+ * (el recolector), y un hilo consumidor, suscrito como bloqueante (el
+ * transmisor), los saca uno a uno con telemetry_retrieve_packet_for(). Un
+ * tercer hilo lee la tabla de últimos valores con telemetry_get_latest(),
+ * como el diagnóstico. Comprueba:
+ * - que el consumidor recibe todos los paquetes, en orden, sin duplicados y
+ *   sin mezclar el contenido de dos paquetes (palabra de control por paquete)
+ * - que cada paquete lleva sus sellos de latencia: publicación no anterior
+ *   a la adquisición, y ambos iguales si se copió con telemetry_store_packet()
+ * - que telemetry_get_latest() nunca devuelve un paquete a medio escribir
+ *
+ * Con el buffer lleno el productor reintenta, así que no se pierde nada.
+ * Mide operaciones por segundo y la latencia de cada llamada (p50, p99,
+ * p99.9 y máximo) en el productor y en el consumidor. Se compila una vez con
+ * el mutex (por defecto) y otra con TELEM_STORAGE_LOCKFREE=1 para comparar;
+ * las pruebas deben pasar también con TELEM_STORAGE_PRIORITY_LANES=1 y con
+ * TELEM_LATENCY_TRACE=0. El directorio host/ sustituye a FreeRTOS y esp_timer.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -pthread -Ihost -I../../include storage_spsc.cpp ../../src/telemetry_storage.cpp \
+ *       ../../src/telemetry_latency.cpp ../../src/telemetry_schema.cpp ../../src/telemetry_wake.cpp \
+ *       -o storage_spsc_mutex
+ *   (lo mismo con -DTELEM_STORAGE_LOCKFREE=1 -o storage_spsc_lockfree)
+ *
+ * Uso:
+ *   ./storage_spsc_mutex [paquetes]   (por defecto 1000000)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "../../include/telemetry_storage.h"
+#include "../../include/telemetry_logger.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+/** @brief telemetry_latency.cpp solo registra por aquí en telemetry_latency_dump() */
+void telemetry_logf(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  va_end(args);
+  printf("\n");
+}
+
+/** @brief Palabra de control del paquete i: detecta paquetes mezclados */
+static uint32_t check_word(uint32_t i) {
+  return i * 2654435761u ^ 0x5A5A5A5Au;
+}
+
+static telemetry_packet_t make_packet(uint32_t i) {
+  telemetry_packet_t p;
+  memset(&p, 0, sizeof(p));
+  p.header.type = TELEM_SYSTEM_STATUS;
+  p.header.priority = TELEM_PRIORITY_NORMAL;
+  p.header.sequence = (uint16_t)i;
+  p.header.timestamp = i;
+  p.system.uptime_seconds = i;
+  p.system.heap_free = check_word(i);
+  return p;
+}
+
+static inline uint32_t elapsed_ns(clock_type::time_point start) {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+}
+
+static uint32_t percentile(std::vector<uint32_t>& v, double p) {
+  if (v.empty()) return 0;
+  size_t i = (size_t)(p * (v.size() - 1));
+  std::nth_element(v.begin(), v.begin() + i, v.end());
+  return v[i];
+}
+
+static void print_latency(const char* name, std::vector<uint32_t>& v) {
+  uint32_t max = v.empty() ? 0 : *std::max_element(v.begin(), v.end());
+  printf("  %-10s p50 %6u ns  p99 %6u ns  p99.9 %7u ns  máx %9u ns  (%zu llamadas)\n", name, percentile(v, 0.50),
+         percentile(v, 0.99), percentile(v, 0.999), max, v.size());
+}
+
+int main(int argc, char** argv) {
+  uint32_t total = (argc > 1) ? (uint32_t)atoi(argv[1]) : 1000000;
+  if (total == 0) {
+    fprintf(stderr, "uso: %s [paquetes]\n", argv[0]);
+    return 1;
+  }
+
+  telemetry_storage_init();
+  telemetry_subscriber_t sub = telemetry_subscribe(TELEM_SUB_BLOCKING);
+  if (sub == TELEM_INVALID_SUBSCRIBER) {
+    printf("ERROR: no se pudo suscribir\n");
+    return 1;
+  }
+
+  std::vector<uint32_t> store_ns, retrieve_ns;
+  store_ns.reserve(total);
+  retrieve_ns.reserve(total);
+  std::atomic<bool> done(false);
+  uint64_t store_full = 0;
+  uint32_t order_errors = 0, data_errors = 0, stamp_errors = 0, received = 0;
+  uint64_t latest_reads = 0;
+  uint32_t latest_errors = 0;
+
+  auto start = clock_type::now();
+
+  std::thread consumer([&] {
+    uint32_t expected = 0;
+    while (expected < total) {
+      telemetry_packet_t p;
+      auto t0 = clock_type::now();
+      if (!telemetry_retrieve_packet_for(sub, &p)) {
+        std::this_thread::yield();
+        continue;
+      }
+      retrieve_ns.push_back(elapsed_ns(t0));
+      if (p.system.uptime_seconds != expected) order_errors++;
+      if (p.system.heap_free != check_word(p.system.uptime_seconds) ||
+          p.header.sequence != (uint16_t)p.system.uptime_seconds) {
+        data_errors++;
+      }
+      // Sellos: los reservados se adquieren antes de publicarse (32 bits con vuelta)
+      bool reserved = (p.system.uptime_seconds & 1) != 0;
+      uint32_t queued_us = p.header.enqueued_us - p.header.acquired_us;
+      if (p.header.enqueued_us == 0 || queued_us > 1000000 || (!reserved && queued_us != 0)) stamp_errors++;
+      expected = p.system.uptime_seconds + 1;
+      received++;
+    }
+  });
+
+  std::thread reader([&] {
+    while (!done.load(std::memory_order_relaxed)) {
+      telemetry_packet_t p;
+      if (telemetry_get_latest(TELEM_SYSTEM_STATUS, &p)) {
+        latest_reads++;
+        if (p.system.heap_free != check_word(p.system.uptime_seconds)) latest_errors++;
+      }
+    }
+  });
+
+  for (uint32_t i = 0; i < total; i++) {
+    telemetry_packet_t p = make_packet(i);
+    for (;;) {
+      auto t0 = clock_type::now();
+      bool stored;
+      if (i & 1) {
+        // Como el recolector: rellenar en el sitio conservando el sello de la reserva
+        telemetry_packet_t* slot = telemetry_reserve_slot(TELEM_SYSTEM_STATUS, TELEM_PRIORITY_NORMAL);
+        stored = slot != NULL;
+        if (stored) {
+          uint32_t acquired_us = slot->header.acquired_us;
+          *slot = p;
+          slot->header.acquired_us = acquired_us;
+          telemetry_commit_slot();
+        }
+      } else {
+        stored = telemetry_store_packet(&p);
+      }
+      uint32_t ns = elapsed_ns(t0);
+      if (stored) {
+        store_ns.push_back(ns);
+        break;
+      }
+      // Buffer lleno: el suscriptor bloqueante retiene la cola
+      store_full++;
+      std::this_thread::yield();
+    }
+  }
+  consumer.join();
+  double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+  done = true;
+  reader.join();
+
+  telemetry_storage_metrics_t m;
+  telemetry_get_metrics(&m);
+  uint32_t written, read, lost;
+  telemetry_get_stats(&written, &read, &lost);
+
+  printf("modo %s, %u paquetes, buffer de %u, vías de prioridad %s\n", TELEM_STORAGE_LOCKFREE ? "lockfree" : "mutex",
+         total, (unsigned)telemetry_capacity(), TELEM_STORAGE_PRIORITY_LANES ? "sí" : "no");
+  printf("  %.0f paquetes/s (%.3f s), %llu rechazos con el buffer lleno, ocupación máxima %u\n", total / seconds,
+         seconds, (unsigned long long)store_full, m.high_water);
+  print_latency("store", store_ns);
+  print_latency("retrieve", retrieve_ns);
+  printf("  mutex: %u tomas, espera máx %u us, %u timeouts\n", m.lock_acquired, m.lock_wait_max_us, m.lock_timeouts);
+  printf("  últimos valores: %llu lecturas, %u inconsistentes\n", (unsigned long long)latest_reads, latest_errors);
+
+  bool ok = received == total && order_errors == 0 && data_errors == 0 && stamp_errors == 0 && latest_errors == 0 &&
+            written == total && read == total;
+  if (!ok) {
+    printf("ERROR: %u recibidos, %u fuera de orden, %u corruptos, %u con sellos incorrectos, "
+           "%u últimos valores inconsistentes (escritos %u, leídos %u)\n",
+           received, order_errors, data_errors, stamp_errors, latest_errors, written, read);
+  }
+  return ok ? 0 : 1;
+}
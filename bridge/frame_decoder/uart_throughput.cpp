@@ -0,0 +1,254 @@
+/**
+ * @file uart_throughput.cpp
+ * @brief Caudal de la bajada JSON por una UART emulada: pausa por paquete frente a telemetry_txbuf
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Abre un pseudoterminal y limita la escritura en el maestro a la velocidad
+ * de una UART real: una FIFO de 128 bytes que se vacía a baudios/10 bytes
+ * por segundo (8N1). Un hilo lee el esclavo como lo haría el bridge y cuenta
+ * líneas y bytes. Sobre esa salida se comparan dos transmisores con los
+ * mismos paquetes (JSON de telemetry_schema.cpp):
+ * - pausa: escritura directa de cada línea y 50 ms de espera, como el
+ *   transmisor anterior
+ * - txbuf: el transmisor encola en telemetry_txbuf.cpp y un hilo escritor
+ *   hace de vTelemetryTxWriterTask, dormido hasta que telemetry_txbuf_write()
+ *   lo avisa (variable de condición en lugar de notificación de tarea); con
+ *   el anillo lleno el transmisor duerme en telemetry_txbuf_wait_space()
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -pthread -I../../include uart_throughput.cpp ../../src/telemetry_txbuf.cpp \
+ *       ../../src/telemetry_schema.cpp -o uart_throughput
+ *
+ * Uso:
+ *   ./uart_throughput [baudios] [segundos por modo]     (por defecto 115200 y 5)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "../../include/telemetry_schema.h"
+#include "../../include/telemetry_txbuf.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/** @brief FIFO de transmisión de la UART del ESP32 */
+static const double kFifoBytes = 128.0;
+
+static int g_master = -1;
+static uint32_t g_baud = 115200;
+
+/** @brief Nivel de la FIFO emulada y último instante en que se actualizó */
+static double g_fifo_level = 0.0;
+static Clock::time_point g_fifo_time;
+
+static std::atomic<uint64_t> g_rx_bytes(0);
+static std::atomic<uint64_t> g_rx_lines(0);
+static std::atomic<bool> g_stop(false);
+
+/**
+ * @brief Aviso pendiente como el de una notificación de tarea
+ */
+typedef struct {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool pending;
+} host_waiter_t;
+
+static void host_notify(void* ctx) {
+  host_waiter_t* w = (host_waiter_t*)ctx;
+  std::lock_guard<std::mutex> lock(w->mutex);
+  w->pending = true;
+  w->cv.notify_one();
+}
+
+static bool host_wait(void* ctx, uint32_t timeout_ms) {
+  host_waiter_t* w = (host_waiter_t*)ctx;
+  std::unique_lock<std::mutex> lock(w->mutex);
+  w->cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [w] { return w->pending; });
+  bool notified = w->pending;
+  w->pending = false;
+  return notified;
+}
+
+static const telemetry_wake_port_t kHostWake = { host_notify, host_wait };
+/** @brief Avisos del hilo escritor y del transmisor */
+static host_waiter_t g_writer_wake;
+static host_waiter_t g_producer_wake;
+
+/**
+ * @brief Vacía la FIFO emulada según el tiempo transcurrido
+ */
+static void fifo_update(void) {
+  Clock::time_point now = Clock::now();
+  double drained = std::chrono::duration<double>(now - g_fifo_time).count() * g_baud / TELEM_TXBUF_BITS_PER_BYTE;
+  g_fifo_level = (drained >= g_fifo_level) ? 0.0 : g_fifo_level - drained;
+  g_fifo_time = now;
+}
+
+static uint32_t uart_writable(void) {
+  fifo_update();
+  return (uint32_t)(kFifoBytes - g_fifo_level);
+}
+
+/**
+ * @brief Escribe como Serial.write(): bloquea hasta que todo ha entrado en la FIFO
+ */
+static uint32_t uart_write(const uint8_t* data, uint32_t len) {
+  uint32_t done = 0;
+  while (done < len) {
+    uint32_t room = uart_writable();
+    if (room == 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      continue;
+    }
+    uint32_t n = (len - done < room) ? len - done : room;
+    ssize_t w = write(g_master, data + done, n);
+    if (w <= 0) break;
+    g_fifo_level += (double)w;
+    done += (uint32_t)w;
+  }
+  return done;
+}
+
+static const telemetry_txbuf_port_t kUartPort = { uart_writable, uart_write };
+
+/**
+ * @brief Lector del esclavo: cuenta bytes y líneas completas
+ */
+static void reader(int slave) {
+  uint8_t buf[1024];
+  while (!g_stop.load()) {
+    ssize_t n = read(slave, buf, sizeof(buf));
+    if (n <= 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    g_rx_bytes += (uint64_t)n;
+    for (ssize_t i = 0; i < n; i++) {
+      if (buf[i] == '\n') g_rx_lines++;
+    }
+  }
+}
+
+/**
+ * @brief Paquete sintético del tipo i % TELEM_DATA_TYPE_COUNT
+ */
+static size_t make_line(uint32_t i, char* out, size_t capacity) {
+  telemetry_packet_t p;
+  memset(&p, 0, sizeof(p));
+  p.header.type = (telem_data_type_t)(i % TELEM_DATA_TYPE_COUNT);
+  p.header.timestamp = i / TELEM_DATA_TYPE_COUNT;
+  p.header.sequence = (uint16_t)i;
+  uint8_t* raw = (uint8_t*)&p + sizeof(p.header);
+  for (size_t b = 0; b < sizeof(p) - sizeof(p.header); b++) {
+    raw[b] = (uint8_t)(rand() & 0x3F);
+  }
+  size_t len = telemetry_schema_format_json(&p, out, capacity - 2);
+  out[len++] = '\r';
+  out[len++] = '\n';
+  return len;
+}
+
+/**
+ * @brief Ejecuta un modo durante seconds y muestra su caudal
+ */
+static void run(const char* name, bool buffered, double seconds) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(300)); // Restos del modo anterior
+  g_fifo_level = 0.0;
+  g_fifo_time = Clock::now();
+  g_rx_bytes = 0;
+  g_rx_lines = 0;
+  telemetry_txbuf_init(&kUartPort);
+  telemetry_txbuf_attach_producer(&kHostWake, &g_producer_wake);
+
+  std::atomic<bool> producing(true);
+  std::thread writer;
+  if (buffered) {
+    writer = std::thread([&producing]() {
+      telemetry_txbuf_attach_writer(&kHostWake, &g_writer_wake);
+      while (producing.load() || telemetry_txbuf_drain() > 0) {
+        if (telemetry_txbuf_drain() == 0) telemetry_txbuf_wait_data(10); // 10 ms: para ver el fin del modo
+      }
+    });
+  }
+
+  Clock::time_point start = Clock::now();
+  Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+  char line[TELEM_TXBUF_MAX_MESSAGE];
+  uint32_t sent = 0;
+  while (Clock::now() < end) {
+    size_t len = make_line(sent, line, sizeof(line));
+    if (buffered) {
+      while (!telemetry_txbuf_write(line, (uint32_t)len) && Clock::now() < end) {
+        telemetry_txbuf_wait_space((uint32_t)len, 10); // Como queue_message(); 10 ms para ver el final
+      }
+    } else {
+      uart_write((const uint8_t*)line, (uint32_t)len);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    sent++;
+  }
+  producing = false;
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  uint64_t rx_bytes = g_rx_bytes.load();
+  uint64_t rx_lines = g_rx_lines.load();
+  if (buffered) writer.join();
+
+  uint32_t util = telemetry_txbuf_utilization_x100((uint32_t)rx_bytes, (uint32_t)(elapsed * 1000), g_baud);
+  printf("%-8s %10.1f %10.0f %8u.%02u%%", name, rx_lines / elapsed, rx_bytes / elapsed, util / 100, util % 100);
+  if (buffered) {
+    telemetry_txbuf_stats_t st;
+    telemetry_txbuf_get_stats(&st);
+    printf("   (%u escrituras, %.0f B/escritura, max %u B en el anillo)", st.writes,
+           st.writes ? (double)st.bytes_written / st.writes : 0.0, st.high_water);
+  }
+  printf("\n");
+}
+
+int main(int argc, char** argv) {
+  g_baud = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 115200;
+  double seconds = (argc > 2) ? atof(argv[2]) : 5.0;
+  if (g_baud == 0 || seconds <= 0) {
+    fprintf(stderr, "uso: %s [baudios] [segundos por modo]\n", argv[0]);
+    return 1;
+  }
+
+  g_master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (g_master < 0 || grantpt(g_master) != 0 || unlockpt(g_master) != 0) {
+    perror("posix_openpt");
+    return 1;
+  }
+  int slave = open(ptsname(g_master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (slave < 0) {
+    perror(ptsname(g_master));
+    return 1;
+  }
+  struct termios tio;
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio); // Sin eco ni traducción de fin de línea
+  tcsetattr(slave, TCSANOW, &tio);
+  std::thread rx(reader, slave);
+
+  printf("UART emulada a %u baudios (%u B/s como máximo), %.0f s por modo\n", g_baud,
+         g_baud / TELEM_TXBUF_BITS_PER_BYTE, seconds);
+  printf("%-8s %10s %10s %9s\n", "modo", "paquetes/s", "B/s", "enlace");
+  run("pausa", false, seconds);
+  run("txbuf", true, seconds);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  g_stop = true;
+  rx.join();
+  close(slave);
+  close(g_master);
+  return 0;
+}
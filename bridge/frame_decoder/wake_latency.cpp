@@ -0,0 +1,192 @@
+/**
+ * @file wake_latency.cpp
+ * @brief Latencia del consumidor con sondeo frente a avisos (telemetry_wake.cpp)
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Un hilo productor publica ráfagas de paquetes como el recolector (una
+ * publicación por paquete, la ráfaga cada periodo) y un hilo consumidor los
+ * saca como el procesador:
+ * - sondeo: si no hay nada, duerme el periodo de sondeo (lo que hacían
+ *   vTelemetryProcessorTask con 1 s y vTelemetryTransmitterTask con 2 s)
+ * - avisos: duerme en telemetry_wake_wait() hasta que el productor avisa
+ * - avisos con min_batch = dos ráfagas: despierta una vez por cada dos
+ *
+ * El aviso es una variable de condición con un indicador pendiente, que se
+ * comporta como la notificación de tarea de telemetry_wake_freertos.cpp.
+ * Los tiempos van a escala 1/10 del firmware (ráfaga cada 200 ms, sondeo
+ * de 100 ms, espera máxima con avisos de 1 s como TELEM_PROC_WAKE_MAX_DELAY_MS)
+ * para que la prueba dure poco.
+ *
+ * Compilación:
+ *   g++ -O2 -std=c++17 -pthread -I../../include wake_latency.cpp ../../src/telemetry_wake.cpp -o wake_latency
+ *
+ * Uso:
+ *   ./wake_latency [ráfagas] [paquetes por ráfaga] [periodo ms] [sondeo ms] [espera máx ms]
+ *   (por defecto 50 4 200 100 1000)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../../include/telemetry_wake.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+/**
+ * @brief Aviso pendiente como el de una notificación de tarea
+ */
+typedef struct {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool pending;
+} host_waiter_t;
+
+static void host_notify(void* ctx) {
+  host_waiter_t* w = (host_waiter_t*)ctx;
+  std::lock_guard<std::mutex> lock(w->mutex);
+  w->pending = true;
+  w->cv.notify_one();
+}
+
+static bool host_wait(void* ctx, uint32_t timeout_ms) {
+  host_waiter_t* w = (host_waiter_t*)ctx;
+  std::unique_lock<std::mutex> lock(w->mutex);
+  w->cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [w] { return w->pending; });
+  bool notified = w->pending;
+  w->pending = false;
+  return notified;
+}
+
+static const telemetry_wake_port_t s_host_port = { host_notify, host_wait };
+
+typedef enum { MODE_POLL, MODE_WAKE, MODE_WAKE_BATCH } mode_t_;
+
+typedef struct {
+  std::vector<double> latency_ms;
+  uint32_t wakeups;
+  uint32_t empty_wakeups;
+  uint32_t signals;
+  uint32_t notifies;
+  uint32_t timeouts;
+} result_t;
+
+static result_t run(mode_t_ mode, uint32_t bursts, uint32_t burst_size, uint32_t period_ms, uint32_t poll_ms,
+                    uint32_t max_delay_ms) {
+  result_t r;
+  r.wakeups = r.empty_wakeups = 0;
+  std::mutex queue_mutex;
+  std::deque<clock_type::time_point> queue;
+  std::atomic<bool> done(false);
+
+  host_waiter_t waiter;
+  waiter.pending = false;
+  telemetry_wake_t wake;
+  telemetry_wake_init(&wake, &s_host_port, &waiter, (mode == MODE_WAKE_BATCH) ? 2 * burst_size : 1,
+                      max_delay_ms);
+
+  std::thread consumer([&] {
+    for (;;) {
+      bool finished = done.load();
+      telemetry_wake_begin(&wake);
+      uint32_t got = 0;
+      {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        auto now = clock_type::now();
+        while (!queue.empty()) {
+          r.latency_ms.push_back(std::chrono::duration<double, std::milli>(now - queue.front()).count());
+          queue.pop_front();
+          got++;
+        }
+      }
+      r.wakeups++;
+      if (got == 0) r.empty_wakeups++;
+      if (finished) break;
+      if (mode == MODE_POLL) {
+        if (got == 0) std::this_thread::sleep_for(std::chrono::milliseconds(poll_ms));
+      } else {
+        telemetry_wake_wait(&wake);
+      }
+    }
+  });
+
+  // Fase aleatoria frente al sondeo, como un recolector que arranca en cualquier momento
+  std::mt19937 rng(1234 + (uint32_t)mode);
+  std::uniform_int_distribution<uint32_t> jitter(0, period_ms / 4);
+  auto next = clock_type::now();
+  for (uint32_t b = 0; b < bursts; b++) {
+    next += std::chrono::milliseconds(period_ms) + std::chrono::microseconds(jitter(rng) * 1000 / 7);
+    std::this_thread::sleep_until(next);
+    for (uint32_t i = 0; i < burst_size; i++) {
+      {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue.push_back(clock_type::now());
+      }
+      telemetry_wake_signal(&wake, 1); // Una publicación por paquete (telemetry_store_packet())
+    }
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(2 * poll_ms + 10));
+  done = true;
+  host_notify(&waiter);
+  consumer.join();
+  r.signals = wake.signals;
+  r.notifies = wake.notifies;
+  r.timeouts = wake.timeouts;
+  return r;
+}
+
+static double percentile(std::vector<double>& v, double p) {
+  if (v.empty()) return 0.0;
+  std::sort(v.begin(), v.end());
+  size_t i = (size_t)(p * (v.size() - 1));
+  return v[i];
+}
+
+int main(int argc, char** argv) {
+  uint32_t bursts = (argc > 1) ? (uint32_t)atoi(argv[1]) : 50;
+  uint32_t burst_size = (argc > 2) ? (uint32_t)atoi(argv[2]) : 4;
+  uint32_t period_ms = (argc > 3) ? (uint32_t)atoi(argv[3]) : 200;
+  uint32_t poll_ms = (argc > 4) ? (uint32_t)atoi(argv[4]) : 100;
+  uint32_t max_delay_ms = (argc > 5) ? (uint32_t)atoi(argv[5]) : 1000;
+  if (bursts == 0 || burst_size == 0 || period_ms == 0 || poll_ms == 0 || max_delay_ms == 0) {
+    fprintf(stderr, "uso: %s [ráfagas] [paquetes por ráfaga] [periodo ms] [sondeo ms] [espera máx ms]\n", argv[0]);
+    return 1;
+  }
+  printf("%u ráfagas de %u paquetes cada ~%u ms, sondeo de %u ms, espera máxima con avisos %u ms\n", bursts,
+         burst_size, period_ms, poll_ms, max_delay_ms);
+  printf("modo                 latencia p50   p99      máx   despertares (vacíos)  avisos/publicaciones  plazos\n");
+
+  const struct {
+    mode_t_ mode;
+    const char* name;
+  } modes[] = {
+    { MODE_POLL, "sondeo" },
+    { MODE_WAKE, "avisos" },
+    { MODE_WAKE_BATCH, "avisos, lote de 2" },
+  };
+  uint32_t total = bursts * burst_size;
+  bool ok = true;
+  for (const auto& m : modes) {
+    result_t r = run(m.mode, bursts, burst_size, period_ms, poll_ms, max_delay_ms);
+    if (r.latency_ms.size() != total) ok = false;
+    double p50 = percentile(r.latency_ms, 0.50);
+    double p99 = percentile(r.latency_ms, 0.99);
+    double max = r.latency_ms.empty() ? 0.0 : r.latency_ms.back();
+    printf("%-19s  %8.2f ms %6.2f ms %6.2f ms  %6u (%4u)  %10u/%-10u  %6u\n", m.name, p50, p99, max, r.wakeups,
+           r.empty_wakeups, r.notifies, r.signals, r.timeouts);
+  }
+  if (!ok) {
+    printf("ERROR: el consumidor no recibió todos los paquetes\n");
+    return 1;
+  }
+  return 0;
+}
@@ -7,11 +7,15 @@
  * @details
  * Proporciona la interfaz pública para la fase de adquisición de datos
  * del pipeline de telemetría. Envuelve las funciones generadoras y define
- * punto único de inicialización y ciclo periódico.
+ * punto único de inicialización y ciclo periódico. Cada paquete se
+ * comprueba contra los límites de telemetry_limits.h antes de publicarlo.
  */
 #ifndef TELEMETRY_ACQUISITION_H
 #define TELEMETRY_ACQUISITION_H
 
+#include <stdint.h>
+#include "telemetry_limits.h"
+
 /**
  * @brief Inicializa recursos necesarios para adquisición (almacenamiento, etc.)
  * 
@@ -32,4 +36,12 @@ void telemetry_acquisition_init(void);
  */
 void telemetry_acquisition_cycle(void);
 
+/**
+ * @brief Estado de los límites que evalúa el recolector (telemetry_limits.h)
+ *
+ * @param[out] events_lost Eventos que no cupieron en el buffer (puede ser NULL)
+ * @return const telemetry_limits_t* NULL con TELEM_LIMITS_ENGINE=0
+ */
+const telemetry_limits_t* telemetry_acquisition_get_limits(uint32_t* events_lost);
+
 #endif /* TELEMETRY_ACQUISITION_H */
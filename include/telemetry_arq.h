@@ -0,0 +1,238 @@
+/**
+ * @file telemetry_arq.h
+ * @brief ARQ de repetición selectiva con ventana deslizante sobre las tramas binarias
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Con TELEM_DOWNLINK_ARQ=1 cada trama de bajada lleva una secuencia de
+ * enlace (cabecera secundaria, ver telemetry_frame.h) y una copia se guarda
+ * en la ventana del emisor hasta que tierra la confirma. Tierra devuelve
+ * por la línea de subida de la misma UART tramas de acuse con:
+ * - el acuse acumulado: siguiente secuencia que espera (todas las
+ *   anteriores están recibidas)
+ * - el acuse selectivo: un mapa de las 32 siguientes, para que el emisor
+ *   solo repita los huecos
+ *
+ * Hasta TELEM_ARQ_WINDOW tramas pueden estar sin confirmar, así que el
+ * enlace no se para a esperar cada acuse como en parada y espera. La UART
+ * entrega en orden, así que en cuanto tierra confirma una trama enviada
+ * después de otra que sigue sin acuse, esa otra se ha perdido y se repite
+ * ya (también si lo perdido era una repetición). Si no llega ningún acuse
+ * posterior, la trama se repite al vencer el plazo: SRTT + 4·RTTVAR (o
+ * TELEM_ARQ_RTO_MARGIN_MS si es mayor) medidos con las tramas confirmadas
+ * al primer envío (algoritmo de Karn), hasta TELEM_ARQ_RTO_MS y doblándolo
+ * cada vez que vence sin indicio de pérdida. Tras TELEM_ARQ_MAX_TRIES envíos
+ * se abandona: el receptor lo detecta porque la siguiente secuencia queda
+ * fuera de su ventana y deja de esperarla.
+ *
+ * El receptor (telemetry_arq_rx_t, lo usa bridge/frame_decoder) guarda las
+ * tramas que llegan adelantadas y las entrega en orden, de modo que la
+ * decodificación delta ve la misma secuencia que produjo el emisor.
+ *
+ * Sin dependencias de Arduino: el transmisor le pasa el tiempo y los bytes
+ * de subida, y el mismo código corre en bridge/frame_decoder/arq_loopback.cpp.
+ */
+
+#ifndef TELEMETRY_ARQ_H
+#define TELEMETRY_ARQ_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_frame.h"
+
+/** @brief Tramas sin confirmar como máximo (potencia de dos, hasta 32: lo que cubre el acuse selectivo) */
+#ifndef TELEM_ARQ_WINDOW
+#define TELEM_ARQ_WINDOW 32
+#endif
+
+/** @brief Plazo de repetición inicial y máximo (ms) */
+#ifndef TELEM_ARQ_RTO_MS
+#define TELEM_ARQ_RTO_MS 1000
+#endif
+
+/** @brief Margen mínimo del plazo de repetición sobre SRTT (ms) */
+#ifndef TELEM_ARQ_RTO_MARGIN_MS
+#define TELEM_ARQ_RTO_MARGIN_MS 100
+#endif
+
+/** @brief Envíos de una trama (el primero incluido) antes de abandonarla */
+#ifndef TELEM_ARQ_MAX_TRIES
+#define TELEM_ARQ_MAX_TRIES 8
+#endif
+
+#if (TELEM_ARQ_WINDOW & (TELEM_ARQ_WINDOW - 1)) != 0 || TELEM_ARQ_WINDOW > 32
+#error "TELEM_ARQ_WINDOW debe ser potencia de dos y no mayor que 32"
+#endif
+
+/**
+ * @brief Copia de una trama enviada a la espera de acuse
+ */
+typedef struct {
+  uint8_t frame[TELEM_FRAME_MAX_BYTES];  /**< Trama completa, delimitadores incluidos */
+  uint16_t len;                          /**< Bytes de la trama */
+  uint8_t type;                          /**< Tipo de telemetría (para invalidar su delta si se abandona) */
+  uint8_t tries;                         /**< Envíos hechos */
+  bool acked;                            /**< Confirmada (o abandonada) */
+  uint32_t order;                        /**< Orden de su último envío entre todos los envíos */
+  uint32_t sent_ms;                      /**< Último envío */
+} telemetry_arq_slot_t;
+
+/**
+ * @brief Emisor (satélite)
+ */
+typedef struct {
+  telemetry_arq_slot_t slots[TELEM_ARQ_WINDOW];  /**< Ventana, indexada por secuencia */
+  uint16_t base;                /**< Secuencia más antigua sin confirmar */
+  uint16_t next;                /**< Secuencia de la siguiente trama nueva */
+  uint32_t rto_max_ms;          /**< Plazo de repetición inicial y máximo */
+  uint32_t rto_ms;              /**< Plazo de repetición actual */
+  uint32_t srtt_ms;             /**< Tiempo de ida y vuelta suavizado (0 = sin medidas) */
+  uint32_t rttvar_ms;           /**< Variación del tiempo de ida y vuelta */
+  uint32_t order;               /**< Envíos hechos (orden del siguiente) */
+  uint32_t acked_order;         /**< Mayor orden de envío confirmado */
+  uint8_t max_tries;            /**< Envíos antes de abandonar */
+  uint32_t abandoned_types;     /**< Bit por tipo con tramas abandonadas desde la última consulta */
+  telemetry_frame_rx_t uplink;  /**< Separador de las tramas de subida */
+  uint32_t frames_sent;         /**< Tramas nuevas */
+  uint32_t retransmissions;     /**< Repeticiones (por plazo o por acuse selectivo) */
+  uint32_t frames_acked;        /**< Tramas confirmadas */
+  uint32_t frames_abandoned;    /**< Tramas abandonadas tras max_tries envíos */
+  uint32_t acks;                /**< Acuses válidos recibidos */
+} telemetry_arq_tx_t;
+
+/**
+ * @brief Trama del receptor pendiente de entrega
+ */
+typedef struct {
+  uint8_t frame[TELEM_FRAME_MAX_BYTES];  /**< Bytes COBS sin delimitadores */
+  uint16_t len;                          /**< Bytes de la trama */
+  bool have;                             /**< Recibida y aún no entregada */
+} telemetry_arq_rx_slot_t;
+
+/**
+ * @brief Entrega en orden de una trama recibida (bytes COBS sin delimitadores)
+ */
+typedef void (*telemetry_arq_deliver_t)(const uint8_t* frame, uint16_t len, void* arg);
+
+/**
+ * @brief Receptor (tierra)
+ */
+typedef struct {
+  telemetry_arq_rx_slot_t slots[TELEM_ARQ_WINDOW];  /**< Tramas adelantadas, indexadas por secuencia */
+  uint16_t expected;            /**< Siguiente secuencia a entregar (acuse acumulado) */
+  bool synced;                  /**< Ya se ha recibido alguna trama */
+  uint32_t frames_delivered;    /**< Tramas entregadas en orden */
+  uint32_t duplicates;          /**< Repeticiones de tramas ya recibidas */
+  uint32_t out_of_order;        /**< Tramas guardadas a la espera de un hueco */
+  uint32_t skipped;             /**< Secuencias abandonadas por el emisor */
+  uint32_t resyncs;             /**< Reinicios del emisor detectados */
+} telemetry_arq_rx_t;
+
+/**
+ * @brief Inicializa el emisor con la ventana vacía
+ *
+ * @param rto_ms Plazo de repetición inicial y máximo (0 = TELEM_ARQ_RTO_MS)
+ * @param max_tries Envíos antes de abandonar (0 = TELEM_ARQ_MAX_TRIES)
+ */
+void telemetry_arq_tx_init(telemetry_arq_tx_t* tx, uint32_t rto_ms, uint8_t max_tries);
+
+/**
+ * @brief Queda sitio en la ventana para una trama nueva
+ */
+bool telemetry_arq_tx_ready(const telemetry_arq_tx_t* tx);
+
+/**
+ * @brief Tramas enviadas sin confirmar
+ */
+uint32_t telemetry_arq_tx_in_flight(const telemetry_arq_tx_t* tx);
+
+/**
+ * @brief Secuencia de enlace que llevará la siguiente trama nueva
+ */
+uint16_t telemetry_arq_tx_next_seq(const telemetry_arq_tx_t* tx);
+
+/**
+ * @brief Guarda una trama nueva, construida con telemetry_arq_tx_next_seq()
+ *
+ * @param frame Trama completa (la que se envía)
+ * @param len Bytes de la trama
+ * @param type Tipo de telemetría del paquete
+ * @param now_ms Instante del envío
+ * @return false Si la ventana está llena o la trama no cabe (no se guarda)
+ */
+bool telemetry_arq_tx_store(telemetry_arq_tx_t* tx, const uint8_t* frame, uint16_t len, uint8_t type, uint32_t now_ms);
+
+/**
+ * @brief Aplica un acuse de tierra
+ *
+ * @param cumulative Siguiente secuencia que espera tierra
+ * @param selective Bit i: tierra tiene cumulative + 1 + i
+ * @param now_ms Instante actual (para medir el tiempo de ida y vuelta)
+ */
+void telemetry_arq_tx_ack(telemetry_arq_tx_t* tx, uint16_t cumulative, uint32_t selective, uint32_t now_ms);
+
+/**
+ * @brief Entrega al emisor un byte de la línea de subida
+ *
+ * @return true Si con este byte se completó un acuse válido (ya aplicado)
+ */
+bool telemetry_arq_tx_uplink(telemetry_arq_tx_t* tx, uint8_t byte, uint32_t now_ms);
+
+/**
+ * @brief Siguiente trama que hay que repetir
+ *
+ * @details La da por reenviada en now_ms. Las que agotan sus envíos se
+ * abandonan por el camino (ver telemetry_arq_tx_take_abandoned()).
+ *
+ * @param[out] len Bytes de la trama
+ * @return const uint8_t* Trama a enviar de nuevo (NULL si no hay ninguna)
+ */
+const uint8_t* telemetry_arq_tx_due(telemetry_arq_tx_t* tx, uint32_t now_ms, uint16_t* len);
+
+/**
+ * @brief Tiempo hasta que vence el plazo de la próxima trama sin confirmar
+ *
+ * @details Para dormir hasta la siguiente repetición en lugar de consultar
+ * telemetry_arq_tx_due() periódicamente.
+ *
+ * @return uint32_t ms (0 si alguna ya ha vencido; UINT32_MAX si no hay
+ * tramas sin confirmar)
+ */
+uint32_t telemetry_arq_tx_next_due_ms(const telemetry_arq_tx_t* tx, uint32_t now_ms);
+
+/**
+ * @brief Tipos con tramas abandonadas desde la última llamada (bit = telem_data_type_t)
+ *
+ * @details Con compresión delta, el siguiente paquete de esos tipos debe
+ * ser un fotograma clave (telemetry_delta_invalidate()).
+ */
+uint32_t telemetry_arq_tx_take_abandoned(telemetry_arq_tx_t* tx);
+
+/**
+ * @brief Inicializa el receptor (la primera trama fija la secuencia inicial)
+ */
+void telemetry_arq_rx_init(telemetry_arq_rx_t* rx);
+
+/**
+ * @brief Entrega al receptor una trama ya separada
+ *
+ * @param frame Bytes COBS sin delimitadores
+ * @param len Bytes de la trama
+ * @param deliver Llamada para cada trama que queda en orden (esta y las
+ * adelantadas que desbloquea)
+ * @param arg Argumento de deliver
+ * @return int 1 = trama nueva, 0 = repetida, -1 = no es una trama de datos
+ * con secuencia de enlace (no se entrega)
+ */
+int telemetry_arq_rx_accept(telemetry_arq_rx_t* rx, const uint8_t* frame, uint16_t len,
+                            telemetry_arq_deliver_t deliver, void* arg);
+
+/**
+ * @brief Construye la trama de acuse con el estado actual del receptor
+ *
+ * @return size_t Bytes de la trama (0 si aún no se ha recibido nada)
+ */
+size_t telemetry_arq_rx_ack(const telemetry_arq_rx_t* rx, uint8_t* out, size_t capacity);
+
+#endif /* TELEMETRY_ARQ_H */
@@ -0,0 +1,142 @@
+/**
+ * @file telemetry_contact.h
+ * @brief Tabla de ventanas de contacto con la estación terrestre y presupuesto de bytes por pase
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Con TELEM_CONTACT_SCHEDULE=1 el transmisor solo baja datos dentro de una
+ * ventana (AOS..LOS). Las ventanas salen de una tabla de texto en LittleFS
+ * (TELEM_CONTACT_FILE), una por línea:
+ *
+ *     # aos_s  duracion_s  [bps]
+ *     120      45
+ *     900      60          9600
+ *
+ * con los instantes en segundos desde el arranque. Sin fichero, se usa un
+ * pase periódico (TELEM_CONTACT_FIRST_AOS_S, TELEM_CONTACT_PERIOD_S,
+ * TELEM_CONTACT_DURATION_S), útil en el banco de pruebas.
+ *
+ * El presupuesto de un pase son los bytes que el enlace puede sacar desde
+ * AOS hasta LOS menos TELEM_CONTACT_GUARD_MS, a la velocidad de la ventana
+ * (8N1, TELEM_TXBUF_BITS_PER_BYTE bits por byte).
+ *
+ * El módulo no depende de Arduino: el transmisor le pasa el tiempo actual y
+ * el contenido del fichero.
+ */
+
+#ifndef TELEMETRY_CONTACT_H
+#define TELEMETRY_CONTACT_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+
+/**
+ * @brief Transmisión por ventanas de contacto
+ *
+ * @details 0: transmisión continua (desarrollo, con el bridge conectado
+ * siempre). 1: solo durante las ventanas de la tabla y hasta agotar su
+ * presupuesto de bytes; requiere TELEM_STORAGE_PRIORITY_LANES=1 para que
+ * la telemetría de alta prioridad no espere detrás de la cola de flash.
+ *
+ * Ejemplo en platformio.ini: build_flags = -DTELEM_CONTACT_SCHEDULE=1 -DTELEM_STORAGE_PRIORITY_LANES=1
+ */
+#ifndef TELEM_CONTACT_SCHEDULE
+#define TELEM_CONTACT_SCHEDULE 0
+#endif
+
+/** @brief Fichero de LittleFS con la tabla de ventanas */
+#ifndef TELEM_CONTACT_FILE
+#define TELEM_CONTACT_FILE "/contacts.txt"
+#endif
+
+/** @brief Ventanas que admite la tabla */
+#ifndef TELEM_CONTACT_MAX_WINDOWS
+#define TELEM_CONTACT_MAX_WINDOWS 32
+#endif
+
+/** @brief Primer AOS del pase periódico por defecto (s desde el arranque) */
+#ifndef TELEM_CONTACT_FIRST_AOS_S
+#define TELEM_CONTACT_FIRST_AOS_S 60
+#endif
+
+/** @brief Periodo del pase periódico por defecto (s) */
+#ifndef TELEM_CONTACT_PERIOD_S
+#define TELEM_CONTACT_PERIOD_S 300
+#endif
+
+/** @brief Duración del pase periódico por defecto (s) */
+#ifndef TELEM_CONTACT_DURATION_S
+#define TELEM_CONTACT_DURATION_S 45
+#endif
+
+/** @brief Antelación con la que se serializa el primer lote antes de AOS (ms) */
+#ifndef TELEM_CONTACT_LEAD_MS
+#define TELEM_CONTACT_LEAD_MS 3000
+#endif
+
+/** @brief Margen antes de LOS que no se cuenta en el presupuesto (ms) */
+#ifndef TELEM_CONTACT_GUARD_MS
+#define TELEM_CONTACT_GUARD_MS 500
+#endif
+
+/**
+ * @brief Ventana de contacto
+ */
+typedef struct {
+  uint32_t aos_ms;      /**< Adquisición de señal (ms desde el arranque) */
+  uint32_t los_ms;      /**< Pérdida de señal (ms desde el arranque) */
+  uint32_t rate_bps;    /**< Velocidad del enlace en la ventana (baudios) */
+} telemetry_contact_window_t;
+
+/**
+ * @brief Vuelve al pase periódico por defecto
+ */
+void telemetry_contact_init(void);
+
+/**
+ * @brief Carga la tabla de ventanas desde su texto
+ *
+ * @param text Contenido del fichero (no hace falta que termine en '\0')
+ * @param len Bytes de text
+ * @return uint32_t Ventanas cargadas. Las líneas mal formadas, las ventanas
+ * vacías y las que se solapan con la anterior se descartan; si no queda
+ * ninguna se mantiene la tabla actual.
+ *
+ * @details La velocidad que falta o es 0 se toma de TELEM_TXBUF_BAUD. La
+ * tabla se ordena por AOS.
+ */
+uint32_t telemetry_contact_load(const char* text, uint32_t len);
+
+/**
+ * @brief Ventanas cargadas (0 = pase periódico por defecto)
+ */
+uint32_t telemetry_contact_count(void);
+
+/**
+ * @brief Ventana en curso o siguiente
+ *
+ * @param now_ms Tiempo actual (ms desde el arranque)
+ * @param[out] window Primera ventana con LOS posterior a now_ms
+ * @return false Si la tabla no tiene más ventanas
+ */
+bool telemetry_contact_next(uint32_t now_ms, telemetry_contact_window_t* window);
+
+/**
+ * @brief Bytes que el enlace saca en un intervalo
+ *
+ * @param rate_bps Velocidad de la línea
+ * @param ms Duración del intervalo
+ */
+uint32_t telemetry_contact_link_bytes(uint32_t rate_bps, uint32_t ms);
+
+/**
+ * @brief Bytes que aún caben en una ventana desde un instante
+ *
+ * @param window Ventana
+ * @param from_ms Instante (antes de AOS cuenta la ventana entera)
+ * @return uint32_t Bytes hasta LOS - TELEM_CONTACT_GUARD_MS (0 si ya ha pasado)
+ */
+uint32_t telemetry_contact_budget(const telemetry_contact_window_t* window, uint32_t from_ms);
+
+#endif /* TELEMETRY_CONTACT_H */
@@ -0,0 +1,91 @@
+/**
+ * @file telemetry_decimation.h
+ * @brief Diezmado adaptativo de la bajada según el retraso acumulado
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Con TELEM_DOWNLINK_DECIMATION=1, cuando el enlace va por detrás el
+ * transmisor no intenta bajar todo el retraso paquete a paquete: aclara los
+ * datos antiguos de los tipos de baja prioridad según una escalera que
+ * depende de cuántos paquetes más recientes quedan por detrás de cada uno
+ * (en RAM y en flash):
+ *
+ *     más recientes   < STEP          todos
+ *                     < 2·STEP        uno de cada 2
+ *                     < 4·STEP        uno de cada 4
+ *                     ...             hasta uno de cada 2^TELEM_DECIMATION_MAX_LEVEL
+ *
+ * Los TELEM_DECIMATION_STEP paquetes más recientes no se aclaran nunca, así
+ * que la última muestra de cada tipo siempre baja, y los de prioridad mayor
+ * que TELEM_DECIMATION_MAX_PRIORITY (potencia) tampoco. Los escalones son
+ * potencias de dos y la fase es por tipo, así que al bajar de nivel se
+ * conservan las muestras que ya conservaba el nivel superior.
+ *
+ * Los paquetes descartados se confirman como enviados: el enlace recupera
+ * su ritmo y el buffer deja sitio a los nuevos en lugar de perderlos por
+ * desbordamiento. bridge/frame_decoder/decimation_sim.cpp mide el efecto
+ * sobre la frescura de los datos en tierra y el uso del enlace.
+ *
+ * El módulo no depende de Arduino.
+ */
+
+#ifndef TELEMETRY_DECIMATION_H
+#define TELEMETRY_DECIMATION_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_types.h"
+
+/** @brief 1 = aclarar el retraso antiguo de los tipos de baja prioridad */
+#ifndef TELEM_DOWNLINK_DECIMATION
+#define TELEM_DOWNLINK_DECIMATION 0
+#endif
+
+/** @brief Paquetes más recientes por escalón de la escalera (los STEP últimos no se aclaran) */
+#ifndef TELEM_DECIMATION_STEP
+#define TELEM_DECIMATION_STEP 64
+#endif
+
+/** @brief Último escalón: uno de cada 2^MAX_LEVEL paquetes */
+#ifndef TELEM_DECIMATION_MAX_LEVEL
+#define TELEM_DECIMATION_MAX_LEVEL 3
+#endif
+
+/** @brief Prioridad máxima que se aclara (telem_priority_t) */
+#ifndef TELEM_DECIMATION_MAX_PRIORITY
+#define TELEM_DECIMATION_MAX_PRIORITY TELEM_PRIORITY_NORMAL
+#endif
+
+/**
+ * @brief Estado del diezmado
+ */
+typedef struct {
+  uint32_t phase[TELEM_DATA_TYPE_COUNT];    /**< Paquetes aclarables vistos de cada tipo */
+  uint32_t dropped[TELEM_DATA_TYPE_COUNT];  /**< Paquetes descartados de cada tipo */
+  uint32_t dropped_total;                   /**< Paquetes descartados en total */
+} telemetry_decimation_t;
+
+/**
+ * @brief Inicializa el estado (sin descartes)
+ */
+void telemetry_decimation_init(telemetry_decimation_t* dec);
+
+/**
+ * @brief Escalón de la escalera para un paquete
+ *
+ * @param newer Paquetes más recientes que él pendientes de bajar
+ * @return uint8_t 0 = se envía; n = se envía uno de cada 2^n
+ */
+uint8_t telemetry_decimation_level(uint32_t newer);
+
+/**
+ * @brief Decide si un paquete se envía
+ *
+ * @param header Encabezado del paquete
+ * @param newer Paquetes más recientes que él pendientes de bajar
+ * @return false Si se descarta (queda contado en el estado)
+ */
+bool telemetry_decimation_keep(telemetry_decimation_t* dec, const telem_header_t* header, uint32_t newer);
+
+#endif /* TELEMETRY_DECIMATION_H */
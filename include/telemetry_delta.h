@@ -0,0 +1,103 @@
+/**
+ * @file telemetry_delta.h
+ * @brief Compresión delta por tipo con varints zigzag y fotogramas clave
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Dos paquetes seguidos del mismo tipo se parecen mucho: timestamp y uptimes
+ * crecen de forma monótona y voltajes y temperaturas apenas cambian. El
+ * codificador guarda el último paquete de cada tipo y envía solo la
+ * diferencia, campo a campo según telemetry_schema.h:
+ * - Enteros: diferencia con el anterior (módulo su anchura) en varint zigzag
+ * - F32: con TELEM_DELTA_FLOAT_QUANTIZED=1 (por defecto) se cuantifica a los
+ *   decimales del esquema (los mismos que muestran el JSON y el log) y se
+ *   codifica la diferencia de enteros; con 0, XOR de los bits en varint
+ *   (sin pérdidas pero menos compacto)
+ *
+ * Cada TELEM_DELTA_KEYFRAME_INTERVAL paquetes de un tipo, o si el
+ * decodificador no tiene referencia, se envía un fotograma clave completo:
+ * una pérdida nunca se propaga más allá del siguiente.
+ *
+ * Formato: byte 0 = bit 7 clave | bits 6-5 prioridad | bits 4-0 tipo.
+ * - Clave: timestamp(4) secuencia(2) y los campos en little-endian, como
+ *   telemetry_schema_encode() sin su byte de tipo
+ * - Delta: varint zigzag del timestamp y de la secuencia, y un varint por
+ *   elemento de cada campo
+ *
+ * Sin dependencias de Arduino: se usa en la bajada, en la cola de flash y en
+ * el host.
+ */
+
+#ifndef TELEMETRY_DELTA_H
+#define TELEMETRY_DELTA_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_types.h"
+
+/** @brief Paquetes de un mismo tipo entre dos fotogramas clave */
+#ifndef TELEM_DELTA_KEYFRAME_INTERVAL
+#define TELEM_DELTA_KEYFRAME_INTERVAL 16
+#endif
+
+/** @brief 1 = floats cuantificados a los decimales del esquema; 0 = XOR sin pérdidas */
+#ifndef TELEM_DELTA_FLOAT_QUANTIZED
+#define TELEM_DELTA_FLOAT_QUANTIZED 1
+#endif
+
+/** @brief Bytes máximos de un paquete codificado (caso peor: todos los varints a tamaño máximo) */
+#define TELEM_DELTA_MAX_BYTES (1 + 2 * sizeof(telemetry_packet_t))
+
+/** @brief Bit de fotograma clave en el primer byte */
+#define TELEM_DELTA_KEYFRAME 0x80
+
+/**
+ * @brief Estado de un codificador o decodificador (uno por flujo)
+ */
+typedef struct {
+  telemetry_packet_t last[TELEM_DATA_TYPE_COUNT]; /**< Referencia de cada tipo (tal como la reconstruye el decodificador) */
+  uint16_t since_keyframe[TELEM_DATA_TYPE_COUNT]; /**< Paquetes desde el último fotograma clave */
+  bool valid[TELEM_DATA_TYPE_COUNT];              /**< Hay referencia para ese tipo */
+  uint16_t keyframe_interval;                     /**< Paquetes entre fotogramas clave */
+} telemetry_delta_ctx_t;
+
+/**
+ * @brief Inicializa un contexto sin referencias (el siguiente paquete de cada tipo será clave)
+ *
+ * @param ctx Contexto
+ * @param keyframe_interval Paquetes entre fotogramas clave (0 = TELEM_DELTA_KEYFRAME_INTERVAL)
+ */
+void telemetry_delta_init(telemetry_delta_ctx_t* ctx, uint16_t keyframe_interval);
+
+/**
+ * @brief Descarta la referencia de un tipo (p. ej. al detectar una pérdida)
+ */
+void telemetry_delta_invalidate(telemetry_delta_ctx_t* ctx, telem_data_type_t type);
+
+/**
+ * @brief Codifica un paquete respecto al anterior de su tipo
+ *
+ * @param ctx Contexto del codificador
+ * @param packet Paquete
+ * @param[out] out Buffer destino (TELEM_DELTA_MAX_BYTES basta siempre)
+ * @param capacity Tamaño de out
+ * @return uint32_t Bytes escritos (0 si el tipo no existe o no cabe)
+ */
+uint32_t telemetry_delta_encode(telemetry_delta_ctx_t* ctx, const telemetry_packet_t* packet,
+                                uint8_t* out, uint32_t capacity);
+
+/**
+ * @brief Decodifica un paquete generado por telemetry_delta_encode()
+ *
+ * @param ctx Contexto del decodificador
+ * @param in Bytes codificados
+ * @param len Bytes disponibles
+ * @param[out] packet Paquete reconstruido
+ * @return uint32_t Bytes consumidos (0 si los datos no son válidos o es un
+ * delta sin referencia: hay que esperar al siguiente fotograma clave)
+ */
+uint32_t telemetry_delta_decode(telemetry_delta_ctx_t* ctx, const uint8_t* in, uint32_t len,
+                                telemetry_packet_t* packet);
+
+#endif /* TELEMETRY_DELTA_H */
@@ -0,0 +1,222 @@
+/**
+ * @file telemetry_frame.h
+ * @brief Formato binario de bajada: paquete CCSDS, CRC-16 y entramado COBS
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Alternativa compacta al JSON por UART. Cada paquete de telemetría se envía
+ * como una trama:
+ *
+ *   0x00 | COBS( cabecera primaria CCSDS | datos | CRC-16 ) | 0x00
+ *
+ * - Cabecera primaria CCSDS (6 bytes, big-endian como en el estándar):
+ *   versión 0, tipo telemetría, sin cabecera secundaria, APID =
+ *   TELEM_FRAME_APID_BASE + telem_data_type_t, paquete no segmentado,
+ *   contador de secuencia de 14 bits por APID y longitud de datos - 1.
+ * - Datos: codificación binaria little-endian de telemetry_schema_encode(),
+ *   o con telemetry_frame_encode_delta() la diferencia respecto al paquete
+ *   anterior del mismo tipo (telemetry_delta.h) en el APID
+ *   TELEM_FRAME_APID_DELTA_BASE + tipo.
+ * - CRC-16/CCITT (polinomio 0x1021, valor inicial 0xFFFF) sobre cabecera y
+ *   datos, big-endian (Packet Error Control de CCSDS).
+ * - COBS elimina los 0x00 del contenido, de modo que 0x00 delimita tramas
+ *   sin ambigüedad. El delimitador inicial permite resincronizar cuando el
+ *   mismo puerto lleva también texto de log: lo recibido entre tramas se
+ *   descarta al no superar el CRC.
+ *
+ * En los APID delta el contador de secuencia permite al receptor detectar
+ * tramas perdidas: ante un salto descarta la referencia de ese tipo y
+ * espera al siguiente fotograma clave en lugar de reconstruir valores
+ * erróneos.
+ *
+ * Con ARQ (telemetry_arq.h) cada trama lleva además cabecera secundaria:
+ * la secuencia de enlace de 16 bits, común a todos los APID. Tierra
+ * responde con tramas de acuse (tipo TC, APID TELEM_FRAME_APID_ACK) con el
+ * acuse acumulado (siguiente secuencia esperada) y un mapa de 32 bits de
+ * las tramas recibidas a continuación (bit i = cumulative + 1 + i).
+ *
+ * El módulo no depende de Arduino: el decodificador se compila también en el
+ * host (ver bridge/frame_decoder).
+ */
+
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+  #include <stdbool.h>
+  #include <stddef.h>
+  #include <stdint.h>
+  #include "telemetry_types.h"
+  #include "telemetry_delta.h"
+
+/** @brief APID del primer tipo de telemetría (se suma telem_data_type_t) */
+#define TELEM_FRAME_APID_BASE 0x100
+
+/** @brief APID del primer tipo con codificación delta */
+#define TELEM_FRAME_APID_DELTA_BASE 0x180
+
+/** @brief APID de las tramas de acuse de tierra (ARQ) */
+#define TELEM_FRAME_APID_ACK 0x7F0
+
+/** @brief Bytes de la cabecera primaria CCSDS */
+#define TELEM_FRAME_HEADER_BYTES 6
+
+/** @brief Bytes de la cabecera secundaria (secuencia de enlace ARQ) */
+#define TELEM_FRAME_SECONDARY_BYTES 2
+
+/** @brief Bytes de datos de una trama de acuse: acumulado (16 bits) y selectivo (32 bits) */
+#define TELEM_FRAME_ACK_BYTES 6
+
+/** @brief Bit de tipo telecomando (subida) en la primera palabra de la cabecera */
+#define TELEM_FRAME_FLAG_TC 0x1000
+
+/** @brief Bit de cabecera secundaria presente en la primera palabra de la cabecera */
+#define TELEM_FRAME_FLAG_SECONDARY 0x0800
+
+/** @brief Bytes del CRC-16 final */
+#define TELEM_FRAME_CRC_BYTES 2
+
+/** @brief Bytes máximos de datos (el caso peor de la codificación delta supera al de esquema) */
+#define TELEM_FRAME_MAX_DATA TELEM_DELTA_MAX_BYTES
+
+/** @brief Bytes máximos sin entramar: cabeceras, datos y CRC */
+#define TELEM_FRAME_MAX_RAW (TELEM_FRAME_HEADER_BYTES + TELEM_FRAME_SECONDARY_BYTES + TELEM_FRAME_MAX_DATA + TELEM_FRAME_CRC_BYTES)
+
+/** @brief Bytes máximos de una trama completa (COBS añade 1 byte cada 254, más los delimitadores) */
+#define TELEM_FRAME_MAX_BYTES (TELEM_FRAME_MAX_RAW + TELEM_FRAME_MAX_RAW / 254 + 1 + 2)
+
+/**
+ * @brief Estado del receptor de tramas (decodificación byte a byte)
+ */
+typedef struct {
+  uint8_t buf[TELEM_FRAME_MAX_BYTES];  /**< Trama COBS en curso (sin delimitadores) */
+  uint16_t len;                        /**< Bytes acumulados */
+  bool overflow;                       /**< La trama en curso excede el máximo: se descartará */
+  bool complete;                       /**< buf contiene una trama cerrada (se vacía con el siguiente byte) */
+  uint32_t frames_ok;                  /**< Tramas válidas recibidas */
+  uint32_t frames_bad;                 /**< Tramas descartadas (COBS, longitud, CRC o tipo; incluye el texto de log entre tramas) */
+  telemetry_delta_ctx_t* delta;        /**< Decodificador de los APID delta (NULL = se descartan) */
+  uint16_t delta_next_seq[TELEM_DATA_TYPE_COUNT]; /**< Contador CCSDS esperado en cada APID delta */
+  uint32_t frames_unsynced;            /**< Tramas delta válidas sin referencia (a la espera de un fotograma clave) */
+} telemetry_frame_rx_t;
+
+/**
+ * @brief Calcula el CRC-16/CCITT (0x1021, inicial 0xFFFF, sin reflejar)
+ */
+uint16_t telemetry_crc16(const uint8_t* data, size_t len);
+
+/**
+ * @brief Construye la trama completa de un paquete
+ *
+ * @param packet Paquete a enviar
+ * @param seq_count Contador de secuencia CCSDS (se usan 14 bits)
+ * @param[out] out Buffer destino (TELEM_FRAME_MAX_BYTES basta siempre)
+ * @param capacity Tamaño de out
+ * @return size_t Bytes de la trama, delimitadores incluidos (0 si el tipo no existe o no cabe)
+ */
+size_t telemetry_frame_encode(const telemetry_packet_t* packet, uint16_t seq_count, uint8_t* out, size_t capacity);
+
+/**
+ * @brief Construye la trama de un paquete codificado como delta del anterior de su tipo
+ *
+ * @param ctx Codificador delta del enlace (decide cuándo enviar un fotograma clave)
+ * @param packet Paquete a enviar
+ * @param seq_count Contador de secuencia CCSDS de su APID delta (debe avanzar de uno en uno)
+ * @param[out] out Buffer destino (TELEM_FRAME_MAX_BYTES basta siempre)
+ * @param capacity Tamaño de out
+ * @return size_t Bytes de la trama, delimitadores incluidos (0 si el tipo no existe o no cabe)
+ */
+size_t telemetry_frame_encode_delta(telemetry_delta_ctx_t* ctx, const telemetry_packet_t* packet,
+                                    uint16_t seq_count, uint8_t* out, size_t capacity);
+
+/**
+ * @brief Construye la trama de un paquete con secuencia de enlace ARQ
+ *
+ * @param ctx Codificador delta (NULL = codificación de esquema, APID normal)
+ * @param packet Paquete a enviar
+ * @param seq_count Contador de secuencia CCSDS de su APID
+ * @param link_seq Secuencia de enlace (cabecera secundaria)
+ * @param[out] out Buffer destino (TELEM_FRAME_MAX_BYTES basta siempre)
+ * @param capacity Tamaño de out
+ * @return size_t Bytes de la trama, delimitadores incluidos (0 si el tipo no existe o no cabe)
+ */
+size_t telemetry_frame_encode_link(telemetry_delta_ctx_t* ctx, const telemetry_packet_t* packet,
+                                   uint16_t seq_count, uint16_t link_seq, uint8_t* out, size_t capacity);
+
+/**
+ * @brief Construye una trama de acuse (de tierra al satélite)
+ *
+ * @param cumulative Siguiente secuencia de enlace esperada (todas las anteriores recibidas)
+ * @param selective Bit i: recibida la trama cumulative + 1 + i
+ * @return size_t Bytes de la trama, delimitadores incluidos (0 si no cabe)
+ */
+size_t telemetry_frame_encode_ack(uint16_t cumulative, uint32_t selective, uint8_t* out, size_t capacity);
+
+/**
+ * @brief Decodifica una trama de acuse ya separada (bytes COBS sin delimitadores)
+ *
+ * @return true Si es un acuse válido
+ */
+bool telemetry_frame_decode_ack(const uint8_t* frame, size_t len, uint16_t* cumulative, uint32_t* selective);
+
+/**
+ * @brief Secuencia de enlace de una trama de datos ya separada
+ *
+ * @return int32_t Secuencia (0..65535); -1 si la trama no es válida, es un
+ * acuse o no lleva cabecera secundaria
+ */
+int32_t telemetry_frame_link_seq(const uint8_t* frame, size_t len);
+
+/**
+ * @brief Decodifica una trama ya separada (bytes COBS sin delimitadores)
+ *
+ * @param frame Bytes COBS
+ * @param len Número de bytes
+ * @param[out] packet Paquete reconstruido
+ * @param[out] seq_count Contador de secuencia CCSDS (puede ser NULL)
+ * @return true Si la trama es válida (las tramas delta necesitan un receptor: devuelven false)
+ */
+bool telemetry_frame_decode(const uint8_t* frame, size_t len, telemetry_packet_t* packet, uint16_t* seq_count);
+
+/**
+ * @brief Inicializa un receptor de tramas
+ *
+ * @details Para aceptar tramas delta se asigna después rx->delta a un
+ * contexto inicializado con telemetry_delta_init().
+ */
+void telemetry_frame_rx_init(telemetry_frame_rx_t* rx);
+
+/**
+ * @brief Separa tramas sin decodificarlas
+ *
+ * @param rx Receptor
+ * @param byte Byte recibido
+ * @return true Si con este byte se cerró una trama: está en rx->buf
+ * (rx->len bytes COBS) hasta el siguiente byte
+ */
+bool telemetry_frame_split(telemetry_frame_rx_t* rx, uint8_t byte);
+
+/**
+ * @brief Decodifica en el receptor una trama ya separada, delta incluidas
+ *
+ * @details Actualiza los contadores del receptor igual que
+ * telemetry_frame_rx_push(). Las tramas delta deben llegar en orden (con
+ * ARQ, tal como las entrega telemetry_arq_rx_pop()).
+ *
+ * @return true Si la trama contiene un paquete válido
+ */
+bool telemetry_frame_rx_decode(telemetry_frame_rx_t* rx, const uint8_t* frame, size_t len,
+                               telemetry_packet_t* packet, uint16_t* seq_count);
+
+/**
+ * @brief Entrega un byte recibido al receptor
+ *
+ * @param rx Receptor
+ * @param byte Byte recibido
+ * @param[out] packet Paquete completado, si lo hay
+ * @param[out] seq_count Contador de secuencia del paquete (puede ser NULL)
+ * @return true Si con este byte se completó una trama válida
+ */
+bool telemetry_frame_rx_push(telemetry_frame_rx_t* rx, uint8_t byte, telemetry_packet_t* packet, uint16_t* seq_count);
+
+#endif /* TELEMETRY_FRAME_H */
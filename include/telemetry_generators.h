@@ -12,6 +12,8 @@
 #ifndef TELEMETRY_GENERATORS_H
 #define TELEMETRY_GENERATORS_H
 
+#include "telemetry_types.h"
+
 /**
  * @brief Genera datos de telemetría del estado del sistema
  * 
@@ -78,4 +80,32 @@ void generate_temperature_telemetry(void);
  */
 void generate_subsystem_telemetry(void);
 
+/**
+ * @brief Prioridad asignada a cada tipo de telemetría
+ *
+ * @param type Tipo de dato
+ * @return uint8_t Prioridad (telem_priority_t) para telem_header_t.priority
+ *
+ * @details Única fuente de la prioridad por tipo: la usan tanto los
+ * generadores al rellenar la cabecera como la adquisición al reservar slots
+ * en la vía correspondiente.
+ */
+uint8_t telemetry_type_priority(telem_data_type_t type);
+
+/**
+ * @brief Rellenan un paquete con la telemetría correspondiente sin almacenarlo
+ *
+ * @param[out] packet Paquete destino (cabecera incluida)
+ *
+ * @details Variantes de las funciones generate_*() que permiten construir
+ * los paquetes directamente en slots reservados con telemetry_reserve_slots(),
+ * o en un array local para telemetry_store_batch().
+ */
+void fill_system_telemetry(telemetry_packet_t* packet);
+void fill_power_telemetry(telemetry_packet_t* packet);
+void fill_temperature_telemetry(telemetry_packet_t* packet);
+void fill_subsystem_telemetry(telemetry_packet_t* packet);
+void fill_storage_metrics_telemetry(telemetry_packet_t* packet);
+void fill_latency_telemetry(telemetry_packet_t* packet);
+
 #endif /* TELEMETRY_GENERATORS_H */
\ No newline at end of file
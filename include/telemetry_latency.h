@@ -0,0 +1,110 @@
+/**
+ * @file telemetry_latency.h
+ * @brief Trazado de latencia por paquete a lo largo de las etapas del pipeline
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Cada paquete lleva en su cabecera dos sellos en microsegundos
+ * (telem_header_t.acquired_us y enqueued_us) que pone telemetry_storage al
+ * reservar el slot y al publicarlo. Los consumidores miden al sacar el
+ * paquete y al terminar de enviarlo, y cada diferencia se acumula en un
+ * histograma por etapa y tipo:
+ *
+ * | Etapa                         | Desde       | Hasta                         |
+ * |-------------------------------|-------------|-------------------------------|
+ * | TELEM_LATENCY_ACQUIRE         | reserva     | publicación en el buffer      |
+ * | TELEM_LATENCY_PROCESSOR_QUEUE | publicación | telemetry_processing_handle_batch() |
+ * | TELEM_LATENCY_TRANSMIT_QUEUE  | publicación | lectura del transmisor (RAM o flash) |
+ * | TELEM_LATENCY_TRANSMIT        | lectura del transmisor | fin de send_packet() |
+ * | TELEM_LATENCY_END_TO_END      | reserva     | fin de send_packet()          |
+ *
+ * Los histogramas son logarítmicos con dos intervalos por octava (64
+ * intervalos cubren todo uint32_t); p50 y p99 se interpolan dentro del
+ * intervalo. Cada etapa la registra una sola tarea, así que basta con
+ * incrementos atómicos relajados.
+ *
+ * Los sellos son los 32 bits bajos de esp_timer_get_time(): esperas de más
+ * de ~71 minutos (paquetes que pasan mucho tiempo en la cola de flash) se
+ * registran módulo 2^32 µs, y los recuperados de flash tras un reinicio no
+ * tienen una referencia de tiempo válida. La codificación delta de la cola
+ * de flash (TELEM_SPILL_DELTA) no guarda los sellos: esos paquetes llegan
+ * con acquired_us = enqueued_us = 0 y solo cuentan en TELEM_LATENCY_TRANSMIT.
+ */
+
+#ifndef TELEMETRY_LATENCY_H
+#define TELEMETRY_LATENCY_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_types.h"
+
+/** @brief 1 = registrar latencias (los sellos de la cabecera se ponen siempre) */
+#ifndef TELEM_LATENCY_TRACE
+#define TELEM_LATENCY_TRACE 1
+#endif
+
+/** @brief Intervalos de cada histograma (dos por octava) */
+#define TELEM_LATENCY_BUCKETS 64
+
+/** @brief Índice de tipo para los resúmenes agregados de todos los tipos */
+#define TELEM_LATENCY_ALL_TYPES TELEM_DATA_TYPE_COUNT
+
+/** @brief Etapas medidas (ver tabla en @details) */
+typedef enum {
+  TELEM_LATENCY_ACQUIRE = 0,
+  TELEM_LATENCY_PROCESSOR_QUEUE,
+  TELEM_LATENCY_TRANSMIT_QUEUE,
+  TELEM_LATENCY_TRANSMIT,
+  TELEM_LATENCY_END_TO_END,
+  TELEM_LATENCY_STAGE_COUNT
+} telem_latency_stage_t;
+
+/**
+ * @brief Resumen de un histograma
+ */
+typedef struct {
+  uint32_t samples;   /**< Muestras registradas */
+  uint32_t p50_us;    /**< Mediana (µs) */
+  uint32_t p99_us;    /**< Percentil 99 (µs) */
+  uint32_t max_us;    /**< Máximo exacto (µs) */
+} telemetry_latency_summary_t;
+
+/**
+ * @brief Instante actual para los sellos de latencia (µs, 32 bits bajos)
+ */
+uint32_t telemetry_latency_now(void);
+
+/**
+ * @brief Registra una muestra
+ *
+ * @param stage Etapa
+ * @param type Tipo del paquete
+ * @param elapsed_us Duración de la etapa (µs)
+ */
+void telemetry_latency_record(telem_latency_stage_t stage, telem_data_type_t type, uint32_t elapsed_us);
+
+/**
+ * @brief Calcula p50/p99/max de una etapa
+ *
+ * @param stage Etapa
+ * @param type Tipo, o TELEM_LATENCY_ALL_TYPES para todos juntos
+ * @param[out] summary Resultado (todo a cero si no hay muestras)
+ */
+void telemetry_latency_summary(telem_latency_stage_t stage, uint32_t type, telemetry_latency_summary_t* summary);
+
+/**
+ * @brief Vuelca por el log una tabla con todas las etapas, total y por tipo
+ */
+void telemetry_latency_dump(void);
+
+/**
+ * @brief Rellena los datos de un paquete TELEM_LATENCY_METRICS
+ *
+ * @details Cada llamada informa de la etapa siguiente a la anterior, de
+ * modo que los paquetes periódicos recorren todas las etapas. La cabecera
+ * la rellena el generador.
+ */
+void telemetry_latency_fill_packet(telemetry_packet_t* packet);
+
+#endif /* TELEMETRY_LATENCY_H */
@@ -0,0 +1,143 @@
+/**
+ * @file telemetry_limits.h
+ * @brief Comprobación de límites por tabla con eventos de cambio de estado
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * TELEM_LIMITS_TABLE enumera, una línea por campo vigilado, el tipo de
+ * paquete, el miembro de su estructura y los umbrales en unidades físicas
+ * (las temperaturas en °C aunque el miembro vaya en décimas):
+ *
+ *     rojo bajo < amarillo bajo < nominal < amarillo alto < rojo alto
+ *
+ * El miembro se comprueba en compilación con offsetof, así que un límite
+ * no puede quedar apuntando a un campo que ya no existe; al iniciar se
+ * asocia con su campo del esquema (tipo y decimales) y se encadena con los
+ * demás límites de su tipo.
+ *
+ * El recolector evalúa cada paquete antes de publicarlo: solo recorre los
+ * límites de su tipo (O(campos vigilados)) y no reserva memoria. Para
+ * evitar avisos por ruido:
+ * - histéresis: para volver hacia nominal el valor debe rebasar el umbral
+ *   en hysteresis unidades
+ * - persistencia: el estado nuevo debe repetirse en persistence paquetes
+ *   seguidos antes de aceptarse
+ *
+ * Cada cambio de estado aceptado produce un paquete TELEM_LIMIT_EVENT de
+ * prioridad alta con el valor y el umbral cruzado.
+ *
+ * El módulo no depende de Arduino.
+ */
+
+#ifndef TELEMETRY_LIMITS_H
+#define TELEMETRY_LIMITS_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_types.h"
+
+/** @brief 1 = el recolector evalúa los límites y publica los eventos */
+#ifndef TELEM_LIMITS_ENGINE
+#define TELEM_LIMITS_ENGINE 1
+#endif
+
+/** @brief Umbral desactivado (sin límite por ese lado) */
+#define TELEM_LIMIT_NONE 1.0e30f
+
+/**
+ * @brief Límites vigilados
+ *
+ * @details X(tipo, estructura, miembro, rojo bajo, amarillo bajo, amarillo
+ * alto, rojo alto, histéresis, persistencia). Los umbrales bajos de un lado
+ * sin límite son -TELEM_LIMIT_NONE y los altos TELEM_LIMIT_NONE. Puede
+ * sustituirse definiendo TELEM_LIMITS_TABLE antes de incluir este fichero.
+ */
+#ifndef TELEM_LIMITS_TABLE
+#define TELEM_LIMITS_TABLE(X) \
+  X(TELEM_POWER_DATA,       power_telem_t,         battery_voltage,      3.0f,   3.2f,   4.2f,  4.3f,  0.05f, 3) \
+  X(TELEM_POWER_DATA,       power_telem_t,         battery_level,        10.0f,  20.0f,  TELEM_LIMIT_NONE, TELEM_LIMIT_NONE, 2.0f, 2) \
+  X(TELEM_POWER_DATA,       power_telem_t,         battery_temperature,  -5.0f,  0.0f,   45.0f, 55.0f, 2.0f,  3) \
+  X(TELEM_TEMPERATURE_DATA, temperature_telem_t,   obc_temperature,      -25.0f, -15.0f, 70.0f, 85.0f, 2.0f,  3) \
+  X(TELEM_TEMPERATURE_DATA, temperature_telem_t,   comms_temperature,    -25.0f, -15.0f, 60.0f, 75.0f, 2.0f,  3) \
+  X(TELEM_TEMPERATURE_DATA, temperature_telem_t,   payload_temperature,  -20.0f, -10.0f, 45.0f, 55.0f, 2.0f,  3) \
+  X(TELEM_TEMPERATURE_DATA, temperature_telem_t,   battery_temperature,  -5.0f,  0.0f,   45.0f, 55.0f, 2.0f,  3) \
+  X(TELEM_TEMPERATURE_DATA, temperature_telem_t,   external_temperature, -100.0f, -80.0f, 90.0f, 110.0f, 5.0f, 3) \
+  X(TELEM_SYSTEM_STATUS,    system_status_telem_t, cpu_temperature,      -TELEM_LIMIT_NONE, -TELEM_LIMIT_NONE, 75.0f, 90.0f, 3.0f, 3)
+#endif
+
+/**
+ * @brief Estado de un límite (el orden de gravedad es nominal < amarillo < rojo)
+ */
+typedef enum {
+  TELEM_LIMIT_NOMINAL = 0,
+  TELEM_LIMIT_YELLOW_LOW,
+  TELEM_LIMIT_YELLOW_HIGH,
+  TELEM_LIMIT_RED_LOW,
+  TELEM_LIMIT_RED_HIGH
+} telem_limit_state_t;
+
+/** @brief Entradas de TELEM_LIMITS_TABLE */
+#define TELEM_LIMITS_ENTRY_COUNT(t, st, m, rl, yl, yh, rh, h, p) + 1
+#define TELEM_LIMIT_COUNT (0 TELEM_LIMITS_TABLE(TELEM_LIMITS_ENTRY_COUNT))
+
+/** @brief Sin siguiente límite en la cadena de un tipo */
+#define TELEM_LIMIT_END 0xFF
+
+/**
+ * @brief Estado de un límite en el motor
+ */
+typedef struct {
+  uint8_t field;      /**< Índice en el esquema (TELEM_LIMIT_END = sin resolver) */
+  uint8_t kind;       /**< telem_field_kind_t del campo */
+  uint8_t decimals;   /**< Decimales del campo */
+  uint8_t next;       /**< Siguiente límite del mismo tipo */
+  uint8_t state;      /**< telem_limit_state_t aceptado */
+  uint8_t pending;    /**< Estado candidato */
+  uint8_t count;      /**< Paquetes seguidos en el estado candidato */
+} telemetry_limit_slot_t;
+
+/**
+ * @brief Motor de límites
+ */
+typedef struct {
+  telemetry_limit_slot_t slots[TELEM_LIMIT_COUNT];
+  uint8_t first[TELEM_DATA_TYPE_COUNT];   /**< Primer límite de cada tipo */
+  uint16_t sequence;                      /**< Secuencia de los eventos */
+  uint32_t packets;                       /**< Paquetes evaluados */
+  uint32_t checks;                        /**< Límites evaluados */
+  uint32_t events;                        /**< Eventos generados */
+  uint32_t unresolved;                    /**< Límites sin campo en el esquema (desactivados) */
+} telemetry_limits_t;
+
+/**
+ * @brief Inicializa el motor con todos los límites en nominal
+ *
+ * @return uint32_t Límites que no corresponden a ningún campo del esquema
+ */
+uint32_t telemetry_limits_init(telemetry_limits_t* limits);
+
+/**
+ * @brief Evalúa los límites del tipo de un paquete
+ *
+ * @param packet Paquete (lleno, antes o después de publicarlo)
+ * @param[out] events Eventos generados (paquetes TELEM_LIMIT_EVENT completos)
+ * @param capacity Eventos que caben en events
+ * @return uint32_t Eventos escritos (los que no caben se pierden, pero el estado cambia igual)
+ */
+uint32_t telemetry_limits_evaluate(telemetry_limits_t* limits, const telemetry_packet_t* packet,
+                                   telemetry_packet_t* events, uint32_t capacity);
+
+/**
+ * @brief Estado aceptado de un límite
+ *
+ * @param index Índice en TELEM_LIMITS_TABLE
+ */
+telem_limit_state_t telemetry_limits_state(const telemetry_limits_t* limits, uint32_t index);
+
+/**
+ * @brief Nombre corto de un estado ("NOMINAL", "YELLOW_LOW", ...)
+ */
+const char* telemetry_limit_state_name(uint8_t state);
+
+#endif /* TELEMETRY_LIMITS_H */
@@ -41,6 +41,8 @@ bool telemetry_logger_init(void);
  * @details Escribe una línea formateada tanto en el Serial 
  * como en el archivo de log. Esto permite mantener un registro 
  * persistente de los eventos y datos de telemetría para su posterior análisis.
+ * La línea se publica en los sinks de telemetry_sink.h: la escriben sus
+ * tareas, no la que llama.
  */
 void telemetry_logf(const char *fmt, ...);
 
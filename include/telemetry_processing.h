@@ -14,6 +14,49 @@
 
 #include <stdbool.h>
 #include "telemetry_types.h"
+#include "telemetry_wake.h"
+#include "telemetry_stats.h"
+
+/**
+ * @brief Paquetes que el procesador atiende como máximo en cada despertar
+ *
+ * @details 1 reproduce el procesado de un paquete por llamada.
+ */
+#ifndef TELEM_PROC_BATCH
+#define TELEM_PROC_BATCH 16
+#endif
+
+/** @brief Paquetes nuevos que despiertan al procesador */
+#ifndef TELEM_PROC_WAKE_MIN_BATCH
+#define TELEM_PROC_WAKE_MIN_BATCH 1
+#endif
+
+/**
+ * @brief Espera máxima del procesador sin paquetes nuevos
+ *
+ * @details Solo red de seguridad: el procesador no tiene trabajo periódico.
+ */
+#ifndef TELEM_PROC_WAKE_MAX_DELAY_MS
+#define TELEM_PROC_WAKE_MAX_DELAY_MS 10000
+#endif
+
+/**
+ * @brief Coste del procesado medido en ciclos de CPU
+ *
+ * @details Los lotes de un solo paquete cuestan lo mismo que el procesado
+ * paquete a paquete; compararlos con el total da la ganancia del lote.
+ */
+typedef struct {
+  uint32_t batches;          /**< Lotes con algún paquete */
+  uint32_t packets;          /**< Paquetes procesados */
+  uint64_t cycles;           /**< Ciclos de todos los lotes */
+  uint32_t single_batches;   /**< Lotes de un solo paquete */
+  uint64_t single_cycles;    /**< Ciclos de los lotes de un solo paquete */
+  uint32_t max_batch;        /**< Mayor lote */
+  uint32_t last_packets;     /**< Paquetes del último lote */
+  uint32_t last_cycles;      /**< Ciclos del último lote */
+  uint32_t discarded;        /**< Paquetes desalojados mientras se leían (TELEM_STORAGE_LOCKFREE), sin procesar */
+} telemetry_processing_cost_t;
 
 /**
  * @brief Inicializa el módulo de procesamiento de telemetría
@@ -28,12 +71,51 @@ void telemetry_processing_init(void);
  * 
  * @details
  * Esta función intenta recuperar un paquete de telemetría del buffer
- * y procesarlo según su tipo. Devuelve true si se procesó un paquete,
- * o false si no había paquetes disponibles.
+ * y procesarlo según su tipo (un lote de uno). Devuelve true si se
+ * procesó un paquete, o false si no había paquetes disponibles.
  * 
  * @return true Si se procesó un paquete
  * @return false Si no había paquetes disponibles
  */
 bool telemetry_processing_handle_one(void);
 
+/**
+ * @brief Procesa los paquetes pendientes, hasta max_packets
+ *
+ * @details Cada paquete se despacha por la tabla de manejadores de su tipo.
+ * Las estadísticas del buffer y la memoria libre se leen una vez por lote,
+ * y los paquetes pendientes se registran una vez al final del lote.
+ * Los de sistema, potencia y temperatura se cuentan en las estadísticas
+ * por ventana (TELEM_STATS_ENGINE).
+ *
+ * @param max_packets Máximo de paquetes de este lote
+ * @return uint32_t Paquetes procesados (menos de max_packets: el buffer quedó vacío)
+ */
+uint32_t telemetry_processing_handle_batch(uint32_t max_packets);
+
+/**
+ * @brief Obtiene el coste acumulado del procesado
+ */
+void telemetry_processing_get_cost(telemetry_processing_cost_t* cost);
+
+/**
+ * @brief Duerme hasta que se publiquen paquetes (TELEM_PROC_WAKE_*)
+ *
+ * @details Con TELEM_WAKE_EVENTS=0 vuelve a sondear cada segundo.
+ */
+void telemetry_processing_wait(void);
+
+/**
+ * @brief Aviso del procesador (contadores para el diagnóstico)
+ */
+const telemetry_wake_t* telemetry_processing_get_wake(void);
+
+/**
+ * @brief Estadísticas por ventana del procesador (telemetry_stats.h)
+ *
+ * @param[out] summaries_lost Resúmenes que no cupieron en el buffer (puede ser NULL)
+ * @return const telemetry_stats_t* NULL con TELEM_STATS_ENGINE=0
+ */
+const telemetry_stats_t* telemetry_processing_get_stats(uint32_t* summaries_lost);
+
 #endif /* TELEMETRY_PROCESSING_H */
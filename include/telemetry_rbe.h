@@ -0,0 +1,128 @@
+/**
+ * @file telemetry_rbe.h
+ * @brief Bajada por excepción con banda muerta por campo
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Con TELEM_DOWNLINK_RBE=1 el transmisor guarda el último paquete enviado
+ * de cada tipo vigilado (los que aparecen en TELEM_RBE_TABLE) y solo envía
+ * uno nuevo cuando algún campo se aleja del último valor enviado más que
+ * su banda muerta, o cuando han pasado TELEM_RBE_HEARTBEAT_MS desde el
+ * último envío del tipo (latido: tierra sabe que el satélite sigue vivo y
+ * que los valores no han cambiado). Los campos de un tipo vigilado que no
+ * están en la tabla tienen banda 0: cualquier cambio cuenta.
+ *
+ * Un paquete que se envía lleva los campos que no han salido de su banda
+ * con el último valor enviado (actualización parcial): en tierra cada
+ * campo se aleja del real como mucho su banda muerta. Con
+ * TELEM_DOWNLINK_DELTA esos campos se codifican como diferencia cero, así
+ * que la trama solo crece con los campos que cambiaron. Los latidos van con
+ * todos los valores actuales.
+ *
+ * Los paquetes suprimidos se confirman como enviados, igual que los del
+ * diezmado. Los contadores por tipo (telemetry_transmission_get_rbe())
+ * permiten comprobar el ahorro en vuelo; bridge/frame_decoder/rbe_savings.cpp
+ * lo mide en el host con el ruido de los generadores.
+ *
+ * El módulo no depende de Arduino.
+ */
+
+#ifndef TELEMETRY_RBE_H
+#define TELEMETRY_RBE_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_types.h"
+
+/** @brief 1 = suprimir en la bajada los paquetes que no cambian (ver @details) */
+#ifndef TELEM_DOWNLINK_RBE
+#define TELEM_DOWNLINK_RBE 0
+#endif
+
+/** @brief Tiempo máximo sin enviar un tipo vigilado (ms del timestamp de los paquetes) */
+#ifndef TELEM_RBE_HEARTBEAT_MS
+#define TELEM_RBE_HEARTBEAT_MS 60000
+#endif
+
+/**
+ * @brief Bandas muertas de los campos vigilados
+ *
+ * @details X(tipo, estructura, miembro, banda) con la banda en unidades
+ * físicas (°C aunque el miembro vaya en décimas). Las temperaturas y la
+ * tasa de éxito de comandos, algo más anchas que el ruido de los
+ * generadores; los uptimes solo se envían cada 10 min o con el latido
+ * (tierra puede extrapolarlos). Puede sustituirse definiendo
+ * TELEM_RBE_TABLE antes de incluir este fichero.
+ */
+#ifndef TELEM_RBE_TABLE
+#define TELEM_RBE_TABLE(X) \
+  X(TELEM_TEMPERATURE_DATA,     temperature_telem_t,      obc_temperature,      3.0f)   \
+  X(TELEM_TEMPERATURE_DATA,     temperature_telem_t,      comms_temperature,    3.0f)   \
+  X(TELEM_TEMPERATURE_DATA,     temperature_telem_t,      payload_temperature,  1.5f)   \
+  X(TELEM_TEMPERATURE_DATA,     temperature_telem_t,      battery_temperature,  3.0f)   \
+  X(TELEM_TEMPERATURE_DATA,     temperature_telem_t,      external_temperature, 7.5f)   \
+  X(TELEM_COMMUNICATION_STATUS, subsystem_status_telem_t, comms_uptime,         600.0f) \
+  X(TELEM_COMMUNICATION_STATUS, subsystem_status_telem_t, payload_uptime,       600.0f) \
+  X(TELEM_COMMUNICATION_STATUS, subsystem_status_telem_t, command_success_rate, 3.0f)
+#endif
+
+/** @brief Campos máximos de un tipo vigilado */
+#define TELEM_RBE_MAX_FIELDS 16
+
+/**
+ * @brief Contadores de un tipo
+ */
+typedef struct {
+  uint32_t sent;          /**< Paquetes enviados */
+  uint32_t suppressed;    /**< Paquetes suprimidos */
+  uint32_t heartbeats;    /**< Enviados por el latido */
+  uint32_t changed;       /**< Campos enviados con valor nuevo */
+  uint32_t held;          /**< Campos enviados con el último valor (dentro de su banda) */
+} telemetry_rbe_counts_t;
+
+/**
+ * @brief Estado de la bajada por excepción
+ */
+typedef struct {
+  telemetry_packet_t last[TELEM_DATA_TYPE_COUNT];           /**< Último paquete enviado de cada tipo */
+  bool has_last[TELEM_DATA_TYPE_COUNT];                     /**< Hay referencia (si no, se envía) */
+  bool watched[TELEM_DATA_TYPE_COUNT];                      /**< Tipo con alguna entrada en la tabla */
+  bool heartbeat[TELEM_DATA_TYPE_COUNT];                    /**< El paquete preparado sale por el latido */
+  float deadband[TELEM_DATA_TYPE_COUNT][TELEM_RBE_MAX_FIELDS]; /**< Banda de cada campo del esquema */
+  uint32_t heartbeat_ms;
+  telemetry_rbe_counts_t counts[TELEM_DATA_TYPE_COUNT];
+  uint32_t unresolved;                                      /**< Entradas sin campo en el esquema */
+} telemetry_rbe_t;
+
+/**
+ * @brief Inicializa el estado sin referencias
+ *
+ * @param heartbeat_ms Tiempo máximo sin enviar un tipo vigilado
+ * @return uint32_t Entradas de TELEM_RBE_TABLE que no corresponden a ningún campo
+ */
+uint32_t telemetry_rbe_init(telemetry_rbe_t* rbe, uint32_t heartbeat_ms);
+
+/**
+ * @brief Decide si un paquete se envía y retiene los campos que no han cambiado
+ *
+ * @details No cambia la referencia: el paquete puede no llegar a salir (sin
+ * presupuesto) y volver a prepararse después.
+ *
+ * @param[in,out] packet Paquete (copia del lote); si se envía, los campos
+ * dentro de su banda quedan con el último valor enviado
+ * @return false Si se suprime (queda contado)
+ */
+bool telemetry_rbe_prepare(telemetry_rbe_t* rbe, telemetry_packet_t* packet);
+
+/**
+ * @brief Toma como referencia un paquete ya enviado (preparado con telemetry_rbe_prepare())
+ */
+void telemetry_rbe_sent(telemetry_rbe_t* rbe, const telemetry_packet_t* packet);
+
+/**
+ * @brief Suma los contadores de todos los tipos
+ */
+void telemetry_rbe_totals(const telemetry_rbe_t* rbe, telemetry_rbe_counts_t* total);
+
+#endif /* TELEMETRY_RBE_H */
@@ -0,0 +1,82 @@
+/**
+ * @file telemetry_record.h
+ * @brief Registros de longitud variable para telemetría y capacidad efectiva por KB
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Alternativa compacta a los slots fijos de telemetry_storage: en lugar del
+ * tamaño de telemetry_packet_t (64 bytes), cada paquete se guarda como un
+ * registro con una pequeña cabecera de longitud seguido solo de los bytes
+ * de su estructura real (p. ej. temperature_telem_t ocupa menos de la mitad
+ * de un slot). Es el formato de los segmentos de la cola de flash
+ * (telemetry_spill.h).
+ *
+ * Características principales:
+ * - Registros alineados a TELEM_RECORD_ALIGN bytes
+ * - Registros delta (TELEM_RECORD_DELTA) con un lote entero de paquetes
+ * - Informe de capacidad efectiva (paquetes por KB) con la mezcla real de
+ *   tipos escrita en telemetry_storage
+ */
+
+#ifndef TELEMETRY_RECORD_H
+#define TELEMETRY_RECORD_H
+
+  #include <stdint.h>
+  #include "telemetry_types.h"
+
+/** @brief Alineación de cada registro (permite leer la cabecera sin accesos desalineados) */
+#define TELEM_RECORD_ALIGN 4
+
+/** @brief Registro con un bloque de paquetes en codificación delta (cola de flash; type = número de paquetes) */
+#define TELEM_RECORD_DELTA 0x02
+
+/**
+ * @brief Cabecera de cada registro
+ */
+typedef struct {
+  uint16_t length;  /**< Bytes de la estructura que siguen a la cabecera */
+  uint8_t type;     /**< Tipo de telemetría (telem_data_type_t) */
+  uint8_t flags;    /**< TELEM_RECORD_DELTA, o 0 para un paquete suelto */
+} telemetry_record_hdr_t;
+
+/**
+ * @brief Capacidad efectiva según la mezcla de tipos
+ *
+ * @details Las medias se expresan en centésimas para evitar coma flotante.
+ */
+typedef struct {
+  uint32_t avg_record_bytes_x100;   /**< Tamaño medio de registro (cabecera y alineación incluidas) x100 */
+  uint32_t packets_per_kb_x100;     /**< Paquetes por KB con registros de longitud variable x100 */
+  uint32_t fixed_packets_per_kb_x100; /**< Paquetes por KB con slots fijos de telemetry_packet_t x100 */
+  uint32_t gain_x100;               /**< Factor de mejora frente a los slots fijos x100 */
+  uint32_t capacity_packets;        /**< Paquetes que caben en los bytes indicados con esta mezcla */
+} telemetry_record_capacity_t;
+
+/**
+ * @brief Bytes de la estructura real de un tipo de telemetría
+ *
+ * @param type Tipo de telemetría
+ * @return uint16_t sizeof de su estructura, o de telemetry_packet_t si el tipo es desconocido
+ */
+uint16_t telemetry_record_payload_size(telem_data_type_t type);
+
+/**
+ * @brief Bytes que ocupa un registro con length bytes tras la cabecera
+ */
+static inline uint32_t telemetry_record_footprint(uint32_t length) {
+  return (sizeof(telemetry_record_hdr_t) + length + TELEM_RECORD_ALIGN - 1) & ~(uint32_t)(TELEM_RECORD_ALIGN - 1);
+}
+
+/**
+ * @brief Calcula la capacidad efectiva por KB
+ *
+ * @param type_counts Paquetes por tipo que definen la mezcla (TELEM_DATA_TYPE_COUNT
+ * entradas, p. ej. telemetry_get_written_by_type()); si todos son 0 se usa la
+ * mezcla nominal de la adquisición
+ * @param bytes Memoria para la que se calcula capacity_packets
+ * @param[out] report Resultado
+ */
+void telemetry_record_capacity_report(const uint32_t* type_counts, uint32_t bytes, telemetry_record_capacity_t* report);
+
+#endif /* TELEMETRY_RECORD_H */
@@ -0,0 +1,251 @@
+/**
+ * @file telemetry_schema.h
+ * @brief Descripción única de los campos de cada tipo de telemetría
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Cada tipo de telemetry_types.h se describe una sola vez con una X-macro
+ * (TELEM_SCHEMA_<TIPO>) que enumera sus campos: miembro de la estructura,
+ * tipo, decimales, clave JSON, etiqueta de log y unidad. A partir de esas
+ * listas se generan tablas constantes que recorren tres formateadores
+ * genéricos:
+ * - Codificación/decodificación binaria (little-endian, sin relleno)
+ * - JSON para la estación de tierra (Fomalhaut)
+ * - Línea de log legible
+ *
+ * Así las salidas no pueden divergir entre sí: añadir o cambiar un campo
+ * es editar una línea de la lista. Ninguna función reserva memoria; todas
+ * escriben en un buffer del llamador.
+ *
+ * Los formateadores de texto no usan printf: copian fragmentos constantes
+ * con su longitud ya calculada (prefijo JSON del tipo, claves, etiquetas) y
+ * convierten los números con rutinas propias de enteros y de punto fijo.
+ * Un F32 se escala por 10^dec y se redondea al par más cercano, como
+ * "%.*f", así que el texto es idéntico al de printf (salvo "-0.0", que se
+ * escribe "0.0").
+ *
+ * Parámetros de cada entrada X(struct, miembro, n, kind, dec, json, log, unidad):
+ * - n: elementos (1 = escalar, >1 = array)
+ * - kind: U8, I8, U16, I16, U32 o F32 (debe coincidir con el miembro; se
+ *   comprueba en compilación)
+ * - dec: decimales al formatear. En F32 es la precisión; en los enteros
+ *   indica que el valor se almacena en unidades de 10^-dec (p. ej. 1 =
+ *   décimas de grado)
+ * - json / log: clave JSON y etiqueta de log; NULL omite el campo en esa
+ *   salida (siempre va en la codificación binaria)
+ */
+
+#ifndef TELEMETRY_SCHEMA_H
+#define TELEMETRY_SCHEMA_H
+
+  #include <stddef.h>
+  #include <stdint.h>
+  #include <string.h>
+  #include "telemetry_types.h"
+
+#define TELEM_SCHEMA_SYSTEM(X) \
+  X(system_status_telem_t, uptime_seconds,   1, U32, 0, "uptime",     "Uptime",   "s") \
+  X(system_status_telem_t, system_mode,      1, U8,  0, NULL,         NULL,       "")  \
+  X(system_status_telem_t, cpu_usage,        1, U8,  0, "cpuUsage",   NULL,       "%") \
+  X(system_status_telem_t, stack_high_water, 1, U16, 0, NULL,         NULL,       "")  \
+  X(system_status_telem_t, heap_free,        1, U32, 0, "memoryFree", NULL,       "B") \
+  X(system_status_telem_t, task_count,       1, U8,  0, "taskCount",  "Tasks",    "")  \
+  X(system_status_telem_t, cpu_temperature,  1, F32, 1, "cpuTemp",    "CPU Temp", "C")
+
+#define TELEM_SCHEMA_POWER(X) \
+  X(power_telem_t, battery_voltage,     1, F32, 2, "voltage",      "Bat",   "V") \
+  X(power_telem_t, battery_current,     1, F32, 3, "current",      NULL,    "A") \
+  X(power_telem_t, solar_panel_voltage, 1, F32, 2, "solarVoltage", NULL,    "V") \
+  X(power_telem_t, solar_panel_current, 1, F32, 3, "solarCurrent", NULL,    "A") \
+  X(power_telem_t, battery_level,       1, U8,  0, "batteryLevel", "Level", "%") \
+  X(power_telem_t, battery_temperature, 1, I8,  0, "batteryTemp",  "Temp",  "C") \
+  X(power_telem_t, power_state,         1, U8,  0, NULL,           NULL,    "")
+
+#define TELEM_SCHEMA_TEMPERATURE(X) \
+  X(temperature_telem_t, obc_temperature,      1, I16, 1, "obcTemp",      "OBC",     "C") \
+  X(temperature_telem_t, comms_temperature,    1, I16, 1, "commsTemp",    "COMMS",   "C") \
+  X(temperature_telem_t, payload_temperature,  1, I16, 1, "payloadTemp",  "PAYLOAD", "C") \
+  X(temperature_telem_t, battery_temperature,  1, I16, 1, "batteryTemp",  NULL,      "C") \
+  X(temperature_telem_t, external_temperature, 1, I16, 1, "externalTemp", NULL,      "C")
+
+#define TELEM_SCHEMA_COMMUNICATION(X) \
+  X(subsystem_status_telem_t, comms_status,         1, U8,  0, NULL,          "Status",  "")    \
+  X(subsystem_status_telem_t, adcs_status,          1, U8,  0, NULL,          NULL,      "")    \
+  X(subsystem_status_telem_t, payload_status,       1, U8,  0, NULL,          NULL,      "")    \
+  X(subsystem_status_telem_t, power_status,         1, U8,  0, NULL,          NULL,      "")    \
+  X(subsystem_status_telem_t, comms_uptime,         1, U32, 0, "commsUptime", "Uptime",  "s")   \
+  X(subsystem_status_telem_t, payload_uptime,       1, U32, 0, NULL,          NULL,      "s")   \
+  X(subsystem_status_telem_t, last_command_id,      1, U8,  0, NULL,          NULL,      "")    \
+  X(subsystem_status_telem_t, command_success_rate, 1, U8,  0, "successRate", "Success", "%")   \
+  X(subsystem_status_telem_t, rssi_dbm,             1, I8,  0, "rssi",        "RSSI",    "dBm") \
+  X(subsystem_status_telem_t, snr_db,               1, I8,  0, "snr",         "SNR",     "dB")
+
+#define TELEM_SCHEMA_STORAGE(X) \
+  X(storage_metrics_telem_t, occupancy,        1,                    U16, 0, "occupancy",     "Occ",      "")   \
+  X(storage_metrics_telem_t, high_water,       1,                    U16, 0, "highWater",     "HWM",      "")   \
+  X(storage_metrics_telem_t, capacity,         1,                    U16, 0, "capacity",      "Cap",      "")   \
+  X(storage_metrics_telem_t, occupancy_pct,    TELEM_OCCUPANCY_BINS, U8,  0, "occupancyPct",  "Hist",     "%")  \
+  X(storage_metrics_telem_t, packets_lost,     1,                    U32, 0, "lost",          "Lost",     "")   \
+  X(storage_metrics_telem_t, lock_timeouts,    1,                    U32, 0, "lockTimeouts",  "Timeouts", "")   \
+  X(storage_metrics_telem_t, lock_wait_avg_us, 1,                    U32, 0, "lockWaitAvgUs", "LockAvg",  "us") \
+  X(storage_metrics_telem_t, lock_wait_max_us, 1,                    U32, 0, "lockWaitMaxUs", "LockMax",  "us")
+
+#define TELEM_SCHEMA_LATENCY(X) \
+  X(latency_metrics_telem_t, stage,   1, U8,  0, "stage",   "Stage", "")   \
+  X(latency_metrics_telem_t, samples, 1, U32, 0, "samples", "N",     "")   \
+  X(latency_metrics_telem_t, p50_us,  1, U32, 0, "p50Us",   "P50",   "us") \
+  X(latency_metrics_telem_t, p99_us,  1, U32, 0, "p99Us",   "P99",   "us") \
+  X(latency_metrics_telem_t, max_us,  1, U32, 0, "maxUs",   "Max",   "us")
+
+#define TELEM_SCHEMA_SUMMARY(X) \
+  X(stats_summary_telem_t, source_type,  1, U8,  0, "source",  "Src",    "")     \
+  X(stats_summary_telem_t, field,        1, U8,  0, "field",   "Field",  "")     \
+  X(stats_summary_telem_t, window_s,     1, U16, 0, "window",  "Window", "s")    \
+  X(stats_summary_telem_t, samples,      1, U16, 0, "samples", "N",      "")     \
+  X(stats_summary_telem_t, min,          1, F32, 3, "min",     "Min",    "")     \
+  X(stats_summary_telem_t, max,          1, F32, 3, "max",     "Max",    "")     \
+  X(stats_summary_telem_t, mean,         1, F32, 3, "mean",    "Mean",   "")     \
+  X(stats_summary_telem_t, stddev,       1, F32, 3, "stddev",  "SD",     "")     \
+  X(stats_summary_telem_t, rate_per_min, 1, F32, 3, "ratePerMin", "Rate", "/min")
+
+#define TELEM_SCHEMA_EVENT(X) \
+  X(limit_event_telem_t, source_type, 1, U8,  0, "source",    "Src",   "") \
+  X(limit_event_telem_t, field,       1, U8,  0, "field",     "Field", "") \
+  X(limit_event_telem_t, limit,       1, U8,  0, "limit",     NULL,    "") \
+  X(limit_event_telem_t, state,       1, U8,  0, "state",     "State", "") \
+  X(limit_event_telem_t, previous,    1, U8,  0, "previous",  "Prev",  "") \
+  X(limit_event_telem_t, value,       1, F32, 3, "value",     "Value", "") \
+  X(limit_event_telem_t, threshold,   1, F32, 3, "threshold", "Thr",   "")
+
+/** @brief Tipo de almacenamiento de un campo */
+typedef enum {
+  TELEM_FIELD_U8 = 0,
+  TELEM_FIELD_I8,
+  TELEM_FIELD_U16,
+  TELEM_FIELD_I16,
+  TELEM_FIELD_U32,
+  TELEM_FIELD_F32
+} telem_field_kind_t;
+
+/** @brief Bytes de cada telem_field_kind_t (en memoria y en la codificación binaria) */
+#define TELEM_FIELD_WIDTH_U8  1
+#define TELEM_FIELD_WIDTH_I8  1
+#define TELEM_FIELD_WIDTH_U16 2
+#define TELEM_FIELD_WIDTH_I16 2
+#define TELEM_FIELD_WIDTH_U32 4
+#define TELEM_FIELD_WIDTH_F32 4
+
+/** @brief Bytes de un elemento de un campo según su telem_field_kind_t */
+static inline uint8_t telemetry_field_width(uint8_t kind) {
+  return (kind >= TELEM_FIELD_U32) ? 4 : (kind >= TELEM_FIELD_U16) ? 2 : 1;
+}
+
+/**
+ * @brief Valor de un elemento escalar en unidades físicas
+ *
+ * @details Los enteros se dividen por 10^decimals (décimas de grado -> °C).
+ *
+ * @param packet Paquete
+ * @param offset offsetof del miembro en su estructura
+ * @param kind telem_field_kind_t
+ * @param decimals Decimales del campo en el esquema
+ */
+static inline float telemetry_field_value(const telemetry_packet_t* packet, uint8_t offset, uint8_t kind,
+                                          uint8_t decimals) {
+  const uint8_t* p = packet->raw_data + offset;
+  float value;
+  switch(kind) {
+    case TELEM_FIELD_U8:  value = (float)*p; break;
+    case TELEM_FIELD_I8:  value = (float)(int8_t)*p; break;
+    case TELEM_FIELD_U16: { uint16_t v; memcpy(&v, p, sizeof(v)); value = (float)v; break; }
+    case TELEM_FIELD_I16: { int16_t v;  memcpy(&v, p, sizeof(v)); value = (float)v; break; }
+    case TELEM_FIELD_U32: { uint32_t v; memcpy(&v, p, sizeof(v)); value = (float)v; break; }
+    default:              { memcpy(&value, p, sizeof(value)); return value; }
+  }
+  for(uint8_t d = 0; d < decimals; d++) value /= 10.0f;
+  return value;
+}
+
+/** @brief Bytes de la cabecera codificada: tipo(1) timestamp(4) secuencia(2) prioridad(1) */
+#define TELEM_SCHEMA_HEADER_BYTES 8
+
+/**
+ * @brief Descripción de un campo (generada a partir de las X-macros)
+ */
+typedef struct {
+  const char* json_key;   /**< Clave JSON (NULL = no se emite) */
+  const char* log_label;  /**< Etiqueta en el log (NULL = no se emite) */
+  const char* unit;       /**< Unidad que sigue al valor en el log */
+  uint8_t offset;         /**< offsetof del miembro en su estructura */
+  uint8_t kind;           /**< telem_field_kind_t */
+  uint8_t count;          /**< Elementos (1 = escalar) */
+  uint8_t decimals;       /**< Decimales (ver @details del fichero) */
+  const char* json_frag;  /**< Fragmento JSON ,"clave": (sin uso si json_key es NULL) */
+  uint8_t json_frag_len;  /**< strlen(json_frag) */
+  uint8_t log_label_len;  /**< strlen(log_label) */
+  uint8_t unit_len;       /**< strlen(unit) */
+} telemetry_field_t;
+
+/**
+ * @brief Descripción de un tipo de telemetría
+ */
+typedef struct {
+  const char* json_type;          /**< Valor de "type" en el JSON */
+  const char* log_tag;            /**< Prefijo de la línea de log */
+  const telemetry_field_t* fields; /**< Campos en orden de la estructura */
+  uint8_t field_count;            /**< Número de campos */
+  uint8_t encoded_size;           /**< Bytes de la codificación binaria (cabecera incluida) */
+  const char* json_prefix;        /**< Inicio del JSON: {"type":"<json_type>" */
+  uint8_t json_prefix_len;        /**< strlen(json_prefix) */
+  uint8_t log_tag_len;            /**< strlen(log_tag) */
+} telemetry_schema_t;
+
+/**
+ * @brief Obtiene la descripción de un tipo
+ *
+ * @return const telemetry_schema_t* NULL si el tipo no existe
+ */
+const telemetry_schema_t* telemetry_schema_get(telem_data_type_t type);
+
+/**
+ * @brief Codifica un paquete en binario compacto (little-endian, sin relleno)
+ *
+ * @param packet Paquete a codificar
+ * @param[out] out Buffer destino
+ * @param capacity Bytes disponibles en out
+ * @return uint32_t Bytes escritos (0 si el tipo no existe o no cabe)
+ */
+uint32_t telemetry_schema_encode(const telemetry_packet_t* packet, uint8_t* out, uint32_t capacity);
+
+/**
+ * @brief Decodifica un paquete generado por telemetry_schema_encode()
+ *
+ * @param in Bytes codificados
+ * @param len Bytes disponibles en in
+ * @param[out] packet Paquete reconstruido (los bytes no descritos quedan a cero)
+ * @return uint32_t Bytes consumidos (0 si el tipo no existe o faltan bytes)
+ */
+uint32_t telemetry_schema_decode(const uint8_t* in, uint32_t len, telemetry_packet_t* packet);
+
+/**
+ * @brief Escribe el JSON de un paquete para la estación de tierra
+ *
+ * @param packet Paquete
+ * @param[out] out Buffer destino (siempre terminado en '\0' si capacity > 0)
+ * @param capacity Tamaño de out
+ * @return size_t Longitud escrita (0 si el tipo no existe o no cabe)
+ */
+size_t telemetry_schema_format_json(const telemetry_packet_t* packet, char* out, size_t capacity);
+
+/**
+ * @brief Escribe la línea de log de un paquete ("TAG: Etiqueta=valor | ... | Seq=n")
+ *
+ * @param packet Paquete
+ * @param[out] out Buffer destino (siempre terminado en '\0' si capacity > 0)
+ * @param capacity Tamaño de out
+ * @return size_t Longitud escrita (0 si el tipo no existe o no cabe)
+ */
+size_t telemetry_schema_format_log(const telemetry_packet_t* packet, char* out, size_t capacity);
+
+#endif /* TELEMETRY_SCHEMA_H */
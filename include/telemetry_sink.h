@@ -0,0 +1,277 @@
+/**
+ * @file telemetry_sink.h
+ * @brief Salidas enchufables (sinks) con reparto asíncrono
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Quien produce una salida (las líneas de telemetry_logger, las tramas o
+ * líneas JSON de bajada) la serializa una sola vez y la publica en un
+ * canal con telemetry_sink_publish(). El despachador la copia en un buffer
+ * del pool, que desde ese momento no cambia, y pone el mismo buffer en la
+ * cola de cada sink suscrito a ese canal. Cada sink tiene su cola, su
+ * tarea (vTelemetrySinkTask, que llama a telemetry_sink_service()) y su
+ * política ante cola llena, así que un sink lento (la flash, un socket)
+ * pierde mensajes propios pero nunca frena a los demás ni a quien publica.
+ * El buffer vuelve al pool cuando lo ha soltado el último sink.
+ *
+ * La tarea de cada sink se registra con telemetry_sink_set_wake() y duerme
+ * en telemetry_sink_wait() hasta que telemetry_sink_publish() le encola un
+ * mensaje. Un sink sin tarea registrada (el planificador aún no corre, o
+ * no se pudo crear la tarea) lo escribe quien publica, como con
+ * TELEM_SINK_ASYNC=0: ningún mensaje se queda esperando a una tarea que no
+ * existe.
+ *
+ * Backends: Serial (telemetry_sink_serial.cpp), ficheros de LittleFS
+ * (telemetry_sink_littlefs.cpp), captura en memoria (telemetry_sink_memory())
+ * y, solo en el host, un socket UDP a localhost (telemetry_sink_udp.cpp).
+ *
+ * Las colas y el pool son colas acotadas MPMC sin mutex (posiciones con
+ * número de secuencia por celda): publican varias tareas a la vez (los
+ * logs) y, con TELEM_SINK_DROP_OLDEST, quien publica también saca de la cola.
+ *
+ * El enlace de bajada sigue en telemetry_txbuf.h: el presupuesto de los
+ * pases y el ARQ necesitan saber qué bytes esperan exactamente a la UART.
+ * Lo que se encola allí se publica además en TELEM_SINK_CH_DOWNLINK para
+ * los sinks de captura.
+ */
+
+#ifndef TELEMETRY_SINK_H
+#define TELEMETRY_SINK_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_wake.h"
+
+/**
+ * @brief Reparto asíncrono
+ *
+ * @details 1: cada sink escribe desde su tarea. 0: telemetry_sink_publish()
+ * escribe en todos los sinks desde la tarea que publica (sin tareas, como
+ * el logger original; útil para depurar el arranque).
+ */
+#ifndef TELEM_SINK_ASYNC
+#define TELEM_SINK_ASYNC 1
+#endif
+
+/**
+ * @brief Espera máxima de la tarea de un sink sin aviso (ms)
+ *
+ * @details Solo es una red de seguridad: cada mensaje encolado la despierta.
+ */
+#ifndef TELEM_SINK_IDLE_MS
+#define TELEM_SINK_IDLE_MS 1000
+#endif
+
+/** @brief Sinks que se pueden registrar */
+#ifndef TELEM_SINK_MAX
+#define TELEM_SINK_MAX 3
+#endif
+
+/** @brief Mensajes en la cola de cada sink (potencia de dos) */
+#ifndef TELEM_SINK_QUEUE
+#define TELEM_SINK_QUEUE 8
+#endif
+
+/** @brief Buffers del pool (potencia de dos) */
+#ifndef TELEM_SINK_POOL
+#define TELEM_SINK_POOL 32
+#endif
+
+/** @brief Bytes de un buffer: una línea JSON (256 + CRLF) con margen */
+#ifndef TELEM_SINK_MESSAGE_BYTES
+#define TELEM_SINK_MESSAGE_BYTES 264
+#endif
+
+/** @brief 1 = el sink de ficheros guarda también la bajada en TELEM_SINK_DOWNLINK_FILE */
+#ifndef TELEM_SINK_DOWNLINK_CAPTURE
+#define TELEM_SINK_DOWNLINK_CAPTURE 0
+#endif
+
+/** @brief Fichero de LittleFS de la captura de bajada */
+#ifndef TELEM_SINK_DOWNLINK_FILE
+#define TELEM_SINK_DOWNLINK_FILE "/downlink.bin"
+#endif
+
+#if (TELEM_SINK_QUEUE & (TELEM_SINK_QUEUE - 1)) != 0 || (TELEM_SINK_POOL & (TELEM_SINK_POOL - 1)) != 0
+#error "TELEM_SINK_QUEUE y TELEM_SINK_POOL deben ser potencias de dos"
+#endif
+#if TELEM_SINK_POOL < TELEM_SINK_MAX * (TELEM_SINK_QUEUE + 1)
+#error "TELEM_SINK_POOL debe cubrir las colas llenas de todos los sinks (un sink parado no deja sin buffers a los demás)"
+#endif
+
+/** @brief Canales (máscara de bits) */
+#define TELEM_SINK_CH_LOG          0x01  /**< telemetry_logf() */
+#define TELEM_SINK_CH_LOG_SYSTEM   0x02  /**< telemetry_log_system() */
+#define TELEM_SINK_CH_LOG_POWER    0x04  /**< telemetry_log_power() */
+#define TELEM_SINK_CH_LOG_TEMP     0x08  /**< telemetry_log_temperature() */
+#define TELEM_SINK_CH_LOG_COMMS    0x10  /**< telemetry_log_comms() */
+#define TELEM_SINK_CH_DOWNLINK     0x20  /**< Mensajes encolados para la UART de bajada */
+#define TELEM_SINK_CH_LOGS         0x1F  /**< Todos los de log */
+
+/** @brief Política de un sink con la cola llena */
+typedef enum {
+  TELEM_SINK_DROP_NEWEST = 0,   /**< Se descarta el mensaje nuevo (ficheros: sin huecos en medio) */
+  TELEM_SINK_DROP_OLDEST        /**< Se descarta el más antiguo de la cola (consola: lo último importa más) */
+} telem_sink_policy_t;
+
+/**
+ * @brief Salida
+ *
+ * @details write() recibe siempre un mensaje completo y puede bloquear (solo
+ * a la tarea de su sink). El buffer es compartido con los demás sinks: no
+ * se modifica.
+ */
+typedef struct {
+  const char* name;                                                            /**< Nombre para los diagnósticos */
+  bool (*write)(void* ctx, uint32_t channel, const uint8_t* data, uint32_t len); /**< false = error de escritura */
+  void* ctx;                                                                   /**< Estado del backend */
+} telemetry_sink_t;
+
+/**
+ * @brief Contadores de un sink
+ */
+typedef struct {
+  uint32_t delivered;   /**< Mensajes escritos */
+  uint32_t dropped;     /**< Mensajes descartados por cola llena */
+  uint32_t failed;      /**< Escrituras con error */
+} telemetry_sink_stats_t;
+
+/**
+ * @brief Captura en memoria: los mensajes seguidos hasta llenar el buffer
+ */
+typedef struct {
+  uint8_t* buffer;      /**< Destino */
+  uint32_t capacity;    /**< Bytes del destino */
+  uint32_t used;        /**< Bytes capturados */
+  uint32_t messages;    /**< Mensajes capturados */
+  uint32_t overflow;    /**< Mensajes que ya no cabían */
+} telemetry_sink_memory_t;
+
+/**
+ * @brief Vacía el registro de sinks y el pool
+ *
+ * @details Sin sinks, publicar no cuesta nada. Antes de arrancar las tareas.
+ */
+void telemetry_sink_init(void);
+
+/**
+ * @brief Registra un sink (en el arranque, antes de publicar)
+ *
+ * @param sink Salida (debe seguir siendo válida)
+ * @param channels Canales que recibe (TELEM_SINK_CH_*)
+ * @param policy Política con la cola llena
+ * @return int Identificador (parámetro de vTelemetrySinkTask), -1 si no quedan
+ */
+int telemetry_sink_add(const telemetry_sink_t* sink, uint32_t channels, telem_sink_policy_t policy);
+
+/**
+ * @brief Sinks registrados
+ */
+uint32_t telemetry_sink_count(void);
+
+/**
+ * @brief Publica un mensaje en un canal (desde cualquier tarea)
+ *
+ * @param channel Canal (un TELEM_SINK_CH_*)
+ * @param data Mensaje ya serializado
+ * @param len Bytes (1..TELEM_SINK_MESSAGE_BYTES)
+ * @return uint32_t Sinks a los que se ha entregado (o encolado)
+ *
+ * @details Nunca espera: un mensaje demasiado largo o sin buffer libre en
+ * el pool se cuenta en telemetry_sink_get_pool_stats().
+ */
+uint32_t telemetry_sink_publish(uint32_t channel, const void* data, uint32_t len);
+
+/**
+ * @brief Registra el aviso de la tarea de un sink
+ *
+ * @param id Identificador de telemetry_sink_add()
+ * @param port Mecanismo de aviso (telemetry_wake_port_task() en el ESP32)
+ * @param ctx Contexto de port (la tarea del sink)
+ *
+ * @details Lo llama la propia tarea al arrancar: desde ese momento
+ * telemetry_sink_publish() encola para ella en lugar de escribir. Se
+ * conserva tras telemetry_sink_init().
+ */
+void telemetry_sink_set_wake(int id, const telemetry_wake_port_t* port, void* ctx);
+
+/**
+ * @brief Duerme a la tarea de un sink hasta que haya mensajes en su cola (solo su tarea)
+ *
+ * @details Arma el aviso y vuelve a mirar la cola antes de dormir, así que
+ * un mensaje encolado justo antes no se pierde. Sin aviso registrado no
+ * espera.
+ *
+ * @param timeout_ms Espera máxima
+ * @return true Si hay mensajes en la cola
+ */
+bool telemetry_sink_wait(int id, uint32_t timeout_ms);
+
+/**
+ * @brief Escribe el siguiente mensaje de la cola de un sink (solo su tarea)
+ *
+ * @return true Si había mensaje
+ */
+bool telemetry_sink_service(int id);
+
+/**
+ * @brief Obtiene los contadores de un sink y su nombre
+ *
+ * @return const char* Nombre (NULL si id no es válido)
+ */
+const char* telemetry_sink_get_stats(int id, telemetry_sink_stats_t* stats);
+
+/**
+ * @brief Mensajes que no se han podido publicar
+ *
+ * @param[out] no_buffer Sin buffer libre en el pool
+ * @param[out] too_long Más largos que TELEM_SINK_MESSAGE_BYTES
+ */
+void telemetry_sink_get_pool_stats(uint32_t* no_buffer, uint32_t* too_long);
+
+/**
+ * @brief Sink de captura en memoria
+ *
+ * @param mem Estado, con buffer y capacity ya asignados (used y contadores a 0)
+ * @param[out] sink Sink que escribe en mem
+ */
+void telemetry_sink_memory(telemetry_sink_memory_t* mem, telemetry_sink_t* sink);
+
+/**
+ * @brief Sink sobre Serial (escribe cada mensaje de una vez)
+ */
+const telemetry_sink_t* telemetry_sink_serial(void);
+
+/**
+ * @brief Sink de ficheros de LittleFS: cada canal en su fichero
+ *
+ * @details Logs en los ficheros de telemetry_logger.h y la bajada en
+ * TELEM_SINK_DOWNLINK_FILE. LittleFS debe estar montado.
+ */
+const telemetry_sink_t* telemetry_sink_littlefs(void);
+
+#ifndef ARDUINO
+/**
+ * @brief Socket UDP a localhost (solo en el host)
+ */
+typedef struct {
+  int fd;               /**< Socket */
+  uint16_t port;        /**< Puerto de destino en 127.0.0.1 */
+} telemetry_sink_udp_t;
+
+/**
+ * @brief Abre un sink que envía cada mensaje como un datagrama a 127.0.0.1:port
+ *
+ * @param[out] sink Sink que envía por udp
+ * @return false Si no se pudo crear el socket
+ */
+bool telemetry_sink_udp_open(telemetry_sink_udp_t* udp, uint16_t port, telemetry_sink_t* sink);
+
+/**
+ * @brief Cierra el socket
+ */
+void telemetry_sink_udp_close(telemetry_sink_udp_t* udp);
+#endif
+
+#endif /* TELEMETRY_SINK_H */
@@ -0,0 +1,162 @@
+/**
+ * @file telemetry_spill.h
+ * @brief Cola persistente de desbordamiento (store-and-forward) en flash
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Segundo nivel de almacenamiento para telemetry_storage. Cuando los paquetes
+ * pendientes de un suscriptor superan TELEM_SPILL_HIGH_WATERMARK, los más
+ * antiguos se vuelcan por lotes a ficheros de segmento de solo-añadir en
+ * LittleFS hasta bajar de TELEM_SPILL_LOW_WATERMARK. La transmisión los
+ * reenvía en orden antes de seguir con los que quedan en RAM, y como el
+ * estado de la cola se guarda en flash, sobrevive a un reinicio.
+ *
+ * Formato de segmento: registros telemetry_record_hdr_t + estructura real del
+ * tipo (ver telemetry_record.h), alineados a TELEM_RECORD_ALIGN. Con
+ * TELEM_SPILL_DELTA cada lote volcado es un único registro TELEM_RECORD_DELTA
+ * con sus paquetes en la codificación de telemetry_delta.h: el primero de
+ * cada tipo completo y el resto como diferencia con el anterior (los float
+ * con los decimales del esquema, ver TELEM_DELTA_FLOAT_QUANTIZED). Cada
+ * registro se decodifica por sí solo, así que un registro dañado no afecta
+ * a los demás. Un registro truncado por un reinicio a mitad de escritura se
+ * detecta por su longitud y se descarta.
+ *
+ * El acceso a ficheros pasa por telemetry_spill_fs_t, de modo que la cola
+ * puede ejecutarse en el host sobre un sustituto del sistema de archivos.
+ *
+ * @note Las funciones de este módulo no son reentrantes: deben llamarse
+ * desde una única tarea (la de transmisión).
+ */
+
+#ifndef TELEMETRY_SPILL_H
+#define TELEMETRY_SPILL_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_types.h"
+  #include "telemetry_storage.h"
+
+/** @brief Tamaño máximo de un fichero de segmento (múltiplo del sector de flash de 4 KB) */
+#ifndef TELEM_SPILL_SEGMENT_BYTES
+#define TELEM_SPILL_SEGMENT_BYTES 16384
+#endif
+
+/** @brief Segmentos pendientes como máximo (limita el espacio ocupado en flash) */
+#ifndef TELEM_SPILL_MAX_SEGMENTS
+#define TELEM_SPILL_MAX_SEGMENTS 32
+#endif
+
+/** @brief Paquetes pendientes en RAM a partir de los cuales se vuelca a flash */
+#ifndef TELEM_SPILL_HIGH_WATERMARK
+#define TELEM_SPILL_HIGH_WATERMARK ((TELEM_BUFFER_SIZE * 3) / 4)
+#endif
+
+/** @brief Paquetes pendientes en RAM que se dejan tras un volcado */
+#ifndef TELEM_SPILL_LOW_WATERMARK
+#define TELEM_SPILL_LOW_WATERMARK (TELEM_BUFFER_SIZE / 2)
+#endif
+
+/** @brief 1 = cada lote se guarda como un registro delta (ocupa varias veces menos flash) */
+#ifndef TELEM_SPILL_DELTA
+#define TELEM_SPILL_DELTA 1
+#endif
+
+/** @brief Paquetes por escritura en flash (una sola llamada append por lote) */
+#define TELEM_SPILL_BATCH 16
+
+/** @brief Prefijo de los ficheros de segmento y fichero de estado de la cola */
+#define TELEM_SPILL_SEGMENT_PREFIX "/spill_"
+#define TELEM_SPILL_STATE_FILE "/spill_state.bin"
+
+/**
+ * @brief Operaciones de sistema de archivos que necesita la cola
+ *
+ * @details Todas devuelven false o -1 ante error. En el ESP32 se usa
+ * telemetry_spill_fs_littlefs(); en el host basta con implementarlas sobre
+ * stdio o en memoria.
+ */
+typedef struct {
+  bool (*append)(const char* path, const void* data, uint32_t len);        /**< Añade al final (crea si no existe) */
+  bool (*write)(const char* path, const void* data, uint32_t len);         /**< Sobrescribe el fichero completo */
+  int32_t (*read)(const char* path, uint32_t offset, void* data, uint32_t len); /**< Lee desde offset: bytes leídos */
+  int32_t (*size)(const char* path);                                       /**< Tamaño, o -1 si no existe */
+  bool (*remove)(const char* path);                                        /**< Borra el fichero */
+} telemetry_spill_fs_t;
+
+/**
+ * @brief Estado persistente de la cola (contenido de TELEM_SPILL_STATE_FILE)
+ */
+typedef struct {
+  uint32_t magic;           /**< Marca de formato */
+  uint32_t head_segment;    /**< Segmento que se está reenviando */
+  uint32_t head_offset;     /**< Bytes ya reenviados del segmento de cabeza */
+  uint32_t tail_segment;    /**< Segmento en el que se añaden registros */
+  uint32_t head_skip;       /**< Paquetes ya reenviados del registro delta de cabeza */
+} telemetry_spill_state_t;
+
+/**
+ * @brief Backend LittleFS (el sistema de archivos lo monta telemetry_logger_init())
+ */
+const telemetry_spill_fs_t* telemetry_spill_fs_littlefs(void);
+
+/**
+ * @brief Inicializa la cola recuperando el estado guardado en flash
+ *
+ * @param fs Operaciones de sistema de archivos
+ * @return true Si la cola está operativa
+ *
+ * @details Tras un reinicio los nuevos volcados empiezan en un segmento
+ * nuevo, para no añadir detrás de un registro que pudo quedar a medias.
+ */
+bool telemetry_spill_init(const telemetry_spill_fs_t* fs);
+
+/**
+ * @brief Vuelca a flash los paquetes más antiguos de un suscriptor si su
+ * retraso supera el umbral alto
+ *
+ * @param sub Suscriptor cuyo retraso se vuelca (sus paquetes se confirman como leídos)
+ * @return uint32_t Paquetes volcados
+ *
+ * @details Si la cola alcanza TELEM_SPILL_MAX_SEGMENTS o falla la escritura,
+ * los paquetes restantes se quedan en RAM y sigue aplicando la política de
+ * desbordamiento del buffer.
+ */
+uint32_t telemetry_spill_offload(telemetry_subscriber_t sub);
+
+/**
+ * @brief Indica si hay paquetes en flash pendientes de reenviar
+ */
+bool telemetry_spill_pending(void);
+
+/**
+ * @brief Lee los siguientes paquetes de la cola sin consumirlos
+ *
+ * @param[out] packets Array destino
+ * @param max_count Capacidad del array
+ * @return uint32_t Paquetes leídos (0 si la cola está vacía)
+ *
+ * @details Los paquetes siguen en la cola hasta telemetry_spill_commit().
+ * Si se reinicia antes de confirmarlos se reenviarán de nuevo (entrega
+ * al menos una vez).
+ */
+uint32_t telemetry_spill_peek(telemetry_packet_t* packets, uint32_t max_count);
+
+/**
+ * @brief Confirma como reenviados los primeros count paquetes del último peek
+ *
+ * @details Borra los segmentos ya consumidos y guarda el estado en flash.
+ */
+void telemetry_spill_commit(uint32_t count);
+
+/**
+ * @brief Obtiene estadísticas de la cola
+ *
+ * @param[out] spilled Paquetes volcados a flash desde el arranque
+ * @param[out] replayed Paquetes reenviados desde flash desde el arranque
+ * @param[out] discarded Registros descartados al reenviar por estar truncados o corruptos
+ * @param[out] segments Segmentos pendientes en flash
+ */
+void telemetry_spill_get_stats(uint32_t* spilled, uint32_t* replayed, uint32_t* discarded, uint32_t* segments);
+
+#endif /* TELEMETRY_SPILL_H */
@@ -0,0 +1,204 @@
+/**
+ * @file telemetry_stats.h
+ * @brief Estadísticas incrementales por campo con resúmenes por ventana
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * El procesador pasa por telemetry_stats_update() cada paquete de sistema,
+ * potencia y temperatura, y el módulo mantiene para cada campo numérico del
+ * esquema mínimo, máximo, media y varianza (Welford) y la variación por
+ * minuto en tres ventanas: 1 min, 10 min y 1 h.
+ *
+ * Cada ventana es un anillo fijo de TELEM_STATS_BUCKETS cubetas de W/B
+ * (10 s, 100 s y 10 min con 6). Un paquete actualiza solo la cubeta de su
+ * instante en cada ventana, así que el coste es O(1) y la memoria no
+ * depende del ritmo de muestreo. Una cubeta guarda su época (instante /
+ * ancho) y vale mientras la época sea la de la ventana consultada: las
+ * cubetas que se saltan en un hueco no hay que limpiarlas, se reutilizan
+ * al volver a tocarles. Las cubetas se combinan al consultar con la fórmula
+ * de Chan para la media y la varianza.
+ *
+ * - telemetry_stats_get(): valores deslizantes de las últimas B cubetas
+ * - Resúmenes: al cruzar un límite de ventana (múltiplos de 1 min, 10 min
+ *   y 1 h del reloj de los paquetes), antes de contar la muestra nueva, se
+ *   entrega un stats_summary_telem_t por campo con la ventana cerrada
+ *
+ * El tiempo es header.timestamp en ms (tick de FreeRTOS de 1 ms, el de
+ * Arduino-ESP32). Los campos enteros con decimales se resumen en unidades
+ * físicas (temperaturas en °C, no en décimas).
+ *
+ * Con TELEM_STATS_DOWNLINK=1 los resúmenes se guardan en el buffer como
+ * cualquier paquete y, cuando el enlace va por detrás, el transmisor deja
+ * de bajar las muestras antiguas de los tipos resumidos: las que tienen al
+ * menos TELEM_STATS_SCARCE_BACKLOG paquetes más recientes pendientes se
+ * confirman sin enviarlas (telemetry_stats_replaces()). Los resúmenes bajan
+ * siempre, y las muestras más recientes también, así que en tierra se
+ * conserva el último valor de cada campo y la estadística de todo lo
+ * demás. bridge/frame_decoder/stats_summary.cpp compara el ahorro del
+ * enlace y la exactitud frente al cálculo en dos pasadas.
+ *
+ * El módulo no depende de Arduino.
+ */
+
+#ifndef TELEMETRY_STATS_H
+#define TELEMETRY_STATS_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_types.h"
+
+/** @brief 1 = el procesador calcula las estadísticas y emite los resúmenes */
+#ifndef TELEM_STATS_ENGINE
+#define TELEM_STATS_ENGINE 1
+#endif
+
+/**
+ * @brief Cubetas del anillo de cada ventana
+ *
+ * @details Resolución de la ventana deslizante de telemetry_stats_get().
+ * Debe dividir 60000 para que las cubetas caigan en segundos exactos.
+ */
+#ifndef TELEM_STATS_BUCKETS
+#define TELEM_STATS_BUCKETS 6
+#endif
+
+/**
+ * @brief 1 = los resúmenes se bajan a tierra y sustituyen al retraso antiguo
+ *
+ * @details 0: los resúmenes solo se registran en el log del procesador.
+ * Requiere el buffer con mutex (no TELEM_STORAGE_LOCKFREE): el procesador
+ * pasa a ser también productor.
+ */
+#ifndef TELEM_STATS_DOWNLINK
+#define TELEM_STATS_DOWNLINK 0
+#endif
+
+/** @brief Paquetes más recientes pendientes a partir de los cuales una muestra resumida no se baja */
+#ifndef TELEM_STATS_SCARCE_BACKLOG
+#define TELEM_STATS_SCARCE_BACKLOG 64
+#endif
+
+/** @brief Prioridad máxima de las muestras que se sustituyen (telem_priority_t) */
+#ifndef TELEM_STATS_REPLACE_MAX_PRIORITY
+#define TELEM_STATS_REPLACE_MAX_PRIORITY TELEM_PRIORITY_HIGH
+#endif
+
+/** @brief Ventanas: 1 min, 10 min y 1 h */
+#define TELEM_STATS_WINDOW_COUNT 3
+
+/** @brief Tipos resumidos: sistema, potencia y temperatura */
+#define TELEM_STATS_SOURCE_COUNT 3
+
+/** @brief Campos por tipo resumido (el mayor de los tres esquemas) */
+#define TELEM_STATS_MAX_FIELDS 7
+
+/** @brief Resúmenes que puede entregar un solo paquete (todas las ventanas a la vez) */
+#define TELEM_STATS_MAX_EMIT (TELEM_STATS_MAX_FIELDS * TELEM_STATS_WINDOW_COUNT)
+
+/**
+ * @brief Acumulador de un campo en una cubeta
+ */
+typedef struct {
+  float mean;     /**< Media (Welford) */
+  float m2;       /**< Suma de cuadrados de las desviaciones (Welford) */
+  float min;
+  float max;
+  float first;    /**< Primer valor de la cubeta (variación por minuto) */
+} telemetry_stats_acc_t;
+
+/**
+ * @brief Cubeta de una ventana
+ */
+typedef struct {
+  uint32_t epoch;       /**< Instante / ancho de la cubeta */
+  uint32_t first_ms;    /**< Instante de la primera muestra */
+  uint16_t count;       /**< Muestras (0 = vacía) */
+  telemetry_stats_acc_t acc[TELEM_STATS_MAX_FIELDS];
+} telemetry_stats_bucket_t;
+
+/**
+ * @brief Estado de un tipo resumido
+ */
+typedef struct {
+  telemetry_stats_bucket_t buckets[TELEM_STATS_WINDOW_COUNT][TELEM_STATS_BUCKETS];
+  float last[TELEM_STATS_MAX_FIELDS];   /**< Última muestra de cada campo */
+  uint32_t last_ms;                     /**< Instante de la última muestra */
+  uint32_t samples;                     /**< Muestras desde el arranque */
+  bool started;                         /**< Hay al menos una muestra */
+} telemetry_stats_source_t;
+
+/**
+ * @brief Recibe cada resumen (paquete TELEM_STATS_SUMMARY completo)
+ */
+typedef void (*telemetry_stats_emit_t)(void* ctx, const telemetry_packet_t* summary);
+
+/**
+ * @brief Motor de estadísticas
+ */
+typedef struct {
+  telemetry_stats_source_t sources[TELEM_STATS_SOURCE_COUNT];
+  telemetry_stats_emit_t emit;    /**< Destino de los resúmenes (NULL = ninguno) */
+  void* ctx;                      /**< Contexto de emit */
+  uint16_t sequence;              /**< Secuencia de los resúmenes */
+  uint32_t updates;               /**< Paquetes contados */
+  uint32_t summaries;             /**< Resúmenes emitidos */
+  uint32_t restarts;              /**< Reinicios por reloj que retrocede */
+} telemetry_stats_t;
+
+/**
+ * @brief Inicializa el motor sin muestras
+ *
+ * @param emit Destino de los resúmenes (NULL = solo consultas)
+ * @param ctx Contexto de emit
+ */
+void telemetry_stats_init(telemetry_stats_t* stats, telemetry_stats_emit_t emit, void* ctx);
+
+/**
+ * @brief Duración de una ventana
+ *
+ * @param window 0..TELEM_STATS_WINDOW_COUNT-1
+ * @return uint16_t Segundos (0 si la ventana no existe)
+ */
+uint16_t telemetry_stats_window_s(uint8_t window);
+
+/**
+ * @brief Indica si un tipo se resume
+ */
+bool telemetry_stats_summarizes(telem_data_type_t type);
+
+/**
+ * @brief Cuenta un paquete en todas las ventanas
+ *
+ * @details Si el paquete cruza el límite de alguna ventana, antes se
+ * emiten los resúmenes de la ventana cerrada. Si el reloj retrocede
+ * (reinicio, desbordamiento del tick) el tipo vuelve a empezar sin emitir.
+ *
+ * @return false Si el tipo no se resume
+ */
+bool telemetry_stats_update(telemetry_stats_t* stats, const telemetry_packet_t* packet);
+
+/**
+ * @brief Estadística deslizante de un campo: las últimas TELEM_STATS_BUCKETS cubetas
+ *
+ * @param type Tipo resumido
+ * @param field Índice del campo en el esquema del tipo
+ * @param window 0..TELEM_STATS_WINDOW_COUNT-1
+ * @param now_ms Instante de la consulta (mismo reloj que header.timestamp)
+ * @param[out] out Resumen (header.type = TELEM_STATS_SUMMARY, timestamp = now_ms)
+ * @return false Si no hay muestras en la ventana
+ */
+bool telemetry_stats_get(const telemetry_stats_t* stats, telem_data_type_t type, uint8_t field, uint8_t window,
+                         uint32_t now_ms, stats_summary_telem_t* out);
+
+/**
+ * @brief Decide si el transmisor sustituye una muestra por los resúmenes
+ *
+ * @param header Encabezado del paquete
+ * @param newer Paquetes más recientes que él pendientes de bajar
+ * @return true Si es una muestra resumida de prioridad <= TELEM_STATS_REPLACE_MAX_PRIORITY
+ * con al menos TELEM_STATS_SCARCE_BACKLOG paquetes más recientes
+ */
+bool telemetry_stats_replaces(const telem_header_t* header, uint32_t newer);
+
+#endif /* TELEMETRY_STATS_H */
@@ -15,6 +15,21 @@
  * - Manejo eficiente de condiciones de buffer lleno
  * - Estadísticas de uso y pérdida de paquetes
  * - Timeout configurable para operaciones de mutex
+ * - Modo alternativo SPSC sin bloqueo (TELEM_STORAGE_LOCKFREE)
+ * - Difusión a varios consumidores: cada suscriptor tiene su propio cursor
+ *   de lectura y los datos se almacenan una sola vez
+ * - Operaciones por lotes con una única sincronización por lote
+ * - Acceso sin copia: reserva/confirmación de slots para el productor y
+ *   peek/release para los consumidores
+ * - Vías por prioridad opcionales (TELEM_STORAGE_PRIORITY_LANES), cada una
+ *   con su capacidad y sus contadores, servidas en orden estricto o ponderado
+ * - Política de desbordamiento configurable y pérdidas desglosadas por tipo
+ * - Consultas de estado y estadísticas sin tomar el mutex, e instrumentación
+ *   (máximo de ocupación, histograma, espera y timeouts del mutex)
+ * - Tabla del último valor de cada tipo, legible en O(1) sin bloquear al
+ *   productor ni consumir paquetes (seqlock)
+ * - Aviso a los consumidores al publicar (telemetry_set_wake()), en lugar
+ *   de que sondeen el buffer
  * 
  * @see https://github.com/CDFER/Ring-Buffer-Demo-ESP32-Arduino
  * @see https://www.youtube.com/watch?v=09HHWATPcwY
@@ -28,6 +43,7 @@
   #include "freertos/semphr.h"
   #include "freertos/task.h"
   #include "telemetry_types.h"
+  #include "telemetry_wake.h"
 
 
 /** @brief Capacidad máxima del buffer circular en número de paquetes */
@@ -36,21 +52,235 @@
 /** @brief Tamaño en bytes de cada paquete de telemetría */
 #define TELEM_PACKET_SIZE sizeof(telemetry_packet_t)
 
+/**
+ * @brief Modo de sincronización del buffer (seleccionable en compilación)
+ *
+ * @details
+ * - 0: mutex de FreeRTOS (por defecto). Admite varios productores y consumidores.
+ * - 1: SPSC sin bloqueo. Los índices de escritura/lectura se publican con
+ *   semántica acquire/release y ninguna operación puede quedarse esperando
+ *   por un mutex (sin inversión de prioridad).
+ *
+ * @warning En modo SPSC solo puede existir UNA tarea productora, y cada
+ * suscriptor (cursor) debe ser consumido por UNA sola tarea.
+ *
+ * Ejemplo en platformio.ini: build_flags = -DTELEM_STORAGE_LOCKFREE=1
+ */
+#ifndef TELEM_STORAGE_LOCKFREE
+#define TELEM_STORAGE_LOCKFREE 0
+#endif
+
+/** @brief Número máximo de consumidores con cursor propio */
+#ifndef TELEM_MAX_SUBSCRIBERS
+#define TELEM_MAX_SUBSCRIBERS 4
+#endif
+
+/** @brief Identificador de suscriptor (índice de cursor) */
+typedef int8_t telemetry_subscriber_t;
+
+/** @brief Valor devuelto cuando no se puede registrar un suscriptor */
+#define TELEM_INVALID_SUBSCRIBER ((telemetry_subscriber_t)-1)
+
+/**
+ * @brief Comportamiento del productor frente a un suscriptor lento
+ */
+typedef enum {
+  TELEM_SUB_BLOCKING = 0,   /**< Frena al productor: con el buffer lleno se descarta el paquete nuevo */
+  TELEM_SUB_EVICTABLE       /**< Se le desaloja: pierde su paquete más antiguo y el productor continúa */
+} telem_subscriber_policy_t;
+
+/**
+ * @brief Vías por prioridad (seleccionable en compilación)
+ *
+ * @details Con TELEM_STORAGE_PRIORITY_LANES=1 el buffer se divide en una vía
+ * por valor de telem_header_t.priority (ver telem_priority_t), cada una con su
+ * propia capacidad y contadores de pérdida. Así un atasco de telemetría
+ * rutinaria no llena el espacio de la telemetría crítica. Con 0 (por defecto)
+ * existe una única vía FIFO con todo el buffer.
+ *
+ * Ejemplo en platformio.ini: build_flags = -DTELEM_STORAGE_PRIORITY_LANES=1
+ */
+#ifndef TELEM_STORAGE_PRIORITY_LANES
+#define TELEM_STORAGE_PRIORITY_LANES 0
+#endif
+
+#if TELEM_STORAGE_PRIORITY_LANES
+/** @brief Número de vías (una por prioridad) */
+#define TELEM_LANE_COUNT 3
+#else
+#define TELEM_LANE_COUNT 1
+#endif
+
+/** @brief Capacidad de cada vía en paquetes (la suma no debe superar TELEM_BUFFER_SIZE) */
+#ifndef TELEM_LANE_CAPACITY_LOW
+#define TELEM_LANE_CAPACITY_LOW 256
+#endif
+#ifndef TELEM_LANE_CAPACITY_NORMAL
+#define TELEM_LANE_CAPACITY_NORMAL 512
+#endif
+#ifndef TELEM_LANE_CAPACITY_HIGH
+#define TELEM_LANE_CAPACITY_HIGH 256
+#endif
+
+/** @brief Paquetes consecutivos que sirve cada vía por turno en modo ponderado */
+#ifndef TELEM_LANE_WEIGHT_LOW
+#define TELEM_LANE_WEIGHT_LOW 1
+#endif
+#ifndef TELEM_LANE_WEIGHT_NORMAL
+#define TELEM_LANE_WEIGHT_NORMAL 2
+#endif
+#ifndef TELEM_LANE_WEIGHT_HIGH
+#define TELEM_LANE_WEIGHT_HIGH 4
+#endif
+
+/**
+ * @brief Qué paquete se pierde cuando una vía está llena y un suscriptor
+ * bloqueante retiene su paquete más antiguo
+ *
+ * @details Si la cola solo la retienen suscriptores desalojables, siempre se
+ * les desaloja el paquete más antiguo; la política decide el caso en el que
+ * antes se descartaba sin más el paquete nuevo.
+ */
+typedef enum {
+  TELEM_OVERFLOW_DROP_NEWEST = 0,       /**< Se descarta el paquete nuevo (comportamiento clásico) */
+  TELEM_OVERFLOW_OVERWRITE_OLDEST,      /**< Se sobrescribe el más antiguo, también para los bloqueantes */
+  TELEM_OVERFLOW_EVICT_LOWEST_PRIORITY, /**< Se elimina el más antiguo de menor prioridad si no supera la del nuevo */
+  TELEM_OVERFLOW_KEEP_LATEST_PER_TYPE   /**< Se elimina el más antiguo de un tipo con más de TELEM_KEEP_LATEST_PER_TYPE retenidos */
+} telem_overflow_policy_t;
+
+/** @brief Política de desbordamiento inicial (modificable con telemetry_set_overflow_policy()) */
+#ifndef TELEM_OVERFLOW_POLICY
+#define TELEM_OVERFLOW_POLICY TELEM_OVERFLOW_DROP_NEWEST
+#endif
+
+/** @brief Paquetes más recientes de cada tipo protegidos por TELEM_OVERFLOW_KEEP_LATEST_PER_TYPE */
+#ifndef TELEM_KEEP_LATEST_PER_TYPE
+#define TELEM_KEEP_LATEST_PER_TYPE 8
+#endif
+
+/**
+ * @brief Paquetes más antiguos de la vía entre los que se busca la víctima
+ *
+ * @details Eliminar un paquete que no es el más antiguo obliga a desplazar
+ * los anteriores un slot; la ventana acota ese coste. En modo
+ * TELEM_STORAGE_LOCKFREE los consumidores copian sin mutex y no se puede
+ * desplazar nada: solo es candidato el paquete más antiguo.
+ */
+#if TELEM_STORAGE_LOCKFREE
+#undef TELEM_OVERFLOW_SCAN_WINDOW
+#define TELEM_OVERFLOW_SCAN_WINDOW 1
+#elif !defined(TELEM_OVERFLOW_SCAN_WINDOW)
+#define TELEM_OVERFLOW_SCAN_WINDOW 32
+#endif
+
+/** @brief Reintentos de lectura de telemetry_get_latest() antes de rendirse */
+#define TELEM_LATEST_MAX_RETRIES 8
+
+/** @brief Tramos de vía distintos por lote (en modo ponderado acota telemetry_retrieve_batch()/telemetry_peek_batch()) */
+#define TELEM_PEEK_MAX_RUNS 16
+
+/** @brief Slots que puede reservar el productor en una misma reserva */
+#define TELEM_MAX_RESERVATION 8
+
+/**
+ * @brief Orden de servicio entre vías para un suscriptor
+ */
+typedef enum {
+  TELEM_LANE_STRICT = 0,    /**< Siempre la vía de mayor prioridad con datos */
+  TELEM_LANE_WEIGHTED       /**< Round robin ponderado por TELEM_LANE_WEIGHT_* */
+} telem_lane_scheduling_t;
+
+/**
+ * @brief Anillo de una vía dentro del array común de paquetes
+ */
+typedef struct {
+  uint32_t base;              /**< Primer slot de la vía dentro de buffer[] */
+  uint32_t capacity;          /**< Slots de la vía (uno queda libre para indicar lleno) */
+  uint32_t write_index;       /**< Índice de escritura actual (solo lo modifica el productor) */
+  uint32_t tail_index;        /**< Paquete retenido más antiguo (solo lo modifica el productor) */
+  uint32_t reserved_count;    /**< Slots reservados por el productor pendientes de confirmar */
+  uint32_t packets_written;   /**< Paquetes escritos en esta vía */
+  uint32_t packets_lost;      /**< Paquetes rechazados en esta vía */
+} telemetry_lane_t;
+
+/**
+ * @brief Cursor de lectura independiente de un suscriptor
+ */
+typedef struct {
+  uint32_t read_index[TELEM_LANE_COUNT];  /**< Siguiente paquete a leer por vía (lo avanza el suscriptor, o el productor al desalojar) */
+  uint32_t peek_index[TELEM_LANE_COUNT];  /**< Posición por vía del último peek pendiente de confirmar */
+  uint8_t peek_run_lane[TELEM_PEEK_MAX_RUNS];   /**< Vía de cada tramo del último telemetry_peek_batch() */
+  uint16_t peek_run_count[TELEM_PEEK_MAX_RUNS]; /**< Paquetes de cada tramo */
+  uint8_t peek_runs;          /**< Tramos válidos del último telemetry_peek_batch() */
+  uint8_t peek_lane;          /**< Vía del paquete devuelto por telemetry_peek() */
+  uint8_t rr_lane;            /**< Vía con el turno en modo ponderado */
+  uint8_t rr_credit[TELEM_LANE_COUNT]; /**< Paquetes que le quedan a cada vía en su turno */
+  uint8_t scheduling;         /**< Orden de servicio entre vías (telem_lane_scheduling_t) */
+  uint32_t packets_read;      /**< Paquetes leídos por este suscriptor */
+  uint32_t packets_overrun;   /**< Paquetes que este suscriptor perdió por desalojo */
+  uint8_t policy;             /**< Política ante buffer lleno (telem_subscriber_policy_t) */
+  bool active;                /**< Cursor en uso */
+  bool peeking;               /**< Hay un telemetry_peek() sin liberar: no se le desaloja */
+  telemetry_wake_t* wake;     /**< Aviso de paquetes nuevos (NULL = el suscriptor sondea) */
+} telemetry_cursor_t;
+
+/**
+ * @brief Último paquete almacenado de un tipo, protegido por un seqlock
+ *
+ * @details El productor incrementa `sequence` antes y después de copiar el
+ * paquete: un valor impar indica escritura en curso. Los lectores copian el
+ * paquete y repiten si la secuencia cambió entre medias, sin tomar el mutex
+ * ni frenar nunca al productor.
+ */
+typedef struct {
+  uint32_t sequence;            /**< Contador del seqlock (0 = nunca escrito) */
+  telemetry_packet_t packet;    /**< Copia del último paquete de este tipo */
+} telemetry_latest_t;
+
+/**
+ * @brief Instrumentación del buffer
+ *
+ * @details Todos los campos se actualizan con operaciones atómicas y se leen
+ * sin tomar el mutex. La ocupación se muestrea tras cada escritura del
+ * productor. En modo TELEM_STORAGE_LOCKFREE no hay mutex y los campos lock_*
+ * quedan a cero.
+ */
+typedef struct {
+  uint32_t high_water;          /**< Máximo de paquetes retenidos desde el arranque */
+  uint32_t occupancy_samples[TELEM_OCCUPANCY_BINS]; /**< Muestras por intervalo de ocupación */
+  uint32_t lock_acquired;       /**< Veces que se obtuvo el mutex */
+  uint32_t lock_timeouts;       /**< Veces que expiró el timeout del mutex */
+  uint32_t lock_wait_total_us;  /**< Espera acumulada por el mutex (µs, con desbordamiento) */
+  uint32_t lock_wait_max_us;    /**< Espera máxima por el mutex (µs) */
+} telemetry_storage_metrics_t;
+
 /**
  * @brief Estructura principal del buffer circular de telemetría
  *
  * @details Esta estructura mantiene el estado completo del buffer circular,
- * incluyendo los datos almacenados, índices de lectura/escritura, contadores
- * estadísticos y el mutex para sincronización.
+ * incluyendo los datos almacenados, los índices de cada vía, un cursor de
+ * lectura por suscriptor, contadores estadísticos y el mutex para sincronización.
+ *
+ * Cada paquete se almacena una única vez y permanece en el buffer hasta que
+ * todos los suscriptores lo han leído (o han sido desalojados). La cola
+ * `tail_index` de cada vía marca su paquete retenido más antiguo.
  */
 typedef struct {
-  telemetry_packet_t buffer[TELEM_BUFFER_SIZE];  /**< Array circular de paquetes */
-  uint32_t write_index;                          /**< Índice de escritura actual */
-  uint32_t read_index;                           /**< Índice de lectura actual */
+  telemetry_packet_t buffer[TELEM_BUFFER_SIZE];  /**< Array de paquetes repartido entre las vías */
+  telemetry_lane_t lanes[TELEM_LANE_COUNT];      /**< Anillo de cada vía (índice = prioridad) */
+  telemetry_cursor_t subscribers[TELEM_MAX_SUBSCRIBERS]; /**< Cursores de lectura por suscriptor */
+  uint8_t reservation_size;                      /**< Slots solicitados en la reserva en curso */
   uint32_t packets_written;                      /**< Total de paquetes escritos */
-	uint32_t packets_read;                         /**< Total de paquetes leídos */
-  uint32_t packets_lost;                         /**< Paquetes perdidos por buffer lleno */
+  uint32_t packets_read;                         /**< Total de lecturas (suma de todos los suscriptores) */
+  uint32_t packets_lost;                         /**< Paquetes perdidos por buffer lleno o timeout del mutex */
+  uint32_t packets_written_by_type[TELEM_DATA_TYPE_COUNT]; /**< Escritos desglosados por telem_data_type_t (mezcla real) */
+  uint32_t packets_lost_by_type[TELEM_DATA_TYPE_COUNT]; /**< Pérdidas desglosadas por telem_data_type_t */
+  uint8_t overflow_policy;                       /**< Política ante vía llena (telem_overflow_policy_t) */
+  telemetry_latest_t latest[TELEM_DATA_TYPE_COUNT]; /**< Último valor de cada tipo */
+  telemetry_storage_metrics_t metrics;           /**< Instrumentación */
+#if !TELEM_STORAGE_LOCKFREE
   SemaphoreHandle_t mutex;                       /**< Mutex para sincronización */
+#endif
 } telemetry_buffer_t;
 
 /**
@@ -69,6 +299,8 @@ void telemetry_storage_init(void);
  * @return false Si el buffer está lleno o hay error de sincronización
  * 
  * @note Esta función es segura y puede ser llamada desde cualquier tarea
+ * (en modo TELEM_STORAGE_LOCKFREE, solo desde la tarea productora). Todo
+ * paquete rechazado, también por timeout del mutex, cuenta como perdido.
  */
 bool telemetry_store_packet(const telemetry_packet_t* packet);
 
@@ -79,17 +311,196 @@ bool telemetry_store_packet(const telemetry_packet_t* packet);
  * @return true Si se recuperó un paquete correctamente
  * @return false Si el buffer está vacío o hay error de sincronización
  * 
+ * @details Lee a través de un suscriptor por defecto (TELEM_SUB_BLOCKING)
+ * que se registra en la primera llamada. Todas las tareas que usan esta
+ * función comparten ese cursor, de modo que cada paquete lo recibe solo
+ * una de ellas; para recibir todos los paquetes use telemetry_subscribe().
+ *
  * @note Esta función es segura y puede ser llamada desde cualquier tarea
+ * (en modo TELEM_STORAGE_LOCKFREE, solo desde la tarea consumidora)
  */
 bool telemetry_retrieve_packet(telemetry_packet_t* packet);
 
 /**
- * @brief Obtiene el número de paquetes disponibles para lectura
+ * @brief Registra un nuevo consumidor con cursor de lectura propio
+ *
+ * @param policy Comportamiento cuando este suscriptor retiene el buffer lleno
+ * @return telemetry_subscriber_t Identificador del suscriptor, o
+ * TELEM_INVALID_SUBSCRIBER si no quedan cursores libres
+ *
+ * @details El cursor empieza en el paquete retenido más antiguo, de modo que
+ * el suscriptor recibe también lo almacenado antes de registrarse. El
+ * productor solo queda limitado por el suscriptor TELEM_SUB_BLOCKING más lento.
+ *
+ * @note Requiere telemetry_storage_init() previo.
+ */
+telemetry_subscriber_t telemetry_subscribe(telem_subscriber_policy_t policy);
+
+/**
+ * @brief Da de baja un suscriptor y libera su cursor
+ *
+ * @param sub Identificador devuelto por telemetry_subscribe()
+ */
+void telemetry_unsubscribe(telemetry_subscriber_t sub);
+
+/**
+ * @brief Recupera el siguiente paquete pendiente para un suscriptor
+ *
+ * @param sub Identificador del suscriptor
+ * @param packet Puntero donde se almacenará el paquete leído
+ * @return true Si se recuperó un paquete correctamente
+ * @return false Si no hay paquetes pendientes, el suscriptor no es válido
+ * o hay error de sincronización
+ */
+bool telemetry_retrieve_packet_for(telemetry_subscriber_t sub, telemetry_packet_t* packet);
+
+/**
+ * @brief Almacena varios paquetes con una única sincronización
+ *
+ * @param packets Array de paquetes a almacenar
+ * @param count Número de paquetes del array
+ * @return uint32_t Paquetes almacenados (los primeros del array); el resto
+ * se contabiliza como perdido
+ *
+ * @details Copia el lote en como máximo dos tramos contiguos del buffer
+ * (antes y después del punto de vuelta). Los sellos de latencia de la
+ * cabecera se ponen al publicar; si acquired_us llega a 0 la adquisición
+ * cuenta desde ese momento (ver telemetry_latency.h).
+ */
+uint32_t telemetry_store_batch(const telemetry_packet_t* packets, uint32_t count);
+
+/**
+ * @brief Recupera hasta max_count paquetes de un suscriptor con una única sincronización
+ *
+ * @param sub Identificador del suscriptor
+ * @param[out] packets Array destino (capacidad mínima max_count)
+ * @param max_count Número máximo de paquetes a recuperar
+ * @return uint32_t Paquetes recuperados (0 si no hay pendientes)
+ */
+uint32_t telemetry_retrieve_batch(telemetry_subscriber_t sub, telemetry_packet_t* packets, uint32_t max_count);
+
+/**
+ * @brief Copia hasta max_count paquetes pendientes sin consumirlos
+ *
+ * @param sub Identificador del suscriptor
+ * @param[out] packets Array destino (capacidad mínima max_count)
+ * @param max_count Número máximo de paquetes a copiar
+ * @return uint32_t Paquetes copiados
+ *
+ * @details Los paquetes siguen pendientes hasta telemetry_commit_batch(),
+ * lo que permite confirmarlos solo cuando se han transmitido.
+ */
+uint32_t telemetry_peek_batch(telemetry_subscriber_t sub, telemetry_packet_t* packets, uint32_t max_count);
+
+/**
+ * @brief Confirma como leídos los primeros count paquetes del último peek
+ *
+ * @param sub Identificador del suscriptor
+ * @param count Paquetes a confirmar (como máximo los devueltos por el peek)
+ *
+ * @details Si el suscriptor fue desalojado entre el peek y la confirmación,
+ * los paquetes ya desalojados no se descuentan dos veces.
+ */
+void telemetry_commit_batch(telemetry_subscriber_t sub, uint32_t count);
+
+/**
+ * @brief Reserva slots del buffer para rellenarlos directamente (sin copia)
+ *
+ * @param headers Tipo y prioridad de cada slot (la prioridad decide su vía,
+ * el tipo la contabilidad de pérdidas); NULL = tipo desconocido y TELEM_PRIORITY_NORMAL
+ * @param[out] slots Punteros a los slots reservados (NULL si su vía está llena)
+ * @param count Número de slots solicitados (máximo TELEM_MAX_RESERVATION)
+ * @return uint32_t Slots reservados; los no reservados cuentan como perdidos
+ *
+ * @details Los slots no son visibles para los consumidores hasta
+ * telemetry_commit_slots(). Tras una reserva con resultado distinto de 0 es
+ * obligatorio llamar a telemetry_commit_slots() o telemetry_cancel_slots().
+ * La cabecera escrita en cada slot debe llevar el tipo y la prioridad con los
+ * que se reservó, y conservar el sello acquired_us que pone la reserva.
+ *
+ * @note En modo mutex, el mutex permanece tomado entre la reserva y la
+ * confirmación: el relleno de los slots debe ser breve.
+ */
+uint32_t telemetry_reserve_slots(const telem_header_t* headers, telemetry_packet_t** slots, uint32_t count);
+
+/**
+ * @brief Publica todos los slots de la reserva en curso
+ */
+void telemetry_commit_slots(void);
+
+/**
+ * @brief Descarta la reserva en curso sin publicar nada
+ */
+void telemetry_cancel_slots(void);
+
+/**
+ * @brief Reserva un único slot para rellenarlo en el sitio
+ *
+ * @param type Tipo del paquete que se escribirá
+ * @param priority Prioridad del paquete que se escribirá (telem_priority_t)
+ * @return telemetry_packet_t* Slot reservado, o NULL si su vía está llena
+ */
+telemetry_packet_t* telemetry_reserve_slot(telem_data_type_t type, uint8_t priority);
+
+/**
+ * @brief Publica el slot reservado con telemetry_reserve_slot()
+ */
+void telemetry_commit_slot(void);
+
+/**
+ * @brief Actualiza la tabla de últimos valores con un paquete que no entra en el buffer
+ *
+ * @param packet Paquete generado por el productor para el que no hubo slot
+ *
+ * @details Para el productor que rellena slots reservados: si la reserva no
+ * le da slot (vía llena o timeout del mutex), genera el paquete en su propia
+ * memoria y lo publica aquí, de modo que telemetry_get_latest() no se congela
+ * mientras el buffer está lleno. No debe llamarse con una reserva abierta.
+ */
+void telemetry_update_latest(const telemetry_packet_t* packet);
+
+/**
+ * @brief Accede sin copia al siguiente paquete pendiente de un suscriptor
+ *
+ * @param sub Identificador del suscriptor
+ * @return const telemetry_packet_t* Paquete dentro del buffer, o NULL si no hay pendientes
+ *
+ * @details El paquete sigue pendiente hasta telemetry_release(). Mientras
+ * tanto el suscriptor no puede ser desalojado, por lo que se comporta como
+ * bloqueante si retiene el buffer lleno.
+ */
+const telemetry_packet_t* telemetry_peek(telemetry_subscriber_t sub);
+
+/**
+ * @brief Libera el paquete obtenido con telemetry_peek() y avanza el cursor
+ *
+ * @param sub Identificador del suscriptor
+ * @return true Si el paquete siguió siendo válido durante todo el acceso
+ * @return false Si fue desalojado mientras se leía (solo posible en modo
+ * TELEM_STORAGE_LOCKFREE): los datos leídos deben descartarse
+ */
+bool telemetry_release(telemetry_subscriber_t sub);
+
+/**
+ * @brief Obtiene el número de paquetes retenidos en el buffer
  * 
- * @return uint32_t Número de paquetes almacenados en el buffer
+ * @return uint32_t Paquetes pendientes para el suscriptor más retrasado
+ *
+ * @note Esta y las demás consultas de estado y estadísticas no toman el
+ * mutex: leen índices y contadores atómicos, así que pueden llamarse en cada
+ * paquete sin competir con el productor. Con otras tareas operando a la vez
+ * el resultado es una instantánea que puede quedar desfasada enseguida.
  */
 uint32_t telemetry_available_packets(void);
 
+/**
+ * @brief Obtiene el número de paquetes pendientes para un suscriptor
+ *
+ * @param sub Identificador del suscriptor
+ * @return uint32_t Paquetes aún no leídos por ese suscriptor
+ */
+uint32_t telemetry_available_packets_for(telemetry_subscriber_t sub);
+
 /**
  * @brief Obtiene el espacio libre en el buffer
  * 
@@ -104,9 +515,111 @@ uint32_t telemetry_free_space(void);
  * @param[out] read Puntero donde se almacenará el total de paquetes leídos
  * @param[out] lost Puntero donde se almacenará el total de paquetes perdidos
  * 
- * @note Los paquetes se consideran perdidos cuando el buffer está lleno y
- * no se pueden almacenar nuevos datos
+ * @note Los paquetes se consideran perdidos cuando el buffer está lleno o
+ * el mutex no se obtuvo a tiempo y no se pudieron almacenar nuevos datos,
+ * o cuando la política de desbordamiento elimina un paquete que algún
+ * suscriptor bloqueante no había leído
  */
 void telemetry_get_stats(uint32_t* written, uint32_t* read, uint32_t* lost);
 
+/**
+ * @brief Obtiene el último paquete almacenado de un tipo (estado actual)
+ *
+ * @param type Tipo de telemetría
+ * @param[out] packet Copia del último paquete de ese tipo
+ * @return true Si hay un valor válido
+ * @return false Si nunca se almacenó ese tipo, o si el productor lo
+ * reescribió continuamente durante TELEM_LATEST_MAX_RETRIES intentos
+ *
+ * @details No toma el mutex ni consume paquetes del buffer: coste constante.
+ * Se actualiza con cada paquete que llega a telemetry_store_batch() o
+ * telemetry_commit_slots(), incluso si el buffer lo descarta por estar lleno,
+ * y con los que el productor no pudo reservar (telemetry_update_latest()).
+ */
+bool telemetry_get_latest(telem_data_type_t type, telemetry_packet_t* packet);
+
+/**
+ * @brief Obtiene los paquetes perdidos de un tipo concreto
+ *
+ * @param type Tipo de telemetría
+ * @return uint32_t Paquetes de ese tipo descartados o eliminados por desbordamiento
+ */
+uint32_t telemetry_get_lost_by_type(telem_data_type_t type);
+
+/**
+ * @brief Obtiene los paquetes escritos de un tipo concreto
+ *
+ * @param type Tipo de telemetría
+ * @return uint32_t Paquetes de ese tipo almacenados en el buffer desde el arranque
+ */
+uint32_t telemetry_get_written_by_type(telem_data_type_t type);
+
+/**
+ * @brief Cambia la política de desbordamiento en tiempo de ejecución
+ *
+ * @param policy Nueva política (ver telem_overflow_policy_t)
+ */
+void telemetry_set_overflow_policy(telem_overflow_policy_t policy);
+
+/**
+ * @brief Selecciona el orden de servicio entre vías de un suscriptor
+ *
+ * @param sub Identificador del suscriptor
+ * @param scheduling TELEM_LANE_STRICT (por defecto) o TELEM_LANE_WEIGHTED
+ *
+ * @note Sin TELEM_STORAGE_PRIORITY_LANES solo hay una vía y no tiene efecto.
+ */
+void telemetry_set_lane_scheduling(telemetry_subscriber_t sub, telem_lane_scheduling_t scheduling);
+
+/**
+ * @brief Asocia un aviso de paquetes nuevos a un suscriptor
+ *
+ * @param sub Identificador del suscriptor
+ * @param wake Aviso ya preparado con telemetry_wake_init() (NULL lo quita)
+ *
+ * @details Cada publicación (telemetry_store_batch(), telemetry_commit_slots())
+ * llama a telemetry_wake_signal() con los paquetes publicados, después de
+ * soltar el mutex para que el consumidor no despierte solo para esperarlo.
+ */
+void telemetry_set_wake(telemetry_subscriber_t sub, telemetry_wake_t* wake);
+
+/**
+ * @brief Obtiene estadísticas de una vía de prioridad
+ *
+ * @param lane Vía (igual a la prioridad; 0 si no hay vías)
+ * @param[out] written Paquetes escritos en la vía
+ * @param[out] lost Paquetes rechazados en la vía
+ * @param[out] retained Paquetes retenidos actualmente en la vía
+ */
+void telemetry_get_lane_stats(uint8_t lane, uint32_t* written, uint32_t* lost, uint32_t* retained);
+
+/**
+ * @brief Obtiene estadísticas de un suscriptor
+ *
+ * @param sub Identificador del suscriptor
+ * @param[out] read Paquetes leídos por el suscriptor
+ * @param[out] overrun Paquetes que perdió por ser desalojado
+ */
+void telemetry_get_subscriber_stats(telemetry_subscriber_t sub, uint32_t* read, uint32_t* overrun);
+
+/**
+ * @brief Obtiene la instrumentación del buffer
+ *
+ * @param[out] metrics Copia de los contadores (ver telemetry_storage_metrics_t)
+ */
+void telemetry_get_metrics(telemetry_storage_metrics_t* metrics);
+
+/**
+ * @brief Paquetes que caben en el buffer (suma de todas las vías)
+ */
+uint32_t telemetry_capacity(void);
+
+/**
+ * @brief Rellena los datos de un paquete TELEM_STORAGE_METRICS con la
+ * instrumentación actual
+ *
+ * @param[out] packet Paquete destino (no modifica la cabecera)
+ */
+void telemetry_fill_metrics_packet(telemetry_packet_t* packet);
+
 #endif // TELEMETRY_STORAGE_H
\ No newline at end of file
@@ -13,6 +13,8 @@
  * - Recolector: Genera y almacena datos de telemetría
  * - Procesador: Procesa y visualiza los datos almacenados
  * - Transmisor: Simula el envío de datos a estación terrestre
+ * - Escritora: Saca por la UART lo que encola el transmisor
+ * - Sinks: Una por salida de telemetry_sink.h (consola, ficheros)
  * 
  * @note Las tareas están optimizadas para entorno WOKWI con intervalos
  * reducidos para facilitar la visualización durante pruebas.
@@ -23,6 +25,17 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "telemetry_sink.h"
+
+/** @brief Pila de la tarea escritora (bytes) */
+#ifndef TELEM_TXWRITER_STACK
+#define TELEM_TXWRITER_STACK 2048
+#endif
+
+/** @brief Pila de la tarea de cada sink (bytes; LittleFS necesita margen) */
+#ifndef TELEM_SINK_TASK_STACK
+#define TELEM_SINK_TASK_STACK 4096
+#endif
 
 /**
  * @brief Tarea recolectora de datos de telemetría
@@ -83,7 +96,7 @@ void vTelemetryProcessorTask(void *pvParameters);
  * - Simula ventanas de comunicación cada ~30 segundos
  * - Transmite paquetes en lotes cuando hay conectividad
  * - Implementa un mecanismo de transmisión con confirmación visual
- * - Incluye pausas entre paquetes para simular latencia de transmisión
+ * - Encola los paquetes serializados en telemetry_txbuf sin esperar a la UART
  * 
  * @note En un sistema real, esta tarea incluiría protocolos de comunicación
  * específicos (AX.25, CSP, etc.) y manejo de errores de transmisión.
@@ -93,6 +106,36 @@ void vTelemetryProcessorTask(void *pvParameters);
  */
 void vTelemetryTransmitterTask(void *pvParameters);
 
+/**
+ * @brief Tarea escritora de la UART de bajada
+ * @param pvParameters Parámetros de la tarea (no utilizados en esta implementación)
+ * 
+ * @details
+ * Vacía el buffer de telemetry_txbuf.h agrupando mensajes completos en cada
+ * Serial.write(), de modo que el enlace no se queda parado mientras el
+ * transmisor lee del buffer o de flash. Con el buffer vacío (o la salida
+ * retenida) duerme hasta que telemetry_txbuf_write() la avisa.
+ *
+ * La crea telemetry_transmission_init(), con una prioridad más que el
+ * transmisor: si se queda sin CPU, el enlace se vacía aunque haya paquetes
+ * encolados.
+ */
+void vTelemetryTxWriterTask(void *pvParameters);
+
+/**
+ * @brief Tarea de una salida de telemetry_sink.h
+ * @param pvParameters Identificador del sink (el de telemetry_sink_add(), como (void*)(intptr_t)id)
+ *
+ * @details
+ * Escribe los mensajes de la cola de su sink. Una tarea por sink: si una
+ * salida se bloquea (la flash, la UART), solo se llena su cola. Con la
+ * cola vacía duerme hasta que telemetry_sink_publish() le encola un
+ * mensaje.
+ *
+ * Las crea telemetry_logger_init(), una por cada telemetry_sink_add().
+ */
+void vTelemetrySinkTask(void *pvParameters);
+
 /**
  * @brief Handles de tareas para diagnóstico de stack
  *
@@ -103,5 +146,7 @@ void vTelemetryTransmitterTask(void *pvParameters);
 extern TaskHandle_t gTaskCollectHandle;
 extern TaskHandle_t gTaskProcessHandle;
 extern TaskHandle_t gTaskTransmitHandle;
+extern TaskHandle_t gTaskTxWriterHandle;
+extern TaskHandle_t gTaskSinkHandles[TELEM_SINK_MAX];
 
 #endif /* TELEMETRY_TASKS_H */
\ No newline at end of file
@@ -13,6 +13,58 @@
 
 #include <stdbool.h>
 #include "telemetry_types.h"
+#include "telemetry_wake.h"
+#include "telemetry_rbe.h"
+
+/**
+ * @brief Formato de bajada por Serial
+ *
+ * @details 0: una línea JSON por paquete (Fomalhaut lo lee directamente).
+ * 1: tramas binarias de telemetry_frame.h, unas 3-4 veces más cortas; en
+ * tierra bridge/frame_decoder las convierte de nuevo al mismo JSON.
+ */
+#ifndef TELEM_DOWNLINK_BINARY
+#define TELEM_DOWNLINK_BINARY 0
+#endif
+
+/**
+ * @brief Compresión delta de las tramas binarias
+ *
+ * @details Con TELEM_DOWNLINK_BINARY=1, cada paquete se envía como
+ * diferencia respecto al anterior de su tipo (telemetry_delta.h), con un
+ * fotograma clave cada TELEM_DELTA_KEYFRAME_INTERVAL paquetes. Sin efecto
+ * en modo JSON.
+ */
+#ifndef TELEM_DOWNLINK_DELTA
+#define TELEM_DOWNLINK_DELTA 0
+#endif
+
+/**
+ * @brief Retransmisión con repetición selectiva (telemetry_arq.h)
+ *
+ * @details Con TELEM_DOWNLINK_BINARY=1, las tramas llevan secuencia de
+ * enlace y se repiten hasta que tierra las confirma (bridge/frame_decoder
+ * con el puerto abierto en lectura y escritura). Sin efecto en modo JSON.
+ */
+#ifndef TELEM_DOWNLINK_ARQ
+#define TELEM_DOWNLINK_ARQ 0
+#endif
+
+/** @brief Paquetes nuevos que despiertan al transmisor */
+#ifndef TELEM_XMIT_WAKE_MIN_BATCH
+#define TELEM_XMIT_WAKE_MIN_BATCH 1
+#endif
+
+/**
+ * @brief Espera máxima entre ciclos de transmisión
+ *
+ * @details Sin paquetes nuevos el ciclo sigue corriendo con este periodo
+ * (ventanas de contacto, retransmisiones del ARQ, retraso en flash). Es el
+ * periodo fijo del transmisor con TELEM_WAKE_EVENTS=0.
+ */
+#ifndef TELEM_XMIT_WAKE_MAX_DELAY_MS
+#define TELEM_XMIT_WAKE_MAX_DELAY_MS 2000
+#endif
 
 /** 
  * @brief Inicializa el módulo de transmisión de telemetría
@@ -34,4 +86,24 @@ void telemetry_transmission_init(void);
  */
 void telemetry_transmission_cycle(void);
 
+/**
+ * @brief Duerme hasta que se publiquen paquetes o toque el siguiente ciclo
+ *
+ * @details Lo que el ciclo dejó pendiente a propósito (fuera de ventana,
+ * sin presupuesto) no despierta al transmisor: solo los paquetes nuevos.
+ */
+void telemetry_transmission_wait(void);
+
+/**
+ * @brief Aviso del transmisor (contadores para el diagnóstico)
+ */
+const telemetry_wake_t* telemetry_transmission_get_wake(void);
+
+/**
+ * @brief Estado de la bajada por excepción (contadores por tipo, telemetry_rbe.h)
+ *
+ * @return const telemetry_rbe_t* NULL con TELEM_DOWNLINK_RBE=0
+ */
+const telemetry_rbe_t* telemetry_transmission_get_rbe(void);
+
 #endif /* TELEMETRY_TRANSMISSION_H */
@@ -0,0 +1,217 @@
+/**
+ * @file telemetry_txbuf.h
+ * @brief Buffer de transmisión por la UART con tarea escritora dedicada
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * El transmisor ya no escribe en Serial: serializa cada paquete (línea JSON
+ * o trama binaria) y lo copia entero en un anillo de bytes. Una tarea
+ * escritora lo vacía agrupando en cada escritura tantos mensajes como
+ * admita la UART sin esperar (availableForWrite()), de modo que el enlace se
+ * mantiene lleno mientras haya datos y el transmisor no espera nunca a la
+ * UART, solo a que quede sitio en el anillo.
+ *
+ * Cada escritura lleva mensajes completos: los logs que otras tareas
+ * escriben directamente en Serial caen entre dos mensajes, nunca dentro de
+ * una línea JSON o de una trama.
+ *
+ * Un productor (la tarea de transmisión) y un consumidor (la escritora):
+ * los índices se publican con acquire/release como en el modo
+ * TELEM_STORAGE_LOCKFREE de telemetry_storage, sin mutex.
+ *
+ * La escritora no sondea el anillo: se registra con
+ * telemetry_txbuf_attach_writer() y duerme en telemetry_txbuf_wait_data()
+ * hasta que telemetry_txbuf_write() (o telemetry_txbuf_hold(false)) la
+ * avisa, con el mismo mecanismo de telemetry_wake.h. Del mismo modo, con
+ * el anillo lleno el productor duerme en telemetry_txbuf_wait_space() y la
+ * escritora lo despierta al liberar sitio.
+ *
+ * La salida pasa por telemetry_txbuf_port_t: en el ESP32 se usa
+ * telemetry_txbuf_port_serial(); en el host, cualquier descriptor (p. ej.
+ * un pty con la velocidad limitada, ver bridge/frame_decoder/uart_throughput.cpp).
+ */
+
+#ifndef TELEMETRY_TXBUF_H
+#define TELEMETRY_TXBUF_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+  #include "telemetry_wake.h"
+
+/** @brief Bytes del anillo de transmisión (potencia de dos) */
+#ifndef TELEM_TXBUF_BYTES
+#define TELEM_TXBUF_BYTES 4096
+#endif
+
+/** @brief Mensajes pendientes como máximo (potencia de dos) */
+#ifndef TELEM_TXBUF_MESSAGES
+#define TELEM_TXBUF_MESSAGES 64
+#endif
+
+/** @brief Longitud máxima de un mensaje */
+#define TELEM_TXBUF_MAX_MESSAGE 512
+
+/** @brief Velocidad de la UART de bajada (la misma que monitor_speed) */
+#ifndef TELEM_TXBUF_BAUD
+#define TELEM_TXBUF_BAUD 115200
+#endif
+
+/**
+ * @brief Espera máxima de la escritora sin aviso (ms)
+ *
+ * @details Solo es una red de seguridad: cada mensaje encolado la despierta.
+ */
+#ifndef TELEM_TXBUF_WRITER_IDLE_MS
+#define TELEM_TXBUF_WRITER_IDLE_MS 1000
+#endif
+
+/**
+ * @brief Espera máxima del productor sin aviso con el anillo lleno (ms)
+ *
+ * @details Red de seguridad, como TELEM_TXBUF_WRITER_IDLE_MS: cada escritura
+ * de la escritora lo despierta.
+ */
+#ifndef TELEM_TXBUF_PRODUCER_WAIT_MS
+#define TELEM_TXBUF_PRODUCER_WAIT_MS 100
+#endif
+
+/** @brief Bits en la línea por byte (8N1: inicio + 8 datos + parada) */
+#define TELEM_TXBUF_BITS_PER_BYTE 10
+
+/**
+ * @brief Salida de bytes que vacía el buffer
+ *
+ * @details writable() no bloquea y solo sirve para decidir cuántos mensajes
+ * agrupar. write() puede bloquear a la escritora hasta aceptarlo todo (como
+ * Serial.write()) o devolver menos bytes (el resto sale en la siguiente
+ * llamada).
+ */
+typedef struct {
+  uint32_t (*writable)(void);                           /**< Bytes que se pueden escribir ya sin esperar */
+  uint32_t (*write)(const uint8_t* data, uint32_t len); /**< Escribe y devuelve los bytes aceptados */
+} telemetry_txbuf_port_t;
+
+/**
+ * @brief Contadores del buffer (acumulados desde telemetry_txbuf_init())
+ */
+typedef struct {
+  uint32_t bytes_queued;    /**< Bytes aceptados por telemetry_txbuf_write() */
+  uint32_t bytes_written;   /**< Bytes entregados a la salida */
+  uint32_t writes;          /**< Llamadas a write() de la salida */
+  uint32_t producer_full;   /**< Veces que el productor encontró el anillo lleno */
+  uint32_t high_water;      /**< Ocupación máxima del anillo (bytes) */
+  uint32_t pending;         /**< Bytes en el anillo en este momento */
+} telemetry_txbuf_stats_t;
+
+/**
+ * @brief Backend sobre Serial (HardwareSerial del ESP32)
+ */
+const telemetry_txbuf_port_t* telemetry_txbuf_port_serial(void);
+
+/**
+ * @brief Vacía el anillo y asigna la salida
+ *
+ * @param port Salida (debe seguir siendo válida mientras se use el buffer)
+ *
+ * @details Se llama una vez, antes de encolar; hasta entonces
+ * telemetry_txbuf_drain() no hace nada, así que la escritora puede arrancar
+ * antes.
+ */
+void telemetry_txbuf_init(const telemetry_txbuf_port_t* port);
+
+/**
+ * @brief Encola un mensaje completo (solo el productor)
+ *
+ * @param data Bytes del mensaje
+ * @param len Longitud (1..TELEM_TXBUF_MAX_MESSAGE)
+ * @return true Si se ha copiado entero; false si no cabe todavía (no se
+ * copia nada: los mensajes nunca salen partidos por falta de sitio)
+ */
+bool telemetry_txbuf_write(const void* data, uint32_t len);
+
+/**
+ * @brief Registra el aviso de la escritora
+ *
+ * @param port Mecanismo de aviso (telemetry_wake_port_task() en el ESP32)
+ * @param ctx Contexto de port (la tarea escritora)
+ *
+ * @details Se llama desde la escritora antes de su primer
+ * telemetry_txbuf_wait_data(). telemetry_txbuf_init() no lo borra.
+ */
+void telemetry_txbuf_attach_writer(const telemetry_wake_port_t* port, void* ctx);
+
+/**
+ * @brief Duerme a la escritora hasta que haya mensajes que sacar (solo la tarea escritora)
+ *
+ * @details Arma el aviso y vuelve a mirar el anillo antes de dormir, así
+ * que un mensaje encolado justo antes no se pierde. Sin aviso registrado
+ * no espera.
+ *
+ * @param timeout_ms Espera máxima
+ * @return true Si hay mensajes pendientes y la salida no está retenida
+ */
+bool telemetry_txbuf_wait_data(uint32_t timeout_ms);
+
+/**
+ * @brief Registra el aviso del productor
+ *
+ * @param port Mecanismo de aviso (telemetry_wake_port_task() en el ESP32)
+ * @param ctx Contexto de port (la tarea productora)
+ *
+ * @details telemetry_txbuf_init() no lo borra.
+ */
+void telemetry_txbuf_attach_producer(const telemetry_wake_port_t* port, void* ctx);
+
+/**
+ * @brief Duerme al productor hasta que quepa un mensaje de len bytes (solo el productor)
+ *
+ * @details La escritora lo despierta cada vez que libera sitio. Sin aviso
+ * registrado no espera.
+ *
+ * @param len Longitud del mensaje que se quiere encolar
+ * @param timeout_ms Espera máxima
+ * @return true Si ya cabe
+ */
+bool telemetry_txbuf_wait_space(uint32_t len, uint32_t timeout_ms);
+
+/**
+ * @brief Bytes libres en el anillo
+ */
+uint32_t telemetry_txbuf_free(void);
+
+/**
+ * @brief Entrega a la salida el siguiente grupo de mensajes (solo la tarea escritora)
+ *
+ * @details Siempre el primer mensaje pendiente, más los siguientes mientras
+ * quepan en writable(), en una sola llamada a write().
+ *
+ * @return uint32_t Bytes escritos (0 si el anillo está vacío)
+ */
+uint32_t telemetry_txbuf_drain(void);
+
+/**
+ * @brief Retiene o libera la salida
+ *
+ * @details Mientras está retenida, telemetry_txbuf_drain() no escribe nada
+ * y el productor puede llenar el anillo por adelantado (p. ej. antes de que
+ * se abra una ventana de contacto); al liberarla sale todo de seguido.
+ */
+void telemetry_txbuf_hold(bool hold);
+
+/**
+ * @brief Obtiene los contadores del buffer
+ */
+void telemetry_txbuf_get_stats(telemetry_txbuf_stats_t* stats);
+
+/**
+ * @brief Ocupación del enlace en centésimas de porcentaje
+ *
+ * @param bytes Bytes enviados en el intervalo
+ * @param elapsed_ms Duración del intervalo
+ * @param baud Velocidad de la línea
+ * @return uint32_t 10000 = enlace saturado
+ */
+uint32_t telemetry_txbuf_utilization_x100(uint32_t bytes, uint32_t elapsed_ms, uint32_t baud);
+
+#endif /* TELEMETRY_TXBUF_H */
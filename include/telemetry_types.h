@@ -8,7 +8,9 @@
  * Tipos y estructuras usadas por el sistema de telemetría. Incluye el
  * encabezado común `telem_header_t`, los distintos bloques de datos de
  * telemetría (sistema, potencia, temperatura, subsistemas) y la unión
- * `telemetry_packet_t` para almacenar cualquier paquete.
+ * `telemetry_packet_t` para almacenar cualquier paquete. La descripción de
+ * los campos para codificar, enviar y registrar cada tipo está en
+ * telemetry_schema.h: al cambiar una estructura hay que actualizarla.
  * 
  * @see https://www.luisllamas.es/en/esp32-built-in-temperature-sensor/
  */
@@ -24,21 +26,41 @@ typedef enum {
     TELEM_SYSTEM_STATUS = 0,      /**< Estado general del sistema */
     TELEM_POWER_DATA,             /**< Datos del sistema de potencia */
     TELEM_TEMPERATURE_DATA,       /**< Mediciones de temperatura */
-    TELEM_COMMUNICATION_STATUS    /**< Estado de comunicaciones */
+    TELEM_COMMUNICATION_STATUS,   /**< Estado de comunicaciones */
+    TELEM_STORAGE_METRICS,        /**< Instrumentación del buffer de telemetría */
+    TELEM_LATENCY_METRICS,        /**< Latencias por etapa del pipeline */
+    TELEM_STATS_SUMMARY,          /**< Estadísticas de un campo en una ventana (telemetry_stats.h) */
+    TELEM_LIMIT_EVENT             /**< Cambio de estado de un límite (telemetry_limits.h) */
 } telem_data_type_t;
 
+/** @brief Número de tipos de telemetría (tamaño de las tablas indexadas por tipo) */
+#define TELEM_DATA_TYPE_COUNT 8
+
+/** @brief Intervalos del histograma de ocupación del buffer */
+#define TELEM_OCCUPANCY_BINS 8
+
+/** @brief Niveles de prioridad de los paquetes (telem_header_t.priority) */
+typedef enum {
+    TELEM_PRIORITY_LOW = 0,       /**< Datos prescindibles bajo congestión */
+    TELEM_PRIORITY_NORMAL = 1,    /**< Telemetría rutinaria */
+    TELEM_PRIORITY_HIGH = 2       /**< Telemetría crítica (p. ej. potencia) */
+} telem_priority_t;
+
 /**
  * @brief Encabezado común para todos los paquetes de telemetría
  *
  * @details Contiene el tipo de dato, timestamp, número de secuencia y
- * prioridad. Se incluye como primer miembro en todas las estructuras de
+ * prioridad, y los sellos de latencia que pone telemetry_storage (ver
+ * telemetry_latency.h; no se envían a tierra). Se incluye como primer miembro en todas las estructuras de
  * telemetría para permitir un manejo genérico de paquetes.
  */
 typedef struct {
     telem_data_type_t type;   /**< Tipo de telemetría (ver telem_data_type_t) */
     uint32_t timestamp;       /**< Timestamp interno del sistema (segundos) */
     uint16_t sequence;        /**< Número de secuencia del paquete */
-    uint8_t priority;         /**< Prioridad (0=low,1=normal,2=high) */
+    uint8_t priority;         /**< Prioridad (0=low,1=normal,2=high, ver telem_priority_t) */
+    uint32_t acquired_us;     /**< Sello de adquisición: reserva del slot (µs, 32 bits bajos) */
+    uint32_t enqueued_us;     /**< Sello de publicación en el buffer (µs, 32 bits bajos) */
 } telem_header_t;
 
 /**
@@ -78,15 +100,16 @@ typedef struct {
 /**
  * @brief Datos de temperatura del bus espacial
  *
- * @details Temperaturas reportadas por distintos sensores a bordo.
+ * @details Temperaturas reportadas por distintos sensores a bordo, todas en
+ * décimas de grado (p. ej. 253 = 25.3 °C).
  */
 typedef struct {
     telem_header_t header;          /**< Encabezado común */
-    int16_t obc_temperature;        /**< Temperatura OBC (0.1°C o °C según convención) */
-    int16_t comms_temperature;      /**< Temperatura módulo comunicaciones */
-    int16_t payload_temperature;    /**< Temperatura del payload */
-    int16_t battery_temperature;    /**< Temperatura de la batería */
-    int16_t external_temperature;   /**< Temperatura externa/ambiente */
+    int16_t obc_temperature;        /**< Temperatura OBC (0.1 °C) */
+    int16_t comms_temperature;      /**< Temperatura módulo comunicaciones (0.1 °C) */
+    int16_t payload_temperature;    /**< Temperatura del payload (0.1 °C) */
+    int16_t battery_temperature;    /**< Temperatura de la batería (0.1 °C) */
+    int16_t external_temperature;   /**< Temperatura externa/ambiente (0.1 °C) */
 } temperature_telem_t;
 
 /**
@@ -105,8 +128,78 @@ typedef struct {
     uint32_t payload_uptime;        /**< Tiempo activo payload (s) */
     uint8_t last_command_id;        /**< ID del último comando ejecutado */
     uint8_t command_success_rate;   /**< Tasa de éxito de comandos (%) */
+    int8_t rssi_dbm;                /**< RSSI del enlace (dBm) */
+    int8_t snr_db;                  /**< Relación señal/ruido del enlace (dB) */
 } subsystem_status_telem_t;
 
+/**
+ * @brief Instrumentación del buffer de telemetría
+ *
+ * @details Instantánea de telemetry_get_metrics() para enviarla a tierra.
+ * El histograma se expresa en porcentaje de muestras por intervalo de
+ * ocupación (intervalo i = ocupación entre i/BINS y (i+1)/BINS).
+ */
+typedef struct {
+    telem_header_t header;          /**< Encabezado común */
+    uint16_t occupancy;             /**< Paquetes retenidos al generar el paquete */
+    uint16_t high_water;            /**< Máximo de paquetes retenidos desde el arranque */
+    uint16_t capacity;              /**< Paquetes que caben en el buffer */
+    uint8_t occupancy_pct[TELEM_OCCUPANCY_BINS]; /**< Histograma de ocupación (%) */
+    uint32_t packets_lost;          /**< Paquetes perdidos desde el arranque */
+    uint32_t lock_timeouts;         /**< Timeouts al tomar el mutex del buffer */
+    uint32_t lock_wait_avg_us;      /**< Espera media por el mutex (µs) */
+    uint32_t lock_wait_max_us;      /**< Espera máxima por el mutex (µs) */
+} storage_metrics_telem_t;
+
+/**
+ * @brief Latencias de una etapa del pipeline (ver telemetry_latency.h)
+ *
+ * @details Agregadas para todos los tipos desde el arranque; los paquetes
+ * sucesivos recorren las etapas por turno.
+ */
+typedef struct {
+    telem_header_t header;          /**< Encabezado común */
+    uint8_t stage;                  /**< Etapa (telem_latency_stage_t) */
+    uint32_t samples;               /**< Paquetes medidos */
+    uint32_t p50_us;                /**< Mediana (µs) */
+    uint32_t p99_us;                /**< Percentil 99 (µs) */
+    uint32_t max_us;                /**< Máximo (µs) */
+} latency_metrics_telem_t;
+
+/**
+ * @brief Resumen de un campo numérico en una ventana (ver telemetry_stats.h)
+ *
+ * @details Sustituye en la bajada a las muestras de la ventana cuando el
+ * enlace no da abasto. Los valores van en las unidades físicas del campo
+ * (los enteros en décimas ya divididos: 25.3 °C, no 253).
+ */
+typedef struct {
+    telem_header_t header;          /**< Encabezado común (timestamp = fin de la ventana) */
+    uint8_t source_type;            /**< Tipo resumido (telem_data_type_t) */
+    uint8_t field;                  /**< Índice del campo en el esquema del tipo */
+    uint16_t window_s;              /**< Duración de la ventana (s) */
+    uint16_t samples;               /**< Muestras en la ventana */
+    float min;                      /**< Mínimo */
+    float max;                      /**< Máximo */
+    float mean;                     /**< Media */
+    float stddev;                   /**< Desviación típica */
+    float rate_per_min;             /**< Variación por minuto entre la primera y la última muestra */
+} stats_summary_telem_t;
+
+/**
+ * @brief Cambio de estado de un límite (ver telemetry_limits.h)
+ */
+typedef struct {
+    telem_header_t header;          /**< Encabezado común (timestamp = el del paquete evaluado) */
+    uint8_t source_type;            /**< Tipo del paquete evaluado (telem_data_type_t) */
+    uint8_t field;                  /**< Índice del campo en el esquema del tipo */
+    uint8_t limit;                  /**< Índice del límite en TELEM_LIMITS_TABLE */
+    uint8_t state;                  /**< Estado nuevo (telem_limit_state_t) */
+    uint8_t previous;               /**< Estado anterior */
+    float value;                    /**< Valor que completó la persistencia (unidades físicas) */
+    float threshold;                /**< Umbral cruzado */
+} limit_event_telem_t;
+
 /**
  * @brief Unión que representa un paquete de telemetría genérico
  *
@@ -119,6 +212,10 @@ typedef union {
     power_telem_t power;                   /**< Datos de potencia */
     temperature_telem_t temperature;       /**< Datos de temperatura */
     subsystem_status_telem_t subsystems;   /**< Estados de subsistemas */
+    storage_metrics_telem_t storage;       /**< Instrumentación del buffer */
+    latency_metrics_telem_t latency;       /**< Latencias del pipeline */
+    stats_summary_telem_t summary;         /**< Resumen estadístico de un campo */
+    limit_event_telem_t event;             /**< Cambio de estado de un límite */
     uint8_t raw_data[64];                  /**< Buffer crudo para datos genéricos */
 } telemetry_packet_t;
 
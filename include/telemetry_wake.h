@@ -0,0 +1,109 @@
+/**
+ * @file telemetry_wake.h
+ * @brief Avisos de datos nuevos del productor a los consumidores
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Cada consumidor (procesador, transmisor) tiene un telemetry_wake_t que
+ * asocia a su suscriptor con telemetry_set_wake(). Al publicar paquetes,
+ * telemetry_storage llama a telemetry_wake_signal() y el consumidor, que
+ * duerme en telemetry_wake_wait(), despierta en cuanto hay datos en lugar
+ * de al cumplirse su periodo de sondeo.
+ *
+ * Los avisos se agrupan: el consumidor arma el aviso al dormirse y el
+ * primer productor que lo encuentra armado lo desarma y despierta a la
+ * tarea, así que una ráfaga de publicaciones la despierta una sola vez. Con
+ * min_batch > 1 no se despierta hasta reunir ese número de paquetes nuevos,
+ * y max_delay_ms limita la espera (trabajo periódico del consumidor y
+ * paquetes que no llegan a completar el lote).
+ *
+ * El aviso pasa por telemetry_wake_port_t: en el ESP32 una notificación de
+ * tarea (telemetry_wake_port_task(), telemetry_wake_freertos.cpp); en el
+ * host, una variable de condición (bridge/frame_decoder/wake_latency.cpp).
+ */
+
+#ifndef TELEMETRY_WAKE_H
+#define TELEMETRY_WAKE_H
+
+  #include <stdbool.h>
+  #include <stdint.h>
+
+/**
+ * @brief Consumidores despertados por el productor
+ *
+ * @details 0: el procesador y el transmisor vuelven a sondear el buffer con
+ * su periodo fijo (1 s y 2 s).
+ */
+#ifndef TELEM_WAKE_EVENTS
+#define TELEM_WAKE_EVENTS 1
+#endif
+
+/**
+ * @brief Mecanismo de aviso de la plataforma
+ *
+ * @details notify() puede llamarse antes de que el consumidor llegue a
+ * wait(): el aviso debe quedar pendiente (como una notificación de tarea) y
+ * hacer que el siguiente wait() vuelva enseguida.
+ */
+typedef struct {
+  void (*notify)(void* ctx);                      /**< Despierta al consumidor */
+  bool (*wait)(void* ctx, uint32_t timeout_ms);   /**< Espera un aviso; false si se cumple el plazo */
+} telemetry_wake_port_t;
+
+/**
+ * @brief Punto de aviso de un consumidor
+ */
+typedef struct {
+  const telemetry_wake_port_t* port;
+  void* ctx;                  /**< Contexto del aviso (la tarea consumidora) */
+  uint32_t min_batch;         /**< Paquetes nuevos que despiertan al consumidor */
+  uint32_t max_delay_ms;      /**< Espera máxima sin aviso */
+  uint32_t published;         /**< Paquetes publicados (lo suma el productor) */
+  uint32_t seen;              /**< published al empezar la última pasada del consumidor */
+  uint32_t armed;             /**< 1 = el consumidor duerme y aún no se le ha avisado */
+  uint32_t signals;           /**< Publicaciones avisadas */
+  uint32_t notifies;          /**< Veces que se despertó al consumidor */
+  uint32_t timeouts;          /**< Esperas terminadas por max_delay_ms */
+} telemetry_wake_t;
+
+/**
+ * @brief Aviso por notificación a la tarea indicada en ctx (TaskHandle_t)
+ */
+const telemetry_wake_port_t* telemetry_wake_port_task(void);
+
+/**
+ * @brief Prepara un punto de aviso
+ *
+ * @param port Mecanismo de aviso
+ * @param ctx Contexto de port (p. ej. la tarea que esperará)
+ * @param min_batch Paquetes nuevos que despiertan (1 = cada publicación)
+ * @param max_delay_ms Espera máxima en telemetry_wake_wait()
+ */
+void telemetry_wake_init(telemetry_wake_t* wake, const telemetry_wake_port_t* port, void* ctx,
+                         uint32_t min_batch, uint32_t max_delay_ms);
+
+/**
+ * @brief Cuenta paquetes publicados y despierta al consumidor si procede (productor)
+ *
+ * @param count Paquetes recién publicados
+ */
+void telemetry_wake_signal(telemetry_wake_t* wake, uint32_t count);
+
+/**
+ * @brief Marca el comienzo de una pasada del consumidor
+ *
+ * @details Se llama antes de leer el buffer: lo que se publique después
+ * cuenta como nuevo para el siguiente telemetry_wake_wait().
+ */
+void telemetry_wake_begin(telemetry_wake_t* wake);
+
+/**
+ * @brief Duerme hasta que haya min_batch paquetes nuevos o pase max_delay_ms
+ *
+ * @return true Si hay paquetes nuevos suficientes (no espera si ya los había)
+ * @return false Si se cumplió el plazo
+ */
+bool telemetry_wake_wait(telemetry_wake_t* wake);
+
+#endif /* TELEMETRY_WAKE_H */
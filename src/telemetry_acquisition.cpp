@@ -7,24 +7,124 @@
  * @details
  * Este módulo inicializa el almacenamiento de telemetría y coordina la generación
  * de diferentes tipos de datos de telemetría mediante llamadas a los generadores específicos.
+ *
+ * Cada paquete lleno se pasa por los límites de telemetry_limits.h antes de
+ * publicarlo (también los que se quedan sin slot con el buffer lleno: los
+ * límites no dependen de la reserva), y los eventos de cambio de estado se publican detrás de los
+ * paquetes del ciclo (el recolector es el productor del buffer, también en
+ * TELEM_STORAGE_LOCKFREE).
  */
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <string.h>
 #include "../include/telemetry_acquisition.h"
 #include "../include/telemetry_generators.h"
 #include "../include/telemetry_storage.h"
 #include "../include/telemetry_logger.h"
+#include "../include/telemetry_limits.h"
+
+#if TELEM_LIMITS_ENGINE
+/** @brief Estado de los límites (solo lo toca la tarea recolectora) */
+static telemetry_limits_t s_limits;
+/** @brief Eventos del ciclo en curso, pendientes de publicar */
+static telemetry_packet_t s_events[TELEM_LIMIT_COUNT];
+/** @brief Eventos que no se pudieron publicar */
+static uint32_t s_events_lost = 0;
+#endif
 
 void telemetry_acquisition_init(void) {
   telemetry_storage_init();
+#if TELEM_LIMITS_ENGINE
+  uint32_t unresolved = telemetry_limits_init(&s_limits);
+  if(unresolved > 0) {
+    telemetry_logf("[ACQ] WARN: %lu limits do not match a schema field", unresolved);
+  }
+  telemetry_logf("[ACQ] Init OK (%u limits)", (unsigned)TELEM_LIMIT_COUNT);
+#else
   telemetry_logf("[ACQ] Init OK");
+#endif
 }
 
+/** @brief Generadores y cada cuántos ciclos se ejecuta cada uno */
+static const struct {
+  telem_data_type_t type;
+  void (*fill)(telemetry_packet_t*);
+  uint8_t period;
+} s_fillers[] = {
+  { TELEM_SYSTEM_STATUS,        fill_system_telemetry,          1 },
+  { TELEM_POWER_DATA,           fill_power_telemetry,           1 },
+  { TELEM_TEMPERATURE_DATA,     fill_temperature_telemetry,     1 },
+  { TELEM_COMMUNICATION_STATUS, fill_subsystem_telemetry,       1 },
+  { TELEM_STORAGE_METRICS,      fill_storage_metrics_telemetry, 15 }, // ~30 s
+  { TELEM_LATENCY_METRICS,      fill_latency_telemetry,         3 },  // una etapa cada ~6 s
+};
+
+#define ACQ_MAX_PACKETS_PER_CYCLE (sizeof(s_fillers) / sizeof(s_fillers[0]))
+
+static uint32_t s_cycle = 0;
+
 void telemetry_acquisition_cycle(void) {
-  // Generar todos los tipos de datos (orden puede afectar prioridad futura)
-  generate_system_telemetry();
-  generate_power_telemetry();
-  generate_temperature_telemetry();
-  generate_subsystem_telemetry();
+  // Reservar los slots de todo el ciclo, cada uno en la vía de su prioridad,
+  // y rellenarlos en el sitio: una sola sincronización y ninguna copia por paquete
+  telem_header_t headers[ACQ_MAX_PACKETS_PER_CYCLE];
+  telemetry_packet_t* slots[ACQ_MAX_PACKETS_PER_CYCLE];
+  uint8_t filler[ACQ_MAX_PACKETS_PER_CYCLE];
+  uint32_t count = 0;
+  for(uint32_t i = 0; i < ACQ_MAX_PACKETS_PER_CYCLE; i++) {
+    if(s_cycle % s_fillers[i].period != 0) continue;
+    headers[count].type = s_fillers[i].type;
+    headers[count].priority = telemetry_type_priority(s_fillers[i].type);
+    filler[count++] = (uint8_t)i;
+  }
+  s_cycle++;
+
+  uint32_t reserved = telemetry_reserve_slots(headers, slots, count);
+
+#if TELEM_LIMITS_ENGINE
+  uint32_t events = 0;
+#endif
+  for(uint32_t i = 0; i < count; i++) {
+    if(slots[i]) {
+      s_fillers[filler[i]].fill(slots[i]);
+#if TELEM_LIMITS_ENGINE
+      events += telemetry_limits_evaluate(&s_limits, slots[i], &s_events[events], TELEM_LIMIT_COUNT - events);
+#endif
+    }
+  }
+  if(reserved > 0) {
+    telemetry_commit_slots();
+  }
+
+  // Vías llenas (contabilizado como perdido): los paquetes sin slot se generan
+  // igualmente para que el estado actual no se congele mientras dure el atasco,
+  // y pasan por los límites para que una transición no se pierda con ellos
+  for(uint32_t i = 0; i < count; i++) {
+    if(slots[i]) continue;
+    telemetry_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    s_fillers[filler[i]].fill(&packet);
+#if TELEM_LIMITS_ENGINE
+    events += telemetry_limits_evaluate(&s_limits, &packet, &s_events[events], TELEM_LIMIT_COUNT - events);
+#endif
+    telemetry_update_latest(&packet);
+  }
+
+#if TELEM_LIMITS_ENGINE
+  for(uint32_t i = 0; i < events; i++) {
+    if(!telemetry_store_packet(&s_events[i])) {
+      s_events_lost++;
+    }
+  }
+#endif
+}
+
+const telemetry_limits_t* telemetry_acquisition_get_limits(uint32_t* events_lost) {
+#if TELEM_LIMITS_ENGINE
+  if(events_lost) *events_lost = s_events_lost;
+  return &s_limits;
+#else
+  if(events_lost) *events_lost = 0;
+  return NULL;
+#endif
 }
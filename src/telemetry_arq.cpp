@@ -0,0 +1,288 @@
+/**
+ * @file telemetry_arq.cpp
+ * @brief Implementación del ARQ de repetición selectiva
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Las secuencias son de 16 bits y se comparan siempre por diferencia
+ * módulo 2^16 respecto a la base de la ventana, que nunca abarca más de
+ * TELEM_ARQ_WINDOW secuencias.
+ */
+
+  #include <string.h>
+  #include "../include/telemetry_arq.h"
+
+#define ARQ_MASK (TELEM_ARQ_WINDOW - 1)
+
+static telemetry_arq_slot_t* tx_slot(telemetry_arq_tx_t* tx, uint16_t seq) {
+  return &tx->slots[seq & ARQ_MASK];
+}
+
+/**
+ * @brief Avanza la base sobre las tramas ya confirmadas
+ */
+static void tx_slide(telemetry_arq_tx_t* tx) {
+  while(tx->base != tx->next && tx_slot(tx, tx->base)->acked) {
+    tx->base++;
+  }
+}
+
+void telemetry_arq_tx_init(telemetry_arq_tx_t* tx, uint32_t rto_ms, uint8_t max_tries) {
+  memset(tx->slots, 0, sizeof(tx->slots));
+  tx->base = 0;
+  tx->next = 0;
+  tx->rto_max_ms = rto_ms ? rto_ms : TELEM_ARQ_RTO_MS;
+  tx->rto_ms = tx->rto_max_ms;
+  tx->srtt_ms = 0;
+  tx->rttvar_ms = 0;
+  tx->order = 0;
+  tx->acked_order = 0;
+  tx->max_tries = max_tries ? max_tries : TELEM_ARQ_MAX_TRIES;
+  tx->abandoned_types = 0;
+  telemetry_frame_rx_init(&tx->uplink);
+  tx->frames_sent = 0;
+  tx->retransmissions = 0;
+  tx->frames_acked = 0;
+  tx->frames_abandoned = 0;
+  tx->acks = 0;
+}
+
+bool telemetry_arq_tx_ready(const telemetry_arq_tx_t* tx) {
+  return (uint16_t)(tx->next - tx->base) < TELEM_ARQ_WINDOW;
+}
+
+uint32_t telemetry_arq_tx_in_flight(const telemetry_arq_tx_t* tx) {
+  return (uint16_t)(tx->next - tx->base);
+}
+
+uint16_t telemetry_arq_tx_next_seq(const telemetry_arq_tx_t* tx) {
+  return tx->next;
+}
+
+bool telemetry_arq_tx_store(telemetry_arq_tx_t* tx, const uint8_t* frame, uint16_t len, uint8_t type, uint32_t now_ms) {
+  if(!telemetry_arq_tx_ready(tx) || len > TELEM_FRAME_MAX_BYTES) {
+    return false;
+  }
+  telemetry_arq_slot_t* slot = tx_slot(tx, tx->next);
+  memcpy(slot->frame, frame, len);
+  slot->len = len;
+  slot->type = type;
+  slot->tries = 1;
+  slot->acked = false;
+  slot->order = ++tx->order;
+  slot->sent_ms = now_ms;
+  tx->next++;
+  tx->frames_sent++;
+  return true;
+}
+
+/**
+ * @brief Actualiza el plazo de repetición con una medida (RFC 6298)
+ */
+static void tx_rtt_sample(telemetry_arq_tx_t* tx, uint32_t rtt_ms) {
+  if(tx->srtt_ms == 0) {
+    tx->srtt_ms = rtt_ms ? rtt_ms : 1;
+    tx->rttvar_ms = rtt_ms / 2;
+  } else {
+    uint32_t err = (rtt_ms > tx->srtt_ms) ? rtt_ms - tx->srtt_ms : tx->srtt_ms - rtt_ms;
+    tx->rttvar_ms = (3 * tx->rttvar_ms + err) / 4;
+    tx->srtt_ms = (7 * tx->srtt_ms + rtt_ms) / 8;
+  }
+  // El margen cubre la granularidad del reloj y la cola del buffer de transmisión
+  uint32_t margin = 4 * tx->rttvar_ms;
+  if(margin < TELEM_ARQ_RTO_MARGIN_MS) margin = TELEM_ARQ_RTO_MARGIN_MS;
+  uint32_t rto = tx->srtt_ms + margin;
+  if(rto > tx->rto_max_ms) rto = tx->rto_max_ms;
+  tx->rto_ms = rto;
+}
+
+/**
+ * @brief Marca una secuencia de la ventana como confirmada
+ */
+static void tx_mark_acked(telemetry_arq_tx_t* tx, uint16_t seq, uint32_t now_ms) {
+  telemetry_arq_slot_t* slot = tx_slot(tx, seq);
+  if(slot->acked) {
+    return;
+  }
+  slot->acked = true;
+  tx->frames_acked++;
+  if(slot->tries == 1) {
+    tx_rtt_sample(tx, now_ms - slot->sent_ms); // Karn: solo sin repeticiones
+  }
+  if((int32_t)(slot->order - tx->acked_order) > 0) {
+    tx->acked_order = slot->order;
+  }
+}
+
+void telemetry_arq_tx_ack(telemetry_arq_tx_t* tx, uint16_t cumulative, uint32_t selective, uint32_t now_ms) {
+  uint16_t in_flight = (uint16_t)(tx->next - tx->base);
+  uint16_t upto = (uint16_t)(cumulative - tx->base);
+  if(upto > in_flight) {
+    return; // Acuse de algo que no se ha enviado (o de antes de un reinicio)
+  }
+  tx->acks++;
+  for(uint16_t d = 0; d < upto; d++) {
+    tx_mark_acked(tx, (uint16_t)(tx->base + d), now_ms);
+  }
+  for(uint32_t i = 0; i < 32; i++) {
+    if(!(selective & (1UL << i))) continue;
+    uint16_t seq = (uint16_t)(cumulative + 1 + i);
+    if((uint16_t)(seq - tx->base) >= in_flight) break;
+    tx_mark_acked(tx, seq, now_ms);
+  }
+
+  // La bajada entrega en orden: lo enviado antes que algo ya confirmado y
+  // aún sin acuse se ha perdido, así que vence ya en lugar de esperar al plazo
+  for(uint16_t seq = tx->base; seq != tx->next; seq++) {
+    telemetry_arq_slot_t* slot = tx_slot(tx, seq);
+    if(!slot->acked && (int32_t)(tx->acked_order - slot->order) > 0) {
+      slot->sent_ms = now_ms - tx->rto_ms;
+    }
+  }
+  tx_slide(tx);
+}
+
+bool telemetry_arq_tx_uplink(telemetry_arq_tx_t* tx, uint8_t byte, uint32_t now_ms) {
+  uint16_t cumulative;
+  uint32_t selective;
+  if(!telemetry_frame_split(&tx->uplink, byte) ||
+     !telemetry_frame_decode_ack(tx->uplink.buf, tx->uplink.len, &cumulative, &selective)) {
+    return false;
+  }
+  telemetry_arq_tx_ack(tx, cumulative, selective, now_ms);
+  return true;
+}
+
+const uint8_t* telemetry_arq_tx_due(telemetry_arq_tx_t* tx, uint32_t now_ms, uint16_t* len) {
+  for(uint16_t seq = tx->base; seq != tx->next; seq++) {
+    telemetry_arq_slot_t* slot = tx_slot(tx, seq);
+    if(slot->acked || now_ms - slot->sent_ms < tx->rto_ms) continue;
+    if((int32_t)(tx->acked_order - slot->order) <= 0) {
+      // Venció el plazo sin indicio de pérdida: el plazo se queda corto
+      tx->rto_ms = (tx->rto_ms * 2 < tx->rto_max_ms) ? tx->rto_ms * 2 : tx->rto_max_ms;
+    }
+    if(slot->tries >= tx->max_tries) {
+      slot->acked = true;
+      tx->frames_abandoned++;
+      tx->abandoned_types |= 1UL << slot->type;
+      continue;
+    }
+    slot->tries++;
+    slot->order = ++tx->order;
+    slot->sent_ms = now_ms;
+    tx->retransmissions++;
+    *len = slot->len;
+    tx_slide(tx);
+    return slot->frame;
+  }
+  tx_slide(tx);
+  return NULL;
+}
+
+uint32_t telemetry_arq_tx_next_due_ms(const telemetry_arq_tx_t* tx, uint32_t now_ms) {
+  uint32_t next = UINT32_MAX;
+  for(uint16_t seq = tx->base; seq != tx->next; seq++) {
+    const telemetry_arq_slot_t* slot = &tx->slots[seq & ARQ_MASK];
+    if(slot->acked) continue;
+    uint32_t elapsed = now_ms - slot->sent_ms;
+    if(elapsed >= tx->rto_ms) return 0;
+    if(tx->rto_ms - elapsed < next) next = tx->rto_ms - elapsed;
+  }
+  return next;
+}
+
+uint32_t telemetry_arq_tx_take_abandoned(telemetry_arq_tx_t* tx) {
+  uint32_t types = tx->abandoned_types;
+  tx->abandoned_types = 0;
+  return types;
+}
+
+void telemetry_arq_rx_init(telemetry_arq_rx_t* rx) {
+  memset(rx->slots, 0, sizeof(rx->slots));
+  rx->expected = 0;
+  rx->synced = false;
+  rx->frames_delivered = 0;
+  rx->duplicates = 0;
+  rx->out_of_order = 0;
+  rx->skipped = 0;
+  rx->resyncs = 0;
+}
+
+/**
+ * @brief Entrega las tramas consecutivas a partir de expected
+ */
+static void rx_flush(telemetry_arq_rx_t* rx, telemetry_arq_deliver_t deliver, void* arg) {
+  telemetry_arq_rx_slot_t* slot;
+  while((slot = &rx->slots[rx->expected & ARQ_MASK])->have) {
+    slot->have = false;
+    rx->expected++;
+    rx->frames_delivered++;
+    deliver(slot->frame, slot->len, arg);
+  }
+}
+
+int telemetry_arq_rx_accept(telemetry_arq_rx_t* rx, const uint8_t* frame, uint16_t len,
+                            telemetry_arq_deliver_t deliver, void* arg) {
+  int32_t link_seq = telemetry_frame_link_seq(frame, len);
+  if(link_seq < 0 || len > TELEM_FRAME_MAX_BYTES) {
+    return -1;
+  }
+  uint16_t seq = (uint16_t)link_seq;
+  int16_t ahead = (int16_t)(uint16_t)(seq - rx->expected);
+
+  if(!rx->synced || ahead < -TELEM_ARQ_WINDOW) {
+    // Primera trama, o el emisor ha vuelto a empezar: lo guardado ya no vale
+    if(rx->synced) rx->resyncs++;
+    for(uint32_t i = 0; i < TELEM_ARQ_WINDOW; i++) rx->slots[i].have = false;
+    rx->expected = seq;
+    rx->synced = true;
+    ahead = 0;
+  }
+  if(ahead < 0) {
+    rx->duplicates++; // Ya entregada: el acuse se perdió
+    return 0;
+  }
+
+  // El emisor solo envía dentro de su ventana: si esta trama queda fuera de
+  // la nuestra, lo que falta por debajo ya no va a llegar
+  while(ahead >= TELEM_ARQ_WINDOW) {
+    telemetry_arq_rx_slot_t* slot = &rx->slots[rx->expected & ARQ_MASK];
+    if(slot->have) {
+      slot->have = false;
+      rx->frames_delivered++;
+      deliver(slot->frame, slot->len, arg);
+    } else {
+      rx->skipped++;
+    }
+    rx->expected++;
+    ahead--;
+  }
+
+  telemetry_arq_rx_slot_t* slot = &rx->slots[seq & ARQ_MASK];
+  if(slot->have) {
+    rx->duplicates++;
+    return 0;
+  }
+  memcpy(slot->frame, frame, len);
+  slot->len = len;
+  slot->have = true;
+  if(ahead > 0) {
+    rx->out_of_order++;
+  }
+  rx_flush(rx, deliver, arg);
+  return 1;
+}
+
+size_t telemetry_arq_rx_ack(const telemetry_arq_rx_t* rx, uint8_t* out, size_t capacity) {
+  if(!rx->synced) {
+    return 0;
+  }
+  uint32_t selective = 0;
+  for(uint32_t i = 0; i + 1 < TELEM_ARQ_WINDOW; i++) {
+    if(rx->slots[(uint16_t)(rx->expected + 1 + i) & ARQ_MASK].have) {
+      selective |= 1UL << i;
+    }
+  }
+  return telemetry_frame_encode_ack(rx->expected, selective, out, capacity);
+}
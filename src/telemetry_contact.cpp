@@ -0,0 +1,131 @@
+/**
+ * @file telemetry_contact.cpp
+ * @brief Implementación de la tabla de ventanas de contacto
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ */
+
+  #include "../include/telemetry_contact.h"
+  #include "../include/telemetry_txbuf.h"
+
+static telemetry_contact_window_t s_windows[TELEM_CONTACT_MAX_WINDOWS];
+/** @brief Ventanas de la tabla (0 = pase periódico) */
+static uint32_t s_count = 0;
+
+void telemetry_contact_init(void) {
+  s_count = 0;
+}
+
+/**
+ * @brief Lee un entero decimal sin signo y avanza el cursor
+ *
+ * @return false Si no hay dígitos o no cabe en 32 bits
+ */
+static bool parse_u32(const char** cursor, const char* end, uint32_t* value) {
+  const char* p = *cursor;
+  uint64_t v = 0;
+  while(p < end && (*p == ' ' || *p == '\t')) p++;
+  const char* digits = p;
+  while(p < end && *p >= '0' && *p <= '9') {
+    v = v * 10 + (uint32_t)(*p - '0');
+    if(v > UINT32_MAX) return false;
+    p++;
+  }
+  if(p == digits) return false;
+  *cursor = p;
+  *value = (uint32_t)v;
+  return true;
+}
+
+uint32_t telemetry_contact_load(const char* text, uint32_t len) {
+  telemetry_contact_window_t table[TELEM_CONTACT_MAX_WINDOWS];
+  uint32_t count = 0;
+  const char* end = text + len;
+
+  for(const char* line = text; line < end && count < TELEM_CONTACT_MAX_WINDOWS; ) {
+    const char* eol = line;
+    while(eol < end && *eol != '\n') eol++;
+    const char* p = line;
+    line = eol + 1;
+
+    uint32_t aos_s, duration_s, rate = 0;
+    if(!parse_u32(&p, eol, &aos_s) || !parse_u32(&p, eol, &duration_s)) {
+      continue; // Comentario, línea vacía o mal formada
+    }
+    parse_u32(&p, eol, &rate);
+    if(duration_s == 0 || aos_s > UINT32_MAX / 1000 - duration_s) {
+      continue;
+    }
+    telemetry_contact_window_t w = { aos_s * 1000, (aos_s + duration_s) * 1000,
+                                     rate ? rate : (uint32_t)TELEM_TXBUF_BAUD };
+
+    // Inserción ordenada por AOS (la tabla es corta)
+    uint32_t i = count;
+    while(i > 0 && table[i - 1].aos_ms > w.aos_ms) {
+      table[i] = table[i - 1];
+      i--;
+    }
+    table[i] = w;
+    count++;
+  }
+
+  // Fuera las que se solapan con la anterior: dos pases no comparten enlace
+  uint32_t kept = 0;
+  for(uint32_t i = 0; i < count; i++) {
+    if(kept > 0 && table[i].aos_ms < table[kept - 1].los_ms) continue;
+    table[kept++] = table[i];
+  }
+  if(kept == 0) {
+    return 0;
+  }
+  for(uint32_t i = 0; i < kept; i++) {
+    s_windows[i] = table[i];
+  }
+  s_count = kept;
+  return kept;
+}
+
+uint32_t telemetry_contact_count(void) {
+  return s_count;
+}
+
+bool telemetry_contact_next(uint32_t now_ms, telemetry_contact_window_t* window) {
+  if(s_count > 0) {
+    for(uint32_t i = 0; i < s_count; i++) {
+      if(s_windows[i].los_ms > now_ms) {
+        *window = s_windows[i];
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Pase periódico: el k-ésimo empieza en FIRST + k·PERIOD
+  const uint32_t first_ms = TELEM_CONTACT_FIRST_AOS_S * 1000UL;
+  const uint32_t period_ms = TELEM_CONTACT_PERIOD_S * 1000UL;
+  const uint32_t duration_ms = TELEM_CONTACT_DURATION_S * 1000UL;
+  uint32_t aos_ms = first_ms;
+  if(now_ms >= first_ms + duration_ms && period_ms > 0) {
+    aos_ms = first_ms + ((now_ms - first_ms - duration_ms) / period_ms + 1) * period_ms;
+  }
+  window->aos_ms = aos_ms;
+  window->los_ms = aos_ms + duration_ms;
+  window->rate_bps = TELEM_TXBUF_BAUD;
+  return period_ms > 0 || now_ms < first_ms + duration_ms;
+}
+
+uint32_t telemetry_contact_link_bytes(uint32_t rate_bps, uint32_t ms) {
+  return (uint32_t)((uint64_t)rate_bps * ms / (1000ULL * TELEM_TXBUF_BITS_PER_BYTE));
+}
+
+uint32_t telemetry_contact_budget(const telemetry_contact_window_t* window, uint32_t from_ms) {
+  if(from_ms < window->aos_ms) {
+    from_ms = window->aos_ms;
+  }
+  uint32_t usable_end = (window->los_ms - window->aos_ms > TELEM_CONTACT_GUARD_MS)
+      ? window->los_ms - TELEM_CONTACT_GUARD_MS : window->aos_ms;
+  if(from_ms >= usable_end) {
+    return 0;
+  }
+  return telemetry_contact_link_bytes(window->rate_bps, usable_end - from_ms);
+}
@@ -0,0 +1,43 @@
+/**
+ * @file telemetry_decimation.cpp
+ * @brief Implementación del diezmado adaptativo de la bajada
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ */
+
+  #include <string.h>
+  #include "../include/telemetry_decimation.h"
+
+void telemetry_decimation_init(telemetry_decimation_t* dec) {
+  memset(dec, 0, sizeof(*dec));
+}
+
+uint8_t telemetry_decimation_level(uint32_t newer) {
+  uint8_t level = 0;
+  uint32_t threshold = TELEM_DECIMATION_STEP;
+  while(level < TELEM_DECIMATION_MAX_LEVEL && newer >= threshold) {
+    level++;
+    if(threshold > UINT32_MAX / 2) break;
+    threshold *= 2;
+  }
+  return level;
+}
+
+bool telemetry_decimation_keep(telemetry_decimation_t* dec, const telem_header_t* header, uint32_t newer) {
+  if(header->priority > TELEM_DECIMATION_MAX_PRIORITY || (uint32_t)header->type >= TELEM_DATA_TYPE_COUNT) {
+    return true;
+  }
+  uint8_t level = telemetry_decimation_level(newer);
+  if(level == 0) {
+    return true;
+  }
+  // Fase por tipo: con escalones potencia de dos, lo que conserva un nivel
+  // lo conservan también los inferiores
+  uint32_t phase = dec->phase[header->type]++;
+  if((phase & ((1UL << level) - 1)) == 0) {
+    return true;
+  }
+  dec->dropped[header->type]++;
+  dec->dropped_total++;
+  return false;
+}
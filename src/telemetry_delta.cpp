@@ -0,0 +1,306 @@
+/**
+ * @file telemetry_delta.cpp
+ * @brief Implementación del codificador delta por tipo
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Codificador y decodificador recorren la misma tabla de campos del esquema
+ * y actualizan la referencia con el valor reconstruido, no con el original:
+ * con floats cuantificados ambos extremos quedan siempre idénticos y el
+ * error no se acumula entre deltas.
+ */
+
+  #include <math.h>
+  #include <string.h>
+  #include "../include/telemetry_delta.h"
+  #include "../include/telemetry_schema.h"
+
+/* ----------------------------------------------------------------------------
+ * Varints (LEB128) y zigzag
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Salida binaria acotada: deja de escribir al llenarse y lo recuerda
+ */
+typedef struct {
+  uint8_t* out;
+  uint32_t capacity;
+  uint32_t len;
+  bool overflow;
+} byte_writer_t;
+
+/**
+ * @brief Entrada binaria acotada: marca error si se lee más allá del final
+ */
+typedef struct {
+  const uint8_t* in;
+  uint32_t len;
+  uint32_t pos;
+  bool error;
+} byte_reader_t;
+
+static inline uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v) {
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static void put_byte(byte_writer_t* w, uint8_t b) {
+  if(w->len >= w->capacity) {
+    w->overflow = true;
+    return;
+  }
+  w->out[w->len++] = b;
+}
+
+static void put_varint(byte_writer_t* w, uint32_t v) {
+  while(v >= 0x80) {
+    put_byte(w, (uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  put_byte(w, (uint8_t)v);
+}
+
+static void put_le(byte_writer_t* w, uint32_t v, uint8_t width) {
+  for(uint8_t b = 0; b < width; b++) {
+    put_byte(w, (uint8_t)(v >> (8 * b)));
+  }
+}
+
+static uint8_t get_byte(byte_reader_t* r) {
+  if(r->pos >= r->len) {
+    r->error = true;
+    return 0;
+  }
+  return r->in[r->pos++];
+}
+
+static uint32_t get_varint(byte_reader_t* r) {
+  uint32_t v = 0;
+  for(uint8_t shift = 0; shift < 35; shift += 7) {
+    uint8_t b = get_byte(r);
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if(!(b & 0x80)) {
+      return v;
+    }
+  }
+  r->error = true; // Más de 5 bytes: no es un varint de 32 bits
+  return 0;
+}
+
+static uint32_t get_le(byte_reader_t* r, uint8_t width) {
+  uint32_t v = 0;
+  for(uint8_t b = 0; b < width; b++) {
+    v |= (uint32_t)get_byte(r) << (8 * b);
+  }
+  return v;
+}
+
+/* ----------------------------------------------------------------------------
+ * Campos
+ * ------------------------------------------------------------------------- */
+
+/** @brief Lee un elemento como entero sin signo de su anchura */
+static inline uint32_t load_raw(const uint8_t* p, uint8_t width) {
+  uint32_t raw = 0;
+  memcpy(&raw, p, width); // Little-endian (ESP32 y host x86/ARM)
+  return raw;
+}
+
+/** @brief Extiende el signo de una diferencia truncada a la anchura del campo */
+static inline int32_t wrap_diff(uint32_t diff, uint8_t width) {
+  if(width == 1) return (int8_t)diff;
+  if(width == 2) return (int16_t)diff;
+  return (int32_t)diff;
+}
+
+#if TELEM_DELTA_FLOAT_QUANTIZED
+/** @brief Escala de cuantificación de un F32 (10^decimales del esquema) */
+static inline double float_scale(uint8_t decimals) {
+  double scale = 1.0;
+  for(uint8_t d = 0; d < decimals; d++) scale *= 10.0;
+  return scale;
+}
+
+/**
+ * @brief Cuantifica un F32 a sus decimales
+ *
+ * @details En double para redondear sobre el valor exacto del float, y al
+ * par más cercano como printf y telemetry_schema_format_json(): así el JSON
+ * reconstruido en tierra es idéntico al del modo JSON, empates incluidos.
+ */
+static inline int32_t quantize(float value, double scale) {
+  return (int32_t)llrint((double)value * scale);
+}
+#endif
+
+/**
+ * @brief Codifica la diferencia de un elemento y deja en ref el valor que reconstruirá el decodificador
+ */
+static void encode_element(byte_writer_t* w, const telemetry_field_t* field, const uint8_t* cur, uint8_t* ref) {
+  uint8_t width = telemetry_field_width(field->kind);
+  if(field->kind == TELEM_FIELD_F32) {
+#if TELEM_DELTA_FLOAT_QUANTIZED
+    float value, prev;
+    memcpy(&value, cur, sizeof(value));
+    memcpy(&prev, ref, sizeof(prev));
+    double scale = float_scale(field->decimals);
+    int32_t q_prev = quantize(prev, scale);
+    int32_t delta = quantize(value, scale) - q_prev;
+    put_varint(w, zigzag(delta));
+    float rebuilt = (float)((q_prev + delta) / scale);
+    memcpy(ref, &rebuilt, sizeof(rebuilt));
+#else
+    uint32_t bits = load_raw(cur, 4);
+    put_varint(w, bits ^ load_raw(ref, 4));
+    memcpy(ref, &bits, 4);
+#endif
+    return;
+  }
+  uint32_t raw = load_raw(cur, width);
+  put_varint(w, zigzag(wrap_diff(raw - load_raw(ref, width), width)));
+  memcpy(ref, &raw, width);
+}
+
+/**
+ * @brief Aplica sobre ref la diferencia de un elemento
+ */
+static void decode_element(byte_reader_t* r, const telemetry_field_t* field, uint8_t* ref) {
+  uint8_t width = telemetry_field_width(field->kind);
+  uint32_t v = get_varint(r);
+  if(field->kind == TELEM_FIELD_F32) {
+#if TELEM_DELTA_FLOAT_QUANTIZED
+    float prev;
+    memcpy(&prev, ref, sizeof(prev));
+    double scale = float_scale(field->decimals);
+    float rebuilt = (float)((quantize(prev, scale) + unzigzag(v)) / scale);
+    memcpy(ref, &rebuilt, sizeof(rebuilt));
+#else
+    uint32_t bits = load_raw(ref, 4) ^ v;
+    memcpy(ref, &bits, 4);
+#endif
+    return;
+  }
+  uint32_t raw = load_raw(ref, width) + (uint32_t)unzigzag(v);
+  memcpy(ref, &raw, width);
+}
+
+/* ----------------------------------------------------------------------------
+ * API
+ * ------------------------------------------------------------------------- */
+
+void telemetry_delta_init(telemetry_delta_ctx_t* ctx, uint16_t keyframe_interval) {
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->keyframe_interval = keyframe_interval ? keyframe_interval : TELEM_DELTA_KEYFRAME_INTERVAL;
+}
+
+void telemetry_delta_invalidate(telemetry_delta_ctx_t* ctx, telem_data_type_t type) {
+  if((uint32_t)type < TELEM_DATA_TYPE_COUNT) {
+    ctx->valid[type] = false;
+  }
+}
+
+uint32_t telemetry_delta_encode(telemetry_delta_ctx_t* ctx, const telemetry_packet_t* packet,
+                                uint8_t* out, uint32_t capacity) {
+  const telemetry_schema_t* schema = telemetry_schema_get(packet->header.type);
+  if(!schema) {
+    return 0;
+  }
+
+  telem_data_type_t type = packet->header.type;
+  bool keyframe = !ctx->valid[type] || ctx->since_keyframe[type] + 1 >= ctx->keyframe_interval;
+  telemetry_packet_t* ref = &ctx->last[type];
+  telemetry_packet_t rebuilt = *ref; // La referencia solo se actualiza si el paquete cabe
+
+  byte_writer_t w = { out, capacity, 0, false };
+  put_byte(&w, (uint8_t)((keyframe ? TELEM_DELTA_KEYFRAME : 0) | ((packet->header.priority & 0x03) << 5) | type));
+
+  const uint8_t* cur = (const uint8_t*)packet;
+  uint8_t* base = (uint8_t*)&rebuilt;
+  if(keyframe) {
+    memset(&rebuilt, 0, sizeof(rebuilt));
+    put_le(&w, packet->header.timestamp, 4);
+    put_le(&w, packet->header.sequence, 2);
+    for(uint8_t f = 0; f < schema->field_count; f++) {
+      const telemetry_field_t* field = &schema->fields[f];
+      uint8_t width = telemetry_field_width(field->kind);
+      for(uint8_t i = 0; i < field->count; i++) {
+        uint32_t off = field->offset + i * width;
+        put_le(&w, load_raw(cur + off, width), width);
+        memcpy(base + off, cur + off, width);
+      }
+    }
+  } else {
+    put_varint(&w, zigzag((int32_t)(packet->header.timestamp - ref->header.timestamp)));
+    put_varint(&w, zigzag((int16_t)(packet->header.sequence - ref->header.sequence)));
+    for(uint8_t f = 0; f < schema->field_count; f++) {
+      const telemetry_field_t* field = &schema->fields[f];
+      uint8_t width = telemetry_field_width(field->kind);
+      for(uint8_t i = 0; i < field->count; i++) {
+        uint32_t off = field->offset + i * width;
+        encode_element(&w, field, cur + off, base + off);
+      }
+    }
+  }
+  if(w.overflow) {
+    return 0;
+  }
+
+  rebuilt.header = packet->header;
+  *ref = rebuilt;
+  ctx->valid[type] = true;
+  ctx->since_keyframe[type] = keyframe ? 0 : (uint16_t)(ctx->since_keyframe[type] + 1);
+  return w.len;
+}
+
+uint32_t telemetry_delta_decode(telemetry_delta_ctx_t* ctx, const uint8_t* in, uint32_t len,
+                                telemetry_packet_t* packet) {
+  byte_reader_t r = { in, len, 0, false };
+  uint8_t first = get_byte(&r);
+  telem_data_type_t type = (telem_data_type_t)(first & 0x1F);
+  const telemetry_schema_t* schema = telemetry_schema_get(type);
+  bool keyframe = (first & TELEM_DELTA_KEYFRAME) != 0;
+  if(r.error || !schema || (!keyframe && !ctx->valid[type])) {
+    return 0;
+  }
+
+  telemetry_packet_t rebuilt;
+  uint8_t* base = (uint8_t*)&rebuilt;
+  if(keyframe) {
+    memset(&rebuilt, 0, sizeof(rebuilt));
+    rebuilt.header.timestamp = get_le(&r, 4);
+    rebuilt.header.sequence = (uint16_t)get_le(&r, 2);
+    for(uint8_t f = 0; f < schema->field_count; f++) {
+      const telemetry_field_t* field = &schema->fields[f];
+      uint8_t width = telemetry_field_width(field->kind);
+      for(uint8_t i = 0; i < field->count; i++) {
+        uint32_t raw = get_le(&r, width);
+        memcpy(base + field->offset + i * width, &raw, width);
+      }
+    }
+  } else {
+    rebuilt = ctx->last[type];
+    rebuilt.header.timestamp += (uint32_t)unzigzag(get_varint(&r));
+    rebuilt.header.sequence = (uint16_t)(rebuilt.header.sequence + unzigzag(get_varint(&r)));
+    for(uint8_t f = 0; f < schema->field_count; f++) {
+      const telemetry_field_t* field = &schema->fields[f];
+      uint8_t width = telemetry_field_width(field->kind);
+      for(uint8_t i = 0; i < field->count; i++) {
+        decode_element(&r, field, base + field->offset + i * width);
+      }
+    }
+  }
+  if(r.error) {
+    return 0;
+  }
+
+  rebuilt.header.type = type;
+  rebuilt.header.priority = (uint8_t)((first >> 5) & 0x03);
+  ctx->last[type] = rebuilt;
+  ctx->valid[type] = true;
+  *packet = rebuilt;
+  return r.pos;
+}
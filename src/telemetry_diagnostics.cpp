@@ -15,14 +15,31 @@
 #include "../include/telemetry_diagnostics.h"
 #include "../include/telemetry_logger.h"
 #include "../include/telemetry_storage.h"
+#include "../include/telemetry_record.h"
 #include "../include/telemetry_tasks.h"
+#include "../include/telemetry_latency.h"
+#include "../include/telemetry_txbuf.h"
+#include "../include/telemetry_sink.h"
+#include "../include/telemetry_processing.h"
+#include "../include/telemetry_transmission.h"
+#include "../include/telemetry_acquisition.h"
 
 static uint32_t s_last_dump_ms = 0;
 static uint32_t s_last_status_ms = 0;
+static uint32_t s_last_capacity_ms = 0;
+static uint32_t s_last_state_ms = 0;
+static uint32_t s_last_latency_ms = 0;
+static uint32_t s_last_link_ms = 0;
+/** @brief Bytes enviados en el informe de enlace anterior */
+static uint32_t s_last_link_bytes = 0;
 
 void telemetry_diagnostics_init(void) {
   s_last_dump_ms = millis();
   s_last_status_ms = millis();
+  s_last_capacity_ms = millis();
+  s_last_state_ms = millis();
+  s_last_latency_ms = millis();
+  s_last_link_ms = millis();
   telemetry_logf("[DIAG] Init OK");
 }
 
@@ -36,6 +53,112 @@ void telemetry_diagnostics_tick(void) {
     s_last_dump_ms = now;
   }
 
+  // Capacidad efectiva del buffer si guardara registros de longitud variable,
+  // con la mezcla de tipos realmente escrita, cada 60 s
+  if (now - s_last_capacity_ms > 60000) {
+    uint32_t mix[TELEM_DATA_TYPE_COUNT];
+    for (int t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+      mix[t] = telemetry_get_written_by_type((telem_data_type_t)t);
+    }
+    telemetry_record_capacity_t cap;
+    telemetry_record_capacity_report(mix, TELEM_BUFFER_SIZE * TELEM_PACKET_SIZE, &cap);
+    telemetry_logf("[DIAG] Capacity: %lu.%02lu pkt/KB variable vs %lu.%02lu pkt/KB fixed (x%lu.%02lu, avg %lu.%02lu B/pkt, %lu pkt in %u B)",
+                   cap.packets_per_kb_x100 / 100, cap.packets_per_kb_x100 % 100,
+                   cap.fixed_packets_per_kb_x100 / 100, cap.fixed_packets_per_kb_x100 % 100,
+                   cap.gain_x100 / 100, cap.gain_x100 % 100,
+                   cap.avg_record_bytes_x100 / 100, cap.avg_record_bytes_x100 % 100,
+                   cap.capacity_packets, (unsigned)(TELEM_BUFFER_SIZE * TELEM_PACKET_SIZE));
+    s_last_capacity_ms = now;
+  }
+
+  // Estado actual de potencia cada 30 s, leído de la tabla de últimos valores
+  // (no consume paquetes del buffer ni bloquea a la adquisición)
+  if (now - s_last_state_ms > 30000) {
+    telemetry_packet_t latest;
+    if (telemetry_get_latest(TELEM_POWER_DATA, &latest)) {
+      telemetry_logf("[DIAG] Current power: %.2fV %.2fA %u%% (seq %u, t=%lus)",
+                     latest.power.battery_voltage, latest.power.battery_current,
+                     latest.power.battery_level, latest.header.sequence,
+                     (unsigned long)latest.header.timestamp);
+    }
+    s_last_state_ms = now;
+  }
+
+  // Latencias por etapa y tipo (p50/p99/max) cada 60 s
+  if (now - s_last_latency_ms > 60000) {
+    telemetry_latency_dump();
+    s_last_latency_ms = now;
+  }
+
+  // Caudal y ocupación del enlace de bajada cada 30 s
+  if (now - s_last_link_ms > 30000) {
+    telemetry_txbuf_stats_t tx;
+    telemetry_txbuf_get_stats(&tx);
+    uint32_t bytes = tx.bytes_written - s_last_link_bytes;
+    uint32_t elapsed_ms = now - s_last_link_ms;
+    uint32_t util = telemetry_txbuf_utilization_x100(bytes, elapsed_ms, TELEM_TXBUF_BAUD);
+    telemetry_logf("[DIAG] Downlink: %lu B/s, %lu.%02lu%% of %lu baud (pending %lu B, hwm %lu/%u B, %lu writes, %lu full)",
+                   (unsigned long)((uint64_t)bytes * 1000 / elapsed_ms), util / 100, util % 100,
+                   (unsigned long)TELEM_TXBUF_BAUD, tx.pending, tx.high_water, (unsigned)TELEM_TXBUF_BYTES,
+                   tx.writes, tx.producer_full);
+    s_last_link_bytes = tx.bytes_written;
+    s_last_link_ms = now;
+
+    // Salidas: lo que cada sink ha escrito y lo que ha perdido por ir lento
+    for (uint32_t i = 0; i < telemetry_sink_count(); i++) {
+      telemetry_sink_stats_t st;
+      const char* name = telemetry_sink_get_stats((int)i, &st);
+      telemetry_logf("[DIAG] Sink %s: %lu written, %lu dropped, %lu failed", name, st.delivered, st.dropped, st.failed);
+    }
+
+    // Coste del procesador: ciclos por paquete de todos los lotes frente a los de un paquete
+    telemetry_processing_cost_t cost;
+    telemetry_processing_get_cost(&cost);
+    if (cost.packets > 0) {
+      telemetry_logf("[DIAG] Processor: %lu pkt in %lu batches (max %lu, last %lu pkt/%lu cycles), %lu cycles/pkt, 1-pkt batches %lu cycles/pkt, %lu discarded",
+                     cost.packets, cost.batches, cost.max_batch, cost.last_packets, cost.last_cycles,
+                     (unsigned long)(cost.cycles / cost.packets),
+                     (unsigned long)(cost.single_batches ? cost.single_cycles / cost.single_batches : 0),
+                     cost.discarded);
+    }
+
+    // Avisos: publicaciones agrupadas en cada despertar y esperas agotadas
+    const telemetry_wake_t* proc = telemetry_processing_get_wake();
+    const telemetry_wake_t* xmit = telemetry_transmission_get_wake();
+    telemetry_logf("[DIAG] Wakeups: proc %lu of %lu signals (%lu timeouts), xmit %lu of %lu signals (%lu timeouts)",
+                   proc->notifies, proc->signals, proc->timeouts, xmit->notifies, xmit->signals, xmit->timeouts);
+
+    // Estadísticas por ventana: resúmenes emitidos y los que no cupieron en el buffer
+    uint32_t summaries_lost;
+    const telemetry_stats_t* stats = telemetry_processing_get_stats(&summaries_lost);
+    if(stats) {
+      telemetry_logf("[DIAG] Stats: %lu samples, %lu summaries (%lu lost), %lu restarts",
+                     stats->updates, stats->summaries, summaries_lost, stats->restarts);
+    }
+
+    // Límites: evaluaciones, eventos y límites fuera de nominal
+    uint32_t events_lost;
+    const telemetry_limits_t* limits = telemetry_acquisition_get_limits(&events_lost);
+    if(limits) {
+      uint32_t off_nominal = 0;
+      for(uint32_t i = 0; i < TELEM_LIMIT_COUNT; i++) {
+        if(telemetry_limits_state(limits, i) != TELEM_LIMIT_NOMINAL) off_nominal++;
+      }
+      telemetry_logf("[DIAG] Limits: %lu packets, %lu checks, %lu events (%lu lost), %lu of %u off nominal",
+                     limits->packets, limits->checks, limits->events, events_lost, off_nominal,
+                     (unsigned)TELEM_LIMIT_COUNT);
+    }
+
+    // Bajada por excepción: enviados y suprimidos de los tipos vigilados
+    const telemetry_rbe_t* rbe = telemetry_transmission_get_rbe();
+    if(rbe) {
+      const telemetry_rbe_counts_t* tmp = &rbe->counts[TELEM_TEMPERATURE_DATA];
+      const telemetry_rbe_counts_t* com = &rbe->counts[TELEM_COMMUNICATION_STATUS];
+      telemetry_logf("[DIAG] RBE: TMP %lu sent / %lu suppressed, COM %lu sent / %lu suppressed",
+                     tmp->sent, tmp->suppressed, com->sent, com->suppressed);
+    }
+  }
+
   // Reporte de uso de stack de tareas cada ~20s (solo si DEBUG_STACK está definido)
 #ifdef DEBUG_STACK
   if (now - s_last_status_ms > 20000) {
@@ -52,6 +175,16 @@ void telemetry_diagnostics_tick(void) {
       UBaseType_t hwm = uxTaskGetStackHighWaterMark(gTaskTransmitHandle);
       telemetry_logf("[STACK] TelemXmit high-water mark: %u stack words free", (unsigned)(hwm * sizeof(StackType_t)));
     }
+    if (gTaskTxWriterHandle) {
+      UBaseType_t hwm = uxTaskGetStackHighWaterMark(gTaskTxWriterHandle);
+      telemetry_logf("[STACK] TelemTxWriter high-water mark: %u stack words free", (unsigned)(hwm * sizeof(StackType_t)));
+    }
+    for (uint32_t i = 0; i < TELEM_SINK_MAX; i++) {
+      if (gTaskSinkHandles[i]) {
+        UBaseType_t hwm = uxTaskGetStackHighWaterMark(gTaskSinkHandles[i]);
+        telemetry_logf("[STACK] TelemSink%lu high-water mark: %u stack words free", i, (unsigned)(hwm * sizeof(StackType_t)));
+      }
+    }
   }
 #endif
 }
\ No newline at end of file
@@ -0,0 +1,343 @@
+/**
+ * @file telemetry_frame.cpp
+ * @brief Implementación del entramado binario de bajada (CCSDS + CRC-16 + COBS)
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Sin dependencias de Arduino ni de FreeRTOS: se usa igual en el ESP32 y en
+ * el decodificador del host.
+ */
+
+  #include <string.h>
+  #include "../include/telemetry_frame.h"
+  #include "../include/telemetry_schema.h"
+  #include "../include/telemetry_delta.h"
+
+uint16_t telemetry_crc16(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for(size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for(int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Codifica en COBS (sin delimitador)
+ *
+ * @return size_t Bytes escritos en out (como máximo len + len / 254 + 1)
+ */
+static size_t cobs_encode(const uint8_t* in, size_t len, uint8_t* out) {
+  size_t code_pos = 0;
+  size_t pos = 1;
+  uint8_t code = 1;
+  for(size_t i = 0; i < len; i++) {
+    if(in[i] == 0) {
+      out[code_pos] = code;
+      code_pos = pos++;
+      code = 1;
+      continue;
+    }
+    out[pos++] = in[i];
+    if(++code == 0xFF) {
+      out[code_pos] = code;
+      code_pos = pos++;
+      code = 1;
+    }
+  }
+  out[code_pos] = code;
+  return pos;
+}
+
+/**
+ * @brief Decodifica COBS
+ *
+ * @return size_t Bytes decodificados (0 si la entrada no es COBS válido o no cabe)
+ */
+static size_t cobs_decode(const uint8_t* in, size_t len, uint8_t* out, size_t capacity) {
+  size_t pos = 0;
+  size_t i = 0;
+  while(i < len) {
+    uint8_t code = in[i++];
+    if(code == 0 || i + code - 1 > len || pos + code - 1 > capacity) {
+      return 0;
+    }
+    for(uint8_t k = 1; k < code; k++) {
+      out[pos++] = in[i++];
+    }
+    if(code != 0xFF && i < len) {
+      if(pos >= capacity) return 0;
+      out[pos++] = 0;
+    }
+  }
+  return pos;
+}
+
+/**
+ * @brief Añade cabecera CCSDS y CRC a unos datos ya escritos en raw + TELEM_FRAME_HEADER_BYTES y los entrama
+ *
+ * @param flags Bits de la primera palabra de la cabecera (tipo TC, cabecera secundaria)
+ */
+static size_t frame_wrap(uint8_t* raw, uint32_t data_len, uint16_t apid, uint16_t flags, uint16_t seq_count,
+                         uint8_t* out, size_t capacity) {
+  // Cabecera primaria: versión 0
+  apid = (uint16_t)((apid & 0x07FF) | flags);
+  uint16_t seq = (uint16_t)(0xC000 | (seq_count & 0x3FFF)); // No segmentado
+  uint16_t length = (uint16_t)(data_len + TELEM_FRAME_CRC_BYTES - 1);
+  raw[0] = (uint8_t)(apid >> 8);
+  raw[1] = (uint8_t)apid;
+  raw[2] = (uint8_t)(seq >> 8);
+  raw[3] = (uint8_t)seq;
+  raw[4] = (uint8_t)(length >> 8);
+  raw[5] = (uint8_t)length;
+
+  size_t raw_len = TELEM_FRAME_HEADER_BYTES + data_len;
+  uint16_t crc = telemetry_crc16(raw, raw_len);
+  raw[raw_len++] = (uint8_t)(crc >> 8);
+  raw[raw_len++] = (uint8_t)crc;
+
+  if(capacity < raw_len + raw_len / 254 + 1 + 2) {
+    return 0;
+  }
+  out[0] = 0x00;
+  size_t n = 1 + cobs_encode(raw, raw_len, out + 1);
+  out[n++] = 0x00;
+  return n;
+}
+
+/**
+ * @brief Deshace el COBS y comprueba CRC y longitud
+ *
+ * @param[out] raw Contenido decodificado
+ * @param[out] apid APID de la cabecera
+ * @param[out] seq_count Contador de secuencia de la cabecera
+ * @param[out] flags Bits de tipo y cabecera secundaria de la cabecera
+ * @param[out] data Inicio de los datos en raw (tras la cabecera secundaria, si la hay)
+ * @param[out] link_seq Secuencia ARQ de la cabecera secundaria (-1 si no la lleva)
+ * @return uint32_t Bytes de datos (0 si la trama no es válida)
+ */
+static uint32_t frame_unwrap(const uint8_t* frame, size_t len, uint8_t* raw, uint16_t* apid, uint16_t* seq_count,
+                             uint16_t* flags, const uint8_t** data, int32_t* link_seq) {
+  size_t raw_len = cobs_decode(frame, len, raw, TELEM_FRAME_MAX_RAW);
+  if(raw_len < TELEM_FRAME_HEADER_BYTES + TELEM_FRAME_CRC_BYTES + 1) {
+    return 0;
+  }
+
+  uint16_t crc = (uint16_t)((raw[raw_len - 2] << 8) | raw[raw_len - 1]);
+  if(telemetry_crc16(raw, raw_len - TELEM_FRAME_CRC_BYTES) != crc) {
+    return 0;
+  }
+
+  uint16_t length = (uint16_t)((raw[4] << 8) | raw[5]);
+  if((size_t)length + 1 != raw_len - TELEM_FRAME_HEADER_BYTES) {
+    return 0;
+  }
+
+  uint16_t word = (uint16_t)((raw[0] << 8) | raw[1]);
+  *apid = (uint16_t)(word & 0x07FF);
+  *flags = (uint16_t)(word & (TELEM_FRAME_FLAG_TC | TELEM_FRAME_FLAG_SECONDARY));
+  *seq_count = (uint16_t)(((raw[2] << 8) | raw[3]) & 0x3FFF);
+  uint32_t data_len = (uint32_t)(raw_len - TELEM_FRAME_HEADER_BYTES - TELEM_FRAME_CRC_BYTES);
+  *data = raw + TELEM_FRAME_HEADER_BYTES;
+  *link_seq = -1;
+  if(*flags & TELEM_FRAME_FLAG_SECONDARY) {
+    if(data_len <= TELEM_FRAME_SECONDARY_BYTES) {
+      return 0;
+    }
+    *link_seq = (int32_t)(((*data)[0] << 8) | (*data)[1]);
+    *data += TELEM_FRAME_SECONDARY_BYTES;
+    data_len -= TELEM_FRAME_SECONDARY_BYTES;
+  }
+  return data_len;
+}
+
+/**
+ * @brief Trama de un paquete con codificación de esquema (ctx NULL) o delta
+ */
+static size_t frame_encode(telemetry_delta_ctx_t* ctx, const telemetry_packet_t* packet, uint16_t seq_count,
+                           int32_t link_seq, uint8_t* out, size_t capacity) {
+  uint8_t raw[TELEM_FRAME_MAX_RAW];
+  uint32_t offset = TELEM_FRAME_HEADER_BYTES;
+  uint16_t flags = 0;
+  if(link_seq >= 0) {
+    raw[offset++] = (uint8_t)(link_seq >> 8);
+    raw[offset++] = (uint8_t)link_seq;
+    flags = TELEM_FRAME_FLAG_SECONDARY;
+  }
+  uint32_t max_data = TELEM_FRAME_MAX_RAW - offset - TELEM_FRAME_CRC_BYTES;
+  uint32_t data_len = ctx ? telemetry_delta_encode(ctx, packet, raw + offset, max_data)
+                          : telemetry_schema_encode(packet, raw + offset, max_data);
+  if(data_len == 0) {
+    return 0;
+  }
+  uint16_t apid = (uint16_t)((ctx ? TELEM_FRAME_APID_DELTA_BASE : TELEM_FRAME_APID_BASE) + packet->header.type);
+  return frame_wrap(raw, offset - TELEM_FRAME_HEADER_BYTES + data_len, apid, flags, seq_count, out, capacity);
+}
+
+size_t telemetry_frame_encode(const telemetry_packet_t* packet, uint16_t seq_count, uint8_t* out, size_t capacity) {
+  return frame_encode(NULL, packet, seq_count, -1, out, capacity);
+}
+
+size_t telemetry_frame_encode_delta(telemetry_delta_ctx_t* ctx, const telemetry_packet_t* packet,
+                                    uint16_t seq_count, uint8_t* out, size_t capacity) {
+  return frame_encode(ctx, packet, seq_count, -1, out, capacity);
+}
+
+size_t telemetry_frame_encode_link(telemetry_delta_ctx_t* ctx, const telemetry_packet_t* packet,
+                                   uint16_t seq_count, uint16_t link_seq, uint8_t* out, size_t capacity) {
+  return frame_encode(ctx, packet, seq_count, link_seq, out, capacity);
+}
+
+size_t telemetry_frame_encode_ack(uint16_t cumulative, uint32_t selective, uint8_t* out, size_t capacity) {
+  uint8_t raw[TELEM_FRAME_HEADER_BYTES + TELEM_FRAME_ACK_BYTES + TELEM_FRAME_CRC_BYTES];
+  uint8_t* data = raw + TELEM_FRAME_HEADER_BYTES;
+  data[0] = (uint8_t)(cumulative >> 8);
+  data[1] = (uint8_t)cumulative;
+  data[2] = (uint8_t)(selective >> 24);
+  data[3] = (uint8_t)(selective >> 16);
+  data[4] = (uint8_t)(selective >> 8);
+  data[5] = (uint8_t)selective;
+  return frame_wrap(raw, TELEM_FRAME_ACK_BYTES, TELEM_FRAME_APID_ACK, TELEM_FRAME_FLAG_TC, 0, out, capacity);
+}
+
+bool telemetry_frame_decode_ack(const uint8_t* frame, size_t len, uint16_t* cumulative, uint32_t* selective) {
+  uint8_t raw[TELEM_FRAME_MAX_RAW];
+  uint16_t apid, seq, flags;
+  const uint8_t* data;
+  int32_t link_seq;
+  if(frame_unwrap(frame, len, raw, &apid, &seq, &flags, &data, &link_seq) != TELEM_FRAME_ACK_BYTES ||
+     apid != TELEM_FRAME_APID_ACK || flags != TELEM_FRAME_FLAG_TC) {
+    return false;
+  }
+  *cumulative = (uint16_t)((data[0] << 8) | data[1]);
+  *selective = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) | ((uint32_t)data[4] << 8) | data[5];
+  return true;
+}
+
+int32_t telemetry_frame_link_seq(const uint8_t* frame, size_t len) {
+  uint8_t raw[TELEM_FRAME_MAX_RAW];
+  uint16_t apid, seq, flags;
+  const uint8_t* data;
+  int32_t link_seq;
+  if(frame_unwrap(frame, len, raw, &apid, &seq, &flags, &data, &link_seq) == 0 || (flags & TELEM_FRAME_FLAG_TC)) {
+    return -1;
+  }
+  return link_seq;
+}
+
+bool telemetry_frame_decode(const uint8_t* frame, size_t len, telemetry_packet_t* packet, uint16_t* seq_count) {
+  uint8_t raw[TELEM_FRAME_MAX_RAW];
+  uint16_t apid, seq, flags;
+  const uint8_t* data;
+  int32_t link_seq;
+  uint32_t data_len = frame_unwrap(frame, len, raw, &apid, &seq, &flags, &data, &link_seq);
+  if(data_len == 0 || (flags & TELEM_FRAME_FLAG_TC) ||
+     telemetry_schema_decode(data, data_len, packet) != data_len ||
+     apid != TELEM_FRAME_APID_BASE + packet->header.type) {
+    return false;
+  }
+  if(seq_count) {
+    *seq_count = seq;
+  }
+  return true;
+}
+
+/**
+ * @brief Decodifica una trama en el receptor, delta incluidas
+ *
+ * @return int 1 = paquete válido, 0 = trama delta válida sin referencia, -1 = trama inválida
+ */
+static int rx_decode(telemetry_frame_rx_t* rx, const uint8_t* frame, size_t len,
+                     telemetry_packet_t* packet, uint16_t* seq_count) {
+  uint8_t raw[TELEM_FRAME_MAX_RAW];
+  uint16_t apid, seq, flags;
+  const uint8_t* data;
+  int32_t link_seq;
+  uint32_t data_len = frame_unwrap(frame, len, raw, &apid, &seq, &flags, &data, &link_seq);
+  if(data_len == 0 || (flags & TELEM_FRAME_FLAG_TC)) {
+    return -1;
+  }
+
+  if(apid >= TELEM_FRAME_APID_DELTA_BASE && apid < TELEM_FRAME_APID_DELTA_BASE + TELEM_DATA_TYPE_COUNT) {
+    if(!rx->delta) {
+      return -1;
+    }
+    telem_data_type_t type = (telem_data_type_t)(apid - TELEM_FRAME_APID_DELTA_BASE);
+    // Un salto en el contador significa tramas perdidas: la referencia ya no vale
+    if(seq != rx->delta_next_seq[type]) {
+      telemetry_delta_invalidate(rx->delta, type);
+    }
+    rx->delta_next_seq[type] = (uint16_t)((seq + 1) & 0x3FFF);
+    if(!(data[0] & TELEM_DELTA_KEYFRAME) && !rx->delta->valid[type]) {
+      return 0;
+    }
+    if(telemetry_delta_decode(rx->delta, data, data_len, packet) != data_len ||
+       packet->header.type != type) {
+      telemetry_delta_invalidate(rx->delta, type);
+      return -1;
+    }
+  } else if(telemetry_schema_decode(data, data_len, packet) != data_len ||
+            apid != TELEM_FRAME_APID_BASE + packet->header.type) {
+    return -1;
+  }
+  if(seq_count) {
+    *seq_count = seq;
+  }
+  return 1;
+}
+
+void telemetry_frame_rx_init(telemetry_frame_rx_t* rx) {
+  rx->len = 0;
+  rx->overflow = false;
+  rx->complete = false;
+  rx->frames_ok = 0;
+  rx->frames_bad = 0;
+  rx->delta = NULL;
+  memset(rx->delta_next_seq, 0, sizeof(rx->delta_next_seq));
+  rx->frames_unsynced = 0;
+}
+
+bool telemetry_frame_split(telemetry_frame_rx_t* rx, uint8_t byte) {
+  if(rx->complete) {
+    rx->len = 0;
+    rx->complete = false;
+  }
+  if(byte != 0x00) {
+    if(rx->len < sizeof(rx->buf)) {
+      rx->buf[rx->len++] = byte;
+    } else {
+      rx->overflow = true;
+    }
+    return false;
+  }
+
+  // Delimitador: cerrar la trama en curso (vacía entre dos delimitadores seguidos)
+  bool ready = (rx->len > 0);
+  if(ready && rx->overflow) {
+    rx->frames_bad++;
+    ready = false;
+  }
+  rx->overflow = false;
+  rx->complete = true;
+  return ready;
+}
+
+bool telemetry_frame_rx_decode(telemetry_frame_rx_t* rx, const uint8_t* frame, size_t len,
+                               telemetry_packet_t* packet, uint16_t* seq_count) {
+  int result = rx_decode(rx, frame, len, packet, seq_count);
+  if(result > 0) {
+    rx->frames_ok++;
+  } else if(result == 0) {
+    rx->frames_unsynced++;
+  } else {
+    rx->frames_bad++;
+  }
+  return result > 0;
+}
+
+bool telemetry_frame_rx_push(telemetry_frame_rx_t* rx, uint8_t byte, telemetry_packet_t* packet, uint16_t* seq_count) {
+  return telemetry_frame_split(rx, byte) && telemetry_frame_rx_decode(rx, rx->buf, rx->len, packet, seq_count);
+}
@@ -0,0 +1,158 @@
+/**
+ * @file telemetry_latency.cpp
+ * @brief Implementación de los histogramas de latencia por etapa y tipo
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Intervalo b de un histograma (dos por octava):
+ * - b = 0, 1: exactamente 0 y 1 µs
+ * - b >= 2: octava m = b / 2 partida en [2^m, 1.5·2^m) y [1.5·2^m, 2^(m+1))
+ */
+
+  #include <string.h>
+  #include "esp_timer.h"
+  #include "../include/telemetry_latency.h"
+  #include "../include/telemetry_logger.h"
+  #include "../include/telemetry_schema.h"
+
+/**
+ * @brief Histograma de una etapa para un tipo
+ */
+typedef struct {
+  uint32_t buckets[TELEM_LATENCY_BUCKETS]; /**< Muestras por intervalo */
+  uint32_t samples;                        /**< Total de muestras */
+  uint32_t max_us;                         /**< Máximo exacto */
+} latency_histogram_t;
+
+#if TELEM_LATENCY_TRACE
+static latency_histogram_t s_hist[TELEM_LATENCY_STAGE_COUNT][TELEM_DATA_TYPE_COUNT];
+#endif
+
+/** @brief Etapa que informará el siguiente paquete TELEM_LATENCY_METRICS */
+static uint8_t s_next_stage = 0;
+
+static const char* const s_stage_names[TELEM_LATENCY_STAGE_COUNT] = {
+  "acquire", "proc-queue", "xmit-queue", "transmit", "end-to-end"
+};
+
+uint32_t telemetry_latency_now(void) {
+  return (uint32_t)esp_timer_get_time();
+}
+
+static inline uint8_t bucket_of(uint32_t us) {
+  if(us < 2) {
+    return (uint8_t)us;
+  }
+  uint8_t msb = (uint8_t)(31 - __builtin_clz(us));
+  return (uint8_t)(2 * msb + ((us >> (msb - 1)) & 1));
+}
+
+static inline uint32_t bucket_low(uint8_t b) {
+  return (b < 2) ? b : (uint32_t)(2 + (b & 1)) << (b / 2 - 1);
+}
+
+static inline uint32_t bucket_width(uint8_t b) {
+  return (b < 2) ? 1 : (uint32_t)1 << (b / 2 - 1);
+}
+
+void telemetry_latency_record(telem_latency_stage_t stage, telem_data_type_t type, uint32_t elapsed_us) {
+#if TELEM_LATENCY_TRACE
+  if((uint32_t)stage >= TELEM_LATENCY_STAGE_COUNT || (uint32_t)type >= TELEM_DATA_TYPE_COUNT) {
+    return;
+  }
+  latency_histogram_t* h = &s_hist[stage][type];
+  __atomic_fetch_add(&h->buckets[bucket_of(elapsed_us)], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&h->samples, 1, __ATOMIC_RELAXED);
+  // Un solo escritor por etapa: no hace falta CAS para el máximo
+  if(elapsed_us > __atomic_load_n(&h->max_us, __ATOMIC_RELAXED)) {
+    __atomic_store_n(&h->max_us, elapsed_us, __ATOMIC_RELAXED);
+  }
+#else
+  (void)stage;
+  (void)type;
+  (void)elapsed_us;
+#endif
+}
+
+#if TELEM_LATENCY_TRACE
+/**
+ * @brief Valor del percentil (rank-ésima muestra) interpolado dentro de su intervalo
+ */
+static uint32_t percentile(const uint32_t* buckets, uint32_t rank, uint32_t max_us) {
+  uint32_t cumulative = 0;
+  for(uint8_t b = 0; b < TELEM_LATENCY_BUCKETS; b++) {
+    if(buckets[b] == 0) continue;
+    if(cumulative + buckets[b] >= rank) {
+      uint64_t value = bucket_low(b) + (uint64_t)bucket_width(b) * (rank - cumulative) / buckets[b];
+      return (value < max_us) ? (uint32_t)value : max_us;
+    }
+    cumulative += buckets[b];
+  }
+  return max_us;
+}
+#endif
+
+void telemetry_latency_summary(telem_latency_stage_t stage, uint32_t type, telemetry_latency_summary_t* summary) {
+  memset(summary, 0, sizeof(*summary));
+#if TELEM_LATENCY_TRACE
+  if((uint32_t)stage >= TELEM_LATENCY_STAGE_COUNT || type > TELEM_LATENCY_ALL_TYPES) {
+    return;
+  }
+
+  // Copia (o suma de todos los tipos) para calcular sobre datos estables
+  uint32_t buckets[TELEM_LATENCY_BUCKETS] = { 0 };
+  uint32_t first = (type == TELEM_LATENCY_ALL_TYPES) ? 0 : type;
+  uint32_t last = (type == TELEM_LATENCY_ALL_TYPES) ? TELEM_DATA_TYPE_COUNT : type + 1;
+  for(uint32_t t = first; t < last; t++) {
+    const latency_histogram_t* h = &s_hist[stage][t];
+    for(uint8_t b = 0; b < TELEM_LATENCY_BUCKETS; b++) {
+      uint32_t n = __atomic_load_n(&h->buckets[b], __ATOMIC_RELAXED);
+      buckets[b] += n;
+      summary->samples += n;
+    }
+    uint32_t max_us = __atomic_load_n(&h->max_us, __ATOMIC_RELAXED);
+    if(max_us > summary->max_us) summary->max_us = max_us;
+  }
+  if(summary->samples == 0) {
+    return;
+  }
+  summary->p50_us = percentile(buckets, (summary->samples + 1) / 2, summary->max_us);
+  summary->p99_us = percentile(buckets, (uint32_t)(((uint64_t)summary->samples * 99 + 99) / 100), summary->max_us);
+#else
+  (void)stage;
+  (void)type;
+#endif
+}
+
+void telemetry_latency_dump(void) {
+#if TELEM_LATENCY_TRACE
+  telemetry_logf("[LAT] %-10s %-12s %8s %10s %10s %10s", "stage", "type", "samples", "p50_us", "p99_us", "max_us");
+  for(uint8_t s = 0; s < TELEM_LATENCY_STAGE_COUNT; s++) {
+    for(uint32_t t = 0; t <= TELEM_LATENCY_ALL_TYPES; t++) {
+      telemetry_latency_summary_t sum;
+      telemetry_latency_summary((telem_latency_stage_t)s, t, &sum);
+      if(sum.samples == 0 && t != TELEM_LATENCY_ALL_TYPES) continue;
+      const telemetry_schema_t* schema = telemetry_schema_get((telem_data_type_t)t);
+      telemetry_logf("[LAT] %-10s %-12s %8lu %10lu %10lu %10lu", s_stage_names[s],
+                     (t == TELEM_LATENCY_ALL_TYPES) ? "all" : (schema ? schema->json_type : "?"),
+                     (unsigned long)sum.samples, (unsigned long)sum.p50_us,
+                     (unsigned long)sum.p99_us, (unsigned long)sum.max_us);
+    }
+  }
+#else
+  telemetry_logf("[LAT] Latency tracing disabled (TELEM_LATENCY_TRACE=0)");
+#endif
+}
+
+void telemetry_latency_fill_packet(telemetry_packet_t* packet) {
+  latency_metrics_telem_t* lat = &packet->latency;
+  telemetry_latency_summary_t sum;
+  telemetry_latency_summary((telem_latency_stage_t)s_next_stage, TELEM_LATENCY_ALL_TYPES, &sum);
+  lat->stage = s_next_stage;
+  lat->samples = sum.samples;
+  lat->p50_us = sum.p50_us;
+  lat->p99_us = sum.p99_us;
+  lat->max_us = sum.max_us;
+  s_next_stage = (uint8_t)((s_next_stage + 1) % TELEM_LATENCY_STAGE_COUNT);
+}
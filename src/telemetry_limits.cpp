@@ -0,0 +1,171 @@
+/**
+ * @file telemetry_limits.cpp
+ * @brief Implementación de la comprobación de límites
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * La histéresis se aplica desplazando el valor hacia el lado del estado
+ * actual: si el estado es bajo, un valor que mejora se clasifica como
+ * x - histéresis; si es alto, como x + histéresis. Así un valor que oscila
+ * sobre el umbral no cambia de estado, y basta una sola clasificación más.
+ */
+
+  #include <stddef.h>
+  #include <string.h>
+  #include "../include/telemetry_limits.h"
+  #include "../include/telemetry_schema.h"
+
+/**
+ * @brief Definición constante de un límite (generada de TELEM_LIMITS_TABLE)
+ */
+typedef struct {
+  telem_data_type_t type;
+  uint8_t offset;           /**< offsetof del miembro en su estructura */
+  float red_low;
+  float yellow_low;
+  float yellow_high;
+  float red_high;
+  float hysteresis;
+  uint8_t persistence;      /**< Paquetes seguidos para aceptar un estado (0 = 1) */
+} telemetry_limit_def_t;
+
+#define TELEM_LIMIT_CHECK(t, st, m, rl, yl, yh, rh, h, p) \
+  static_assert((rl) <= (yl) && (yl) < (yh) && (yh) <= (rh), #st "." #m ": umbrales fuera de orden"); \
+  static_assert((h) >= 0.0f && (p) <= 255, #st "." #m ": histéresis o persistencia no válidas");
+TELEM_LIMITS_TABLE(TELEM_LIMIT_CHECK)
+
+#define TELEM_LIMIT_DEF(t, st, m, rl, yl, yh, rh, h, p) \
+  { t, (uint8_t)offsetof(st, m), rl, yl, yh, rh, h, (uint8_t)(p) },
+
+static const telemetry_limit_def_t s_defs[TELEM_LIMIT_COUNT] = { TELEM_LIMITS_TABLE(TELEM_LIMIT_DEF) };
+
+static_assert(TELEM_LIMIT_COUNT < TELEM_LIMIT_END, "demasiados límites para los índices de 8 bits");
+
+static const char* const s_state_names[] = { "NOMINAL", "YELLOW_LOW", "YELLOW_HIGH", "RED_LOW", "RED_HIGH" };
+
+static inline uint8_t severity(uint8_t state) {
+  return (state == TELEM_LIMIT_NOMINAL) ? 0 : (state <= TELEM_LIMIT_YELLOW_HIGH) ? 1 : 2;
+}
+
+static inline bool low_side(uint8_t state) {
+  return state == TELEM_LIMIT_YELLOW_LOW || state == TELEM_LIMIT_RED_LOW;
+}
+
+static uint8_t classify(const telemetry_limit_def_t* def, float x) {
+  if(x < def->red_low) return TELEM_LIMIT_RED_LOW;
+  if(x > def->red_high) return TELEM_LIMIT_RED_HIGH;
+  if(x < def->yellow_low) return TELEM_LIMIT_YELLOW_LOW;
+  if(x > def->yellow_high) return TELEM_LIMIT_YELLOW_HIGH;
+  return TELEM_LIMIT_NOMINAL;
+}
+
+/**
+ * @brief Umbral de la zona de un estado (el que separa la zona de la menos grave)
+ */
+static float zone_threshold(const telemetry_limit_def_t* def, uint8_t state) {
+  switch(state) {
+    case TELEM_LIMIT_YELLOW_LOW:  return def->yellow_low;
+    case TELEM_LIMIT_YELLOW_HIGH: return def->yellow_high;
+    case TELEM_LIMIT_RED_LOW:     return def->red_low;
+    case TELEM_LIMIT_RED_HIGH:    return def->red_high;
+    default:                      return 0.0f;
+  }
+}
+
+uint32_t telemetry_limits_init(telemetry_limits_t* limits) {
+  memset(limits, 0, sizeof(*limits));
+  memset(limits->first, TELEM_LIMIT_END, sizeof(limits->first));
+
+  // Encadenar de atrás hacia delante: cada tipo recorre sus límites en el orden de la tabla
+  for(int i = TELEM_LIMIT_COUNT - 1; i >= 0; i--) {
+    telemetry_limit_slot_t* slot = &limits->slots[i];
+    slot->field = TELEM_LIMIT_END;
+    slot->next = TELEM_LIMIT_END;
+    const telemetry_schema_t* schema = telemetry_schema_get(s_defs[i].type);
+    for(uint8_t f = 0; schema && f < schema->field_count; f++) {
+      if(schema->fields[f].offset == s_defs[i].offset && schema->fields[f].count == 1) {
+        slot->field = f;
+        slot->kind = schema->fields[f].kind;
+        slot->decimals = schema->fields[f].decimals;
+        break;
+      }
+    }
+    if(slot->field == TELEM_LIMIT_END) {
+      limits->unresolved++;
+      continue;
+    }
+    slot->next = limits->first[s_defs[i].type];
+    limits->first[s_defs[i].type] = (uint8_t)i;
+  }
+  return limits->unresolved;
+}
+
+uint32_t telemetry_limits_evaluate(telemetry_limits_t* limits, const telemetry_packet_t* packet,
+                                   telemetry_packet_t* events, uint32_t capacity) {
+  if((uint32_t)packet->header.type >= TELEM_DATA_TYPE_COUNT) {
+    return 0;
+  }
+  limits->packets++;
+  uint32_t written = 0;
+
+  for(uint8_t i = limits->first[packet->header.type]; i != TELEM_LIMIT_END; i = limits->slots[i].next) {
+    const telemetry_limit_def_t* def = &s_defs[i];
+    telemetry_limit_slot_t* slot = &limits->slots[i];
+    float x = telemetry_field_value(packet, def->offset, slot->kind, slot->decimals);
+    limits->checks++;
+
+    uint8_t candidate = classify(def, x);
+    if(severity(candidate) < severity(slot->state)) {
+      // Mejora: debe rebasar el umbral en la histéresis
+      candidate = classify(def, low_side(slot->state) ? x - def->hysteresis : x + def->hysteresis);
+      if(severity(candidate) > severity(slot->state)) {
+        candidate = slot->state;
+      }
+    }
+    if(candidate == slot->state) {
+      slot->pending = slot->state;
+      slot->count = 0;
+      continue;
+    }
+    if(candidate != slot->pending) {
+      slot->pending = candidate;
+      slot->count = 0;
+    }
+    if(++slot->count < def->persistence) {
+      continue;
+    }
+
+    uint8_t previous = slot->state;
+    slot->state = candidate;
+    slot->count = 0;
+    limits->events++;
+    if(written >= capacity) {
+      continue;
+    }
+    telemetry_packet_t* out = &events[written++];
+    memset(out, 0, sizeof(*out));
+    limit_event_telem_t* ev = &out->event;
+    ev->header.type = TELEM_LIMIT_EVENT;
+    ev->header.timestamp = packet->header.timestamp;
+    ev->header.sequence = limits->sequence++;
+    ev->header.priority = TELEM_PRIORITY_HIGH;
+    ev->source_type = (uint8_t)packet->header.type;
+    ev->field = slot->field;
+    ev->limit = i;
+    ev->state = candidate;
+    ev->previous = previous;
+    ev->value = x;
+    // Al empeorar, el umbral de la zona nueva; al mejorar, el de la zona que se deja
+    ev->threshold = zone_threshold(def, (severity(candidate) > severity(previous)) ? candidate : previous);
+  }
+  return written;
+}
+
+telem_limit_state_t telemetry_limits_state(const telemetry_limits_t* limits, uint32_t index) {
+  return (index < TELEM_LIMIT_COUNT) ? (telem_limit_state_t)limits->slots[index].state : TELEM_LIMIT_NOMINAL;
+}
+
+const char* telemetry_limit_state_name(uint8_t state) {
+  return (state < sizeof(s_state_names) / sizeof(s_state_names[0])) ? s_state_names[state] : "?";
+}
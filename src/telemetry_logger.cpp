@@ -7,6 +7,11 @@
  * @details  Este módulo implementa un logger simple de telemetría
  * que escribe mensajes formateados en un archivo de LittleFS.
  * El logger también imprime los mensajes en el puerto serie. 
+ *
+ * Cada línea se formatea una vez y se publica en el canal de su fichero
+ * (telemetry_sink.h): el sink de Serial y el de LittleFS la escriben desde
+ * sus tareas (vTelemetrySinkTask, creadas en telemetry_logger_init()), así
+ * que quien registra no espera a la UART ni a la flash.
  */
 
 #include <Arduino.h>
@@ -14,6 +19,8 @@
 #include <LittleFS.h>
 #include <stdarg.h>
 #include "../include/telemetry_logger.h"
+#include "../include/telemetry_sink.h"
+#include "../include/telemetry_tasks.h"
 
 // Implementación mínima sin mutex (solo usada desde loop/setup)
 static bool s_logger_ready = false;
@@ -28,26 +35,52 @@ bool telemetry_logger_init(void) {
   
   // Limpiar todos los archivos de telemetría al inicio
   telemetry_clear_all_logs();
+
+  // Consola con lo último (descarta lo antiguo); ficheros sin huecos en medio
+  telemetry_sink_init();
+  telemetry_sink_add(telemetry_sink_serial(), TELEM_SINK_CH_LOGS, TELEM_SINK_DROP_OLDEST);
+  telemetry_sink_add(telemetry_sink_littlefs(),
+                     TELEM_SINK_CH_LOGS | (TELEM_SINK_DOWNLINK_CAPTURE ? TELEM_SINK_CH_DOWNLINK : 0),
+                     TELEM_SINK_DROP_NEWEST);
+#if TELEM_SINK_ASYNC
+  // Una tarea por sink; hasta que arranca y se registra, quien publica escribe en él
+  for (uint32_t i = 0; i < telemetry_sink_count(); i++) {
+    if (gTaskSinkHandles[i] != NULL) continue;
+    char name[16];
+    snprintf(name, sizeof(name), "TelemSink%lu", (unsigned long)i);
+    if (xTaskCreate(vTelemetrySinkTask, name, TELEM_SINK_TASK_STACK, (void*)(intptr_t)i, tskIDLE_PRIORITY + 1,
+                    &gTaskSinkHandles[i]) != pdPASS) {
+      gTaskSinkHandles[i] = NULL;
+      Serial.printf("[Logger] ERROR creando la tarea del sink %lu: se escribe desde quien registra\n", (unsigned long)i);
+    }
+  }
+#endif
   
   return true;
 }
 
+/**
+ * @brief Formatea una línea (terminada en CRLF, como println) y la publica en su canal
+ *
+ * @param capacity Caracteres de la línea como máximo (sin CRLF)
+ */
+static void log_line(uint32_t channel, size_t capacity, const char *fmt, va_list args) {
+  char buffer[202];
+  if (capacity > sizeof(buffer) - 2) capacity = sizeof(buffer) - 2;
+  int n = vsnprintf(buffer, capacity, fmt, args);
+  if (n < 0) return;
+  size_t len = ((size_t)n < capacity) ? (size_t)n : capacity - 1;
+  buffer[len++] = '\r';
+  buffer[len++] = '\n';
+  telemetry_sink_publish(channel, buffer, (uint32_t)len);
+}
+
 void telemetry_logf(const char *fmt, ...) {
   if (!s_logger_ready) return;
-  char buffer[160];
   va_list args;
   va_start(args, fmt);
-  vsnprintf(buffer, sizeof(buffer), fmt, args);
+  log_line(TELEM_SINK_CH_LOG, 160, fmt, args);
   va_end(args);
-  // Serial
-  Serial.println(buffer);
-
-  // Archivo
-  File f = LittleFS.open(TELEMETRY_LOG_FILE, FILE_APPEND);
-  if (f) {
-    f.println(buffer);
-    f.close();
-  }
 }
 
 void telemetry_dump_log(void) {
@@ -110,57 +143,36 @@ void telemetry_clear_all_logs(void) {
 // Funciones de logging específicas por tipo de telemetría
 // ============================================================================
 
-static void write_to_file(const char *filename, const char *buffer) {
-  if (!s_logger_ready) return;
-  File f = LittleFS.open(filename, FILE_APPEND);
-  if (f) {
-    f.println(buffer);
-    f.close();
-  }
-}
-
 void telemetry_log_system(const char *fmt, ...) {
   if (!s_logger_ready) return;
-  char buffer[200];
   va_list args;
   va_start(args, fmt);
-  vsnprintf(buffer, sizeof(buffer), fmt, args);
+  log_line(TELEM_SINK_CH_LOG_SYSTEM, 200, fmt, args);
   va_end(args);
-  Serial.println(buffer);
-  write_to_file(TELEMETRY_SYSTEM_LOG, buffer);
 }
 
 void telemetry_log_power(const char *fmt, ...) {
   if (!s_logger_ready) return;
-  char buffer[200];
   va_list args;
   va_start(args, fmt);
-  vsnprintf(buffer, sizeof(buffer), fmt, args);
+  log_line(TELEM_SINK_CH_LOG_POWER, 200, fmt, args);
   va_end(args);
-  Serial.println(buffer);
-  write_to_file(TELEMETRY_POWER_LOG, buffer);
 }
 
 void telemetry_log_temperature(const char *fmt, ...) {
   if (!s_logger_ready) return;
-  char buffer[200];
   va_list args;
   va_start(args, fmt);
-  vsnprintf(buffer, sizeof(buffer), fmt, args);
+  log_line(TELEM_SINK_CH_LOG_TEMP, 200, fmt, args);
   va_end(args);
-  Serial.println(buffer);
-  write_to_file(TELEMETRY_TEMP_LOG, buffer);
 }
 
 void telemetry_log_comms(const char *fmt, ...) {
   if (!s_logger_ready) return;
-  char buffer[200];
   va_list args;
   va_start(args, fmt);
-  vsnprintf(buffer, sizeof(buffer), fmt, args);
+  log_line(TELEM_SINK_CH_LOG_COMMS, 200, fmt, args);
   va_end(args);
-  Serial.println(buffer);
-  write_to_file(TELEMETRY_COMMS_LOG, buffer);
 }
 
 // ============================================================================
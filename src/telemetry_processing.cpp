@@ -7,6 +7,22 @@
  * @details
  * Este módulo se encarga de procesar los paquetes de telemetría recibidos,
  * interpretando sus datos y generando logs informativos.
+ *
+ * Los paquetes se procesan por lotes: en cada despertar se atienden hasta
+ * TELEM_PROC_BATCH y cada uno se despacha por s_handlers según su tipo. Lo
+ * que no cambia tras el arranque (tamaños del heap, del sketch y de la
+ * flash) se calcula una vez en telemetry_processing_init().
+ *
+ * Cada paquete se copia del slot (telemetry_peek()) y el slot se suelta
+ * antes de procesar la copia: si telemetry_release() indica que se
+ * desalojó durante la lectura (TELEM_STORAGE_LOCKFREE), la copia se
+ * descarta sin llegar al log ni a las estadísticas.
+ *
+ * Los paquetes de sistema, potencia y temperatura alimentan además las
+ * estadísticas por ventana de telemetry_stats.h. Los resúmenes se apartan
+ * mientras se actualizan y se publican al terminar el paquete: en el log
+ * o, con TELEM_STATS_DOWNLINK, en el buffer (y entonces el log los muestra
+ * al procesarlos como un paquete más).
  */
 
 #include <Arduino.h>
@@ -15,72 +31,311 @@
 #include "../include/telemetry_processing.h"
 #include "../include/telemetry_storage.h"
 #include "../include/telemetry_logger.h"
+#include "../include/telemetry_schema.h"
+#include "../include/telemetry_latency.h"
+#include "../include/telemetry_stats.h"
+#include "../include/telemetry_limits.h"
 
-void telemetry_processing_init(void) {
-  telemetry_logf("[PROC] Init OK");
+#if TELEM_STATS_DOWNLINK && TELEM_STORAGE_LOCKFREE
+#error "TELEM_STATS_DOWNLINK requiere el buffer con mutex: en TELEM_STORAGE_LOCKFREE solo publica el recolector"
+#endif
+
+/** @brief Tamaño máximo de una línea de log generada por el esquema */
+#define TELEM_PROC_LINE_SIZE 192
+
+/** @brief Periodo de sondeo sin TELEM_WAKE_EVENTS */
+#define TELEM_PROC_POLL_MS 1000
+
+/**
+ * @brief Cursor propio del procesador en el buffer de telemetría
+ *
+ * @details Desalojable: si el registro se retrasa, pierde sus paquetes más
+ * antiguos en lugar de frenar la adquisición o el enlace de bajada.
+ */
+static telemetry_subscriber_t s_subscriber = TELEM_INVALID_SUBSCRIBER;
+
+/**
+ * @brief Métricas fijas tras el arranque (calculadas en init)
+ */
+static size_t s_heap_total = 0;
+static size_t s_sketch_size = 0;
+static size_t s_flash_total = 0;
+static float s_flash_pct = 0.0f;
+
+static telemetry_processing_cost_t s_cost;
+/** @brief Aviso de paquetes nuevos para este suscriptor */
+static telemetry_wake_t s_wake;
+
+#if TELEM_STATS_ENGINE
+/** @brief Estadísticas por ventana (unos 8 KB: estático para no cargar la pila) */
+static telemetry_stats_t s_stats;
+/** @brief Resúmenes emitidos por el paquete en curso, pendientes de publicar */
+static telemetry_packet_t s_summaries[TELEM_STATS_MAX_EMIT];
+static uint32_t s_summary_count = 0;
+/** @brief Resúmenes que no se pudieron guardar en el buffer */
+static uint32_t s_summaries_lost = 0;
+#endif
+
+/**
+ * @brief Estado compartido por los paquetes de un lote
+ */
+typedef struct {
+  bool stats_read;          /**< Estadísticas del buffer ya leídas en este lote */
+  uint32_t written;
+  uint32_t read;
+  uint32_t lost;
+  uint32_t free_heap;       /**< Heap libre al leer las estadísticas */
+  uint32_t backlog_lines;   /**< Paquetes que piden informar de los pendientes */
+} proc_batch_t;
+
+typedef void (*proc_handler_t)(const telemetry_packet_t* packet, const char* line, proc_batch_t* batch);
+
+static void handle_system(const telemetry_packet_t* packet, const char* line, proc_batch_t* batch) {
+  (void)packet;
+  if(!batch->stats_read) {
+    telemetry_get_stats(&batch->written, &batch->read, &batch->lost);
+    batch->free_heap = ESP.getFreeHeap();
+    batch->stats_read = true;
+  }
+
+  // Calcular uso de RAM
+  size_t usedHeap = (s_heap_total > batch->free_heap) ? (s_heap_total - batch->free_heap) : 0;
+  float  ramPct   = s_heap_total ? (usedHeap * 100.0f) / s_heap_total : 0.0f;
+
+  telemetry_log_system("%s | Buf W/R/L=%lu/%lu/%lu", line, batch->written, batch->read, batch->lost);
+  telemetry_log_system("   RAM: %.1f%% (%u/%u bytes) | Flash: %.1f%% (%u/%u bytes)",
+                  ramPct, (unsigned)usedHeap, (unsigned)s_heap_total,
+                  s_flash_pct, (unsigned)s_sketch_size, (unsigned)s_flash_total);
+  if(batch->lost > 0) {
+    telemetry_log_system("   Lost SYS/PWR/TMP/COM/MET/LAT/SUM/EVT=%lu/%lu/%lu/%lu/%lu/%lu/%lu/%lu",
+                    telemetry_get_lost_by_type(TELEM_SYSTEM_STATUS),
+                    telemetry_get_lost_by_type(TELEM_POWER_DATA),
+                    telemetry_get_lost_by_type(TELEM_TEMPERATURE_DATA),
+                    telemetry_get_lost_by_type(TELEM_COMMUNICATION_STATUS),
+                    telemetry_get_lost_by_type(TELEM_STORAGE_METRICS),
+                    telemetry_get_lost_by_type(TELEM_LATENCY_METRICS),
+                    telemetry_get_lost_by_type(TELEM_STATS_SUMMARY),
+                    telemetry_get_lost_by_type(TELEM_LIMIT_EVENT));
+  }
 }
 
-bool telemetry_processing_handle_one(void) {
-  telemetry_packet_t packet;
-  if(!telemetry_retrieve_packet(&packet)) {
-    return false;
+static void handle_power(const telemetry_packet_t* packet, const char* line, proc_batch_t* batch) {
+  (void)packet;
+  telemetry_log_power("%s", line);
+  batch->backlog_lines++;
+}
+
+static void handle_temperature(const telemetry_packet_t* packet, const char* line, proc_batch_t* batch) {
+  (void)packet;
+  telemetry_log_temperature("%s", line);
+  batch->backlog_lines++;
+}
+
+static void handle_comms(const telemetry_packet_t* packet, const char* line, proc_batch_t* batch) {
+  (void)packet;
+  telemetry_log_comms("%s", line);
+  batch->backlog_lines++;
+}
+
+static void handle_metrics(const telemetry_packet_t* packet, const char* line, proc_batch_t* batch) {
+  (void)packet;
+  telemetry_logf("%s", line);
+  batch->backlog_lines++;
+}
+
+static void handle_summary(const telemetry_packet_t* packet, const char* line, proc_batch_t* batch) {
+  (void)batch; // NULL al mostrar los resúmenes fuera de un lote
+  const telemetry_schema_t* source = telemetry_schema_get((telem_data_type_t)packet->summary.source_type);
+  const telemetry_field_t* field = (source && packet->summary.field < source->field_count)
+                                     ? &source->fields[packet->summary.field] : NULL;
+  // Nombre del campo resumido: la clave JSON, o la etiqueta si no sale en el JSON
+  const char* name = field ? (field->json_key ? field->json_key : field->log_label) : NULL;
+  telemetry_logf("%s | %s.%s", line, source ? source->json_type : "?", name ? name : "?");
+}
+
+static void handle_event(const telemetry_packet_t* packet, const char* line, proc_batch_t* batch) {
+  (void)batch;
+  const limit_event_telem_t* ev = &packet->event;
+  const telemetry_schema_t* source = telemetry_schema_get((telem_data_type_t)ev->source_type);
+  const telemetry_field_t* field = (source && ev->field < source->field_count) ? &source->fields[ev->field] : NULL;
+  const char* name = field ? (field->json_key ? field->json_key : field->log_label) : NULL;
+  telemetry_logf("%s | %s.%s %s -> %s", line, source ? source->json_type : "?", name ? name : "?",
+                 telemetry_limit_state_name(ev->previous), telemetry_limit_state_name(ev->state));
+}
+
+#if TELEM_STATS_ENGINE
+static void collect_summary(void* ctx, const telemetry_packet_t* summary) {
+  (void)ctx;
+  if(s_summary_count < TELEM_STATS_MAX_EMIT) {
+    s_summaries[s_summary_count++] = *summary;
   }
+}
 
-  switch(packet.header.type) {
-    case TELEM_SYSTEM_STATUS: {
-      uint32_t written=0, read=0, lost=0;
-      telemetry_get_stats(&written, &read, &lost);
-      
-      // Calcular uso de RAM
-      size_t totalHeap = ESP.getHeapSize();
-      size_t freeHeap  = ESP.getFreeHeap();
-      size_t usedHeap  = (totalHeap > freeHeap) ? (totalHeap - freeHeap) : 0;
-      float  ramPct    = totalHeap ? (usedHeap * 100.0f) / totalHeap : 0.0f;
-      
-      // Calcular uso de Flash
-      size_t sketchSize = ESP.getSketchSize();
-      size_t flashTotal = ESP.getFlashChipSize();
-      float  flashPct   = flashTotal ? (sketchSize * 100.0f) / flashTotal : 0.0f;
-      
-      telemetry_log_system("📊 SYSTEM: Uptime=%lus | Tasks=%d | CPU Temp=%.1fC | Seq=%d | Buf W/R/L=%lu/%lu/%lu",
-                      packet.system.uptime_seconds,
-                      packet.system.task_count,
-                      packet.system.cpu_temperature,
-                      packet.header.sequence,
-                      written, read, lost);
-      telemetry_log_system("   RAM: %.1f%% (%u/%u bytes) | Flash: %.1f%% (%u/%u bytes)",
-                      ramPct, (unsigned)usedHeap, (unsigned)totalHeap,
-                      flashPct, (unsigned)sketchSize, (unsigned)flashTotal);
-    } break;
-    case TELEM_POWER_DATA:
-      telemetry_log_power("🔋 POWER: Bat=%.2fV | Level=%d%% | Temp=%dC | Seq=%d",
-                      packet.power.battery_voltage,
-                      packet.power.battery_level,
-                      packet.power.battery_temperature,
-                      packet.header.sequence);
-    break;
-    case TELEM_TEMPERATURE_DATA:
-      telemetry_log_temperature("🌡️ TEMP: OBC=%dC | COMMS=%dC | PAYLOAD=%dC | Seq=%d",
-                      packet.temperature.obc_temperature,
-                      packet.temperature.comms_temperature,
-                      packet.temperature.payload_temperature,
-                      packet.header.sequence);
-    break;
-    case TELEM_COMMUNICATION_STATUS:
-      telemetry_log_comms("📡 COMMS: Status=%d | Uptime=%lu | Success=%d%% | Seq=%d",
-                      packet.subsystems.comms_status,
-                      packet.subsystems.comms_uptime,
-                      packet.subsystems.command_success_rate,
-                      packet.header.sequence);
+/**
+ * @brief Publica los resúmenes apartados al terminar el paquete
+ */
+static void flush_summaries(void) {
+  for(uint32_t i = 0; i < s_summary_count; i++) {
+#if TELEM_STATS_DOWNLINK
+    if(!telemetry_store_packet(&s_summaries[i])) {
+      s_summaries_lost++;
+    }
+#else
+    char line[TELEM_PROC_LINE_SIZE];
+    if(telemetry_schema_format_log(&s_summaries[i], line, sizeof(line)) > 0) {
+      handle_summary(&s_summaries[i], line, NULL);
+    }
+#endif
+  }
+  s_summary_count = 0;
+}
+#endif
+
+/**
+ * @brief Tipo con esquema pero sin manejador propio: solo su línea
+ */
+static void handle_default(const telemetry_packet_t* packet, const char* line, proc_batch_t* batch) {
+  (void)packet;
+  (void)batch;
+  telemetry_logf("%s", line);
+}
+
+/**
+ * @brief Manejador de cada tipo, en el orden de telem_data_type_t
+ *
+ * @details Sin tamaño explícito: una entrada que falte no queda a NULL en
+ * silencio, la detecta el static_assert de abajo.
+ */
+static const proc_handler_t s_handlers[] = {
+  handle_system,        // TELEM_SYSTEM_STATUS
+  handle_power,         // TELEM_POWER_DATA
+  handle_temperature,   // TELEM_TEMPERATURE_DATA
+  handle_comms,         // TELEM_COMMUNICATION_STATUS
+  handle_metrics,       // TELEM_STORAGE_METRICS
+  handle_metrics,       // TELEM_LATENCY_METRICS
+  handle_summary,       // TELEM_STATS_SUMMARY
+  handle_event,         // TELEM_LIMIT_EVENT
+};
+
+static_assert(sizeof(s_handlers) / sizeof(s_handlers[0]) == TELEM_DATA_TYPE_COUNT,
+              "Cada telem_data_type_t necesita su manejador en s_handlers");
+
+void telemetry_processing_init(void) {
+  s_heap_total = ESP.getHeapSize();
+  s_sketch_size = ESP.getSketchSize();
+  s_flash_total = ESP.getFlashChipSize();
+  s_flash_pct = s_flash_total ? (s_sketch_size * 100.0f) / s_flash_total : 0.0f;
+  memset(&s_cost, 0, sizeof(s_cost));
+#if TELEM_STATS_ENGINE
+  telemetry_stats_init(&s_stats, collect_summary, NULL);
+#endif
+
+  s_subscriber = telemetry_subscribe(TELEM_SUB_EVICTABLE);
+  if(s_subscriber == TELEM_INVALID_SUBSCRIBER) {
+    telemetry_logf("[PROC] ERROR: no quedan suscriptores libres");
+    return;
+  }
+  // Se llama desde la tarea del procesador: es la que recibirá los avisos
+  telemetry_wake_init(&s_wake, telemetry_wake_port_task(), xTaskGetCurrentTaskHandle(),
+                      TELEM_PROC_WAKE_MIN_BATCH, TELEM_PROC_WAKE_MAX_DELAY_MS);
+#if TELEM_WAKE_EVENTS
+  telemetry_set_wake(s_subscriber, &s_wake);
+#endif
+  telemetry_logf("[PROC] Init OK (batch %u)", (unsigned)TELEM_PROC_BATCH);
+}
+
+uint32_t telemetry_processing_handle_batch(uint32_t max_packets) {
+  uint32_t start = ESP.getCycleCount();
+  telemetry_wake_begin(&s_wake);
+  proc_batch_t batch;
+  memset(&batch, 0, sizeof(batch));
+  uint32_t count = 0;
+
+  while(count < max_packets) {
+    // Se copia y se suelta el slot antes de procesarlo: en TELEM_STORAGE_LOCKFREE
+    // solo telemetry_release() dice si el productor lo sobrescribió mientras tanto
+    const telemetry_packet_t* slot = telemetry_peek(s_subscriber);
+    if(!slot) {
       break;
-    default:
-      telemetry_logf("[PROC] Unknown packet type=%d seq=%d", packet.header.type, packet.header.sequence);
-    break;
     }
+    telemetry_packet_t copy = *slot;
+    count++;
+    if(!telemetry_release(s_subscriber)) {
+      // TELEM_STORAGE_LOCKFREE: desalojado mientras se copiaba, puede estar a medio sobrescribir
+      s_cost.discarded++;
+      continue;
+    }
+    const telemetry_packet_t* packet = &copy;
+    telemetry_latency_record(TELEM_LATENCY_PROCESSOR_QUEUE, packet->header.type,
+                             telemetry_latency_now() - packet->header.enqueued_us);
+
+    // Línea generada a partir del esquema del tipo (mismos campos que el JSON)
+    char line[TELEM_PROC_LINE_SIZE];
+    if(telemetry_schema_format_log(packet, line, sizeof(line)) == 0) {
+      telemetry_logf("[PROC] Unknown packet type=%d seq=%d", packet->header.type, packet->header.sequence);
+    } else { // Tipo válido: el esquema no formatea tipos fuera de la tabla
+      proc_handler_t handler = ((uint32_t)packet->header.type < TELEM_DATA_TYPE_COUNT) ? s_handlers[packet->header.type] : NULL;
+      (handler ? handler : handle_default)(packet, line, &batch);
+#if TELEM_STATS_ENGINE
+      telemetry_stats_update(&s_stats, packet);
+#endif
+    }
+#if TELEM_STATS_ENGINE
+    flush_summaries();
+#endif
+  }
+
+  if(count == 0) {
+    return 0;
+  }
+  // Ya mostramos métricas del buffer en la línea de SYSTEM; los demás tipos
+  // informan de los pendientes una vez por lote para mantener salida concisa.
+  if(batch.backlog_lines > 0) {
+    telemetry_logf("   Available packets: %lu", telemetry_available_packets_for(s_subscriber));
+  }
 
-  // Ya mostramos métricas del buffer en la línea de SYSTEM; evitar línea extra para mantener salida concisa.
-  if(packet.header.type != TELEM_SYSTEM_STATUS) {
-    telemetry_logf("   Available packets: %lu", telemetry_available_packets());
+  uint32_t cycles = ESP.getCycleCount() - start;
+  s_cost.batches++;
+  s_cost.packets += count;
+  s_cost.cycles += cycles;
+  if(count == 1) {
+    s_cost.single_batches++;
+    s_cost.single_cycles += cycles;
+  }
+  if(count > s_cost.max_batch) {
+    s_cost.max_batch = count;
   }
-  return true;
+  s_cost.last_packets = count;
+  s_cost.last_cycles = cycles;
+  return count;
+}
+
+bool telemetry_processing_handle_one(void) {
+  return telemetry_processing_handle_batch(1) > 0;
+}
+
+void telemetry_processing_get_cost(telemetry_processing_cost_t* cost) {
+  *cost = s_cost;
+}
+
+void telemetry_processing_wait(void) {
+#if TELEM_WAKE_EVENTS
+  telemetry_wake_wait(&s_wake);
+#else
+  vTaskDelay(pdMS_TO_TICKS(TELEM_PROC_POLL_MS));
+#endif
+}
+
+const telemetry_wake_t* telemetry_processing_get_wake(void) {
+  return &s_wake;
+}
+
+const telemetry_stats_t* telemetry_processing_get_stats(uint32_t* summaries_lost) {
+#if TELEM_STATS_ENGINE
+  if(summaries_lost) *summaries_lost = s_summaries_lost;
+  return &s_stats;
+#else
+  if(summaries_lost) *summaries_lost = 0;
+  return NULL;
+#endif
 }
@@ -0,0 +1,133 @@
+/**
+ * @file telemetry_rbe.cpp
+ * @brief Implementación de la bajada por excepción
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Se compara siempre con el último valor enviado, no con la muestra
+ * anterior: una deriva lenta acaba saliendo de la banda aunque cada paso
+ * sea pequeño. Los campos retenidos se restauran copiando sus bytes de la
+ * referencia, así que en tierra reaparece exactamente el valor anterior.
+ */
+
+  #include <math.h>
+  #include <stddef.h>
+  #include <string.h>
+  #include "../include/telemetry_rbe.h"
+  #include "../include/telemetry_schema.h"
+
+/**
+ * @brief Entrada de TELEM_RBE_TABLE
+ */
+typedef struct {
+  telem_data_type_t type;
+  uint8_t offset;     /**< offsetof del miembro en su estructura */
+  float deadband;
+} telemetry_rbe_def_t;
+
+#define TELEM_RBE_CHECK(t, st, m, band) \
+  static_assert((band) >= 0.0f, #st "." #m ": banda muerta negativa");
+TELEM_RBE_TABLE(TELEM_RBE_CHECK)
+
+#define TELEM_RBE_DEF(t, st, m, band) { t, (uint8_t)offsetof(st, m), band },
+
+static const telemetry_rbe_def_t s_defs[] = { TELEM_RBE_TABLE(TELEM_RBE_DEF) };
+
+uint32_t telemetry_rbe_init(telemetry_rbe_t* rbe, uint32_t heartbeat_ms) {
+  memset(rbe, 0, sizeof(*rbe));
+  rbe->heartbeat_ms = heartbeat_ms;
+  for(size_t i = 0; i < sizeof(s_defs) / sizeof(s_defs[0]); i++) {
+    const telemetry_schema_t* schema = telemetry_schema_get(s_defs[i].type);
+    bool found = false;
+    for(uint8_t f = 0; schema && f < schema->field_count && f < TELEM_RBE_MAX_FIELDS; f++) {
+      if(schema->fields[f].offset == s_defs[i].offset) {
+        rbe->deadband[s_defs[i].type][f] = s_defs[i].deadband;
+        rbe->watched[s_defs[i].type] = true;
+        found = true;
+        break;
+      }
+    }
+    if(!found) rbe->unresolved++;
+  }
+  // Un tipo con más campos de los que caben no puede vigilarse entero
+  for(int t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+    const telemetry_schema_t* schema = telemetry_schema_get((telem_data_type_t)t);
+    if(rbe->watched[t] && schema->field_count > TELEM_RBE_MAX_FIELDS) {
+      rbe->watched[t] = false;
+      rbe->unresolved++;
+    }
+  }
+  return rbe->unresolved;
+}
+
+bool telemetry_rbe_prepare(telemetry_rbe_t* rbe, telemetry_packet_t* packet) {
+  uint32_t type = (uint32_t)packet->header.type;
+  if(type >= TELEM_DATA_TYPE_COUNT || !rbe->watched[type] || !rbe->has_last[type]) {
+    return true;
+  }
+  const telemetry_packet_t* last = &rbe->last[type];
+  rbe->heartbeat[type] = packet->header.timestamp - last->header.timestamp >= rbe->heartbeat_ms;
+  if(rbe->heartbeat[type]) {
+    return true; // Latido: valores actuales completos
+  }
+
+  const telemetry_schema_t* schema = telemetry_schema_get(packet->header.type);
+  bool moved = false;
+  for(uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    uint8_t width = telemetry_field_width(field->kind);
+    for(uint8_t e = 0; e < field->count; e++) {
+      uint8_t offset = (uint8_t)(field->offset + e * width);
+      float x = telemetry_field_value(packet, offset, field->kind, field->decimals);
+      float ref = telemetry_field_value(last, offset, field->kind, field->decimals);
+      if(fabsf(x - ref) > rbe->deadband[type][f]) {
+        moved = true;
+      } else {
+        memcpy(packet->raw_data + offset, last->raw_data + offset, width); // Retener
+      }
+    }
+  }
+  if(!moved) {
+    rbe->counts[type].suppressed++;
+  }
+  return moved;
+}
+
+void telemetry_rbe_sent(telemetry_rbe_t* rbe, const telemetry_packet_t* packet) {
+  uint32_t type = (uint32_t)packet->header.type;
+  if(type >= TELEM_DATA_TYPE_COUNT || !rbe->watched[type]) {
+    return;
+  }
+  telemetry_rbe_counts_t* counts = &rbe->counts[type];
+  const telemetry_schema_t* schema = telemetry_schema_get(packet->header.type);
+  uint32_t changed = 0;
+  for(uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    uint32_t bytes = (uint32_t)telemetry_field_width(field->kind) * field->count;
+    if(!rbe->has_last[type] || memcmp(packet->raw_data + field->offset, rbe->last[type].raw_data + field->offset,
+                                      bytes) != 0) {
+      changed++;
+    }
+  }
+  counts->sent++;
+  counts->changed += changed;
+  counts->held += schema->field_count - changed;
+  if(rbe->heartbeat[type]) {
+    counts->heartbeats++;
+    rbe->heartbeat[type] = false;
+  }
+  rbe->last[type] = *packet;
+  rbe->has_last[type] = true;
+}
+
+void telemetry_rbe_totals(const telemetry_rbe_t* rbe, telemetry_rbe_counts_t* total) {
+  memset(total, 0, sizeof(*total));
+  for(int t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+    total->sent += rbe->counts[t].sent;
+    total->suppressed += rbe->counts[t].suppressed;
+    total->heartbeats += rbe->counts[t].heartbeats;
+    total->changed += rbe->counts[t].changed;
+    total->held += rbe->counts[t].held;
+  }
+}
@@ -0,0 +1,62 @@
+/**
+ * @file telemetry_record.cpp
+ * @brief Implementación de los registros de longitud variable y del informe de capacidad
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Cada registro ocupa sizeof(telemetry_record_hdr_t) más los bytes de la
+ * estructura de su tipo, redondeado a TELEM_RECORD_ALIGN.
+ */
+
+  #include "../include/telemetry_record.h"
+
+uint16_t telemetry_record_payload_size(telem_data_type_t type) {
+  switch(type) {
+    case TELEM_SYSTEM_STATUS:        return sizeof(system_status_telem_t);
+    case TELEM_POWER_DATA:           return sizeof(power_telem_t);
+    case TELEM_TEMPERATURE_DATA:     return sizeof(temperature_telem_t);
+    case TELEM_COMMUNICATION_STATUS: return sizeof(subsystem_status_telem_t);
+    case TELEM_STORAGE_METRICS:      return sizeof(storage_metrics_telem_t);
+    case TELEM_LATENCY_METRICS:      return sizeof(latency_metrics_telem_t);
+    case TELEM_STATS_SUMMARY:        return sizeof(stats_summary_telem_t);
+    case TELEM_LIMIT_EVENT:          return sizeof(limit_event_telem_t);
+    default:                         return sizeof(telemetry_packet_t);
+  }
+}
+
+/**
+ * @brief Mezcla nominal de telemetry_acquisition_cycle() en 15 ciclos
+ *
+ * @details Sistema, potencia, temperatura y comunicaciones en cada ciclo,
+ * métricas de almacenamiento cada 15 y latencias cada 3. Los resúmenes y
+ * los eventos de límites son esporádicos y no cuentan.
+ */
+static const uint32_t s_nominal_mix[TELEM_DATA_TYPE_COUNT] = { 15, 15, 15, 15, 1, 5, 0, 0 };
+
+void telemetry_record_capacity_report(const uint32_t* type_counts, uint32_t bytes, telemetry_record_capacity_t* report) {
+  const uint32_t* mix = type_counts;
+  uint32_t total = 0;
+  for(int t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+    total += mix[t];
+  }
+  if(total == 0) {
+    // Aún no se ha escrito nada: mezcla nominal de la adquisición
+    mix = s_nominal_mix;
+    for(int t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+      total += mix[t];
+    }
+  }
+
+  // Bytes totales de la mezcla en 64 bits: los contadores pueden ser grandes
+  uint64_t mix_bytes = 0;
+  for(int t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+    mix_bytes += (uint64_t)mix[t] * telemetry_record_footprint(telemetry_record_payload_size((telem_data_type_t)t));
+  }
+
+  report->avg_record_bytes_x100 = (uint32_t)((mix_bytes * 100) / total);
+  report->packets_per_kb_x100 = (uint32_t)((1024ULL * 100 * total) / mix_bytes);
+  report->fixed_packets_per_kb_x100 = (1024 * 100) / sizeof(telemetry_packet_t);
+  report->gain_x100 = (uint32_t)((sizeof(telemetry_packet_t) * 100ULL * total) / mix_bytes);
+  report->capacity_packets = (uint32_t)(((uint64_t)bytes * total) / mix_bytes);
+}
@@ -0,0 +1,391 @@
+/**
+ * @file telemetry_schema.cpp
+ * @brief Tablas de campos generadas y formateadores genéricos de telemetría
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Las X-macros de telemetry_schema.h se expanden aquí dos veces: una en
+ * static_assert que comprueban que cada miembro tiene el tamaño de su kind,
+ * y otra en las tablas telemetry_field_t. Los formateadores solo recorren
+ * la tabla del tipo, con un switch por campo, y escriben sin printf (ver
+ * text_put_fixed() y text_put_f32()).
+ */
+
+  #include <string.h>
+  #include "../include/telemetry_schema.h"
+
+/* Comprobación en compilación: miembro y kind deben coincidir */
+#define TELEM_FIELD_CHECK(st, member, n, kind, dec, json, log, unit) \
+  static_assert(sizeof(((st*)0)->member) == TELEM_FIELD_WIDTH_##kind * (n), \
+                #st "." #member ": el kind del esquema no coincide con el miembro");
+TELEM_SCHEMA_SYSTEM(TELEM_FIELD_CHECK)
+TELEM_SCHEMA_POWER(TELEM_FIELD_CHECK)
+TELEM_SCHEMA_TEMPERATURE(TELEM_FIELD_CHECK)
+TELEM_SCHEMA_COMMUNICATION(TELEM_FIELD_CHECK)
+TELEM_SCHEMA_STORAGE(TELEM_FIELD_CHECK)
+TELEM_SCHEMA_LATENCY(TELEM_FIELD_CHECK)
+TELEM_SCHEMA_SUMMARY(TELEM_FIELD_CHECK)
+TELEM_SCHEMA_EVENT(TELEM_FIELD_CHECK)
+
+/** @brief strlen() en compilación (0 para NULL) */
+static constexpr uint8_t schema_strlen(const char* s) {
+  return (s && *s) ? (uint8_t)(1 + schema_strlen(s + 1)) : 0;
+}
+
+/* Tablas de campos */
+/* #json convierte "clave" en "\"clave\"": el fragmento ,"clave": sale en compilación */
+#define TELEM_FIELD_ENTRY(st, member, n, kind, dec, json, log, unit) \
+  { json, log, unit, (uint8_t)offsetof(st, member), TELEM_FIELD_##kind, n, dec, \
+    "," #json ":", (uint8_t)(sizeof("," #json ":") - 1), schema_strlen(log), schema_strlen(unit) },
+#define TELEM_FIELD_BYTES(st, member, n, kind, dec, json, log, unit) \
+  + TELEM_FIELD_WIDTH_##kind * (n)
+
+static const telemetry_field_t s_system_fields[] = { TELEM_SCHEMA_SYSTEM(TELEM_FIELD_ENTRY) };
+static const telemetry_field_t s_power_fields[] = { TELEM_SCHEMA_POWER(TELEM_FIELD_ENTRY) };
+static const telemetry_field_t s_temperature_fields[] = { TELEM_SCHEMA_TEMPERATURE(TELEM_FIELD_ENTRY) };
+static const telemetry_field_t s_communication_fields[] = { TELEM_SCHEMA_COMMUNICATION(TELEM_FIELD_ENTRY) };
+static const telemetry_field_t s_storage_fields[] = { TELEM_SCHEMA_STORAGE(TELEM_FIELD_ENTRY) };
+static const telemetry_field_t s_latency_fields[] = { TELEM_SCHEMA_LATENCY(TELEM_FIELD_ENTRY) };
+static const telemetry_field_t s_summary_fields[] = { TELEM_SCHEMA_SUMMARY(TELEM_FIELD_ENTRY) };
+static const telemetry_field_t s_event_fields[] = { TELEM_SCHEMA_EVENT(TELEM_FIELD_ENTRY) };
+
+#define TELEM_FIELDS(table) table, (uint8_t)(sizeof(table) / sizeof(table[0]))
+
+/** @brief Entrada de s_schemas con el prefijo JSON y las longitudes ya calculadas */
+#define TELEM_SCHEMA_ENTRY(json_type, log_tag, table, list) \
+  { json_type, log_tag, TELEM_FIELDS(table), TELEM_SCHEMA_HEADER_BYTES list(TELEM_FIELD_BYTES), \
+    "{\"type\":\"" json_type "\"", sizeof("{\"type\":\"" json_type "\"") - 1, sizeof(log_tag) - 1 }
+
+/** @brief Descripción de cada tipo, indexada por telem_data_type_t */
+static const telemetry_schema_t s_schemas[] = {
+  TELEM_SCHEMA_ENTRY("system",      "📊 SYSTEM",  s_system_fields,        TELEM_SCHEMA_SYSTEM),
+  TELEM_SCHEMA_ENTRY("power",       "🔋 POWER",   s_power_fields,         TELEM_SCHEMA_POWER),
+  TELEM_SCHEMA_ENTRY("temperature", "🌡️ TEMP",    s_temperature_fields,   TELEM_SCHEMA_TEMPERATURE),
+  TELEM_SCHEMA_ENTRY("comms",       "📡 COMMS",   s_communication_fields, TELEM_SCHEMA_COMMUNICATION),
+  TELEM_SCHEMA_ENTRY("storage",     "🧮 STORAGE", s_storage_fields,       TELEM_SCHEMA_STORAGE),
+  TELEM_SCHEMA_ENTRY("latency",     "⏱️ LATENCY", s_latency_fields,       TELEM_SCHEMA_LATENCY),
+  TELEM_SCHEMA_ENTRY("summary",     "📈 SUMMARY", s_summary_fields,       TELEM_SCHEMA_SUMMARY),
+  TELEM_SCHEMA_ENTRY("event",       "🚨 EVENT",   s_event_fields,         TELEM_SCHEMA_EVENT),
+};
+
+static_assert(sizeof(s_schemas) / sizeof(s_schemas[0]) == TELEM_DATA_TYPE_COUNT,
+              "Cada telem_data_type_t necesita su entrada en s_schemas");
+
+const telemetry_schema_t* telemetry_schema_get(telem_data_type_t type) {
+  if((uint32_t)type >= TELEM_DATA_TYPE_COUNT) {
+    return NULL;
+  }
+  return &s_schemas[type];
+}
+
+/* ----------------------------------------------------------------------------
+ * Codificación binaria
+ * ------------------------------------------------------------------------- */
+
+static inline void put_le(uint8_t* out, uint32_t value, uint8_t width) {
+  for(uint8_t b = 0; b < width; b++) {
+    out[b] = (uint8_t)(value >> (8 * b));
+  }
+}
+
+static inline uint32_t get_le(const uint8_t* in, uint8_t width) {
+  uint32_t value = 0;
+  for(uint8_t b = 0; b < width; b++) {
+    value |= (uint32_t)in[b] << (8 * b);
+  }
+  return value;
+}
+
+uint32_t telemetry_schema_encode(const telemetry_packet_t* packet, uint8_t* out, uint32_t capacity) {
+  const telemetry_schema_t* schema = telemetry_schema_get(packet->header.type);
+  if(!schema || capacity < schema->encoded_size) {
+    return 0;
+  }
+
+  out[0] = (uint8_t)packet->header.type;
+  put_le(out + 1, packet->header.timestamp, 4);
+  put_le(out + 5, packet->header.sequence, 2);
+  out[7] = packet->header.priority;
+
+  // Los miembros se copian byte a byte en el orden de la memoria: en
+  // little-endian (ESP32) coincide con la codificación
+  uint32_t pos = TELEM_SCHEMA_HEADER_BYTES;
+  const uint8_t* base = (const uint8_t*)packet;
+  for(uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    uint8_t width = telemetry_field_width(field->kind);
+    for(uint8_t i = 0; i < field->count; i++) {
+      uint32_t raw = 0;
+      memcpy(&raw, base + field->offset + i * width, width);
+      put_le(out + pos, raw, width);
+      pos += width;
+    }
+  }
+  return pos;
+}
+
+uint32_t telemetry_schema_decode(const uint8_t* in, uint32_t len, telemetry_packet_t* packet) {
+  if(len < TELEM_SCHEMA_HEADER_BYTES) {
+    return 0;
+  }
+  const telemetry_schema_t* schema = telemetry_schema_get((telem_data_type_t)in[0]);
+  if(!schema || len < schema->encoded_size) {
+    return 0;
+  }
+
+  memset(packet, 0, sizeof(*packet));
+  packet->header.type = (telem_data_type_t)in[0];
+  packet->header.timestamp = get_le(in + 1, 4);
+  packet->header.sequence = (uint16_t)get_le(in + 5, 2);
+  packet->header.priority = in[7];
+
+  uint32_t pos = TELEM_SCHEMA_HEADER_BYTES;
+  uint8_t* base = (uint8_t*)packet;
+  for(uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    uint8_t width = telemetry_field_width(field->kind);
+    for(uint8_t i = 0; i < field->count; i++) {
+      uint32_t raw = get_le(in + pos, width);
+      memcpy(base + field->offset + i * width, &raw, width);
+      pos += width;
+    }
+  }
+  return pos;
+}
+
+/* ----------------------------------------------------------------------------
+ * Formateo de texto
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Salida de texto acotada: deja de escribir al llenarse y lo recuerda
+ */
+typedef struct {
+  char* out;
+  size_t capacity;
+  size_t len;
+  bool overflow;
+} text_writer_t;
+
+/**
+ * @brief Copia len bytes (siempre deja sitio para el '\0' final)
+ *
+ * @details Bucle en lugar de memcpy: los fragmentos son de pocos bytes y un
+ * memcpy de longitud variable en línea (rep movs en x86) cuesta más que la
+ * propia copia.
+ */
+static inline void text_put(text_writer_t* w, const char* s, size_t len) {
+  if(w->overflow || len >= w->capacity - w->len) {
+    w->overflow = true;
+    return;
+  }
+  char* dst = w->out + w->len;
+  for(size_t i = 0; i < len; i++) dst[i] = s[i];
+  w->len += len;
+}
+
+static inline void text_put_char(text_writer_t* w, char c) {
+  text_put(w, &c, 1);
+}
+
+/** @brief Copia un literal sin calcular su longitud en ejecución */
+#define TEXT_PUT_LITERAL(w, lit) text_put((w), (lit), sizeof(lit) - 1)
+
+/**
+ * @brief Escribe mag / 10^decimals con exactamente decimals cifras decimales
+ *
+ * @details Las cifras se generan de atrás hacia delante en un buffer local.
+ * Si mag cabe en 32 bits se divide en 32 bits (la división de 64 bits es
+ * una llamada de biblioteca en el ESP32).
+ */
+static void text_put_fixed(text_writer_t* w, uint64_t mag, uint8_t decimals, bool negative) {
+  char tmp[24 + 8];
+  char* p = tmp + sizeof(tmp);
+  uint8_t d = 0;
+  if(mag <= 0xFFFFFFFFu) {
+    uint32_t v = (uint32_t)mag;
+    for(; d < decimals; d++) { *--p = (char)('0' + v % 10); v /= 10; }
+    if(decimals) *--p = '.';
+    do { *--p = (char)('0' + v % 10); v /= 10; } while(v);
+  } else {
+    for(; d < decimals; d++) { *--p = (char)('0' + mag % 10); mag /= 10; }
+    if(decimals) *--p = '.';
+    do { *--p = (char)('0' + mag % 10); mag /= 10; } while(mag);
+  }
+  if(negative) *--p = '-';
+  text_put(w, p, (size_t)(tmp + sizeof(tmp) - p));
+}
+
+/**
+ * @brief Escribe el entero m · 2^shift (mayor que 2^64, hasta 3.4e38) y decimals ceros
+ *
+ * @details Se desplaza m en base 10^9 para obtener todas las cifras exactas,
+ * como printf.
+ */
+static void text_put_huge(text_writer_t* w, uint32_t m, uint8_t shift, uint8_t decimals, bool negative) {
+  uint32_t limbs[5] = { m, 0, 0, 0, 0 };
+  uint8_t used = 1;
+  while(shift > 0) {
+    uint8_t step = (shift > 29) ? 29 : shift;
+    uint64_t carry = 0;
+    for(uint8_t i = 0; i < used; i++) {
+      uint64_t v = ((uint64_t)limbs[i] << step) + carry;
+      limbs[i] = (uint32_t)(v % 1000000000u);
+      carry = v / 1000000000u;
+    }
+    if(carry) limbs[used++] = (uint32_t)carry;
+    shift = (uint8_t)(shift - step);
+  }
+
+  text_put_fixed(w, limbs[used - 1], 0, negative);
+  for(int8_t i = (int8_t)used - 2; i >= 0; i--) {
+    char digits[9];
+    uint32_t v = limbs[i];
+    for(int8_t k = 8; k >= 0; k--) { digits[k] = (char)('0' + v % 10); v /= 10; }
+    text_put(w, digits, sizeof(digits));
+  }
+  if(decimals) {
+    static const char zeros[] = ".000000";
+    text_put(w, zeros, decimals + 1u);
+  }
+}
+
+/**
+ * @brief Escribe un F32 con decimals cifras, con el mismo resultado que "%.*f"
+ *
+ * @details Solo aritmética entera (el ESP32 no tiene FPU de doble precisión
+ * y la de simple no sirve para redondear exacto): el float es m · 2^e, así
+ * que f · 10^decimals = (m · 10^decimals) · 2^e se calcula exacto en 64
+ * bits y el desplazamiento a la derecha se redondea al par más cercano, como
+ * printf. A diferencia de printf, un negativo que redondea a cero se escribe
+ * sin signo ("0.0", no "-0.0"), igual que lo reconstruye telemetry_delta.
+ */
+static void text_put_f32(text_writer_t* w, float f, uint8_t decimals) {
+  static const uint32_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  bool negative = (bits >> 31) != 0;
+  uint32_t biased = (bits >> 23) & 0xFF;
+  uint32_t m = bits & 0x7FFFFF;
+  if(biased == 0xFF) {
+    if(m) {
+      if(negative) TEXT_PUT_LITERAL(w, "-nan"); else TEXT_PUT_LITERAL(w, "nan");
+    } else {
+      if(negative) TEXT_PUT_LITERAL(w, "-inf"); else TEXT_PUT_LITERAL(w, "inf");
+    }
+    return;
+  }
+  int32_t e = (biased == 0) ? -149 : (int32_t)biased - 150; // Subnormal o normal
+  if(biased != 0) m |= 0x800000;
+  if(decimals > 6) decimals = 6;
+
+  uint64_t scaled = (uint64_t)m * pow10[decimals]; // < 2^44
+  if(e >= 0) {
+    if(e >= 20 || (scaled >> (64 - e)) != 0) { // No cabe en 64 bits: f es entero
+      text_put_huge(w, m, (uint8_t)e, decimals, negative);
+      return;
+    }
+    scaled <<= e;
+  } else if(e <= -64) {
+    scaled = 0; // scaled < 2^44: menos de media unidad
+  } else {
+    uint8_t sh = (uint8_t)-e;
+    uint64_t rem = scaled & (((uint64_t)1 << sh) - 1);
+    uint64_t half = (uint64_t)1 << (sh - 1);
+    scaled >>= sh;
+    if(rem > half || (rem == half && (scaled & 1))) scaled++;
+  }
+  text_put_fixed(w, scaled, decimals, negative && scaled != 0);
+}
+
+static size_t text_finish(text_writer_t* w) {
+  if(w->overflow) {
+    w->out[0] = '\0';
+    return 0;
+  }
+  w->out[w->len] = '\0';
+  return w->len;
+}
+
+/**
+ * @brief Escribe el elemento i de un campo con sus decimales
+ */
+static void write_value(text_writer_t* w, const uint8_t* base, const telemetry_field_t* field, uint8_t i) {
+  const uint8_t* p = base + field->offset + i * telemetry_field_width(field->kind);
+  int32_t value;
+  switch(field->kind) {
+    case TELEM_FIELD_F32: {
+      float f;
+      memcpy(&f, p, sizeof(f));
+      text_put_f32(w, f, field->decimals);
+      return;
+    }
+    case TELEM_FIELD_U8:  value = *p; break;
+    case TELEM_FIELD_I8:  value = (int8_t)*p; break;
+    case TELEM_FIELD_U16: { uint16_t v; memcpy(&v, p, 2); value = v; } break;
+    case TELEM_FIELD_I16: { int16_t v; memcpy(&v, p, 2); value = v; } break;
+    default: {
+      uint32_t v;
+      memcpy(&v, p, 4);
+      text_put_fixed(w, v, field->decimals, false);
+      return;
+    }
+  }
+
+  // Entero en unidades de 10^-decimals
+  uint32_t mag = (value < 0) ? (uint32_t)(-value) : (uint32_t)value;
+  text_put_fixed(w, mag, field->decimals, value < 0);
+}
+
+size_t telemetry_schema_format_json(const telemetry_packet_t* packet, char* out, size_t capacity) {
+  const telemetry_schema_t* schema = telemetry_schema_get(packet->header.type);
+  if(!schema || capacity == 0) {
+    return 0;
+  }
+
+  text_writer_t w = { out, capacity, 0, false };
+  const uint8_t* base = (const uint8_t*)packet;
+  text_put(&w, schema->json_prefix, schema->json_prefix_len);
+  for(uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    if(!field->json_key) continue;
+    text_put(&w, field->json_frag, field->json_frag_len);
+    if(field->count > 1) text_put_char(&w, '[');
+    for(uint8_t i = 0; i < field->count; i++) {
+      if(i) text_put_char(&w, ',');
+      write_value(&w, base, field, i);
+    }
+    if(field->count > 1) text_put_char(&w, ']');
+  }
+  text_put_char(&w, '}');
+  return text_finish(&w);
+}
+
+size_t telemetry_schema_format_log(const telemetry_packet_t* packet, char* out, size_t capacity) {
+  const telemetry_schema_t* schema = telemetry_schema_get(packet->header.type);
+  if(!schema || capacity == 0) {
+    return 0;
+  }
+
+  text_writer_t w = { out, capacity, 0, false };
+  const uint8_t* base = (const uint8_t*)packet;
+  text_put(&w, schema->log_tag, schema->log_tag_len);
+  text_put_char(&w, ':');
+  for(uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    if(!field->log_label) continue;
+    text_put_char(&w, ' ');
+    text_put(&w, field->log_label, field->log_label_len);
+    text_put_char(&w, '=');
+    for(uint8_t i = 0; i < field->count; i++) {
+      if(i) text_put_char(&w, '/');
+      write_value(&w, base, field, i);
+    }
+    text_put(&w, field->unit, field->unit_len);
+    TEXT_PUT_LITERAL(&w, " |");
+  }
+  TEXT_PUT_LITERAL(&w, " Seq=");
+  text_put_fixed(&w, packet->header.sequence, 0, false);
+  return text_finish(&w);
+}
@@ -0,0 +1,343 @@
+/**
+ * @file telemetry_sink.cpp
+ * @brief Implementación del despachador de sinks
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * El pool es una cola de índices libres y cada sink una cola de índices de
+ * buffers: las dos son colas acotadas MPMC en las que cada celda lleva un
+ * número de secuencia que dice si está libre para el productor de esa
+ * vuelta o lista para el consumidor. Cada buffer lleva un contador de
+ * referencias: quien publica retiene una mientras reparte, y cada cola en
+ * la que entra otra.
+ *
+ * El aviso a la tarea de cada sink sigue el esquema de telemetry_wake.cpp:
+ * la tarea arma su aviso antes de volver a mirar la cola y dormirse, y
+ * quien publica lo desarma tras encolar. Los avisos se guardan aparte de
+ * s_sinks para que telemetry_sink_init() no se los quite a tareas que ya
+ * corren.
+ */
+
+  #include <string.h>
+  #include "../include/telemetry_sink.h"
+
+/**
+ * @brief Celda de una cola acotada
+ */
+typedef struct {
+  uint32_t seq;         /**< Vuelta en la que está libre (seq == pos) o lista (seq == pos + 1) */
+  uint32_t value;       /**< Índice de buffer */
+} sink_cell_t;
+
+/**
+ * @brief Buffer compartido del pool
+ */
+typedef struct {
+  uint32_t refs;        /**< Colas (y publicador) que aún lo usan */
+  uint32_t channel;     /**< Canal en el que se publicó */
+  uint16_t len;         /**< Bytes del mensaje */
+  uint8_t data[TELEM_SINK_MESSAGE_BYTES];
+} sink_message_t;
+
+/**
+ * @brief Sink registrado con su cola
+ */
+typedef struct {
+  const telemetry_sink_t* sink;
+  uint32_t channels;
+  telem_sink_policy_t policy;
+  sink_cell_t cells[TELEM_SINK_QUEUE];
+  uint32_t enqueue_pos;
+  uint32_t dequeue_pos;
+  telemetry_sink_stats_t stats;
+} sink_slot_t;
+
+/**
+ * @brief Aviso de la tarea de un sink
+ */
+typedef struct {
+  const telemetry_wake_port_t* port;  /**< NULL = sin tarea: escribe quien publica */
+  void* ctx;
+  uint32_t armed;                     /**< 1 = la tarea duerme y aún no se le ha avisado */
+} sink_wake_t;
+
+static sink_message_t s_pool[TELEM_SINK_POOL];
+static sink_cell_t s_free_cells[TELEM_SINK_POOL];
+static uint32_t s_free_enqueue = 0;
+static uint32_t s_free_dequeue = 0;
+static sink_slot_t s_sinks[TELEM_SINK_MAX];
+static sink_wake_t s_wakes[TELEM_SINK_MAX];
+static uint32_t s_count = 0;
+/** @brief Unión de los canales suscritos (publicar en otro no cuesta nada) */
+static uint32_t s_channels = 0;
+static uint32_t s_no_buffer = 0;
+static uint32_t s_too_long = 0;
+
+static void queue_init(sink_cell_t* cells, uint32_t size, uint32_t* enqueue_pos, uint32_t* dequeue_pos) {
+  for(uint32_t i = 0; i < size; i++) {
+    cells[i].seq = i;
+  }
+  *enqueue_pos = 0;
+  *dequeue_pos = 0;
+}
+
+static bool queue_push(sink_cell_t* cells, uint32_t mask, uint32_t* enqueue_pos, uint32_t value) {
+  uint32_t pos = __atomic_load_n(enqueue_pos, __ATOMIC_RELAXED);
+  for(;;) {
+    sink_cell_t* cell = &cells[pos & mask];
+    int32_t dif = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+    if(dif == 0) {
+      if(__atomic_compare_exchange_n(enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        cell->value = value;
+        __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+        return true;
+      }
+    } else if(dif < 0) {
+      return false; // Llena
+    } else {
+      pos = __atomic_load_n(enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+static bool queue_pop(sink_cell_t* cells, uint32_t mask, uint32_t* dequeue_pos, uint32_t* value) {
+  uint32_t pos = __atomic_load_n(dequeue_pos, __ATOMIC_RELAXED);
+  for(;;) {
+    sink_cell_t* cell = &cells[pos & mask];
+    int32_t dif = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+    if(dif == 0) {
+      if(__atomic_compare_exchange_n(dequeue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        *value = cell->value;
+        __atomic_store_n(&cell->seq, pos + mask + 1, __ATOMIC_RELEASE);
+        return true;
+      }
+    } else if(dif < 0) {
+      return false; // Vacía (o el productor de esta celda aún no ha terminado)
+    } else {
+      pos = __atomic_load_n(dequeue_pos, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+static void message_release(uint32_t index) {
+  if(__atomic_sub_fetch(&s_pool[index].refs, 1, __ATOMIC_ACQ_REL) == 0) {
+    queue_push(s_free_cells, TELEM_SINK_POOL - 1, &s_free_enqueue, index);
+  }
+}
+
+void telemetry_sink_init(void) {
+  queue_init(s_free_cells, TELEM_SINK_POOL, &s_free_enqueue, &s_free_dequeue);
+  for(uint32_t i = 0; i < TELEM_SINK_POOL; i++) {
+    s_pool[i].refs = 0;
+    queue_push(s_free_cells, TELEM_SINK_POOL - 1, &s_free_enqueue, i);
+  }
+  memset(s_sinks, 0, sizeof(s_sinks));
+  s_count = 0;
+  s_channels = 0;
+  s_no_buffer = 0;
+  s_too_long = 0;
+}
+
+int telemetry_sink_add(const telemetry_sink_t* sink, uint32_t channels, telem_sink_policy_t policy) {
+  if(s_count >= TELEM_SINK_MAX || !sink || !sink->write) {
+    return -1;
+  }
+  sink_slot_t* slot = &s_sinks[s_count];
+  slot->sink = sink;
+  slot->channels = channels;
+  slot->policy = policy;
+  queue_init(slot->cells, TELEM_SINK_QUEUE, &slot->enqueue_pos, &slot->dequeue_pos);
+  __atomic_store_n(&s_channels, s_channels | channels, __ATOMIC_RELEASE);
+  __atomic_store_n(&s_count, s_count + 1, __ATOMIC_RELEASE);
+  return (int)(s_count - 1);
+}
+
+uint32_t telemetry_sink_count(void) {
+  return __atomic_load_n(&s_count, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Escribe un mensaje en un sink y lo cuenta
+ */
+static bool sink_write(sink_slot_t* slot, uint32_t channel, const uint8_t* data, uint32_t len) {
+  if(slot->sink->write(slot->sink->ctx, channel, data, len)) {
+    __atomic_add_fetch(&slot->stats.delivered, 1, __ATOMIC_RELAXED);
+    return true;
+  }
+  __atomic_add_fetch(&slot->stats.failed, 1, __ATOMIC_RELAXED);
+  return false;
+}
+
+void telemetry_sink_set_wake(int id, const telemetry_wake_port_t* port, void* ctx) {
+  if(id < 0 || id >= TELEM_SINK_MAX) {
+    return;
+  }
+  s_wakes[id].ctx = ctx;
+  __atomic_store_n(&s_wakes[id].port, port, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief La cola del sink tiene un mensaje listo
+ */
+static bool sink_pending(const sink_slot_t* slot) {
+  uint32_t pos = __atomic_load_n(&slot->dequeue_pos, __ATOMIC_SEQ_CST);
+  return __atomic_load_n(&slot->cells[pos & (TELEM_SINK_QUEUE - 1)].seq, __ATOMIC_SEQ_CST) == pos + 1;
+}
+
+bool telemetry_sink_wait(int id, uint32_t timeout_ms) {
+  if(id < 0 || (uint32_t)id >= telemetry_sink_count()) {
+    return false;
+  }
+  sink_wake_t* wake = &s_wakes[id];
+  const telemetry_wake_port_t* port = __atomic_load_n(&wake->port, __ATOMIC_ACQUIRE);
+  if(!port) {
+    return sink_pending(&s_sinks[id]);
+  }
+  __atomic_store_n(&wake->armed, 1, __ATOMIC_SEQ_CST);
+  if(sink_pending(&s_sinks[id])) {
+    __atomic_store_n(&wake->armed, 0, __ATOMIC_RELAXED);
+    return true;
+  }
+  port->wait(wake->ctx, timeout_ms);
+  __atomic_store_n(&wake->armed, 0, __ATOMIC_RELAXED);
+  return sink_pending(&s_sinks[id]);
+}
+
+#if TELEM_SINK_ASYNC
+/**
+ * @brief Despierta a la tarea de un sink si duerme esperando mensajes
+ */
+static void sink_notify(sink_wake_t* wake) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if(__atomic_exchange_n(&wake->armed, 0, __ATOMIC_SEQ_CST)) {
+    wake->port->notify(wake->ctx);
+  }
+}
+
+/**
+ * @brief Pone un buffer en la cola de un sink aplicando su política
+ */
+static bool sink_enqueue(sink_slot_t* slot, uint32_t index) {
+  __atomic_add_fetch(&s_pool[index].refs, 1, __ATOMIC_RELAXED);
+  if(queue_push(slot->cells, TELEM_SINK_QUEUE - 1, &slot->enqueue_pos, index)) {
+    return true;
+  }
+  uint32_t oldest;
+  if(slot->policy == TELEM_SINK_DROP_OLDEST &&
+     queue_pop(slot->cells, TELEM_SINK_QUEUE - 1, &slot->dequeue_pos, &oldest)) {
+    // Quien saca el más antiguo se queda con su referencia
+    __atomic_add_fetch(&slot->stats.dropped, 1, __ATOMIC_RELAXED);
+    message_release(oldest);
+    if(queue_push(slot->cells, TELEM_SINK_QUEUE - 1, &slot->enqueue_pos, index)) {
+      return true;
+    }
+  }
+  __atomic_add_fetch(&slot->stats.dropped, 1, __ATOMIC_RELAXED);
+  message_release(index);
+  return false;
+}
+#endif
+
+uint32_t telemetry_sink_publish(uint32_t channel, const void* data, uint32_t len) {
+  if(!(__atomic_load_n(&s_channels, __ATOMIC_ACQUIRE) & channel) || len == 0) {
+    return 0;
+  }
+  if(len > TELEM_SINK_MESSAGE_BYTES) {
+    __atomic_add_fetch(&s_too_long, 1, __ATOMIC_RELAXED);
+    return 0;
+  }
+  uint32_t count = telemetry_sink_count();
+  uint32_t delivered = 0;
+
+#if TELEM_SINK_ASYNC
+  uint32_t index = TELEM_SINK_POOL;
+  for(uint32_t i = 0; i < count; i++) {
+    sink_slot_t* slot = &s_sinks[i];
+    if(!(slot->channels & channel)) continue;
+    sink_wake_t* wake = &s_wakes[i];
+    if(!__atomic_load_n(&wake->port, __ATOMIC_ACQUIRE)) {
+      // Sin tarea que vacíe la cola: se escribe desde aquí
+      if(sink_write(slot, channel, (const uint8_t*)data, len)) delivered++;
+      continue;
+    }
+    if(index == TELEM_SINK_POOL) {
+      if(!queue_pop(s_free_cells, TELEM_SINK_POOL - 1, &s_free_dequeue, &index)) {
+        __atomic_add_fetch(&s_no_buffer, 1, __ATOMIC_RELAXED);
+        return delivered;
+      }
+      // Se serializa una vez: a partir de aquí el buffer es de solo lectura
+      sink_message_t* msg = &s_pool[index];
+      memcpy(msg->data, data, len);
+      msg->len = (uint16_t)len;
+      msg->channel = channel;
+      __atomic_store_n(&msg->refs, 1, __ATOMIC_RELEASE);
+    }
+    if(sink_enqueue(slot, index)) {
+      delivered++;
+      sink_notify(wake);
+    }
+  }
+  if(index != TELEM_SINK_POOL) {
+    message_release(index);
+  }
+#else
+  for(uint32_t i = 0; i < count; i++) {
+    sink_slot_t* slot = &s_sinks[i];
+    if((slot->channels & channel) && sink_write(slot, channel, (const uint8_t*)data, len)) {
+      delivered++;
+    }
+  }
+#endif
+  return delivered;
+}
+
+bool telemetry_sink_service(int id) {
+  if(id < 0 || (uint32_t)id >= telemetry_sink_count()) {
+    return false;
+  }
+  sink_slot_t* slot = &s_sinks[id];
+  uint32_t index;
+  if(!queue_pop(slot->cells, TELEM_SINK_QUEUE - 1, &slot->dequeue_pos, &index)) {
+    return false;
+  }
+  const sink_message_t* msg = &s_pool[index];
+  sink_write(slot, msg->channel, msg->data, msg->len);
+  message_release(index);
+  return true;
+}
+
+const char* telemetry_sink_get_stats(int id, telemetry_sink_stats_t* stats) {
+  if(id < 0 || (uint32_t)id >= telemetry_sink_count()) {
+    return NULL;
+  }
+  const sink_slot_t* slot = &s_sinks[id];
+  stats->delivered = __atomic_load_n(&slot->stats.delivered, __ATOMIC_RELAXED);
+  stats->dropped = __atomic_load_n(&slot->stats.dropped, __ATOMIC_RELAXED);
+  stats->failed = __atomic_load_n(&slot->stats.failed, __ATOMIC_RELAXED);
+  return slot->sink->name;
+}
+
+void telemetry_sink_get_pool_stats(uint32_t* no_buffer, uint32_t* too_long) {
+  *no_buffer = __atomic_load_n(&s_no_buffer, __ATOMIC_RELAXED);
+  *too_long = __atomic_load_n(&s_too_long, __ATOMIC_RELAXED);
+}
+
+static bool memory_write(void* ctx, uint32_t channel, const uint8_t* data, uint32_t len) {
+  (void)channel;
+  telemetry_sink_memory_t* mem = (telemetry_sink_memory_t*)ctx;
+  if(len > mem->capacity - mem->used) {
+    mem->overflow++;
+    return false;
+  }
+  memcpy(mem->buffer + mem->used, data, len);
+  mem->used += len;
+  mem->messages++;
+  return true;
+}
+
+void telemetry_sink_memory(telemetry_sink_memory_t* mem, telemetry_sink_t* sink) {
+  sink->name = "memory";
+  sink->write = memory_write;
+  sink->ctx = mem;
+}
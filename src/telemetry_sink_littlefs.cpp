@@ -0,0 +1,49 @@
+/**
+ * @file telemetry_sink_littlefs.cpp
+ * @brief Sink de ficheros de LittleFS
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Cada canal va a su fichero (los de telemetry_logger.h y la captura de
+ * bajada). Abrir, añadir y cerrar por mensaje cuesta milisegundos de
+ * flash: ahora los paga la tarea de este sink y no quien escribe el log.
+ */
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "../include/telemetry_sink.h"
+#include "../include/telemetry_logger.h"
+
+static const char* channel_path(uint32_t channel) {
+  switch (channel) {
+    case TELEM_SINK_CH_LOG:        return TELEMETRY_LOG_FILE;
+    case TELEM_SINK_CH_LOG_SYSTEM: return TELEMETRY_SYSTEM_LOG;
+    case TELEM_SINK_CH_LOG_POWER:  return TELEMETRY_POWER_LOG;
+    case TELEM_SINK_CH_LOG_TEMP:   return TELEMETRY_TEMP_LOG;
+    case TELEM_SINK_CH_LOG_COMMS:  return TELEMETRY_COMMS_LOG;
+    case TELEM_SINK_CH_DOWNLINK:   return TELEM_SINK_DOWNLINK_FILE;
+    default:                       return NULL;
+  }
+}
+
+static bool littlefs_write(void* ctx, uint32_t channel, const uint8_t* data, uint32_t len) {
+  (void)ctx;
+  const char* path = channel_path(channel);
+  if (!path) return false;
+  File f = LittleFS.open(path, FILE_APPEND);
+  if (!f) return false;
+  size_t written = f.write(data, len);
+  f.close();
+  return written == len;
+}
+
+static const telemetry_sink_t s_littlefs_sink = {
+  "littlefs",
+  littlefs_write,
+  NULL,
+};
+
+const telemetry_sink_t* telemetry_sink_littlefs(void) {
+  return &s_littlefs_sink;
+}
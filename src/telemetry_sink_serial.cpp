@@ -0,0 +1,30 @@
+/**
+ * @file telemetry_sink_serial.cpp
+ * @brief Sink sobre Serial
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Cada mensaje sale en una sola llamada a Serial.write(), que toma el
+ * cerrojo de la UART una vez: las líneas de log no se mezclan con los
+ * mensajes que saca la escritora de telemetry_txbuf.
+ */
+
+#include <Arduino.h>
+#include "../include/telemetry_sink.h"
+
+static bool serial_write(void* ctx, uint32_t channel, const uint8_t* data, uint32_t len) {
+  (void)ctx;
+  (void)channel;
+  return Serial.write(data, len) == len;
+}
+
+static const telemetry_sink_t s_serial_sink = {
+  "serial",
+  serial_write,
+  NULL,
+};
+
+const telemetry_sink_t* telemetry_sink_serial(void) {
+  return &s_serial_sink;
+}
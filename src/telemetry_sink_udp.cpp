@@ -0,0 +1,52 @@
+/**
+ * @file telemetry_sink_udp.cpp
+ * @brief Sink UDP a localhost para las herramientas del host
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Cada mensaje es un datagrama a 127.0.0.1, así que cualquier programa
+ * (p. ej. `nc -ul 5005`) puede escuchar la salida sin tocar el puerto
+ * serie. No se compila en el ESP32.
+ */
+
+#ifndef ARDUINO
+
+  #include <string.h>
+  #include <unistd.h>
+  #include <arpa/inet.h>
+  #include <netinet/in.h>
+  #include <sys/socket.h>
+  #include "../include/telemetry_sink.h"
+
+static bool udp_write(void* ctx, uint32_t channel, const uint8_t* data, uint32_t len) {
+  (void)channel;
+  const telemetry_sink_udp_t* udp = (const telemetry_sink_udp_t*)ctx;
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(udp->port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  return sendto(udp->fd, data, len, 0, (const struct sockaddr*)&addr, sizeof(addr)) == (ssize_t)len;
+}
+
+bool telemetry_sink_udp_open(telemetry_sink_udp_t* udp, uint16_t port, telemetry_sink_t* sink) {
+  udp->fd = socket(AF_INET, SOCK_DGRAM, 0);
+  udp->port = port;
+  if(udp->fd < 0) {
+    return false;
+  }
+  sink->name = "udp";
+  sink->write = udp_write;
+  sink->ctx = udp;
+  return true;
+}
+
+void telemetry_sink_udp_close(telemetry_sink_udp_t* udp) {
+  if(udp->fd >= 0) {
+    close(udp->fd);
+    udp->fd = -1;
+  }
+}
+
+#endif /* ARDUINO */
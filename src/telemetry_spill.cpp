@@ -0,0 +1,335 @@
+/**
+ * @file telemetry_spill.cpp
+ * @brief Implementación de la cola persistente de desbordamiento en flash
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Los segmentos se nombran TELEM_SPILL_SEGMENT_PREFIX + número creciente. La
+ * cola es [head_segment, tail_segment]: se reenvía desde head_segment en
+ * head_offset y se añade al final de tail_segment. El estado solo se
+ * reescribe al cambiar de segmento o al confirmar un reenvío, nunca por
+ * cada paquete.
+ *
+ * Los registros delta se leen siempre, aunque TELEM_SPILL_DELTA esté a 0:
+ * cambiar la opción no invalida la cola ya guardada. Si se confirma solo
+ * una parte de un registro delta, head_skip recuerda cuántos de sus
+ * paquetes se saltan en el siguiente peek.
+ *
+ * Este fichero no depende de Arduino ni de LittleFS: todo el acceso a
+ * ficheros pasa por telemetry_spill_fs_t.
+ */
+
+  #include <stdio.h>
+  #include <string.h>
+  #include "../include/telemetry_spill.h"
+  #include "../include/telemetry_record.h"
+  #include "../include/telemetry_delta.h"
+
+/** @brief Marca de formato del fichero de estado ("SPL2") */
+#define TELEM_SPILL_MAGIC 0x53504C32
+
+/** @brief Bytes máximos de un registro en flash */
+#define TELEM_SPILL_MAX_RECORD (sizeof(telemetry_record_hdr_t) + sizeof(telemetry_packet_t))
+
+static const telemetry_spill_fs_t* s_fs = NULL;
+static telemetry_spill_state_t s_state;
+/** @brief Bytes de segmento que ocupan los paquetes del último peek (por paquete) */
+static uint16_t s_peek_bytes[TELEM_SPILL_BATCH];
+/** @brief head_skip que queda tras confirmar hasta cada paquete del último peek */
+static uint8_t s_peek_skip[TELEM_SPILL_BATCH];
+static uint32_t s_peek_count = 0;
+/** @brief Lote codificado / leído (estático para no cargar la pila de la tarea) */
+static uint8_t s_io[TELEM_SPILL_BATCH * TELEM_SPILL_MAX_RECORD];
+static telemetry_packet_t s_batch[TELEM_SPILL_BATCH];
+/** @brief Contexto delta del registro que se codifica o decodifica */
+static telemetry_delta_ctx_t s_delta;
+
+static uint32_t s_spilled = 0;
+static uint32_t s_replayed = 0;
+static uint32_t s_discarded = 0;
+
+static void segment_path(uint32_t segment, char* path, size_t len) {
+  snprintf(path, len, TELEM_SPILL_SEGMENT_PREFIX "%08lu.bin", (unsigned long)segment);
+}
+
+static bool save_state(void) {
+  return s_fs->write(TELEM_SPILL_STATE_FILE, &s_state, sizeof(s_state));
+}
+
+static int32_t segment_size(uint32_t segment) {
+  char path[32];
+  segment_path(segment, path, sizeof(path));
+  return s_fs->size(path);
+}
+
+bool telemetry_spill_init(const telemetry_spill_fs_t* fs) {
+  s_fs = fs;
+  s_peek_count = 0;
+  if(!s_fs) {
+    return false;
+  }
+
+  telemetry_spill_state_t saved;
+  if(s_fs->read(TELEM_SPILL_STATE_FILE, 0, &saved, sizeof(saved)) == (int32_t)sizeof(saved) &&
+     saved.magic == TELEM_SPILL_MAGIC && saved.head_segment <= saved.tail_segment) {
+    s_state = saved;
+    // No añadir detrás de un registro que pudo quedar a medias
+    if(segment_size(s_state.tail_segment) > 0) {
+      s_state.tail_segment++;
+    }
+  } else {
+    s_state.magic = TELEM_SPILL_MAGIC;
+    s_state.head_segment = 0;
+    s_state.head_offset = 0;
+    s_state.tail_segment = 0;
+    s_state.head_skip = 0;
+  }
+  if(!save_state()) {
+    // Sistema de archivos no disponible: cola deshabilitada
+    s_fs = NULL;
+    return false;
+  }
+  return true;
+}
+
+bool telemetry_spill_pending(void) {
+  if(!s_fs) {
+    return false;
+  }
+  if(s_state.head_segment < s_state.tail_segment) {
+    return true;
+  }
+  return segment_size(s_state.head_segment) > (int32_t)s_state.head_offset;
+}
+
+/**
+ * @brief Añade un lote codificado al segmento de cola, abriendo uno nuevo si no cabe
+ */
+static bool append_records(const uint8_t* data, uint32_t len) {
+  int32_t size = segment_size(s_state.tail_segment);
+  if(size > 0 && (uint32_t)size + len > TELEM_SPILL_SEGMENT_BYTES) {
+    if(s_state.tail_segment - s_state.head_segment + 1 >= TELEM_SPILL_MAX_SEGMENTS) {
+      return false; // Cola llena
+    }
+    s_state.tail_segment++;
+    if(!save_state()) {
+      s_state.tail_segment--;
+      return false;
+    }
+  }
+  char path[32];
+  segment_path(s_state.tail_segment, path, sizeof(path));
+  return s_fs->append(path, data, len);
+}
+
+uint32_t telemetry_spill_offload(telemetry_subscriber_t sub) {
+  if(!s_fs || telemetry_available_packets_for(sub) <= TELEM_SPILL_HIGH_WATERMARK) {
+    return 0;
+  }
+
+  uint32_t spilled = 0;
+  uint32_t backlog;
+  while((backlog = telemetry_available_packets_for(sub)) > TELEM_SPILL_LOW_WATERMARK) {
+    uint32_t want = backlog - TELEM_SPILL_LOW_WATERMARK;
+    uint32_t count = telemetry_peek_batch(sub, s_batch, want < TELEM_SPILL_BATCH ? want : TELEM_SPILL_BATCH);
+    if(count == 0) {
+      break;
+    }
+
+    // Codificar el lote entero para escribirlo con una sola llamada
+    uint32_t len = 0;
+#if TELEM_SPILL_DELTA
+    // Un registro por lote, sin fotogramas clave intermedios: cada registro
+    // empieza con uno por tipo y se decodifica sin depender de los demás
+    telemetry_delta_init(&s_delta, 0xFFFF);
+    uint32_t encoded = 0;
+    len = sizeof(telemetry_record_hdr_t);
+    while(encoded < count && len + TELEM_DELTA_MAX_BYTES <= sizeof(s_io)) {
+      uint32_t n = telemetry_delta_encode(&s_delta, &s_batch[encoded], s_io + len, sizeof(s_io) - len);
+      if(n == 0) {
+        break;
+      }
+      len += n;
+      encoded++;
+    }
+    if(encoded == 0) {
+      break;
+    }
+    count = encoded;
+    telemetry_record_hdr_t hdr = { (uint16_t)(len - sizeof(hdr)), (uint8_t)count, TELEM_RECORD_DELTA };
+    memcpy(s_io, &hdr, sizeof(hdr));
+    uint32_t footprint = telemetry_record_footprint(hdr.length);
+    memset(s_io + len, 0, footprint - len);
+    len = footprint;
+#else
+    for(uint32_t i = 0; i < count; i++) {
+      uint16_t length = telemetry_record_payload_size(s_batch[i].header.type);
+      telemetry_record_hdr_t hdr = { length, (uint8_t)s_batch[i].header.type, 0 };
+      uint32_t footprint = telemetry_record_footprint(length);
+      memset(s_io + len, 0, footprint);
+      memcpy(s_io + len, &hdr, sizeof(hdr));
+      memcpy(s_io + len + sizeof(hdr), &s_batch[i], length);
+      len += footprint;
+    }
+#endif
+    if(!append_records(s_io, len)) {
+      break; // Los paquetes siguen en RAM
+    }
+    telemetry_commit_batch(sub, count);
+    spilled += count;
+  }
+
+  s_spilled += spilled;
+  return spilled;
+}
+
+/**
+ * @brief Borra el segmento de cabeza y pasa al siguiente
+ */
+static void advance_head_segment(void) {
+  char path[32];
+  segment_path(s_state.head_segment, path, sizeof(path));
+  s_fs->remove(path);
+  if(s_state.head_segment == s_state.tail_segment) {
+    s_state.tail_segment++;
+  }
+  s_state.head_segment++;
+  s_state.head_offset = 0;
+  s_state.head_skip = 0;
+}
+
+/**
+ * @brief Decodifica un registro delta añadiendo al peek sus paquetes pendientes
+ *
+ * @param skip Paquetes del registro ya reenviados
+ * @return bool false si el registro está corrupto (el peek queda como estaba)
+ */
+static bool peek_delta_record(const telemetry_record_hdr_t* hdr, const uint8_t* data, uint32_t footprint,
+                              uint32_t skip, telemetry_packet_t* packets, uint32_t max_count) {
+  uint32_t first = s_peek_count;
+  uint32_t pos = 0;
+  telemetry_delta_init(&s_delta, 0);
+  for(uint32_t k = 0; k < hdr->type && s_peek_count < max_count; k++) {
+    telemetry_packet_t packet;
+    uint32_t n = telemetry_delta_decode(&s_delta, data + pos, hdr->length - pos, &packet);
+    if(n == 0) {
+      s_peek_count = first;
+      return false;
+    }
+    pos += n;
+    if(k < skip) {
+      continue;
+    }
+    bool last = (k + 1 == hdr->type);
+    packets[s_peek_count] = packet;
+    s_peek_bytes[s_peek_count] = last ? (uint16_t)footprint : 0;
+    s_peek_skip[s_peek_count] = last ? 0 : (uint8_t)(k + 1);
+    s_peek_count++;
+  }
+  return true;
+}
+
+uint32_t telemetry_spill_peek(telemetry_packet_t* packets, uint32_t max_count) {
+  s_peek_count = 0;
+  if(!s_fs) {
+    return 0;
+  }
+  if(max_count > TELEM_SPILL_BATCH) {
+    max_count = TELEM_SPILL_BATCH;
+  }
+
+  while(s_peek_count == 0) {
+    char path[32];
+    segment_path(s_state.head_segment, path, sizeof(path));
+    int32_t size = s_fs->size(path);
+    // Un registro delta puede ocupar todo s_io aunque se pidan pocos paquetes
+    int32_t got = (size > (int32_t)s_state.head_offset)
+        ? s_fs->read(path, s_state.head_offset, s_io, sizeof(s_io)) : 0;
+
+    uint32_t pos = 0;
+    uint32_t skip = s_state.head_skip;
+    bool corrupt = false;
+    while(got > 0 && s_peek_count < max_count && pos + sizeof(telemetry_record_hdr_t) <= (uint32_t)got) {
+      telemetry_record_hdr_t hdr;
+      memcpy(&hdr, s_io + pos, sizeof(hdr));
+      bool delta = (hdr.flags & TELEM_RECORD_DELTA) != 0;
+      if(delta ? (hdr.type == 0 || hdr.type > TELEM_SPILL_BATCH || skip >= hdr.type ||
+                  telemetry_record_footprint(hdr.length) > sizeof(s_io))
+               : (skip > 0 || hdr.type >= TELEM_DATA_TYPE_COUNT ||
+                  hdr.length != telemetry_record_payload_size((telem_data_type_t)hdr.type))) {
+        corrupt = true;
+        break;
+      }
+      uint32_t footprint = telemetry_record_footprint(hdr.length);
+      if(pos + footprint > (uint32_t)got) {
+        // Registro incompleto: el resto llega en la siguiente lectura, o está truncado
+        break;
+      }
+      if(delta) {
+        if(!peek_delta_record(&hdr, s_io + pos + sizeof(hdr), footprint, skip, packets, max_count)) {
+          corrupt = true;
+          break;
+        }
+      } else {
+        memset(&packets[s_peek_count], 0, sizeof(telemetry_packet_t));
+        memcpy(&packets[s_peek_count], s_io + pos + sizeof(hdr), hdr.length);
+        s_peek_bytes[s_peek_count] = (uint16_t)footprint;
+        s_peek_skip[s_peek_count] = 0;
+        s_peek_count++;
+      }
+      skip = 0;
+      pos += footprint;
+    }
+
+    if(s_peek_count > 0) {
+      break;
+    }
+    if(s_state.head_segment >= s_state.tail_segment) {
+      // Segmento en escritura: vacío, salvo que contenga un registro corrupto
+      if(corrupt) {
+        s_discarded++;
+        advance_head_segment();
+        save_state();
+      }
+      return 0;
+    }
+    // Segmento cerrado sin registros válidos: lo que quedaba estaba truncado
+    // por un reinicio o corrupto
+    if(got > 0) {
+      s_discarded++;
+    }
+    advance_head_segment();
+    save_state();
+  }
+  return s_peek_count;
+}
+
+void telemetry_spill_commit(uint32_t count) {
+  if(!s_fs || s_peek_count == 0) {
+    return;
+  }
+  if(count > s_peek_count) {
+    count = s_peek_count;
+  }
+  for(uint32_t i = 0; i < count; i++) {
+    s_state.head_offset += s_peek_bytes[i];
+  }
+  s_state.head_skip = s_peek_skip[count - 1];
+  s_peek_count = 0;
+  s_replayed += count;
+
+  // Segmento agotado: si ya no se escribe en él, se borra
+  if(segment_size(s_state.head_segment) <= (int32_t)s_state.head_offset &&
+     s_state.head_segment < s_state.tail_segment) {
+    advance_head_segment();
+  }
+  save_state();
+}
+
+void telemetry_spill_get_stats(uint32_t* spilled, uint32_t* replayed, uint32_t* discarded, uint32_t* segments) {
+  if(spilled) *spilled = s_spilled;
+  if(replayed) *replayed = s_replayed;
+  if(discarded) *discarded = s_discarded;
+  if(segments) *segments = telemetry_spill_pending() ? (s_state.tail_segment - s_state.head_segment + 1) : 0;
+}
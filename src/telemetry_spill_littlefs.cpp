@@ -0,0 +1,67 @@
+/**
+ * @file telemetry_spill_littlefs.cpp
+ * @brief Backend LittleFS de la cola persistente de desbordamiento
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Implementa telemetry_spill_fs_t sobre LittleFS. El montaje lo realiza
+ * telemetry_logger_init(); si no se montó, todas las operaciones fallan y
+ * la cola queda deshabilitada sin afectar al resto del sistema.
+ */
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "../include/telemetry_spill.h"
+
+static bool lfs_append(const char* path, const void* data, uint32_t len) {
+  File f = LittleFS.open(path, FILE_APPEND);
+  if (!f) return false;
+  size_t written = f.write((const uint8_t*)data, len);
+  f.close();
+  return written == len;
+}
+
+static bool lfs_write(const char* path, const void* data, uint32_t len) {
+  File f = LittleFS.open(path, FILE_WRITE);
+  if (!f) return false;
+  size_t written = f.write((const uint8_t*)data, len);
+  f.close();
+  return written == len;
+}
+
+static int32_t lfs_read(const char* path, uint32_t offset, void* data, uint32_t len) {
+  File f = LittleFS.open(path, FILE_READ);
+  if (!f) return -1;
+  int32_t got = -1;
+  if (f.seek(offset)) {
+    got = (int32_t)f.read((uint8_t*)data, len);
+  }
+  f.close();
+  return got;
+}
+
+static int32_t lfs_size(const char* path) {
+  if (!LittleFS.exists(path)) return -1;
+  File f = LittleFS.open(path, FILE_READ);
+  if (!f) return -1;
+  int32_t size = (int32_t)f.size();
+  f.close();
+  return size;
+}
+
+static bool lfs_remove(const char* path) {
+  return LittleFS.remove(path);
+}
+
+static const telemetry_spill_fs_t s_littlefs_ops = {
+  lfs_append,
+  lfs_write,
+  lfs_read,
+  lfs_size,
+  lfs_remove,
+};
+
+const telemetry_spill_fs_t* telemetry_spill_fs_littlefs(void) {
+  return &s_littlefs_ops;
+}
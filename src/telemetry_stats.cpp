@@ -0,0 +1,231 @@
+/**
+ * @file telemetry_stats.cpp
+ * @brief Implementación de las estadísticas incrementales por campo
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Welford actualiza la media y la suma de cuadrados de las desviaciones
+ * sin restar sumas grandes (estable en float aunque el campo valga cientos
+ * de miles, como el heap libre). Al combinar dos cubetas a y b:
+ *
+ *     n = na + nb,  d = mean_b - mean_a
+ *     mean = mean_a + d·nb/n,  m2 = m2_a + m2_b + d²·na·nb/n
+ *
+ * La desviación típica es la muestral (n - 1), 0 con una sola muestra.
+ */
+
+  #include <math.h>
+  #include <string.h>
+  #include "../include/telemetry_stats.h"
+  #include "../include/telemetry_schema.h"
+
+/** @brief Suma 1 por cada campo de una X-macro del esquema */
+#define TELEM_STATS_COUNT_FIELD(s, m, n, k, d, j, l, u) + 1
+
+static_assert((0 TELEM_SCHEMA_SYSTEM(TELEM_STATS_COUNT_FIELD)) <= TELEM_STATS_MAX_FIELDS &&
+              (0 TELEM_SCHEMA_POWER(TELEM_STATS_COUNT_FIELD)) <= TELEM_STATS_MAX_FIELDS &&
+              (0 TELEM_SCHEMA_TEMPERATURE(TELEM_STATS_COUNT_FIELD)) <= TELEM_STATS_MAX_FIELDS,
+              "TELEM_STATS_MAX_FIELDS no cubre los campos de un tipo resumido");
+static_assert(60000 % TELEM_STATS_BUCKETS == 0, "TELEM_STATS_BUCKETS debe dividir 60000");
+
+/** @brief Tipo de cada fuente, en el orden de telemetry_stats_t::sources */
+static const telem_data_type_t s_sources[TELEM_STATS_SOURCE_COUNT] = {
+  TELEM_SYSTEM_STATUS,
+  TELEM_POWER_DATA,
+  TELEM_TEMPERATURE_DATA,
+};
+
+/** @brief Duración de cada ventana (s) */
+static const uint16_t s_window_s[TELEM_STATS_WINDOW_COUNT] = { 60, 600, 3600 };
+
+void telemetry_stats_init(telemetry_stats_t* stats, telemetry_stats_emit_t emit, void* ctx) {
+  memset(stats, 0, sizeof(*stats));
+  stats->emit = emit;
+  stats->ctx = ctx;
+}
+
+uint16_t telemetry_stats_window_s(uint8_t window) {
+  return (window < TELEM_STATS_WINDOW_COUNT) ? s_window_s[window] : 0;
+}
+
+static int source_index(telem_data_type_t type) {
+  for(int i = 0; i < TELEM_STATS_SOURCE_COUNT; i++) {
+    if(s_sources[i] == type) return i;
+  }
+  return -1;
+}
+
+bool telemetry_stats_summarizes(telem_data_type_t type) {
+  return source_index(type) >= 0;
+}
+
+/** @brief Ancho de una cubeta de la ventana (ms) */
+static inline uint32_t bucket_ms(uint8_t window) {
+  return (uint32_t)s_window_s[window] * 1000U / TELEM_STATS_BUCKETS;
+}
+
+/**
+ * @brief Combina las cubetas de épocas [lo, hi] de un campo
+ *
+ * @return false Si no hay muestras
+ */
+static bool merge(const telemetry_stats_source_t* src, uint8_t window, uint8_t field, uint32_t lo, uint32_t hi,
+                  float last, uint32_t last_ms, stats_summary_telem_t* out) {
+  uint32_t n = 0;
+  float mean = 0.0f, m2 = 0.0f, min = 0.0f, max = 0.0f, first = 0.0f;
+  uint32_t first_ms = 0;
+  for(uint8_t b = 0; b < TELEM_STATS_BUCKETS; b++) {
+    const telemetry_stats_bucket_t* bucket = &src->buckets[window][b];
+    if(bucket->count == 0 || bucket->epoch < lo || bucket->epoch > hi) continue;
+    const telemetry_stats_acc_t* acc = &bucket->acc[field];
+    if(n == 0) {
+      n = bucket->count;
+      mean = acc->mean;
+      m2 = acc->m2;
+      min = acc->min;
+      max = acc->max;
+      first = acc->first;
+      first_ms = bucket->first_ms;
+      continue;
+    }
+    uint32_t total = n + bucket->count;
+    float delta = acc->mean - mean;
+    mean += delta * bucket->count / total;
+    m2 += acc->m2 + delta * delta * ((float)n * bucket->count / total);
+    n = total;
+    if(acc->min < min) min = acc->min;
+    if(acc->max > max) max = acc->max;
+    if((int32_t)(bucket->first_ms - first_ms) < 0) {
+      first = acc->first;
+      first_ms = bucket->first_ms;
+    }
+  }
+  if(n == 0) {
+    return false;
+  }
+  out->samples = (n > UINT16_MAX) ? UINT16_MAX : (uint16_t)n;
+  out->min = min;
+  out->max = max;
+  out->mean = mean;
+  out->stddev = (n > 1 && m2 > 0.0f) ? sqrtf(m2 / (n - 1)) : 0.0f;
+  out->rate_per_min = (last_ms != first_ms) ? (last - first) * 60000.0f / (float)(last_ms - first_ms) : 0.0f;
+  return true;
+}
+
+/**
+ * @brief Emite los resúmenes de la ventana que contiene la época last_epoch
+ */
+static void emit_window(telemetry_stats_t* stats, int index, uint8_t window, uint32_t last_epoch) {
+  telemetry_stats_source_t* src = &stats->sources[index];
+  const telemetry_schema_t* schema = telemetry_schema_get(s_sources[index]);
+  uint32_t lo = last_epoch - last_epoch % TELEM_STATS_BUCKETS;
+  for(uint8_t f = 0; f < schema->field_count; f++) {
+    telemetry_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    stats_summary_telem_t* s = &packet.summary;
+    if(!merge(src, window, f, lo, lo + TELEM_STATS_BUCKETS - 1, src->last[f], src->last_ms, s)) {
+      return; // Todos los campos comparten las cubetas
+    }
+    s->header.type = TELEM_STATS_SUMMARY;
+    s->header.timestamp = src->last_ms;
+    s->header.sequence = stats->sequence++;
+    s->header.priority = TELEM_PRIORITY_HIGH;
+    s->source_type = (uint8_t)s_sources[index];
+    s->field = f;
+    s->window_s = s_window_s[window];
+    stats->summaries++;
+    if(stats->emit) stats->emit(stats->ctx, &packet);
+  }
+}
+
+bool telemetry_stats_update(telemetry_stats_t* stats, const telemetry_packet_t* packet) {
+  int index = source_index(packet->header.type);
+  if(index < 0) {
+    return false;
+  }
+  const telemetry_schema_t* schema = telemetry_schema_get(packet->header.type);
+  telemetry_stats_source_t* src = &stats->sources[index];
+  uint32_t now_ms = packet->header.timestamp;
+
+  if(src->started && now_ms < src->last_ms) {
+    memset(src, 0, sizeof(*src)); // Reloj hacia atrás: las cubetas ya no son comparables
+    stats->restarts++;
+  }
+
+  float values[TELEM_STATS_MAX_FIELDS];
+  for(uint8_t f = 0; f < schema->field_count; f++) {
+    const telemetry_field_t* field = &schema->fields[f];
+    values[f] = telemetry_field_value(packet, field->offset, field->kind, field->decimals);
+  }
+
+  for(uint8_t w = 0; w < TELEM_STATS_WINDOW_COUNT; w++) {
+    uint32_t width = bucket_ms(w);
+    uint32_t epoch = now_ms / width;
+    if(src->started) {
+      uint32_t last_epoch = src->last_ms / width;
+      if(epoch / TELEM_STATS_BUCKETS != last_epoch / TELEM_STATS_BUCKETS) {
+        emit_window(stats, index, w, last_epoch);
+      }
+    }
+
+    telemetry_stats_bucket_t* bucket = &src->buckets[w][epoch % TELEM_STATS_BUCKETS];
+    if(bucket->count == 0 || bucket->epoch != epoch) {
+      bucket->epoch = epoch; // Cubeta de una vuelta anterior del anillo: se reutiliza
+      bucket->first_ms = now_ms;
+      bucket->count = 0;
+    }
+    bucket->count++;
+    for(uint8_t f = 0; f < schema->field_count; f++) {
+      telemetry_stats_acc_t* acc = &bucket->acc[f];
+      float x = values[f];
+      if(bucket->count == 1) {
+        acc->mean = acc->min = acc->max = acc->first = x;
+        acc->m2 = 0.0f;
+        continue;
+      }
+      float delta = x - acc->mean;
+      acc->mean += delta / bucket->count;
+      acc->m2 += delta * (x - acc->mean);
+      if(x < acc->min) acc->min = x;
+      if(x > acc->max) acc->max = x;
+    }
+  }
+
+  memcpy(src->last, values, sizeof(float) * schema->field_count);
+  src->last_ms = now_ms;
+  src->samples++;
+  src->started = true;
+  stats->updates++;
+  return true;
+}
+
+bool telemetry_stats_get(const telemetry_stats_t* stats, telem_data_type_t type, uint8_t field, uint8_t window,
+                         uint32_t now_ms, stats_summary_telem_t* out) {
+  int index = source_index(type);
+  if(index < 0 || window >= TELEM_STATS_WINDOW_COUNT || field >= telemetry_schema_get(type)->field_count) {
+    return false;
+  }
+  const telemetry_stats_source_t* src = &stats->sources[index];
+  if(!src->started) {
+    return false;
+  }
+  uint32_t epoch = now_ms / bucket_ms(window);
+  uint32_t lo = (epoch >= TELEM_STATS_BUCKETS - 1) ? epoch - (TELEM_STATS_BUCKETS - 1) : 0;
+  memset(out, 0, sizeof(*out));
+  if(!merge(src, window, field, lo, epoch, src->last[field], src->last_ms, out)) {
+    return false;
+  }
+  out->header.type = TELEM_STATS_SUMMARY;
+  out->header.timestamp = now_ms;
+  out->header.priority = TELEM_PRIORITY_HIGH;
+  out->source_type = (uint8_t)type;
+  out->field = field;
+  out->window_s = s_window_s[window];
+  return true;
+}
+
+bool telemetry_stats_replaces(const telem_header_t* header, uint32_t newer) {
+  return newer >= TELEM_STATS_SCARCE_BACKLOG && header->priority <= TELEM_STATS_REPLACE_MAX_PRIORITY &&
+         telemetry_stats_summarizes(header->type);
+}
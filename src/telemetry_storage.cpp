@@ -8,24 +8,658 @@
  * Este archivo contiene la implementación del sistema de almacenamiento de
  * telemetría basado en un buffer circular con sincronización mediante mutex
  * de FreeRTOS. Diseñado específicamente para ejecutarse en el ESP32 bajo FreeRTOS.
+ *
+ * Con TELEM_STORAGE_LOCKFREE=1 se compila en su lugar una variante SPSC
+ * (un productor, un consumidor por cursor) basada en índices atómicos, sin mutex.
+ * Ambos modos comparten los algoritmos: los índices se publican siempre con
+ * operaciones atómicas y en modo mutex estas simplemente nunca compiten.
+ *
+ * Cada consumidor registra su propio cursor (telemetry_subscribe()). El
+ * productor solo se detiene ante el suscriptor bloqueante más lento; a los
+ * suscriptores desalojables se les adelanta el cursor cuando retienen el
+ * buffer lleno.
+ *
+ * El array de paquetes se reparte entre TELEM_LANE_COUNT vías (una sola si
+ * TELEM_STORAGE_PRIORITY_LANES=0). Cada vía es un anillo independiente y los
+ * cursores guardan una posición por vía.
  */
 
   #include "freertos/FreeRTOS.h"
   #include "freertos/semphr.h"
   #include "freertos/task.h"
+  #include "esp_timer.h"
+  #include <string.h>
   #include "../include/telemetry_storage.h"
+  #include "../include/telemetry_latency.h"
 
   /** @brief Instancia global del buffer circular (static para encapsulamiento) */
 static telemetry_buffer_t telem_buffer;
 
+/** @brief Cursor compartido por los usuarios de telemetry_retrieve_packet() */
+static telemetry_subscriber_t s_default_subscriber = TELEM_INVALID_SUBSCRIBER;
+
+#if TELEM_STORAGE_PRIORITY_LANES
+static const uint32_t s_lane_capacity[TELEM_LANE_COUNT] = {
+  TELEM_LANE_CAPACITY_LOW, TELEM_LANE_CAPACITY_NORMAL, TELEM_LANE_CAPACITY_HIGH
+};
+static const uint8_t s_lane_weight[TELEM_LANE_COUNT] = {
+  TELEM_LANE_WEIGHT_LOW, TELEM_LANE_WEIGHT_NORMAL, TELEM_LANE_WEIGHT_HIGH
+};
+static_assert(TELEM_LANE_CAPACITY_LOW + TELEM_LANE_CAPACITY_NORMAL + TELEM_LANE_CAPACITY_HIGH <= TELEM_BUFFER_SIZE,
+              "Las vías de prioridad no caben en TELEM_BUFFER_SIZE");
+#else
+static const uint32_t s_lane_capacity[TELEM_LANE_COUNT] = { TELEM_BUFFER_SIZE };
+static const uint8_t s_lane_weight[TELEM_LANE_COUNT] = { 1 };
+#endif
+
+/*
+ * Sincronización.
+ * En modo mutex cada operación que modifica el buffer toma el mutex; en modo
+ * SPSC el "lock" es vacío y la corrección depende de los accesos atómicos.
+ * Las consultas de estado no lo toman en ningún modo.
+ */
+static inline bool storage_lock(uint32_t timeout_ms) {
+#if TELEM_STORAGE_LOCKFREE
+  (void)timeout_ms;
+  return true;
+#else
+  telemetry_storage_metrics_t* m = &telem_buffer.metrics;
+  int64_t start_us = esp_timer_get_time();
+  if(xSemaphoreTake(telem_buffer.mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+    __atomic_fetch_add(&m->lock_timeouts, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+  // Con el mutex tomado somos el único escritor de estos campos
+  uint32_t waited_us = (uint32_t)(esp_timer_get_time() - start_us);
+  __atomic_store_n(&m->lock_acquired, m->lock_acquired + 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&m->lock_wait_total_us, m->lock_wait_total_us + waited_us, __ATOMIC_RELAXED);
+  if(waited_us > m->lock_wait_max_us) {
+    __atomic_store_n(&m->lock_wait_max_us, waited_us, __ATOMIC_RELAXED);
+  }
+  return true;
+#endif
+}
+
+static inline void storage_unlock(void) {
+#if !TELEM_STORAGE_LOCKFREE
+  xSemaphoreGive(telem_buffer.mutex);
+#endif
+}
+
+/*
+ * Accesos atómicos a índices y contadores.
+ * Los contadores se incrementan con operaciones atómicas porque también se
+ * actualizan fuera del mutex (p. ej. al fallar el timeout de xSemaphoreTake).
+ * En modo SPSC, el productor publica write_index con release tras copiar el
+ * paquete, y cada suscriptor publica su cursor con release tras leerlo; el
+ * lado contrario los lee con acquire.
+ */
+static inline uint32_t index_load_acquire(const uint32_t* idx) {
+  return __atomic_load_n(idx, __ATOMIC_ACQUIRE);
+}
+
+static inline void index_store_release(uint32_t* idx, uint32_t value) {
+  __atomic_store_n(idx, value, __ATOMIC_RELEASE);
+}
+
+static inline bool index_cas(uint32_t* idx, uint32_t* expected, uint32_t desired) {
+  return __atomic_compare_exchange_n(idx, expected, desired, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline void counter_add(uint32_t* counter, uint32_t n) {
+  __atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t counter_load(const uint32_t* counter) {
+  return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/* ----------------------------------------------------------------------------
+ * Anillo de una vía
+ * ------------------------------------------------------------------------- */
+
+static inline uint8_t lane_for_priority(uint8_t priority) {
+#if TELEM_STORAGE_PRIORITY_LANES
+  return (priority >= TELEM_LANE_COUNT) ? (TELEM_LANE_COUNT - 1) : priority;
+#else
+  (void)priority;
+  return 0;
+#endif
+}
+
+/** @brief Tipo usado cuando el productor no declara el tipo del paquete */
+#define TELEM_TYPE_UNKNOWN 0xFF
+
+/** @brief Vía del slot i de una reserva (NULL = todas de prioridad normal) */
+static inline uint8_t requested_lane(const telem_header_t* headers, uint32_t i) {
+  return lane_for_priority(headers ? headers[i].priority : (uint8_t)TELEM_PRIORITY_NORMAL);
+}
+
+/** @brief Tipo declarado para el slot i de una reserva */
+static inline uint8_t requested_type(const telem_header_t* headers, uint32_t i) {
+  return headers ? (uint8_t)headers[i].type : TELEM_TYPE_UNKNOWN;
+}
+
+static inline uint32_t lane_used(const telemetry_lane_t* lane, uint32_t write_index, uint32_t read_index) {
+  if(write_index >= read_index) {
+    return write_index - read_index;
+  }
+  return lane->capacity - read_index + write_index;
+}
+
+static inline uint32_t lane_advance(const telemetry_lane_t* lane, uint32_t index, uint32_t n) {
+  return (index + n) % lane->capacity;
+}
+
+static inline telemetry_packet_t* lane_slot(const telemetry_lane_t* lane, uint32_t index) {
+  return &telem_buffer.buffer[lane->base + index];
+}
+
+/**
+ * @brief Copia un lote a una vía partiéndolo en el punto de vuelta
+ */
+static void copy_in(const telemetry_lane_t* lane, uint32_t index, const telemetry_packet_t* src, uint32_t count) {
+  uint32_t first = lane->capacity - index;
+  if(first > count) first = count;
+  memcpy(lane_slot(lane, index), src, first * TELEM_PACKET_SIZE);
+  if(count > first) {
+    memcpy(lane_slot(lane, 0), src + first, (count - first) * TELEM_PACKET_SIZE);
+  }
+}
+
+/**
+ * @brief Copia un lote desde una vía partiéndolo en el punto de vuelta
+ */
+static void copy_out(const telemetry_lane_t* lane, uint32_t index, telemetry_packet_t* dst, uint32_t count) {
+  uint32_t first = lane->capacity - index;
+  if(first > count) first = count;
+  memcpy(dst, lane_slot(lane, index), first * TELEM_PACKET_SIZE);
+  if(count > first) {
+    memcpy(dst + first, lane_slot(lane, 0), (count - first) * TELEM_PACKET_SIZE);
+  }
+}
+
+static inline void count_written(uint8_t type) {
+  if(type < TELEM_DATA_TYPE_COUNT) {
+    counter_add(&telem_buffer.packets_written_by_type[type], 1);
+  }
+}
+
+static inline void count_lost(uint8_t lane, uint8_t type, uint32_t n) {
+  counter_add(&telem_buffer.lanes[lane].packets_lost, n);
+  counter_add(&telem_buffer.packets_lost, n);
+  if(type < TELEM_DATA_TYPE_COUNT) {
+    counter_add(&telem_buffer.packets_lost_by_type[type], n);
+  }
+}
+
+/**
+ * @brief Publica un paquete en la tabla de últimos valores (solo productor)
+ */
+static void latest_update(const telemetry_packet_t* packet) {
+  uint8_t type = (uint8_t)packet->header.type;
+  if(type >= TELEM_DATA_TYPE_COUNT) return;
+  telemetry_latest_t* entry = &telem_buffer.latest[type];
+  uint32_t seq = __atomic_load_n(&entry->sequence, __ATOMIC_RELAXED);
+  // Secuencia impar: escritura en curso
+  __atomic_store_n(&entry->sequence, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(&entry->packet, packet, TELEM_PACKET_SIZE);
+  __atomic_store_n(&entry->sequence, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Sella un slot al publicarlo y registra la etapa de adquisición
+ *
+ * @details Los slots de telemetry_reserve_slots() llevan ya el sello de
+ * adquisición; en los copiados por telemetry_store_batch() sin sello la
+ * adquisición cuenta desde la publicación.
+ */
+static inline void trace_enqueue(telemetry_packet_t* slot, uint32_t now_us) {
+  slot->header.enqueued_us = now_us;
+  if(slot->header.acquired_us == 0) {
+    slot->header.acquired_us = now_us;
+  } else {
+    telemetry_latency_record(TELEM_LATENCY_ACQUIRE, slot->header.type, now_us - slot->header.acquired_us);
+  }
+}
+
+/* ----------------------------------------------------------------------------
+ * Suscriptores
+ * ------------------------------------------------------------------------- */
+
+static inline bool subscriber_active(telemetry_subscriber_t sub) {
+  if(sub < 0 || sub >= TELEM_MAX_SUBSCRIBERS) {
+    return false;
+  }
+  return __atomic_load_n(&telem_buffer.subscribers[sub].active, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Cursor con más paquetes pendientes en una vía (o su cola si no hay suscriptores)
+ */
+static uint32_t oldest_pending_index(uint8_t lane_id, uint32_t write_index) {
+  const telemetry_lane_t* lane = &telem_buffer.lanes[lane_id];
+  uint32_t oldest = __atomic_load_n(&lane->tail_index, __ATOMIC_RELAXED);
+  uint32_t max_backlog = 0;
+  bool any = false;
+  for(int i = 0; i < TELEM_MAX_SUBSCRIBERS; i++) {
+    if(!subscriber_active(i)) continue;
+    uint32_t cursor = index_load_acquire(&telem_buffer.subscribers[i].read_index[lane_id]);
+    uint32_t backlog = lane_used(lane, write_index, cursor);
+    if(!any || backlog > max_backlog) {
+      oldest = cursor;
+      max_backlog = backlog;
+      any = true;
+    }
+  }
+  return oldest;
+}
+
+/**
+ * @brief Ocupa un cursor libre empezando en el paquete retenido más antiguo
+ */
+static telemetry_subscriber_t register_subscriber(telem_subscriber_policy_t policy) {
+  for(int i = 0; i < TELEM_MAX_SUBSCRIBERS; i++) {
+    telemetry_cursor_t* cur = &telem_buffer.subscribers[i];
+    if(cur->active) continue;
+    for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+      cur->read_index[l] = index_load_acquire(&telem_buffer.lanes[l].tail_index);
+      cur->peek_index[l] = cur->read_index[l];
+      cur->rr_credit[l] = 0;
+    }
+    cur->peek_runs = 0;
+    cur->peek_lane = 0;
+    cur->rr_lane = TELEM_LANE_COUNT - 1;
+    cur->scheduling = TELEM_LANE_STRICT;
+    cur->packets_read = 0;
+    cur->packets_overrun = 0;
+    cur->peeking = false;
+    cur->wake = NULL;
+    cur->policy = (uint8_t)policy;
+    __atomic_store_n(&cur->active, true, __ATOMIC_RELEASE);
+    return (telemetry_subscriber_t)i;
+  }
+  return TELEM_INVALID_SUBSCRIBER;
+}
+
+/**
+ * @brief Avisa a los suscriptores con aviso de los paquetes recién publicados
+ *
+ * @details Sin el mutex: la tarea despertada puede tener más prioridad que
+ * el productor y no debe encontrarlo tomado.
+ */
+static void signal_subscribers(uint32_t count) {
+  if(count == 0) return;
+  for(int i = 0; i < TELEM_MAX_SUBSCRIBERS; i++) {
+    if(!subscriber_active(i)) continue;
+    telemetry_wake_t* wake = __atomic_load_n(&telem_buffer.subscribers[i].wake, __ATOMIC_ACQUIRE);
+    if(wake) {
+      telemetry_wake_signal(wake, count);
+    }
+  }
+}
+
+/**
+ * @brief Paquetes pendientes por vía para un suscriptor
+ *
+ * @param[out] start Posición del cursor en cada vía
+ * @param[out] avail Paquetes pendientes en cada vía
+ * @return uint32_t Total pendiente
+ */
+static uint32_t pending_per_lane(const telemetry_cursor_t* cur, uint32_t* start, uint32_t* avail) {
+  uint32_t total = 0;
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    const telemetry_lane_t* lane = &telem_buffer.lanes[l];
+    // seq_cst: pareado con la comprobación de `peeking` en make_room()
+    start[l] = __atomic_load_n(&cur->read_index[l], __ATOMIC_SEQ_CST);
+    avail[l] = lane_used(lane, index_load_acquire(&lane->write_index), start[l]);
+    total += avail[l];
+  }
+  return total;
+}
+
+static inline uint8_t next_rr_lane(uint8_t lane) {
+  return (lane == 0) ? (TELEM_LANE_COUNT - 1) : (lane - 1);
+}
+
+/**
+ * @brief Elige la vía del siguiente paquete según el orden de servicio
+ *
+ * @return int Vía elegida, o -1 si no hay paquetes pendientes
+ *
+ * @details En modo ponderado cada vía con datos sirve hasta su peso en
+ * paquetes consecutivos y después cede el turno a la siguiente (de mayor a
+ * menor prioridad). Una vía vacía pierde el crédito que le quedaba.
+ */
+static int pick_lane(telemetry_cursor_t* cur, const uint32_t* avail) {
+  if(cur->scheduling == TELEM_LANE_STRICT) {
+    for(int l = TELEM_LANE_COUNT - 1; l >= 0; l--) {
+      if(avail[l] > 0) return l;
+    }
+    return -1;
+  }
+
+  for(int step = 0; step <= TELEM_LANE_COUNT; step++) {
+    uint8_t l = cur->rr_lane;
+    if(avail[l] == 0) {
+      cur->rr_credit[l] = 0;
+      cur->rr_lane = next_rr_lane(l);
+      continue;
+    }
+    if(cur->rr_credit[l] == 0) {
+      cur->rr_credit[l] = s_lane_weight[l];
+    }
+    if(--cur->rr_credit[l] == 0) {
+      cur->rr_lane = next_rr_lane(l);
+    }
+    return l;
+  }
+  return -1;
+}
+
+/**
+ * @brief Planifica un lote como tramos consecutivos de una misma vía
+ *
+ * @return uint32_t Paquetes planificados
+ */
+static uint32_t plan_runs(telemetry_cursor_t* cur, uint32_t* avail, uint32_t max_count,
+                          uint8_t* run_lane, uint16_t* run_count, uint8_t* runs) {
+  uint32_t total = 0;
+  *runs = 0;
+  while(total < max_count) {
+    int l = pick_lane(cur, avail);
+    if(l < 0) break;
+    if(*runs > 0 && run_lane[*runs - 1] == l) {
+      run_count[*runs - 1]++;
+    } else {
+      if(*runs == TELEM_PEEK_MAX_RUNS) break;
+      run_lane[*runs] = (uint8_t)l;
+      run_count[*runs] = 1;
+      (*runs)++;
+    }
+    avail[l]--;
+    total++;
+  }
+  return total;
+}
+
+/**
+ * @brief Copia los tramos planificados a partir de la posición de cada vía
+ */
+static void copy_runs(const uint32_t* start, const uint8_t* run_lane, const uint16_t* run_count,
+                      uint8_t runs, telemetry_packet_t* packets, uint32_t* end) {
+  uint32_t out = 0;
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    end[l] = start[l];
+  }
+  for(uint8_t r = 0; r < runs; r++) {
+    const telemetry_lane_t* lane = &telem_buffer.lanes[run_lane[r]];
+    copy_out(lane, end[run_lane[r]], packets + out, run_count[r]);
+    end[run_lane[r]] = lane_advance(lane, end[run_lane[r]], run_count[r]);
+    out += run_count[r];
+  }
+}
+
+/**
+ * @brief Elimina del lote los tramos de las vías invalidadas por un desalojo
+ *
+ * @return uint32_t Paquetes que quedan en el lote
+ */
+static uint32_t drop_failed_runs(telemetry_packet_t* packets, uint8_t* run_lane, uint16_t* run_count,
+                                 uint8_t* runs, const bool* failed) {
+  uint32_t in = 0, out = 0;
+  uint8_t kept = 0;
+  for(uint8_t r = 0; r < *runs; r++) {
+    if(!failed[run_lane[r]]) {
+      if(in != out) {
+        memmove(packets + out, packets + in, run_count[r] * TELEM_PACKET_SIZE);
+      }
+      run_lane[kept] = run_lane[r];
+      run_count[kept] = run_count[r];
+      kept++;
+      out += run_count[r];
+    }
+    in += run_count[r];
+  }
+  *runs = kept;
+  return out;
+}
+
+/* ----------------------------------------------------------------------------
+ * Productor
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Posición (desde la cola) del paquete de menor prioridad en la ventana
+ *
+ * @return int32_t Desplazamiento de la víctima, o -1 si todos los candidatos
+ * tienen más prioridad que el paquete nuevo
+ */
+static int32_t find_lowest_priority(const telemetry_lane_t* lane, uint32_t tail, uint32_t window, uint8_t priority) {
+  int32_t victim = -1;
+  uint8_t lowest = priority;
+  for(uint32_t k = 0; k < window; k++) {
+    uint8_t p = lane_slot(lane, lane_advance(lane, tail, k))->header.priority;
+    // Ante igualdad se elige el más antiguo: prevalece el dato fresco
+    if(p < lowest || (victim < 0 && p == lowest)) {
+      victim = (int32_t)k;
+      lowest = p;
+    }
+  }
+  return victim;
+}
+
+/**
+ * @brief Posición (desde la cola) del paquete más antiguo de un tipo sobrerrepresentado
+ *
+ * @return int32_t Desplazamiento de la víctima, o -1 si ningún tipo de la
+ * ventana supera TELEM_KEEP_LATEST_PER_TYPE paquetes retenidos en la vía
+ */
+static int32_t find_type_surplus(const telemetry_lane_t* lane, uint32_t tail, uint32_t retained, uint32_t window) {
+  uint32_t per_type[TELEM_DATA_TYPE_COUNT] = { 0 };
+  for(uint32_t k = 0; k < retained; k++) {
+    uint8_t t = lane_slot(lane, lane_advance(lane, tail, k))->header.type;
+    if(t < TELEM_DATA_TYPE_COUNT) per_type[t]++;
+  }
+  for(uint32_t k = 0; k < window; k++) {
+    uint8_t t = lane_slot(lane, lane_advance(lane, tail, k))->header.type;
+    if(t < TELEM_DATA_TYPE_COUNT && per_type[t] > TELEM_KEEP_LATEST_PER_TYPE) {
+      return (int32_t)k;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Elimina el paquete situado offset posiciones tras la cola
+ *
+ * @return false Si algún suscriptor tiene un telemetry_peek() abierto sobre
+ * los paquetes que habría que mover
+ *
+ * @details Los paquetes anteriores a la víctima se desplazan un slot hacia
+ * delante y la cola avanza uno; los cursores que aún no habían pasado la
+ * víctima avanzan también uno (su posición lógica no cambia, pero pierden la
+ * víctima). Con offset 0 no se mueve nada: es el desalojo de la cola.
+ */
+static bool remove_at(uint8_t lane_id, uint32_t tail, uint32_t offset) {
+  telemetry_lane_t* lane = &telem_buffer.lanes[lane_id];
+
+  for(int i = 0; i < TELEM_MAX_SUBSCRIBERS; i++) {
+    if(!subscriber_active(i)) continue;
+    telemetry_cursor_t* cur = &telem_buffer.subscribers[i];
+    if(__atomic_load_n(&cur->peeking, __ATOMIC_SEQ_CST) &&
+       lane_used(lane, __atomic_load_n(&cur->read_index[lane_id], __ATOMIC_SEQ_CST), tail) <= offset) {
+      return false;
+    }
+  }
+
+  uint32_t victim = lane_advance(lane, tail, offset);
+  bool lost = false;
+  for(int i = 0; i < TELEM_MAX_SUBSCRIBERS; i++) {
+    if(!subscriber_active(i)) continue;
+    telemetry_cursor_t* cur = &telem_buffer.subscribers[i];
+    uint32_t expected = index_load_acquire(&cur->read_index[lane_id]);
+    if(lane_used(lane, expected, tail) > offset) {
+      continue; // Ya había leído la víctima
+    }
+    if(index_cas(&cur->read_index[lane_id], &expected, lane_advance(lane, expected, 1))) {
+      counter_add(&cur->packets_overrun, 1);
+      lost = lost || cur->policy == TELEM_SUB_BLOCKING;
+    }
+  }
+  if(lost) {
+    count_lost(lane_id, lane_slot(lane, victim)->header.type, 1);
+  }
+
+  for(uint32_t k = offset; k > 0; k--) {
+    uint32_t dst = lane_advance(lane, tail, k);
+    memcpy(lane_slot(lane, dst), lane_slot(lane, lane_advance(lane, tail, k - 1)), TELEM_PACKET_SIZE);
+  }
+  index_store_release(&lane->tail_index, lane_advance(lane, tail, 1));
+  return true;
+}
+
+/**
+ * @brief Libera un slot de una vía llena retenida por un bloqueante según la política
+ *
+ * @param priority Prioridad del paquete nuevo
+ * @return false Si la política decide descartar el paquete nuevo
+ */
+static bool apply_overflow_policy(uint8_t lane_id, uint32_t tail, uint8_t priority) {
+  const telemetry_lane_t* lane = &telem_buffer.lanes[lane_id];
+  uint32_t retained = lane_used(lane, __atomic_load_n(&lane->write_index, __ATOMIC_RELAXED), tail);
+  uint32_t window = (retained < TELEM_OVERFLOW_SCAN_WINDOW) ? retained : TELEM_OVERFLOW_SCAN_WINDOW;
+  int32_t victim = -1;
+
+  switch(__atomic_load_n(&telem_buffer.overflow_policy, __ATOMIC_RELAXED)) {
+    case TELEM_OVERFLOW_OVERWRITE_OLDEST:
+      victim = 0;
+      break;
+    case TELEM_OVERFLOW_EVICT_LOWEST_PRIORITY:
+      victim = find_lowest_priority(lane, tail, window, priority);
+      break;
+    case TELEM_OVERFLOW_KEEP_LATEST_PER_TYPE:
+      victim = find_type_surplus(lane, tail, retained, window);
+      break;
+    case TELEM_OVERFLOW_DROP_NEWEST:
+    default:
+      break;
+  }
+  return victim >= 0 && remove_at(lane_id, tail, (uint32_t)victim);
+}
+
+/**
+ * @brief Libera el slot más antiguo de una vía si está llena (solo productor)
+ *
+ * @param priority Prioridad del paquete que se va a escribir
+ * @return false Si la vía sigue llena: el paquete nuevo debe descartarse
+ *
+ * @details Los suscriptores desalojables que retienen la cola ven su cursor
+ * adelantado mediante CAS; si el suscriptor avanzó por sí mismo entre medias,
+ * el CAS falla y el slot queda libre igualmente. Si la retiene un suscriptor
+ * bloqueante decide la política de desbordamiento, y un telemetry_peek()
+ * abierto sobre la cola nunca se invalida.
+ */
+static bool make_room(uint8_t lane_id, uint32_t write_index, uint8_t priority) {
+  telemetry_lane_t* lane = &telem_buffer.lanes[lane_id];
+  uint32_t next_write = lane_advance(lane, write_index, 1);
+  uint32_t tail = __atomic_load_n(&lane->tail_index, __ATOMIC_RELAXED);
+  if(next_write != tail) {
+    return true;
+  }
+
+  // La cola puede estar desfasada respecto al suscriptor más lento
+  tail = oldest_pending_index(lane_id, write_index);
+  if(next_write != tail) {
+    index_store_release(&lane->tail_index, tail);
+    return true;
+  }
+
+  bool blocked = false;
+  for(int i = 0; i < TELEM_MAX_SUBSCRIBERS; i++) {
+    if(!subscriber_active(i)) continue;
+    telemetry_cursor_t* cur = &telem_buffer.subscribers[i];
+    if(cur->policy == TELEM_SUB_BLOCKING &&
+       __atomic_load_n(&cur->read_index[lane_id], __ATOMIC_SEQ_CST) == tail) {
+      blocked = true;
+    }
+  }
+  if(blocked) {
+    return apply_overflow_policy(lane_id, tail, priority);
+  }
+
+  // Desalojar el paquete más antiguo: los cursores que lo retienen avanzan
+  return remove_at(lane_id, tail, 0);
+}
+
+/**
+ * @brief Paquetes retenidos en una vía (pendientes para el suscriptor más lento)
+ */
+static uint32_t lane_retained(uint8_t lane_id) {
+  const telemetry_lane_t* lane = &telem_buffer.lanes[lane_id];
+  uint32_t write_index = index_load_acquire(&lane->write_index);
+  return lane_used(lane, write_index, oldest_pending_index(lane_id, write_index));
+}
+
+static uint32_t total_retained(void) {
+  uint32_t retained = 0;
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    retained += lane_retained(l);
+  }
+  return retained;
+}
+
+/**
+ * @brief Registra la ocupación tras una escritura (solo productor)
+ */
+static void sample_occupancy(void) {
+  telemetry_storage_metrics_t* m = &telem_buffer.metrics;
+  uint32_t retained = total_retained();
+  if(retained > m->high_water) {
+    __atomic_store_n(&m->high_water, retained, __ATOMIC_RELAXED);
+  }
+  uint32_t bin = (retained * TELEM_OCCUPANCY_BINS) / telemetry_capacity();
+  if(bin >= TELEM_OCCUPANCY_BINS) {
+    bin = TELEM_OCCUPANCY_BINS - 1;
+  }
+  counter_add(&m->occupancy_samples[bin], 1);
+}
+
 void telemetry_storage_init(void) {
-  /* Inicialización de índices y contadores */
-  telem_buffer.write_index = 0;
-  telem_buffer.read_index = 0;
+  /* Inicialización de vías, índices y contadores */
+  uint32_t base = 0;
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    telemetry_lane_t* lane = &telem_buffer.lanes[l];
+    lane->base = base;
+    lane->capacity = s_lane_capacity[l];
+    lane->write_index = 0;
+    lane->tail_index = 0;
+    lane->reserved_count = 0;
+    lane->packets_written = 0;
+    lane->packets_lost = 0;
+    base += lane->capacity;
+  }
+  telem_buffer.reservation_size = 0;
   telem_buffer.packets_written = 0;
   telem_buffer.packets_read = 0;
   telem_buffer.packets_lost = 0;
+  for(int t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+    telem_buffer.packets_written_by_type[t] = 0;
+    telem_buffer.packets_lost_by_type[t] = 0;
+  }
+  telem_buffer.overflow_policy = (uint8_t)TELEM_OVERFLOW_POLICY;
+  for(int t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+    telem_buffer.latest[t].sequence = 0;
+  }
+  memset(&telem_buffer.metrics, 0, sizeof(telem_buffer.metrics));
+  for(int i = 0; i < TELEM_MAX_SUBSCRIBERS; i++) {
+    telem_buffer.subscribers[i].active = false;
+  }
+  s_default_subscriber = TELEM_INVALID_SUBSCRIBER;
 
+#if !TELEM_STORAGE_LOCKFREE
   /* Crear e inicializar el mutex */
   telem_buffer.mutex = xSemaphoreCreateMutex();
 
@@ -33,90 +667,539 @@ void telemetry_storage_init(void) {
     /* Error crítico: no se pudo crear el mutex */
     while(1) {
       /* En un sistema real, aquí deberíamos notificar el error */
-      vTaskDelay(pdMS_TO_TICKS(1000)); // "The macro pdMS_TO_TICKS() can be used to convert milliseconds into ticks." 
+      vTaskDelay(pdMS_TO_TICKS(1000)); // "The macro pdMS_TO_TICKS() can be used to convert milliseconds into ticks."
     }
   }
+#endif
 }
 
 bool telemetry_store_packet(const telemetry_packet_t* packet) {
-  if(xSemaphoreTake(telem_buffer.mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-    // Verificar si hay espacio
-    uint32_t next_write = (telem_buffer.write_index + 1) % TELEM_BUFFER_SIZE;
-
-    if(next_write == telem_buffer.read_index) {
-      // Buffer lleno
-      telem_buffer.packets_lost++;
-      xSemaphoreGive(telem_buffer.mutex);
-      return false;
+  return telemetry_store_batch(packet, 1) == 1;
+}
+
+uint32_t telemetry_store_batch(const telemetry_packet_t* packets, uint32_t count) {
+  if(!storage_lock(100)) {
+    // Timeout del mutex: el lote se descarta igualmente, contabilizarlo
+    for(uint32_t i = 0; i < count; i++) {
+      count_lost(lane_for_priority(packets[i].header.priority), packets[i].header.type, 1);
     }
+    return 0;
+  }
 
-    // Almacenar paquete
-    telem_buffer.buffer[telem_buffer.write_index] = *packet;
-    telem_buffer.write_index = next_write;
-    telem_buffer.packets_written++;
+  // Solo el productor modifica write_index: lectura relajada de sus propios índices
+  uint32_t write_index[TELEM_LANE_COUNT];
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    write_index[l] = __atomic_load_n(&telem_buffer.lanes[l].write_index, __ATOMIC_RELAXED);
+  }
 
-    xSemaphoreGive(telem_buffer.mutex);
-    return true;
+  // El estado actual se actualiza aunque el buffer descarte el paquete
+  for(uint32_t k = 0; k < count; k++) {
+    latest_update(&packets[k]);
   }
-  return false;
-}
 
-bool telemetry_retrieve_packet(telemetry_packet_t* packet) {
-  if(xSemaphoreTake(telem_buffer.mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-    if(telem_buffer.read_index == telem_buffer.write_index) {
-      // Buffer vacío
-      xSemaphoreGive(telem_buffer.mutex);
-      return false;
+  uint32_t stored = 0;
+  uint32_t i = 0;
+  while(i < count) {
+    // Tramo de paquetes consecutivos de la misma vía: se copia de una vez
+    uint8_t l = lane_for_priority(packets[i].header.priority);
+    uint32_t run = 1;
+    while(i + run < count && lane_for_priority(packets[i + run].header.priority) == l) {
+      run++;
     }
 
-    // Recuperar paquete
-    *packet = telem_buffer.buffer[telem_buffer.read_index];
-    telem_buffer.read_index = (telem_buffer.read_index + 1) % TELEM_BUFFER_SIZE;
-    telem_buffer.packets_read++;
+    telemetry_lane_t* lane = &telem_buffer.lanes[l];
+    uint32_t fit = 0;
+    while(fit < run && make_room(l, lane_advance(lane, write_index[l], fit), packets[i + fit].header.priority)) {
+      fit++;
+    }
+    copy_in(lane, write_index[l], &packets[i], fit);
+    uint32_t now_us = telemetry_latency_now();
+    for(uint32_t k = 0; k < fit; k++) {
+      trace_enqueue(lane_slot(lane, lane_advance(lane, write_index[l], k)), now_us);
+      count_written(packets[i + k].header.type);
+    }
+    write_index[l] = lane_advance(lane, write_index[l], fit);
+    counter_add(&lane->packets_written, fit);
+    for(uint32_t k = fit; k < run; k++) {
+      // Vía llena
+      count_lost(l, packets[i + k].header.type, 1);
+    }
+    stored += fit;
+    i += run;
+  }
 
-    xSemaphoreGive(telem_buffer.mutex);
-    return true;
+  // Publicar (release: copia visible antes que el índice)
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    index_store_release(&telem_buffer.lanes[l].write_index, write_index[l]);
   }
-  return false;
+  counter_add(&telem_buffer.packets_written, stored);
+  sample_occupancy();
+
+  storage_unlock();
+  signal_subscribers(stored);
+  return stored;
 }
 
-uint32_t telemetry_available_packets(void) {
-  uint32_t available = 0;
-  if(xSemaphoreTake(telem_buffer.mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-    if(telem_buffer.write_index >= telem_buffer.read_index) {
-      available = telem_buffer.write_index - telem_buffer.read_index;
+uint32_t telemetry_reserve_slots(const telem_header_t* headers, telemetry_packet_t** slots, uint32_t count) {
+  if(!storage_lock(100)) {
+    // Timeout del mutex: nada reservado
+    for(uint32_t i = 0; i < count; i++) {
+      slots[i] = NULL;
+      count_lost(requested_lane(headers, i), requested_type(headers, i), 1);
+    }
+    return 0;
+  }
+
+  uint32_t reserved = 0;
+  bool lane_full[TELEM_LANE_COUNT] = { false };
+  for(uint32_t i = 0; i < count; i++) {
+    uint8_t l = requested_lane(headers, i);
+    telemetry_lane_t* lane = &telem_buffer.lanes[l];
+    uint32_t index = lane_advance(lane, __atomic_load_n(&lane->write_index, __ATOMIC_RELAXED),
+                                  lane->reserved_count);
+    // Una vez llena, la vía no admite más slots en esta reserva: así los
+    // slots de una misma vía se confirman siempre contiguos y en orden
+    if(i < TELEM_MAX_RESERVATION && !lane_full[l] &&
+       make_room(l, index, headers ? headers[i].priority : (uint8_t)TELEM_PRIORITY_NORMAL)) {
+      slots[i] = lane_slot(lane, index);
+      slots[i]->header.acquired_us = telemetry_latency_now();
+      lane->reserved_count++;
+      reserved++;
     } else {
-      available = TELEM_BUFFER_SIZE - telem_buffer.read_index + telem_buffer.write_index;
+      // Vía llena
+      lane_full[l] = true;
+      slots[i] = NULL;
+      count_lost(l, requested_type(headers, i), 1);
     }
-    xSemaphoreGive(telem_buffer.mutex);
   }
-  return available;
+
+  if(reserved == 0) {
+    storage_unlock();
+    return 0;
+  }
+  // El mutex queda tomado hasta telemetry_commit_slots()/telemetry_cancel_slots()
+  telem_buffer.reservation_size = (uint8_t)(count < TELEM_MAX_RESERVATION ? count : TELEM_MAX_RESERVATION);
+  return reserved;
 }
 
-uint32_t telemetry_free_space(void) {
-  uint32_t free_space = 0;
-  if(xSemaphoreTake(telem_buffer.mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-    uint32_t used;
-    if(telem_buffer.write_index >= telem_buffer.read_index) {
-      used = telem_buffer.write_index - telem_buffer.read_index;
-    } else {
-      used = TELEM_BUFFER_SIZE - telem_buffer.read_index + telem_buffer.write_index;
+void telemetry_commit_slots(void) {
+  if(telem_buffer.reservation_size == 0) return;
+
+  uint32_t committed = 0;
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    telemetry_lane_t* lane = &telem_buffer.lanes[l];
+    if(lane->reserved_count == 0) continue;
+    // release: el contenido escrito en los slots es visible antes que el índice
+    uint32_t write_index = __atomic_load_n(&lane->write_index, __ATOMIC_RELAXED);
+    uint32_t now_us = telemetry_latency_now();
+    for(uint32_t k = 0; k < lane->reserved_count; k++) {
+      telemetry_packet_t* slot = lane_slot(lane, lane_advance(lane, write_index, k));
+      trace_enqueue(slot, now_us);
+      latest_update(slot);
+      count_written(slot->header.type);
+    }
+    index_store_release(&lane->write_index, lane_advance(lane, write_index, lane->reserved_count));
+    counter_add(&lane->packets_written, lane->reserved_count);
+    committed += lane->reserved_count;
+    lane->reserved_count = 0;
+  }
+  counter_add(&telem_buffer.packets_written, committed);
+  telem_buffer.reservation_size = 0;
+  sample_occupancy();
+
+  storage_unlock();
+  signal_subscribers(committed);
+}
+
+void telemetry_cancel_slots(void) {
+  if(telem_buffer.reservation_size == 0) return;
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    telem_buffer.lanes[l].reserved_count = 0;
+  }
+  telem_buffer.reservation_size = 0;
+  storage_unlock();
+}
+
+telemetry_packet_t* telemetry_reserve_slot(telem_data_type_t type, uint8_t priority) {
+  telem_header_t header;
+  header.type = type;
+  header.priority = priority;
+  telemetry_packet_t* slot = NULL;
+  telemetry_reserve_slots(&header, &slot, 1);
+  return slot;
+}
+
+void telemetry_commit_slot(void) {
+  telemetry_commit_slots();
+}
+
+void telemetry_update_latest(const telemetry_packet_t* packet) {
+  // telemetry_store_batch() también escribe la tabla (resúmenes, eventos):
+  // en modo mutex un único escritor a la vez
+  if(!storage_lock(100)) return;
+  latest_update(packet);
+  storage_unlock();
+}
+
+/* ----------------------------------------------------------------------------
+ * Consumidores
+ * ------------------------------------------------------------------------- */
+
+telemetry_subscriber_t telemetry_subscribe(telem_subscriber_policy_t policy) {
+  telemetry_subscriber_t sub = TELEM_INVALID_SUBSCRIBER;
+  if(storage_lock(100)) {
+    sub = register_subscriber(policy);
+    storage_unlock();
+  }
+  return sub;
+}
+
+void telemetry_unsubscribe(telemetry_subscriber_t sub) {
+  if(!subscriber_active(sub)) return;
+  if(storage_lock(100)) {
+    __atomic_store_n(&telem_buffer.subscribers[sub].active, false, __ATOMIC_RELEASE);
+    storage_unlock();
+  }
+}
+
+void telemetry_set_wake(telemetry_subscriber_t sub, telemetry_wake_t* wake) {
+  if(!subscriber_active(sub)) return;
+  __atomic_store_n(&telem_buffer.subscribers[sub].wake, wake, __ATOMIC_RELEASE);
+}
+
+void telemetry_set_lane_scheduling(telemetry_subscriber_t sub, telem_lane_scheduling_t scheduling) {
+  if(!subscriber_active(sub)) return;
+  telem_buffer.subscribers[sub].scheduling = (uint8_t)scheduling;
+}
+
+uint32_t telemetry_retrieve_batch(telemetry_subscriber_t sub, telemetry_packet_t* packets, uint32_t max_count) {
+  if(!subscriber_active(sub) || max_count == 0) {
+    return 0;
+  }
+  if(!storage_lock(100)) {
+    return 0;
+  }
+  telemetry_cursor_t* cur = &telem_buffer.subscribers[sub];
+
+  uint32_t count = 0;
+  for(;;) {
+    uint32_t start[TELEM_LANE_COUNT], avail[TELEM_LANE_COUNT], end[TELEM_LANE_COUNT];
+    uint8_t run_lane[TELEM_PEEK_MAX_RUNS];
+    uint16_t run_count[TELEM_PEEK_MAX_RUNS];
+    uint8_t runs;
+
+    // acquire: si vemos el índice publicado, vemos también los paquetes copiados
+    if(pending_per_lane(cur, start, avail) == 0) {
+      // Buffer vacío para este suscriptor
+      break;
+    }
+    count = plan_runs(cur, avail, max_count, run_lane, run_count, &runs);
+    copy_runs(start, run_lane, run_count, runs, packets, end);
+
+    // Confirmar por vía; si el productor nos desalojó durante la copia, los
+    // slots de esa vía pudieron reescribirse: se descartan y se reintenta
+    bool failed[TELEM_LANE_COUNT] = { false };
+    bool any_failed = false;
+    for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+      if(end[l] == start[l]) continue;
+      uint32_t expected = start[l];
+      if(!index_cas(&cur->read_index[l], &expected, end[l])) {
+        failed[l] = true;
+        any_failed = true;
+      }
+    }
+    if(any_failed) {
+      count = drop_failed_runs(packets, run_lane, run_count, &runs, failed);
+    }
+    if(count > 0 || !any_failed) {
+      break;
+    }
+  }
+
+  counter_add(&cur->packets_read, count);
+  counter_add(&telem_buffer.packets_read, count);
+  storage_unlock();
+  return count;
+}
+
+bool telemetry_retrieve_packet_for(telemetry_subscriber_t sub, telemetry_packet_t* packet) {
+  return telemetry_retrieve_batch(sub, packet, 1) == 1;
+}
+
+uint32_t telemetry_peek_batch(telemetry_subscriber_t sub, telemetry_packet_t* packets, uint32_t max_count) {
+  if(!subscriber_active(sub) || max_count == 0) {
+    return 0;
+  }
+  if(!storage_lock(100)) {
+    return 0;
+  }
+  telemetry_cursor_t* cur = &telem_buffer.subscribers[sub];
+
+  uint32_t count = 0;
+  for(;;) {
+    uint32_t start[TELEM_LANE_COUNT], avail[TELEM_LANE_COUNT], end[TELEM_LANE_COUNT];
+    cur->peek_runs = 0;
+    if(pending_per_lane(cur, start, avail) == 0) {
+      break;
+    }
+    count = plan_runs(cur, avail, max_count, cur->peek_run_lane, cur->peek_run_count, &cur->peek_runs);
+    copy_runs(start, cur->peek_run_lane, cur->peek_run_count, cur->peek_runs, packets, end);
+
+    // Validar que no hubo desalojo durante la copia
+    bool failed[TELEM_LANE_COUNT] = { false };
+    bool any_failed = false;
+    for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+      cur->peek_index[l] = start[l];
+      if(end[l] != start[l] && index_load_acquire(&cur->read_index[l]) != start[l]) {
+        failed[l] = true;
+        any_failed = true;
+      }
+    }
+    if(any_failed) {
+      count = drop_failed_runs(packets, cur->peek_run_lane, cur->peek_run_count, &cur->peek_runs, failed);
+    }
+    if(count > 0 || !any_failed) {
+      break;
+    }
+  }
+
+  storage_unlock();
+  return count;
+}
+
+void telemetry_commit_batch(telemetry_subscriber_t sub, uint32_t count) {
+  if(!subscriber_active(sub) || count == 0) {
+    return;
+  }
+  if(!storage_lock(100)) {
+    return;
+  }
+  telemetry_cursor_t* cur = &telem_buffer.subscribers[sub];
+
+  // Repartir la confirmación entre las vías en el orden en que se entregó
+  uint32_t per_lane[TELEM_LANE_COUNT] = { 0 };
+  for(uint8_t r = 0; r < cur->peek_runs && count > 0; r++) {
+    uint32_t n = (cur->peek_run_count[r] < count) ? cur->peek_run_count[r] : count;
+    per_lane[cur->peek_run_lane[r]] += n;
+    count -= n;
+  }
+  cur->peek_runs = 0;
+
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    if(per_lane[l] == 0) continue;
+    const telemetry_lane_t* lane = &telem_buffer.lanes[l];
+    uint32_t target = lane_advance(lane, cur->peek_index[l], per_lane[l]);
+    uint32_t read_index = index_load_acquire(&cur->read_index[l]);
+    for(;;) {
+      // Lo desalojado desde el peek ya no está pendiente
+      uint32_t consumed = lane_used(lane, read_index, cur->peek_index[l]);
+      if(consumed >= per_lane[l]) {
+        break;
+      }
+      if(index_cas(&cur->read_index[l], &read_index, target)) {
+        counter_add(&cur->packets_read, per_lane[l] - consumed);
+        counter_add(&telem_buffer.packets_read, per_lane[l] - consumed);
+        break;
+      }
+    }
+  }
+
+  storage_unlock();
+}
+
+const telemetry_packet_t* telemetry_peek(telemetry_subscriber_t sub) {
+  if(!subscriber_active(sub)) {
+    return NULL;
+  }
+  if(!storage_lock(100)) {
+    return NULL;
+  }
+  telemetry_cursor_t* cur = &telem_buffer.subscribers[sub];
+  const telemetry_packet_t* packet = NULL;
+
+  // Anunciar el acceso antes de leer el cursor (seq_cst, pareado con make_room):
+  // mientras dure, make_room() no desaloja este cursor
+  __atomic_store_n(&cur->peeking, true, __ATOMIC_SEQ_CST);
+  uint32_t start[TELEM_LANE_COUNT], avail[TELEM_LANE_COUNT];
+  pending_per_lane(cur, start, avail);
+  int l = pick_lane(cur, avail);
+  if(l < 0) {
+    __atomic_store_n(&cur->peeking, false, __ATOMIC_RELEASE);
+  } else {
+    cur->peek_lane = (uint8_t)l;
+    cur->peek_index[l] = start[l];
+    packet = lane_slot(&telem_buffer.lanes[l], start[l]);
+  }
+
+  storage_unlock();
+  return packet;
+}
+
+bool telemetry_release(telemetry_subscriber_t sub) {
+  if(!subscriber_active(sub)) {
+    return false;
+  }
+  if(!storage_lock(100)) {
+    return false;
+  }
+  telemetry_cursor_t* cur = &telem_buffer.subscribers[sub];
+  bool valid = false;
+
+  if(__atomic_load_n(&cur->peeking, __ATOMIC_RELAXED)) {
+    // Si el CAS falla, el productor desalojó el paquete durante el acceso
+    uint8_t l = cur->peek_lane;
+    uint32_t expected = cur->peek_index[l];
+    valid = index_cas(&cur->read_index[l], &expected,
+                      lane_advance(&telem_buffer.lanes[l], expected, 1));
+    if(valid) {
+      counter_add(&cur->packets_read, 1);
+      counter_add(&telem_buffer.packets_read, 1);
+    }
+    __atomic_store_n(&cur->peeking, false, __ATOMIC_RELEASE);
+  }
+
+  storage_unlock();
+  return valid;
+}
+
+bool telemetry_retrieve_packet(telemetry_packet_t* packet) {
+  if(s_default_subscriber == TELEM_INVALID_SUBSCRIBER && storage_lock(100)) {
+    // Registro perezoso bajo mutex: varias tareas pueden llegar a la vez
+    if(s_default_subscriber == TELEM_INVALID_SUBSCRIBER) {
+      s_default_subscriber = register_subscriber(TELEM_SUB_BLOCKING);
     }
-    // Un slot reservado para condición de lleno
-    free_space = (TELEM_BUFFER_SIZE - 1) - used;
-    xSemaphoreGive(telem_buffer.mutex);
+    storage_unlock();
   }
-  return free_space;
+  return telemetry_retrieve_packet_for(s_default_subscriber, packet);
+}
+
+/* ----------------------------------------------------------------------------
+ * Ocupación y estadísticas
+ * ------------------------------------------------------------------------- */
+
+uint32_t telemetry_available_packets(void) {
+  return total_retained();
+}
+
+uint32_t telemetry_available_packets_for(telemetry_subscriber_t sub) {
+  if(!subscriber_active(sub)) {
+    return 0;
+  }
+  uint32_t start[TELEM_LANE_COUNT], avail[TELEM_LANE_COUNT];
+  return pending_per_lane(&telem_buffer.subscribers[sub], start, avail);
+}
+
+uint32_t telemetry_capacity(void) {
+  uint32_t capacity = 0;
+  for(int l = 0; l < TELEM_LANE_COUNT; l++) {
+    // Un slot reservado por vía para condición de lleno
+    capacity += telem_buffer.lanes[l].capacity - 1;
+  }
+  return capacity;
+}
+
+uint32_t telemetry_free_space(void) {
+  uint32_t retained = total_retained();
+  uint32_t capacity = telemetry_capacity();
+  return (retained < capacity) ? capacity - retained : 0;
 }
 
 void telemetry_get_stats(uint32_t* written, uint32_t* read, uint32_t* lost) {
+  if(written) *written = counter_load(&telem_buffer.packets_written);
+  if(read) *read = counter_load(&telem_buffer.packets_read);
+  if(lost) *lost = counter_load(&telem_buffer.packets_lost);
+}
+
+bool telemetry_get_latest(telem_data_type_t type, telemetry_packet_t* packet) {
+  if((uint32_t)type >= TELEM_DATA_TYPE_COUNT) {
+    return false;
+  }
+  const telemetry_latest_t* entry = &telem_buffer.latest[type];
+  for(int attempt = 0; attempt < TELEM_LATEST_MAX_RETRIES; attempt++) {
+    uint32_t before = __atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE);
+    if(before == 0) {
+      return false; // Nunca escrito
+    }
+    if(before & 1) {
+      continue; // Escritura en curso
+    }
+    memcpy(packet, &entry->packet, TELEM_PACKET_SIZE);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if(__atomic_load_n(&entry->sequence, __ATOMIC_RELAXED) == before) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t telemetry_get_lost_by_type(telem_data_type_t type) {
+  if((uint32_t)type >= TELEM_DATA_TYPE_COUNT) {
+    return 0;
+  }
+  return counter_load(&telem_buffer.packets_lost_by_type[type]);
+}
+
+uint32_t telemetry_get_written_by_type(telem_data_type_t type) {
+  if((uint32_t)type >= TELEM_DATA_TYPE_COUNT) {
+    return 0;
+  }
+  return counter_load(&telem_buffer.packets_written_by_type[type]);
+}
+
+void telemetry_set_overflow_policy(telem_overflow_policy_t policy) {
+  if(storage_lock(100)) {
+    __atomic_store_n(&telem_buffer.overflow_policy, (uint8_t)policy, __ATOMIC_RELAXED);
+    storage_unlock();
+  }
+}
+
+void telemetry_get_lane_stats(uint8_t lane, uint32_t* written, uint32_t* lost, uint32_t* retained) {
   if(written) *written = 0;
-  if(read) *read = 0;
   if(lost) *lost = 0;
-  if(xSemaphoreTake(telem_buffer.mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-    if(written) *written = telem_buffer.packets_written;
-    if(read) *read = telem_buffer.packets_read;
-    if(lost) *lost = telem_buffer.packets_lost;
-    xSemaphoreGive(telem_buffer.mutex);
+  if(retained) *retained = 0;
+  if(lane >= TELEM_LANE_COUNT) return;
+  if(written) *written = counter_load(&telem_buffer.lanes[lane].packets_written);
+  if(lost) *lost = counter_load(&telem_buffer.lanes[lane].packets_lost);
+  if(retained) *retained = lane_retained(lane);
+}
+
+void telemetry_get_subscriber_stats(telemetry_subscriber_t sub, uint32_t* read, uint32_t* overrun) {
+  if(read) *read = 0;
+  if(overrun) *overrun = 0;
+  if(!subscriber_active(sub)) return;
+  if(read) *read = counter_load(&telem_buffer.subscribers[sub].packets_read);
+  if(overrun) *overrun = counter_load(&telem_buffer.subscribers[sub].packets_overrun);
+}
+
+void telemetry_get_metrics(telemetry_storage_metrics_t* metrics) {
+  const telemetry_storage_metrics_t* m = &telem_buffer.metrics;
+  metrics->high_water = counter_load(&m->high_water);
+  for(int b = 0; b < TELEM_OCCUPANCY_BINS; b++) {
+    metrics->occupancy_samples[b] = counter_load(&m->occupancy_samples[b]);
+  }
+  metrics->lock_acquired = counter_load(&m->lock_acquired);
+  metrics->lock_timeouts = counter_load(&m->lock_timeouts);
+  metrics->lock_wait_total_us = counter_load(&m->lock_wait_total_us);
+  metrics->lock_wait_max_us = counter_load(&m->lock_wait_max_us);
+}
+
+void telemetry_fill_metrics_packet(telemetry_packet_t* packet) {
+  telemetry_storage_metrics_t m;
+  telemetry_get_metrics(&m);
+  storage_metrics_telem_t* out = &packet->storage;
+
+  out->occupancy = (uint16_t)total_retained();
+  out->high_water = (uint16_t)m.high_water;
+  out->capacity = (uint16_t)telemetry_capacity();
+  uint32_t samples = 0;
+  for(int b = 0; b < TELEM_OCCUPANCY_BINS; b++) {
+    samples += m.occupancy_samples[b];
+  }
+  for(int b = 0; b < TELEM_OCCUPANCY_BINS; b++) {
+    out->occupancy_pct[b] = samples ? (uint8_t)(((uint64_t)m.occupancy_samples[b] * 100) / samples) : 0;
   }
+  out->packets_lost = counter_load(&telem_buffer.packets_lost);
+  out->lock_timeouts = m.lock_timeouts;
+  out->lock_wait_avg_us = m.lock_acquired ? m.lock_wait_total_us / m.lock_acquired : 0;
+  out->lock_wait_max_us = m.lock_wait_max_us;
 }
\ No newline at end of file
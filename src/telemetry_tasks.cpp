@@ -13,6 +13,11 @@
  * - Recolector: Genera y almacena datos de telemetría
  * - Procesador: Procesa y visualiza los datos almacenados
  * - Transmisor: Simula el envío de datos a estación terrestre
+ * - Escritora: Saca por la UART lo que encola el transmisor
+ * - Sinks: Una por salida de telemetry_sink.h (consola, ficheros)
+ *
+ * El procesador y el transmisor no sondean el buffer: duermen hasta que el
+ * almacenamiento les avisa de paquetes nuevos (telemetry_wake.h).
  * 
  * @note Las tareas están optimizadas para entorno WOKWI con intervalos
  * reducidos para facilitar la visualización durante pruebas.
@@ -29,12 +34,16 @@
 TaskHandle_t gTaskCollectHandle = NULL;
 TaskHandle_t gTaskProcessHandle = NULL;
 TaskHandle_t gTaskTransmitHandle = NULL;
+TaskHandle_t gTaskTxWriterHandle = NULL;
+TaskHandle_t gTaskSinkHandles[TELEM_SINK_MAX] = { NULL };
 #include "../include/telemetry_acquisition.h"
 #include "../include/telemetry_processing.h"
 #include "../include/telemetry_transmission.h"
+#include "../include/telemetry_txbuf.h"
 
 
 void vTelemetryCollectorTask(void *pvParameters) {
+  (void)pvParameters;
   TickType_t xLastWakeTime = xTaskGetTickCount();
   telemetry_logf("🚀 Telemetry Collector Task Started");
   telemetry_acquisition_init();
@@ -47,24 +56,49 @@ void vTelemetryCollectorTask(void *pvParameters) {
 
 
 void vTelemetryProcessorTask(void *pvParameters) {
+  (void)pvParameters;
   telemetry_logf("🔧 Telemetry Processor Task Started");
   telemetry_processing_init();
 
   for(;;) {
-    if(!telemetry_processing_handle_one()) {
-      vTaskDelay(pdMS_TO_TICKS(1000));
+    // Lote incompleto: el buffer ha quedado vacío, dormir hasta el siguiente aviso
+    if(telemetry_processing_handle_batch(TELEM_PROC_BATCH) < TELEM_PROC_BATCH) {
+      telemetry_processing_wait();
     }
   }
 }
 
 void vTelemetryTransmitterTask(void *pvParameters) {
+  (void)pvParameters;
   telemetry_logf("📡 Telemetry Transmitter Task Started");
   telemetry_transmission_init();
   for(;;) {
     telemetry_transmission_cycle();
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    telemetry_transmission_wait();
   }
 
   // Crear tareas desde un punto común usando handles
   // Nota: Este archivo no define setup(), pero las tareas se crean en main.cpp.
-}
\ No newline at end of file
+}
+
+void vTelemetryTxWriterTask(void *pvParameters) {
+  (void)pvParameters;
+  telemetry_txbuf_attach_writer(telemetry_wake_port_task(), xTaskGetCurrentTaskHandle());
+  for(;;) {
+    // Serial.write() bloquea esta tarea (y solo esta) mientras la UART está llena
+    if(telemetry_txbuf_drain() == 0) {
+      telemetry_txbuf_wait_data(TELEM_TXBUF_WRITER_IDLE_MS); // Buffer vacío o retenido
+    }
+  }
+}
+
+void vTelemetrySinkTask(void *pvParameters) {
+  int id = (int)(intptr_t)pvParameters;
+  telemetry_sink_set_wake(id, telemetry_wake_port_task(), xTaskGetCurrentTaskHandle());
+  for(;;) {
+    // write() bloquea solo a esta tarea: las demás salidas siguen a su ritmo
+    if(!telemetry_sink_service(id)) {
+      telemetry_sink_wait(id, TELEM_SINK_IDLE_MS); // Cola vacía
+    }
+  }
+}
@@ -7,126 +7,686 @@
  * @details
  * Este módulo se encarga de transmitir los paquetes de telemetría almacenados,
  * simulando la comunicación con la estación terrestre.
- * Envía datos en formato JSON compatible con Fomalhaut.
+ * Envía datos en formato JSON compatible con Fomalhaut, o en tramas binarias
+ * (TELEM_DOWNLINK_BINARY, opcionalmente con compresión delta) que
+ * bridge/frame_decoder convierte al mismo JSON. Cada mensaje encolado se
+ * publica además en TELEM_SINK_CH_DOWNLINK para los sinks de captura.
+ *
+ * Los paquetes no se escriben en Serial desde aquí: se serializan en el
+ * buffer de telemetry_txbuf.h y la tarea escritora los saca por la UART,
+ * así que el ritmo lo marca la velocidad del enlace y no una pausa fija
+ * por paquete.
+ *
+ * Con TELEM_CONTACT_SCHEDULE solo se transmite dentro de las ventanas de
+ * telemetry_contact.h. TELEM_CONTACT_LEAD_MS antes de AOS se serializa el
+ * primer lote con la salida retenida (telemetry_txbuf_hold()), de modo que
+ * en AOS el enlace arranca lleno. Durante el pase se envía mientras quepa
+ * el siguiente mensaje en los bytes que el enlace aún puede sacar antes de
+ * LOS, contando lo que ya espera en el buffer: lo que no cabe queda sin
+ * confirmar para el pase siguiente. Exige TELEM_STORAGE_PRIORITY_LANES: con
+ * el cursor en TELEM_LANE_STRICT toda la RAM de alta prioridad sale antes
+ * que la cola de flash.
+ *
+ * Con TELEM_DOWNLINK_ARQ cada trama se guarda en la ventana de
+ * telemetry_arq.h hasta que tierra la confirma por la línea de subida
+ * (Serial RX); las repeticiones salen por el mismo buffer y cuentan en el
+ * presupuesto del pase.
+ *
+ * Con TELEM_DOWNLINK_DECIMATION, los paquetes antiguos de baja prioridad
+ * se aclaran según el retraso que queda por detrás (telemetry_decimation.h):
+ * se confirman sin enviarlos.
+ *
+ * Con TELEM_STATS_DOWNLINK, las muestras antiguas de los tipos que resume
+ * el procesador (telemetry_stats.h) tampoco se envían: en su lugar bajan
+ * los resúmenes por ventana, que se transmiten siempre.
+ *
+ * Con TELEM_DOWNLINK_RBE, los tipos de telemetry_rbe.h solo se envían
+ * cuando algún campo sale de su banda muerta o vence el latido; los campos
+ * que no han cambiado bajan con el último valor enviado.
+ *
+ * Entre ciclos el transmisor duerme hasta que el almacenamiento le avisa de
+ * paquetes nuevos (telemetry_wake.h) o pasan TELEM_XMIT_WAKE_MAX_DELAY_MS.
  */
 
 #include <Arduino.h>
+#include <LittleFS.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "../include/telemetry_transmission.h"
 #include "../include/telemetry_storage.h"
 #include "../include/telemetry_logger.h"
+#include "../include/telemetry_spill.h"
+#include "../include/telemetry_schema.h"
+#include "../include/telemetry_frame.h"
+#include "../include/telemetry_delta.h"
+#include "../include/telemetry_latency.h"
+#include "../include/telemetry_txbuf.h"
+#include "../include/telemetry_contact.h"
+#include "../include/telemetry_arq.h"
+#include "../include/telemetry_decimation.h"
+#include "../include/telemetry_sink.h"
+#include "../include/telemetry_stats.h"
+#include "../include/telemetry_rbe.h"
+#include "../include/telemetry_tasks.h"
+
+#if TELEM_CONTACT_SCHEDULE && !TELEM_STORAGE_PRIORITY_LANES
+#error "TELEM_CONTACT_SCHEDULE requiere TELEM_STORAGE_PRIORITY_LANES=1: sin vías, los paquetes de alta prioridad detrás de uno normal esperan a toda la cola de flash"
+#endif
+
+/** @brief Paquetes leídos del buffer por cada sincronización */
+#define TELEM_XMIT_BATCH_SIZE 16
+
+/** @brief Tamaño máximo de una línea JSON */
+#define TELEM_XMIT_JSON_SIZE 256
+
+/** @brief Sin límite de bytes (transmisión continua) */
+#define XMIT_NO_BUDGET UINT32_MAX
 
 static uint32_t s_transmitted_total = 0;
 static bool s_ground_window_open = false;
-static TickType_t s_last_window_tick = 0;
+/** @brief Cursor propio del transmisor (bloqueante: el enlace no pierde paquetes) */
+static telemetry_subscriber_t s_subscriber = TELEM_INVALID_SUBSCRIBER;
+/** @brief Aviso de paquetes nuevos para este suscriptor */
+static telemetry_wake_t s_wake;
+/** @brief Lote en curso (estático para no cargar la pila de la tarea) */
+static telemetry_packet_t s_batch[TELEM_XMIT_BATCH_SIZE];
+
+#if TELEM_DOWNLINK_BINARY
+/** @brief Contador de secuencia CCSDS de cada APID (uno por tipo) */
+static uint16_t s_frame_seq[TELEM_DATA_TYPE_COUNT];
+#if TELEM_DOWNLINK_DELTA
+/** @brief Referencia de cada tipo para la codificación delta del enlace */
+static telemetry_delta_ctx_t s_delta;
+#endif
+#if TELEM_DOWNLINK_ARQ
+/** @brief Ventana de tramas a la espera de acuse */
+static telemetry_arq_tx_t s_arq;
+/** @brief Tarea del transmisor, para despertarla desde la recepción de Serial */
+static TaskHandle_t s_xmit_task = NULL;
+
+/**
+ * @brief Llegaron bytes por la línea de subida (tarea de eventos de la UART)
+ */
+static void uplink_received(void) {
+  if (s_xmit_task) xTaskNotifyGive(s_xmit_task);
+}
+#endif
+#endif
+
+#if TELEM_DOWNLINK_DECIMATION
+/** @brief Fase y descartes del diezmado */
+static telemetry_decimation_t s_decimation;
+#endif
+
+#if TELEM_STATS_DOWNLINK
+/** @brief Muestras sustituidas por los resúmenes por ventana */
+static uint32_t s_replaced_total = 0;
+#endif
+
+#if TELEM_DOWNLINK_RBE
+/** @brief Último paquete enviado de cada tipo y contadores de la bajada por excepción */
+static telemetry_rbe_t s_rbe;
+#endif
+
+#if TELEM_CONTACT_SCHEDULE
+/** @brief Ventana en curso o siguiente */
+static telemetry_contact_window_t s_window;
+static bool s_window_valid = false;
+/** @brief Primer lote ya serializado para la ventana s_window */
+static bool s_preloaded = false;
+/** @brief Pases abiertos desde el arranque */
+static uint32_t s_pass_count = 0;
+/** @brief Presupuesto, bytes y paquetes del pase en curso */
+static uint32_t s_pass_budget = 0;
+static uint32_t s_pass_bytes = 0;
+static uint32_t s_pass_packets = 0;
+
+/**
+ * @brief Carga la tabla de ventanas de LittleFS
+ */
+static void load_contact_table(void) {
+  telemetry_contact_init();
+  File f = LittleFS.open(TELEM_CONTACT_FILE, "r");
+  if(!f) {
+    telemetry_logf("[XMIT] No %s: periodic pass every %u s (%u s long)", TELEM_CONTACT_FILE,
+                   (unsigned)TELEM_CONTACT_PERIOD_S, (unsigned)TELEM_CONTACT_DURATION_S);
+    return;
+  }
+  static char text[1024];
+  uint32_t len = (uint32_t)f.read((uint8_t*)text, sizeof(text));
+  f.close();
+  uint32_t count = telemetry_contact_load(text, len);
+  telemetry_logf("[XMIT] Contact table %s: %lu windows", TELEM_CONTACT_FILE, count);
+}
+#endif
 
 void telemetry_transmission_init(void) {
-  telemetry_logf("[XMIT] Init OK - JSON mode enabled");
-  s_last_window_tick = xTaskGetTickCount();
+  telemetry_txbuf_init(telemetry_txbuf_port_serial());
+  // Con el anillo lleno, la escritora despierta a esta tarea al liberar sitio
+  telemetry_txbuf_attach_producer(telemetry_wake_port_task(), xTaskGetCurrentTaskHandle());
+  // Sin la escritora nada saca el anillo por la UART
+  if(gTaskTxWriterHandle == NULL &&
+     xTaskCreate(vTelemetryTxWriterTask, "TelemTxWriter", TELEM_TXWRITER_STACK, NULL,
+                 uxTaskPriorityGet(NULL) + 1, &gTaskTxWriterHandle) != pdPASS) {
+    gTaskTxWriterHandle = NULL;
+    telemetry_logf("[XMIT] ERROR: no se pudo crear la tarea escritora");
+  }
+  s_subscriber = telemetry_subscribe(TELEM_SUB_BLOCKING);
+  if(s_subscriber == TELEM_INVALID_SUBSCRIBER) {
+    telemetry_logf("[XMIT] ERROR: no quedan suscriptores libres");
+    return;
+  }
+  // Se llama desde la tarea del transmisor: es la que recibirá los avisos
+  telemetry_wake_init(&s_wake, telemetry_wake_port_task(), xTaskGetCurrentTaskHandle(),
+                      TELEM_XMIT_WAKE_MIN_BATCH, TELEM_XMIT_WAKE_MAX_DELAY_MS);
+#if TELEM_WAKE_EVENTS
+  telemetry_set_wake(s_subscriber, &s_wake);
+#endif
+  if(!telemetry_spill_init(telemetry_spill_fs_littlefs())) {
+    telemetry_logf("[XMIT] WARN: cola de desbordamiento en flash no disponible");
+  }
+  telemetry_logf("[XMIT] Init OK - %s mode enabled",
+                 TELEM_DOWNLINK_BINARY ? (TELEM_DOWNLINK_DELTA ? "delta binary frame" : "binary frame") : "JSON");
+#if TELEM_DOWNLINK_BINARY && TELEM_DOWNLINK_DELTA
+  telemetry_delta_init(&s_delta, TELEM_DELTA_KEYFRAME_INTERVAL);
+#endif
+#if TELEM_DOWNLINK_BINARY && TELEM_DOWNLINK_ARQ
+  telemetry_arq_tx_init(&s_arq, TELEM_ARQ_RTO_MS, TELEM_ARQ_MAX_TRIES);
+  s_xmit_task = xTaskGetCurrentTaskHandle();
+  Serial.onReceive(uplink_received);
+  telemetry_logf("[XMIT] ARQ window %u frames, RTO %u ms, %u tries", (unsigned)TELEM_ARQ_WINDOW,
+                 (unsigned)TELEM_ARQ_RTO_MS, (unsigned)TELEM_ARQ_MAX_TRIES);
+#endif
+#if TELEM_DOWNLINK_DECIMATION
+  telemetry_decimation_init(&s_decimation);
+  telemetry_logf("[XMIT] Decimation: every 2^n-th packet of priority <= %u, step %u packets, up to 1/%u",
+                 (unsigned)TELEM_DECIMATION_MAX_PRIORITY, (unsigned)TELEM_DECIMATION_STEP,
+                 (unsigned)(1U << TELEM_DECIMATION_MAX_LEVEL));
+#endif
+#if TELEM_STATS_DOWNLINK
+  telemetry_logf("[XMIT] Stats summaries replace samples with >= %u newer packets pending",
+                 (unsigned)TELEM_STATS_SCARCE_BACKLOG);
+#endif
+#if TELEM_DOWNLINK_RBE
+  if(telemetry_rbe_init(&s_rbe, TELEM_RBE_HEARTBEAT_MS) > 0) {
+    telemetry_logf("[XMIT] WARN: %lu report-by-exception entries do not match a schema field", s_rbe.unresolved);
+  }
+  telemetry_logf("[XMIT] Report-by-exception: heartbeat %u ms", (unsigned)TELEM_RBE_HEARTBEAT_MS);
+#endif
+#if TELEM_CONTACT_SCHEDULE
+  load_contact_table();
+#endif
 }
 
 /**
- * @brief Envía un paquete de telemetría en formato JSON por Serial
+ * @brief Encola un mensaje para la tarea escritora
+ *
+ * @details Si el buffer está lleno, el enlace va por detrás: con wait se
+ * duerme hasta que la escritora libera sitio (telemetry_txbuf_wait_space())
+ * y se reintenta. El paquete sigue sin confirmar en el buffer de
+ * telemetría, así que esperar aquí solo frena al transmisor. Sin wait
+ * (salida retenida antes de AOS) se devuelve false en lugar de esperar.
+ * Los sinks de captura reciben el mismo mensaje sin frenar al enlace.
+ */
+static bool queue_message(const void* data, uint32_t len, bool wait) {
+  if (len > TELEM_TXBUF_MAX_MESSAGE) return false;
+  while (!telemetry_txbuf_write(data, len)) {
+    if (!wait) return false;
+    telemetry_txbuf_wait_space(len, TELEM_TXBUF_PRODUCER_WAIT_MS);
+  }
+  telemetry_sink_publish(TELEM_SINK_CH_DOWNLINK, data, len);
+  return true;
+}
+
+#if TELEM_DOWNLINK_BINARY && TELEM_DOWNLINK_ARQ
+/**
+ * @brief Atiende el ARQ: aplica los acuses recibidos y repite lo que toca
+ *
+ * @param[in,out] budget Bytes que aún se pueden encolar
+ * @param wait Esperar a que haya sitio en el buffer de transmisión
+ *
+ * @details Una repetición que no cabe en el presupuesto o en el buffer se
+ * da igualmente por enviada: vuelve a vencer al cabo de otro plazo.
+ */
+static void arq_service(uint32_t* budget, bool wait) {
+  while (Serial.available() > 0) {
+    telemetry_arq_tx_uplink(&s_arq, (uint8_t)Serial.read(), millis());
+  }
+  const uint8_t* frame;
+  uint16_t len;
+  while ((frame = telemetry_arq_tx_due(&s_arq, millis(), &len)) != NULL) {
+    if (len <= *budget && queue_message(frame, len, wait) && *budget != XMIT_NO_BUDGET) {
+      *budget -= len;
+    }
+  }
+#if TELEM_DOWNLINK_DELTA
+  // Tierra no verá las abandonadas: el siguiente de esos tipos debe ser clave
+  uint32_t abandoned = telemetry_arq_tx_take_abandoned(&s_arq);
+  for (uint32_t t = 0; t < TELEM_DATA_TYPE_COUNT; t++) {
+    if (abandoned & (1UL << t)) telemetry_delta_invalidate(&s_delta, (telem_data_type_t)t);
+  }
+#endif
+}
+
+/**
+ * @brief Duerme hasta que llegue algo por la línea de subida o venza la próxima repetición
+ *
+ * @details uplink_received() despierta a la tarea con cada recepción; el
+ * plazo sale de telemetry_arq_tx_next_due_ms(), así que no se consulta el
+ * ARQ más que cuando algo ha cambiado.
+ */
+static void arq_sleep(void) {
+  if (Serial.available() > 0) return;
+  uint32_t ms = telemetry_arq_tx_next_due_ms(&s_arq, millis());
+  if (ms == 0) return;
+  if (ms > s_arq.rto_max_ms) ms = s_arq.rto_max_ms;
+  TickType_t ticks = pdMS_TO_TICKS(ms);
+  ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1);
+}
+
+/**
+ * @brief Espera a que la ventana ARQ admita una trama nueva
+ *
+ * @return false Si está llena y no se puede esperar
+ */
+static bool arq_wait_window(uint32_t* budget, bool wait) {
+  for (;;) {
+    arq_service(budget, wait);
+    if (telemetry_arq_tx_ready(&s_arq)) return true;
+    if (!wait) return false;
+    arq_sleep();
+  }
+}
+
+/**
+ * @brief Atiende el ARQ hasta que no quedan tramas sin confirmar
+ *
+ * @details Termina siempre: cada trama acaba confirmada o abandonada tras
+ * TELEM_ARQ_MAX_TRIES envíos.
+ */
+static void arq_settle(uint32_t* budget) {
+  for (;;) {
+    arq_service(budget, true);
+    if (telemetry_arq_tx_in_flight(&s_arq) == 0) return;
+    arq_sleep();
+  }
+}
+#endif
+
+/**
+ * @brief Serializa un paquete de telemetría y lo encola para Serial
  * @param packet Paquete de telemetría a enviar
+ * @param[in,out] budget Bytes que aún se pueden encolar; se descuenta lo encolado
+ * @param wait Esperar a que haya sitio en el buffer de transmisión
+ * @return true Si se ha encolado; false si no cabe en el presupuesto o en
+ * el buffer (el paquete debe quedar sin confirmar)
+ *
+ * @details En JSON las claves y el formato de cada campo salen de
+ * telemetry_schema.h; en binario se envía la trama de telemetry_frame.h.
+ * Los paquetes que no se pueden serializar se dan por enviados.
  */
-static void send_json_packet(const telemetry_packet_t* packet) {
-  if (!packet) return;
-  
-  switch(packet->header.type) {
-    case TELEM_SYSTEM_STATUS: {
-      const system_status_telem_t* sys = &packet->system;
-      Serial.print("{\"type\":\"system\",\"cpuUsage\":");
-      Serial.print(sys->cpu_usage);
-      Serial.print(",\"memoryFree\":");
-      Serial.print(sys->heap_free);
-      Serial.print(",\"uptime\":");
-      Serial.print(sys->uptime_seconds);
-      Serial.print(",\"taskCount\":");
-      Serial.print(sys->task_count);
-      Serial.print(",\"cpuTemp\":");
-      Serial.print(sys->cpu_temperature, 1);
-      Serial.println("}");
-      break;
+static bool send_packet(const telemetry_packet_t* packet, uint32_t* budget, bool wait) {
+  if (!packet) return true;
+
+#if TELEM_DOWNLINK_BINARY
+  if ((uint32_t)packet->header.type >= TELEM_DATA_TYPE_COUNT) return true;
+  uint8_t frame[TELEM_FRAME_MAX_BYTES];
+#if TELEM_DOWNLINK_ARQ
+  if (!arq_wait_window(budget, wait)) return false;
+#if TELEM_DOWNLINK_DELTA
+  telemetry_delta_ctx_t* delta = &s_delta;
+#else
+  telemetry_delta_ctx_t* delta = NULL;
+#endif
+  size_t len = telemetry_frame_encode_link(delta, packet, s_frame_seq[packet->header.type],
+                                           telemetry_arq_tx_next_seq(&s_arq), frame, sizeof(frame));
+#elif TELEM_DOWNLINK_DELTA
+  size_t len = telemetry_frame_encode_delta(&s_delta, packet, s_frame_seq[packet->header.type], frame, sizeof(frame));
+#else
+  size_t len = telemetry_frame_encode(packet, s_frame_seq[packet->header.type], frame, sizeof(frame));
+#endif
+  if (len == 0) return true;
+  if (len > *budget || !queue_message(frame, len, wait)) {
+#if TELEM_DOWNLINK_DELTA
+    // El codificador ya tomó este paquete como referencia y tierra no lo
+    // verá: el siguiente de su tipo debe ser clave
+    telemetry_delta_invalidate(&s_delta, packet->header.type);
+#endif
+    return false;
+  }
+  s_frame_seq[packet->header.type]++;
+#if TELEM_DOWNLINK_ARQ
+  telemetry_arq_tx_store(&s_arq, frame, (uint16_t)len, (uint8_t)packet->header.type, millis());
+#endif
+#else
+  char json[TELEM_XMIT_JSON_SIZE + 2];
+  size_t len = telemetry_schema_format_json(packet, json, TELEM_XMIT_JSON_SIZE);
+  if (len == 0) return true;
+  json[len++] = '\r'; // Como Serial.println()
+  json[len++] = '\n';
+  if (len > *budget || !queue_message(json, len, wait)) return false;
+#endif
+  if (*budget != XMIT_NO_BUDGET) *budget -= len;
+  return true;
+}
+
+/**
+ * @brief Registra la espera de un lote hasta su lectura por el transmisor
+ *
+ * @return uint32_t Instante de la lectura (referencia de TELEM_LATENCY_TRANSMIT)
+ */
+static uint32_t trace_dequeue(const telemetry_packet_t* packets, uint32_t count) {
+  uint32_t now_us = telemetry_latency_now();
+  for(uint32_t i = 0; i < count; i++) {
+    if(packets[i].header.enqueued_us == 0) continue; // Sin sello (registro delta de flash)
+    telemetry_latency_record(TELEM_LATENCY_TRANSMIT_QUEUE, packets[i].header.type,
+                             now_us - packets[i].header.enqueued_us);
+  }
+  return now_us;
+}
+
+/**
+ * @brief Registra el fin del envío de un paquete
+ *
+ * @details Termina al dejar el mensaje en el buffer de transmisión: la
+ * espera hasta la UART depende solo del enlace (ver las estadísticas de
+ * telemetry_txbuf_get_stats()).
+ */
+static void trace_transmitted(const telemetry_packet_t* packet, uint32_t dequeued_us) {
+  uint32_t now_us = telemetry_latency_now();
+  telemetry_latency_record(TELEM_LATENCY_TRANSMIT, packet->header.type, now_us - dequeued_us);
+  if(packet->header.acquired_us != 0) {
+    telemetry_latency_record(TELEM_LATENCY_END_TO_END, packet->header.type, now_us - packet->header.acquired_us);
+  }
+}
+
+#if TELEM_DOWNLINK_DECIMATION || TELEM_STATS_DOWNLINK
+/**
+ * @brief Paquetes pendientes de bajar: los de RAM y los de la cola de flash
+ *
+ * @details Incluye el lote leído, que sigue sin confirmar. Los de flash se
+ * cuentan desde el arranque: tras un reinicio el retraso anterior no suma.
+ */
+static uint32_t backlog_packets(void) {
+  uint32_t spilled, replayed, discarded, segments;
+  telemetry_spill_get_stats(&spilled, &replayed, &discarded, &segments);
+  uint32_t flash = (spilled > replayed) ? spilled - replayed : 0;
+  return telemetry_available_packets_for(s_subscriber) + flash;
+}
+#endif
+
+/**
+ * @brief Envía un lote leído y devuelve cuántos paquetes han salido
+ *
+ * @details Se detiene en el primero que no cabe: lo enviado es siempre un
+ * prefijo del lote, que es lo que admiten los commit de la cola. Los
+ * paquetes que descarta el diezmado, que sustituyen los resúmenes o que
+ * suprime la bajada por excepción cuentan como salidos.
+ */
+static uint32_t send_batch(uint32_t count, uint32_t* budget, bool wait) {
+  uint32_t dequeued_us = trace_dequeue(s_batch, count);
+#if TELEM_DOWNLINK_DECIMATION || TELEM_STATS_DOWNLINK
+  uint32_t backlog = backlog_packets();
+#endif
+  for(uint32_t i = 0; i < count; i++) {
+#if TELEM_DOWNLINK_DECIMATION || TELEM_STATS_DOWNLINK
+    uint32_t newer = (backlog > i + 1) ? backlog - i - 1 : 0;
+#endif
+#if TELEM_STATS_DOWNLINK
+    if(telemetry_stats_replaces(&s_batch[i].header, newer)) {
+      s_replaced_total++;
+      continue;
+    }
+#endif
+#if TELEM_DOWNLINK_DECIMATION
+    if(!telemetry_decimation_keep(&s_decimation, &s_batch[i].header, newer)) {
+      continue;
+    }
+#endif
+#if TELEM_DOWNLINK_RBE
+    if(!telemetry_rbe_prepare(&s_rbe, &s_batch[i])) {
+      continue;
+    }
+#endif
+    if(!send_packet(&s_batch[i], budget, wait)) {
+      return i;
     }
-    
-    case TELEM_POWER_DATA: {
-      const power_telem_t* pwr = &packet->power;
-      Serial.print("{\"type\":\"power\",\"voltage\":");
-      Serial.print(pwr->battery_voltage, 2);
-      Serial.print(",\"current\":");
-      Serial.print(pwr->battery_current, 3);
-      Serial.print(",\"solarVoltage\":");
-      Serial.print(pwr->solar_panel_voltage, 2);
-      Serial.print(",\"solarCurrent\":");
-      Serial.print(pwr->solar_panel_current, 3);
-      Serial.print(",\"batteryLevel\":");
-      Serial.print(pwr->battery_level);
-      Serial.print(",\"batteryTemp\":");
-      Serial.print(pwr->battery_temperature);
-      Serial.println("}");
-      break;
+#if TELEM_DOWNLINK_RBE
+    telemetry_rbe_sent(&s_rbe, &s_batch[i]);
+#endif
+    s_transmitted_total++;
+    trace_transmitted(&s_batch[i], dequeued_us);
+  }
+  return count;
+}
+
+#if TELEM_DOWNLINK_RBE
+static void log_rbe_totals(void) {
+  telemetry_rbe_counts_t total;
+  telemetry_rbe_totals(&s_rbe, &total);
+  telemetry_logf("[XMIT] Report-by-exception since boot: %lu sent, %lu suppressed, %lu heartbeats, %lu/%lu fields held",
+                 total.sent, total.suppressed, total.heartbeats, total.held, total.held + total.changed);
+}
+#endif
+
+/**
+ * @brief Baja la cola pendiente (flash y RAM) hasta vaciarla o agotar el presupuesto
+ *
+ * @param[in,out] budget Bytes disponibles (XMIT_NO_BUDGET = sin límite)
+ * @param wait Esperar a la escritora cuando el buffer de transmisión está lleno
+ * @return uint32_t Paquetes confirmados (enviados o descartados por el diezmado)
+ *
+ * @details El orden es de antigüedad: primero lo volcado a flash, que es
+ * anterior a todo lo que sigue en RAM. Con presupuesto (solo con
+ * TELEM_CONTACT_SCHEDULE, que exige TELEM_STORAGE_PRIORITY_LANES) los
+ * paquetes TELEM_PRIORITY_HIGH de la RAM salen antes que la cola de flash:
+ * el cursor del transmisor está en TELEM_LANE_STRICT, así que la vía alta
+ * encabeza cada peek y se envía entera antes de pasar a flash.
+ */
+static uint32_t drain_backlog(uint32_t* budget, bool wait) {
+  uint32_t sent = 0;
+  uint32_t count;
+
+  if(*budget != XMIT_NO_BUDGET) {
+    while((count = telemetry_peek_batch(s_subscriber, s_batch, TELEM_XMIT_BATCH_SIZE)) > 0) {
+      uint32_t high = 0;
+      while(high < count && s_batch[high].header.priority >= TELEM_PRIORITY_HIGH) high++;
+      uint32_t n = (high > 0) ? send_batch(high, budget, wait) : 0;
+      telemetry_commit_batch(s_subscriber, n);
+      sent += n;
+      if(n < count) break;
     }
-    
-    case TELEM_TEMPERATURE_DATA: {
-      const temperature_telem_t* temp = &packet->temperature;
-      Serial.print("{\"type\":\"temperature\",\"obcTemp\":");
-      Serial.print(temp->obc_temperature / 10.0, 1);
-      Serial.print(",\"commsTemp\":");
-      Serial.print(temp->comms_temperature / 10.0, 1);
-      Serial.print(",\"payloadTemp\":");
-      Serial.print(temp->payload_temperature / 10.0, 1);
-      Serial.print(",\"batteryTemp\":");
-      Serial.print(temp->battery_temperature / 10.0, 1);
-      Serial.print(",\"externalTemp\":");
-      Serial.print(temp->external_temperature / 10.0, 1);
-      Serial.println("}");
-      break;
+  }
+
+  while((count = telemetry_spill_peek(s_batch, TELEM_XMIT_BATCH_SIZE)) > 0) {
+    uint32_t n = send_batch(count, budget, wait);
+    if(n > 0) {
+      telemetry_spill_commit(n);
     }
-    
-    case TELEM_COMMUNICATION_STATUS: {
-      const subsystem_status_telem_t* sub = &packet->subsystems;
-      // Simulamos valores de RSSI y SNR basados en el estado de comms
-      int rssi = -50 - (sub->comms_status * 5);
-      int snr = 15 - (sub->comms_status * 2);
-      Serial.print("{\"type\":\"comms\",\"rssi\":");
-      Serial.print(rssi);
-      Serial.print(",\"snr\":");
-      Serial.print(snr);
-      Serial.print(",\"commsUptime\":");
-      Serial.print(sub->comms_uptime);
-      Serial.print(",\"successRate\":");
-      Serial.print(sub->command_success_rate);
-      Serial.println("}");
-      break;
+    sent += n;
+    if(n < count) {
+      return sent;
     }
+    // Mientras se reenvía, la RAM sigue llenándose
+    telemetry_spill_offload(s_subscriber);
   }
+
+  // Un lote por sincronización; se confirma lo que ha salido entero
+  while((count = telemetry_peek_batch(s_subscriber, s_batch, TELEM_XMIT_BATCH_SIZE)) > 0) {
+    uint32_t n = send_batch(count, budget, wait);
+    telemetry_commit_batch(s_subscriber, n);
+    sent += n;
+    if(n < count) break;
+  }
+  return sent;
+}
+
+#if TELEM_CONTACT_SCHEDULE
+/**
+ * @brief Bytes que aún se pueden encolar en la ventana
+ *
+ * @details Lo que el enlace saca hasta LOS menos lo que ya espera en el
+ * buffer de transmisión: con el enlace lleno, encolar exactamente esto
+ * termina de salir justo antes de LOS - TELEM_CONTACT_GUARD_MS.
+ */
+static uint32_t pass_budget(uint32_t now_ms) {
+  telemetry_txbuf_stats_t st;
+  telemetry_txbuf_get_stats(&st);
+  uint32_t link = telemetry_contact_budget(&s_window, now_ms);
+  return (link > st.pending) ? link - st.pending : 0;
+}
+
+/**
+ * @brief Serializa el primer lote con la salida retenida
+ *
+ * @details Llena el buffer de transmisión sin esperar a la escritora (está
+ * retenida): lo que no cabe se envía ya con la ventana abierta.
+ */
+static void preload_window(uint32_t now_ms) {
+  telemetry_txbuf_hold(true);
+  uint32_t budget = pass_budget(now_ms);
+  uint32_t before = budget;
+  uint32_t sent_before = s_transmitted_total;
+  drain_backlog(&budget, false);
+  s_pass_bytes = before - budget;
+  s_pass_packets = s_transmitted_total - sent_before;
+  s_preloaded = true;
 }
 
 static void open_window(void) {
   s_ground_window_open = true;
-  telemetry_logf("\n🎯 GROUND STATION CONTACT WINDOW OPEN!");
+  s_pass_count++;
+  s_pass_budget = telemetry_contact_budget(&s_window, s_window.aos_ms);
+  telemetry_logf("\n🎯 GROUND STATION CONTACT WINDOW OPEN! Pass #%lu, %lu s, budget %lu B (%lu B pre-serialized)",
+                 s_pass_count, (s_window.los_ms - s_window.aos_ms) / 1000, s_pass_budget, s_pass_bytes);
+  telemetry_txbuf_hold(false);
+}
+
+static void close_window(void) {
+  s_ground_window_open = false;
+  uint32_t pct_x100 = s_pass_budget ? (uint32_t)((uint64_t)s_pass_bytes * 10000 / s_pass_budget) : 0;
+  telemetry_logf("📡 LOS pass #%lu: %lu packets, %lu / %lu B (%lu.%02lu%% of budget)", s_pass_count,
+                 s_pass_packets, s_pass_bytes, s_pass_budget, pct_x100 / 100, pct_x100 % 100);
+#if TELEM_DOWNLINK_DECIMATION
+  telemetry_logf("[XMIT] Decimated since boot: %lu packets", s_decimation.dropped_total);
+#endif
+#if TELEM_STATS_DOWNLINK
+  telemetry_logf("[XMIT] Replaced by summaries since boot: %lu packets", s_replaced_total);
+#endif
+#if TELEM_DOWNLINK_RBE
+  log_rbe_totals();
+#endif
+}
+
+/**
+ * @brief Ciclo con ventanas: espera a AOS, baja hasta agotar el presupuesto y cierra en LOS
+ */
+static void pass_cycle(void) {
+  uint32_t now_ms = millis();
+  if(s_window_valid && (int32_t)(now_ms - s_window.los_ms) >= 0) {
+    if(s_ground_window_open) {
+      close_window();
+    }
+    s_window_valid = false;
+  }
+  if(!s_window_valid) {
+    s_window_valid = telemetry_contact_next(now_ms, &s_window);
+    s_preloaded = false;
+    s_pass_bytes = 0;
+    s_pass_packets = 0;
+    if(!s_window_valid) {
+      return; // Tabla agotada: se guarda todo hasta cargar otra
+    }
+    if((int32_t)(s_window.aos_ms - now_ms) > 0) {
+      telemetry_logf("[XMIT] Next pass in %lu s (%lu s at %lu bps)", (s_window.aos_ms - now_ms) / 1000,
+                     (s_window.los_ms - s_window.aos_ms) / 1000, s_window.rate_bps);
+    }
+  }
+
+  if(!s_ground_window_open) {
+    int32_t to_aos = (int32_t)(s_window.aos_ms - now_ms);
+    if(to_aos > TELEM_CONTACT_LEAD_MS) {
+      return; // Fuera de ventana: los paquetes esperan en RAM y flash
+    }
+    if(!s_preloaded) {
+      preload_window(now_ms);
+    }
+    if(to_aos > 0) {
+      vTaskDelay(pdMS_TO_TICKS(to_aos));
+    }
+    open_window();
+  }
+
+  uint32_t budget = pass_budget(millis());
+  uint32_t before = budget;
+  uint32_t sent_before = s_transmitted_total;
+  drain_backlog(&budget, true);
+  s_pass_packets += s_transmitted_total - sent_before;
+#if TELEM_DOWNLINK_BINARY && TELEM_DOWNLINK_ARQ
+  arq_settle(&budget);
+#endif
+  s_pass_bytes += before - budget;
 }
+#endif
 
 void telemetry_transmission_cycle(void) {
-  // NUEVO: Transmitir continuamente sin esperar ventanas de contacto (para desarrollo)
-  uint32_t available = telemetry_available_packets();
-  
-  if(available == 0) {
-    return; // Nada que hacer
+  // Lo que se publique desde aquí despierta al transmisor tras el ciclo
+  telemetry_wake_begin(&s_wake);
+
+  // El retraso que no cabe holgadamente en RAM pasa a flash (los más antiguos)
+  uint32_t spilled = telemetry_spill_offload(s_subscriber);
+  if(spilled > 0) {
+    telemetry_logf("💾 Spilled %lu packets to flash", spilled);
   }
 
-  telemetry_logf("📤 TRANSMITTING %lu packets...", available);
-  telemetry_packet_t packet;
-  static uint32_t s_transmitted_total = 0;
+#if TELEM_CONTACT_SCHEDULE
+  pass_cycle();
+#else
+  // Transmisión continua sin esperar ventanas de contacto (para desarrollo)
+  bool spill_pending = telemetry_spill_pending();
+  uint32_t available = telemetry_available_packets_for(s_subscriber);
   
-  while(telemetry_retrieve_packet(&packet)) {
-    s_transmitted_total++;
-    
-    // Enviar en formato JSON para Fomalhaut
-    send_json_packet(&packet);
-    
-    vTaskDelay(pdMS_TO_TICKS(50));
+  if(available == 0 && !spill_pending) {
+    return; // Nada que hacer
   }
+
+  telemetry_logf("📤 TRANSMITTING %lu packets%s...", available, spill_pending ? " + flash backlog" : "");
+  uint32_t budget = XMIT_NO_BUDGET;
+  drain_backlog(&budget, true);
+#if TELEM_DOWNLINK_BINARY && TELEM_DOWNLINK_ARQ
+  arq_settle(&budget);
+  telemetry_logf("[XMIT] ARQ: %lu frames, %lu retransmitted, %lu acked, %lu abandoned", s_arq.frames_sent,
+                 s_arq.retransmissions, s_arq.frames_acked, s_arq.frames_abandoned);
+#endif
+#if TELEM_DOWNLINK_DECIMATION
+  telemetry_logf("[XMIT] Decimated since boot: %lu packets", s_decimation.dropped_total);
+#endif
+#if TELEM_STATS_DOWNLINK
+  telemetry_logf("[XMIT] Replaced by summaries since boot: %lu packets", s_replaced_total);
+#endif
+#if TELEM_DOWNLINK_RBE
+  log_rbe_totals();
+#endif
   telemetry_logf("✅ Transmission complete. Total sent: %lu packets", s_transmitted_total);
+#endif
+}
+
+void telemetry_transmission_wait(void) {
+#if TELEM_WAKE_EVENTS
+  telemetry_wake_wait(&s_wake);
+#else
+  vTaskDelay(pdMS_TO_TICKS(TELEM_XMIT_WAKE_MAX_DELAY_MS));
+#endif
+}
+
+const telemetry_wake_t* telemetry_transmission_get_wake(void) {
+  return &s_wake;
+}
+
+const telemetry_rbe_t* telemetry_transmission_get_rbe(void) {
+#if TELEM_DOWNLINK_RBE
+  return &s_rbe;
+#else
+  return NULL;
+#endif
 }
@@ -0,0 +1,256 @@
+/**
+ * @file telemetry_txbuf.cpp
+ * @brief Implementación del anillo de bytes de transmisión
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * s_head y s_tail son contadores libres (crecen sin límite y se reducen con
+ * la máscara al indexar): head - tail es siempre la ocupación, sin el hueco
+ * de un byte de los anillos clásicos. Junto a los bytes se guarda en
+ * s_ends el final de cada mensaje, para que la escritora sepa dónde puede
+ * cortar: cada llamada a la salida lleva solo mensajes completos.
+ *
+ * El aviso a la escritora sigue el esquema de telemetry_wake.cpp: ella
+ * arma s_writer_armed antes de volver a mirar el anillo y dormirse, y el
+ * productor lo desarma tras publicar el mensaje. Las dos operaciones
+ * cruzadas son secuencialmente consistentes, así que o la escritora ve el
+ * mensaje o el productor ve el aviso armado. El aviso al productor con el
+ * anillo lleno es el simétrico: lo arma el productor y lo desarma la
+ * escritora tras liberar sitio.
+ */
+
+  #include <string.h>
+  #include "../include/telemetry_txbuf.h"
+
+#if (TELEM_TXBUF_BYTES & (TELEM_TXBUF_BYTES - 1)) != 0
+#error "TELEM_TXBUF_BYTES debe ser potencia de dos"
+#endif
+#if (TELEM_TXBUF_MESSAGES & (TELEM_TXBUF_MESSAGES - 1)) != 0
+#error "TELEM_TXBUF_MESSAGES debe ser potencia de dos"
+#endif
+
+#define TXBUF_MASK (TELEM_TXBUF_BYTES - 1)
+#define TXBUF_MSG_MASK (TELEM_TXBUF_MESSAGES - 1)
+
+static uint8_t s_ring[TELEM_TXBUF_BYTES];
+/** @brief Final (en contador libre de bytes) de cada mensaje encolado */
+static uint32_t s_ends[TELEM_TXBUF_MESSAGES];
+/** @brief Bytes y mensajes encolados (solo los escribe el productor) */
+static uint32_t s_head = 0;
+static uint32_t s_msg_head = 0;
+/** @brief Bytes entregados y mensajes terminados (solo los escribe la escritora) */
+static uint32_t s_tail = 0;
+static uint32_t s_msg_tail = 0;
+/** @brief Copia lineal de un mensaje partido por el final del anillo */
+static uint8_t s_scratch[TELEM_TXBUF_MAX_MESSAGE];
+static const telemetry_txbuf_port_t* s_port = NULL;
+/** @brief Salida retenida (ver telemetry_txbuf_hold()) */
+static bool s_hold = false;
+
+/** @brief Aviso de la escritora (ver telemetry_txbuf_attach_writer()) */
+static const telemetry_wake_port_t* s_writer_port = NULL;
+static void* s_writer_ctx = NULL;
+static uint32_t s_writer_armed = 0;
+/** @brief Aviso del productor (ver telemetry_txbuf_attach_producer()) */
+static const telemetry_wake_port_t* s_producer_port = NULL;
+static void* s_producer_ctx = NULL;
+static uint32_t s_producer_armed = 0;
+
+static uint32_t s_writes = 0;
+static uint32_t s_producer_full = 0;
+static uint32_t s_high_water = 0;
+
+void telemetry_txbuf_init(const telemetry_txbuf_port_t* port) {
+  s_head = 0;
+  s_msg_head = 0;
+  s_tail = 0;
+  s_msg_tail = 0;
+  s_writes = 0;
+  s_producer_full = 0;
+  s_high_water = 0;
+  s_hold = false;
+  __atomic_store_n(&s_port, port, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Despierta a la escritora si duerme esperando datos
+ */
+static void wake_writer(void) {
+  if(__atomic_exchange_n(&s_writer_armed, 0, __ATOMIC_SEQ_CST)) {
+    s_writer_port->notify(s_writer_ctx);
+  }
+}
+
+void telemetry_txbuf_attach_writer(const telemetry_wake_port_t* port, void* ctx) {
+  s_writer_ctx = ctx;
+  __atomic_store_n(&s_writer_port, port, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Hay mensajes que la escritora puede sacar ya
+ */
+static bool writer_has_work(void) {
+  return __atomic_load_n(&s_msg_head, __ATOMIC_SEQ_CST) != __atomic_load_n(&s_msg_tail, __ATOMIC_RELAXED) &&
+         !__atomic_load_n(&s_hold, __ATOMIC_SEQ_CST);
+}
+
+bool telemetry_txbuf_wait_data(uint32_t timeout_ms) {
+  const telemetry_wake_port_t* port = __atomic_load_n(&s_writer_port, __ATOMIC_ACQUIRE);
+  if(!port) {
+    return writer_has_work();
+  }
+  __atomic_store_n(&s_writer_armed, 1, __ATOMIC_SEQ_CST);
+  if(writer_has_work()) {
+    __atomic_store_n(&s_writer_armed, 0, __ATOMIC_RELAXED);
+    return true;
+  }
+  port->wait(s_writer_ctx, timeout_ms);
+  __atomic_store_n(&s_writer_armed, 0, __ATOMIC_RELAXED);
+  return writer_has_work();
+}
+
+void telemetry_txbuf_attach_producer(const telemetry_wake_port_t* port, void* ctx) {
+  s_producer_ctx = ctx;
+  __atomic_store_n(&s_producer_port, port, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Cabe ya un mensaje de len bytes
+ */
+static bool producer_fits(uint32_t len) {
+  uint32_t head = __atomic_load_n(&s_head, __ATOMIC_RELAXED);
+  uint32_t tail = __atomic_load_n(&s_tail, __ATOMIC_SEQ_CST);
+  uint32_t msg_head = __atomic_load_n(&s_msg_head, __ATOMIC_RELAXED);
+  uint32_t msg_tail = __atomic_load_n(&s_msg_tail, __ATOMIC_SEQ_CST);
+  return len <= TELEM_TXBUF_BYTES - (head - tail) && msg_head - msg_tail < TELEM_TXBUF_MESSAGES;
+}
+
+bool telemetry_txbuf_wait_space(uint32_t len, uint32_t timeout_ms) {
+  const telemetry_wake_port_t* port = __atomic_load_n(&s_producer_port, __ATOMIC_ACQUIRE);
+  if(!port) {
+    return producer_fits(len);
+  }
+  __atomic_store_n(&s_producer_armed, 1, __ATOMIC_SEQ_CST);
+  if(producer_fits(len)) {
+    __atomic_store_n(&s_producer_armed, 0, __ATOMIC_RELAXED);
+    return true;
+  }
+  port->wait(s_producer_ctx, timeout_ms);
+  __atomic_store_n(&s_producer_armed, 0, __ATOMIC_RELAXED);
+  return producer_fits(len);
+}
+
+uint32_t telemetry_txbuf_free(void) {
+  uint32_t head = __atomic_load_n(&s_head, __ATOMIC_RELAXED);
+  uint32_t tail = __atomic_load_n(&s_tail, __ATOMIC_ACQUIRE);
+  return TELEM_TXBUF_BYTES - (head - tail);
+}
+
+bool telemetry_txbuf_write(const void* data, uint32_t len) {
+  if(len == 0 || len > TELEM_TXBUF_MAX_MESSAGE) {
+    return false;
+  }
+  uint32_t head = __atomic_load_n(&s_head, __ATOMIC_RELAXED);
+  uint32_t tail = __atomic_load_n(&s_tail, __ATOMIC_ACQUIRE);
+  uint32_t msg_head = __atomic_load_n(&s_msg_head, __ATOMIC_RELAXED);
+  uint32_t msg_tail = __atomic_load_n(&s_msg_tail, __ATOMIC_ACQUIRE);
+  if(len > TELEM_TXBUF_BYTES - (head - tail) || msg_head - msg_tail >= TELEM_TXBUF_MESSAGES) {
+    __atomic_fetch_add(&s_producer_full, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+
+  // Como mucho dos copias: hasta el final del anillo y desde el principio
+  uint32_t pos = head & TXBUF_MASK;
+  uint32_t first = TELEM_TXBUF_BYTES - pos;
+  if(first > len) first = len;
+  memcpy(&s_ring[pos], data, first);
+  memcpy(s_ring, (const uint8_t*)data + first, len - first);
+  s_ends[msg_head & TXBUF_MSG_MASK] = head + len;
+  __atomic_store_n(&s_head, head + len, __ATOMIC_RELEASE);
+  __atomic_store_n(&s_msg_head, msg_head + 1, __ATOMIC_SEQ_CST);
+  wake_writer();
+
+  uint32_t used = head + len - tail;
+  if(used > __atomic_load_n(&s_high_water, __ATOMIC_RELAXED)) {
+    __atomic_store_n(&s_high_water, used, __ATOMIC_RELAXED);
+  }
+  return true;
+}
+
+uint32_t telemetry_txbuf_drain(void) {
+  const telemetry_txbuf_port_t* port = __atomic_load_n(&s_port, __ATOMIC_ACQUIRE);
+  if(!port || __atomic_load_n(&s_hold, __ATOMIC_ACQUIRE)) {
+    return 0;
+  }
+  uint32_t tail = s_tail;
+  uint32_t msg_tail = s_msg_tail;
+  uint32_t msg_head = __atomic_load_n(&s_msg_head, __ATOMIC_ACQUIRE);
+  if(msg_tail == msg_head) {
+    return 0;
+  }
+
+  // Primer mensaje siempre; los siguientes mientras quepan en la UART sin
+  // esperar y sigan contiguos en el anillo
+  uint32_t room = port->writable();
+  uint32_t pos = tail & TXBUF_MASK;
+  uint32_t contiguous = TELEM_TXBUF_BYTES - pos;
+  uint32_t end = s_ends[msg_tail & TXBUF_MSG_MASK];
+  const uint8_t* chunk = &s_ring[pos];
+  if(end - tail > contiguous) {
+    // Mensaje partido por el final del anillo: se reúne para enviarlo de una vez
+    memcpy(s_scratch, chunk, contiguous);
+    memcpy(s_scratch + contiguous, s_ring, end - tail - contiguous);
+    chunk = s_scratch;
+  } else {
+    for(uint32_t m = msg_tail + 1; m != msg_head; m++) {
+      uint32_t next = s_ends[m & TXBUF_MSG_MASK];
+      if(next - tail > room || next - tail > contiguous) break;
+      end = next;
+    }
+  }
+
+  uint32_t len = end - tail;
+  uint32_t written = port->write(chunk, len);
+  if(written > len) written = len;
+  s_writes++;
+
+  // Mensajes terminados (una escritura parcial deja el último a medias)
+  tail += written;
+  while(msg_tail != msg_head && (int32_t)(s_ends[msg_tail & TXBUF_MSG_MASK] - tail) <= 0) {
+    msg_tail++;
+  }
+  __atomic_store_n(&s_tail, tail, __ATOMIC_SEQ_CST);
+  __atomic_store_n(&s_msg_tail, msg_tail, __ATOMIC_SEQ_CST);
+  if(__atomic_exchange_n(&s_producer_armed, 0, __ATOMIC_SEQ_CST)) {
+    s_producer_port->notify(s_producer_ctx);
+  }
+  return written;
+}
+
+void telemetry_txbuf_hold(bool hold) {
+  __atomic_store_n(&s_hold, hold, __ATOMIC_SEQ_CST);
+  if(!hold) {
+    wake_writer();
+  }
+}
+
+void telemetry_txbuf_get_stats(telemetry_txbuf_stats_t* stats) {
+  uint32_t tail = __atomic_load_n(&s_tail, __ATOMIC_ACQUIRE);
+  uint32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+  stats->bytes_queued = head;
+  stats->bytes_written = tail;
+  stats->writes = __atomic_load_n(&s_writes, __ATOMIC_RELAXED);
+  stats->producer_full = __atomic_load_n(&s_producer_full, __ATOMIC_RELAXED);
+  stats->high_water = __atomic_load_n(&s_high_water, __ATOMIC_RELAXED);
+  stats->pending = head - tail;
+}
+
+uint32_t telemetry_txbuf_utilization_x100(uint32_t bytes, uint32_t elapsed_ms, uint32_t baud) {
+  if(elapsed_ms == 0 || baud == 0) {
+    return 0;
+  }
+  // bits enviados / bits posibles · 10000
+  uint64_t sent_bits = (uint64_t)bytes * TELEM_TXBUF_BITS_PER_BYTE * 1000 * 10000;
+  return (uint32_t)(sent_bits / ((uint64_t)baud * elapsed_ms));
+}
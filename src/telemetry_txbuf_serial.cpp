@@ -0,0 +1,33 @@
+/**
+ * @file telemetry_txbuf_serial.cpp
+ * @brief Backend Serial del buffer de transmisión
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * Implementa telemetry_txbuf_port_t sobre Serial. availableForWrite()
+ * devuelve el hueco de la FIFO de la UART (más el buffer de transmisión del
+ * driver, si se configuró con setTxBufferSize()), así que escribir como mucho
+ * esa cantidad nunca bloquea a la tarea escritora.
+ */
+
+#include <Arduino.h>
+#include "../include/telemetry_txbuf.h"
+
+static uint32_t serial_writable(void) {
+  int room = Serial.availableForWrite();
+  return (room > 0) ? (uint32_t)room : 0;
+}
+
+static uint32_t serial_write(const uint8_t* data, uint32_t len) {
+  return (uint32_t)Serial.write(data, len);
+}
+
+static const telemetry_txbuf_port_t s_serial_port = {
+  serial_writable,
+  serial_write,
+};
+
+const telemetry_txbuf_port_t* telemetry_txbuf_port_serial(void) {
+  return &s_serial_port;
+}
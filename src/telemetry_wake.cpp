@@ -0,0 +1,67 @@
+/**
+ * @file telemetry_wake.cpp
+ * @brief Implementación de los avisos de datos nuevos
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * El productor suma a published y después mira armed; el consumidor pone
+ * armed y después mira published. Con las dos secuencias en orden total
+ * (seq_cst) al menos uno ve lo que hizo el otro: o el productor encuentra
+ * el aviso armado y notifica, o el consumidor ve los paquetes y no se
+ * duerme. Si los dos se cruzan, la notificación queda pendiente y solo
+ * provoca una pasada de más.
+ */
+
+  #include <string.h>
+  #include "../include/telemetry_wake.h"
+
+void telemetry_wake_init(telemetry_wake_t* wake, const telemetry_wake_port_t* port, void* ctx,
+                         uint32_t min_batch, uint32_t max_delay_ms) {
+  memset(wake, 0, sizeof(*wake));
+  wake->port = port;
+  wake->ctx = ctx;
+  wake->min_batch = min_batch ? min_batch : 1;
+  wake->max_delay_ms = max_delay_ms;
+}
+
+/**
+ * @brief Paquetes publicados desde telemetry_wake_begin()
+ */
+static inline uint32_t fresh_packets(const telemetry_wake_t* wake) {
+  return __atomic_load_n(&wake->published, __ATOMIC_SEQ_CST) - __atomic_load_n(&wake->seen, __ATOMIC_ACQUIRE);
+}
+
+void telemetry_wake_signal(telemetry_wake_t* wake, uint32_t count) {
+  if(count == 0) {
+    return;
+  }
+  uint32_t published = __atomic_add_fetch(&wake->published, count, __ATOMIC_SEQ_CST);
+  __atomic_add_fetch(&wake->signals, 1, __ATOMIC_RELAXED);
+  if(published - __atomic_load_n(&wake->seen, __ATOMIC_ACQUIRE) < wake->min_batch) {
+    return; // Lote incompleto: ya despertará otra publicación o max_delay_ms
+  }
+  // Solo quien lo encuentra armado avisa: el resto de la ráfaga no cuesta nada
+  if(__atomic_exchange_n(&wake->armed, 0, __ATOMIC_SEQ_CST)) {
+    __atomic_add_fetch(&wake->notifies, 1, __ATOMIC_RELAXED);
+    wake->port->notify(wake->ctx);
+  }
+}
+
+void telemetry_wake_begin(telemetry_wake_t* wake) {
+  __atomic_store_n(&wake->seen, __atomic_load_n(&wake->published, __ATOMIC_SEQ_CST), __ATOMIC_RELEASE);
+}
+
+bool telemetry_wake_wait(telemetry_wake_t* wake) {
+  __atomic_store_n(&wake->armed, 1, __ATOMIC_SEQ_CST);
+  if(fresh_packets(wake) >= wake->min_batch) {
+    // Publicado durante la pasada: no dormir
+    __atomic_store_n(&wake->armed, 0, __ATOMIC_SEQ_CST);
+    return true;
+  }
+  if(!wake->port->wait(wake->ctx, wake->max_delay_ms)) {
+    __atomic_store_n(&wake->armed, 0, __ATOMIC_SEQ_CST);
+    wake->timeouts++;
+  }
+  return fresh_packets(wake) > 0;
+}
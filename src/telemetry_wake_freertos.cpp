@@ -0,0 +1,34 @@
+/**
+ * @file telemetry_wake_freertos.cpp
+ * @brief Avisos de datos nuevos con notificaciones de tarea de FreeRTOS
+ * @author Aarón Ramírez Valencia - TeideSat
+ * @date 16-10-2026
+ *
+ * @details
+ * La notificación de tarea es el mecanismo más ligero de FreeRTOS (sin
+ * objeto aparte ni cola) y queda pendiente si llega antes de que la tarea
+ * espere, que es lo que pide telemetry_wake_port_t. ulTaskNotifyTake() con
+ * pdTRUE consume de una vez todas las que se hayan acumulado.
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "../include/telemetry_wake.h"
+
+static void task_notify(void* ctx) {
+  xTaskNotifyGive((TaskHandle_t)ctx);
+}
+
+static bool task_wait(void* ctx, uint32_t timeout_ms) {
+  (void)ctx; // Siempre espera la tarea que llama
+  return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) > 0;
+}
+
+static const telemetry_wake_port_t s_task_port = {
+  task_notify,
+  task_wait,
+};
+
+const telemetry_wake_port_t* telemetry_wake_port_task(void) {
+  return &s_task_port;
+}